@@ -0,0 +1,126 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/group_committer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+
+GroupCommitter::GroupCommitter(const GroupCommitConfig& config,
+                               MetadataStorePool* metadata_store_pool)
+    : max_delay_(std::max(absl::Microseconds(config.max_delay_micros()),
+                          absl::ZeroDuration())),
+      max_group_size_(std::max(config.max_group_size(), 1)),
+      metadata_store_pool_(metadata_store_pool) {}
+
+absl::Status GroupCommitter::Commit(const Write& write,
+                                    const absl::Time deadline) {
+  std::shared_ptr<Group> group;
+  {
+    absl::MutexLock lock(&mu_);
+    if (open_group_ != nullptr) {
+      // Joins the open group, and waits for its first write to commit it.
+      group = open_group_;
+      const int index = group->writes.size();
+      group->writes.push_back(&write);
+      group->deadline = std::max(group->deadline, deadline);
+      if (index + 1 >= max_group_size_) {
+        group->is_full = true;
+        open_group_ = nullptr;
+      }
+      if (!mu_.AwaitWithDeadline(absl::Condition(&group->is_done),
+                                 deadline)) {
+        if (!group->is_started) {
+          group->writes[index] = nullptr;
+          return absl::DeadlineExceededError(
+              "Deadline exceeded while waiting for the group commit.");
+        }
+        // The write is running, and its queries are stopped once the
+        // deadlines of the group have passed.
+        mu_.Await(absl::Condition(&group->is_done));
+      }
+      return group->statuses[index];
+    }
+    // Opens a new group, and waits for the concurrent writes to join it.
+    group = std::make_shared<Group>();
+    group->writes.push_back(&write);
+    group->deadline = deadline;
+    if (max_group_size_ > 1) {
+      open_group_ = group;
+      mu_.AwaitWithDeadline(absl::Condition(&group->is_full),
+                            std::min(absl::Now() + max_delay_, deadline));
+      if (open_group_ == group) {
+        open_group_ = nullptr;
+      }
+    }
+    group->is_started = true;
+  }
+  // No more writes join the group once it is closed.
+  CommitGroup(group.get());
+  {
+    absl::MutexLock lock(&mu_);
+    group->is_done = true;
+  }
+  return group->statuses[0];
+}
+
+void GroupCommitter::CommitGroup(Group* group) {
+  // The writes which have left the group before it has started are skipped.
+  std::vector<int> indexes;
+  for (int i = 0; i < group->writes.size(); ++i) {
+    if (group->writes[i] != nullptr) {
+      indexes.push_back(i);
+    }
+  }
+  group->statuses.assign(group->writes.size(), absl::OkStatus());
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const absl::Status connection_status =
+      metadata_store_pool_->Acquire(&metadata_store);
+  if (!connection_status.ok()) {
+    group->statuses.assign(group->writes.size(), connection_status);
+    return;
+  }
+  if (group->deadline != absl::InfiniteFuture()) {
+    metadata_store->SetQueryDeadline(group->deadline,
+                                     /*is_cancelled=*/nullptr);
+  }
+  if (indexes.size() == 1) {
+    group->statuses[indexes[0]] =
+        (*group->writes[indexes[0]])(metadata_store.get());
+    return;
+  }
+  const absl::Status transaction_status = metadata_store->ExecuteTransaction(
+      [group, &indexes, &metadata_store]() -> absl::Status {
+        for (const int i : indexes) {
+          MLMD_RETURN_IF_ERROR((*group->writes[i])(metadata_store.get()));
+        }
+        return absl::OkStatus();
+      });
+  if (transaction_status.ok()) {
+    return;
+  }
+  // Isolates the failed writes by running each write in its own transaction.
+  for (const int i : indexes) {
+    group->statuses[i] = (*group->writes[i])(metadata_store.get());
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
+#define ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Commits concurrent write requests together in a single transaction, so that
+// they share the cost of one commit.
+//
+// The first write of a group waits up to `max_delay_micros` for concurrent
+// writes to join, or until the group has `max_group_size` writes, and then runs
+// all of them in one transaction on a store checked out from the pool. The
+// other writes of the group wait until it is committed. If the transaction
+// fails, each write of the group is run again in its own transaction, so that
+// a failed write does not fail the others, and each write gets its own status.
+// A write whose deadline passes before its group starts leaves the group, and
+// the queries of a group are stopped once the deadlines of all of its writes
+// have passed.
+//
+// This class is thread-safe.
+class GroupCommitter {
+ public:
+  // A write request, which runs its MetadataStore method on the given store
+  // and fills its own response. It may be run more than once, in which case
+  // only the updates of the last run are committed.
+  using Write = std::function<absl::Status(MetadataStore* metadata_store)>;
+
+  // Creates a committer which runs the writes on stores from
+  // `metadata_store_pool`, which must outlive this object.
+  GroupCommitter(const GroupCommitConfig& config,
+                 MetadataStorePool* metadata_store_pool);
+
+  // Disallow copy and assign.
+  GroupCommitter(const GroupCommitter&) = delete;
+  GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+  // Runs `write` in a transaction shared with the concurrent writes, and
+  // blocks until the transaction is committed.
+  // Returns DEADLINE_EXCEEDED error, if `deadline` passes before the group of
+  // `write` starts running, in which case `write` is not run.
+  // Returns the error of `write`, or detailed error if the store cannot be
+  // checked out or the transaction cannot be committed.
+  absl::Status Commit(const Write& write,
+                      absl::Time deadline = absl::InfiniteFuture());
+
+ private:
+  // The writes committed in one transaction.
+  struct Group {
+    // The writes of the group, which are null once they have left it.
+    std::vector<const Write*> writes;
+    std::vector<absl::Status> statuses;
+    // The latest deadline of the writes.
+    absl::Time deadline = absl::InfinitePast();
+    // True if the group has `max_group_size_` writes.
+    bool is_full = false;
+    // True if the writes are being run, so that they can no longer leave.
+    bool is_started = false;
+    // True if the statuses of the writes are set.
+    bool is_done = false;
+  };
+
+  // Runs the writes of the closed `group` and sets their statuses.
+  void CommitGroup(Group* group);
+
+  const absl::Duration max_delay_;
+  const int max_group_size_;
+  MetadataStorePool* const metadata_store_pool_;
+
+  absl::Mutex mu_;
+  // The group which new writes join, or null if there is none.
+  std::shared_ptr<Group> open_group_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
@@ -0,0 +1,203 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/group_committer.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAreArray;
+
+class GroupCommitterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // A single pooled connection keeps the in-memory database alive.
+    ConnectionPoolConfig pool_config;
+    pool_config.set_max_pool_size(1);
+    pool_config.set_max_idle_time_sec(0);
+    pool_ = absl::make_unique<MetadataStorePool>(
+        pool_config, [](std::unique_ptr<MetadataStore>* result) {
+          ConnectionConfig connection_config;
+          connection_config.mutable_fake_database();
+          return CreateMetadataStore(connection_config, result);
+        });
+    MetadataStorePool::ScopedMetadataStore metadata_store;
+    ASSERT_EQ(absl::OkStatus(), pool_->Acquire(&metadata_store));
+    PutArtifactTypeResponse response;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_store->PutArtifactType(
+                  ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+                    all_fields_match: true
+                    artifact_type: { name: 'test_type' }
+                  )"),
+                  &response));
+    type_id_ = response.type_id();
+  }
+
+  // Returns the ids of the stored artifacts.
+  std::vector<int64> GetArtifactIds() {
+    MetadataStorePool::ScopedMetadataStore metadata_store;
+    CHECK_EQ(absl::OkStatus(), pool_->Acquire(&metadata_store));
+    GetArtifactsResponse response;
+    CHECK_EQ(absl::OkStatus(),
+             metadata_store->GetArtifacts(GetArtifactsRequest(), &response));
+    std::vector<int64> artifact_ids;
+    for (const Artifact& artifact : response.artifacts()) {
+      artifact_ids.push_back(artifact.id());
+    }
+    return artifact_ids;
+  }
+
+  std::unique_ptr<MetadataStorePool> pool_;
+  int64 type_id_;
+};
+
+TEST_F(GroupCommitterTest, CommitsConcurrentWritesTogether) {
+  // A group is committed once it is full, well before the max delay.
+  GroupCommitConfig config;
+  config.set_max_delay_micros(absl::ToInt64Microseconds(absl::Minutes(10)));
+  config.set_max_group_size(4);
+  GroupCommitter group_committer(config, pool_.get());
+
+  std::vector<int64> artifact_ids(4, -1);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i]() {
+      PutArtifactsRequest request;
+      request.add_artifacts()->set_type_id(type_id_);
+      PutArtifactsResponse response;
+      EXPECT_EQ(absl::OkStatus(),
+                group_committer.Commit([&](MetadataStore* metadata_store) {
+                  return metadata_store->PutArtifacts(request, &response);
+                }));
+      ASSERT_THAT(response.artifact_ids(), SizeIs(1));
+      artifact_ids[i] = response.artifact_ids(0);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(GetArtifactIds(), UnorderedElementsAreArray(artifact_ids));
+}
+
+TEST_F(GroupCommitterTest, FailedWriteDoesNotFailOtherWrites) {
+  GroupCommitConfig config;
+  config.set_max_delay_micros(absl::ToInt64Microseconds(absl::Minutes(10)));
+  config.set_max_group_size(2);
+  GroupCommitter group_committer(config, pool_.get());
+
+  std::atomic<int> num_valid_write_runs(0);
+  PutArtifactsResponse valid_response;
+  absl::Status valid_status, invalid_status;
+  std::thread valid_write([&]() {
+    PutArtifactsRequest request;
+    request.add_artifacts()->set_type_id(type_id_);
+    valid_status = group_committer.Commit([&](MetadataStore* metadata_store) {
+      ++num_valid_write_runs;
+      return metadata_store->PutArtifacts(request, &valid_response);
+    });
+  });
+  std::thread invalid_write([&]() {
+    PutArtifactsRequest request;
+    request.add_artifacts()->set_type_id(type_id_ + 1);
+    PutArtifactsResponse response;
+    invalid_status = group_committer.Commit([&](MetadataStore* metadata_store) {
+      return metadata_store->PutArtifacts(request, &response);
+    });
+  });
+  valid_write.join();
+  invalid_write.join();
+
+  EXPECT_EQ(absl::OkStatus(), valid_status);
+  EXPECT_FALSE(invalid_status.ok());
+  // The valid write is run again in its own transaction.
+  EXPECT_EQ(2, num_valid_write_runs);
+  ASSERT_THAT(valid_response.artifact_ids(), SizeIs(1));
+  EXPECT_THAT(GetArtifactIds(),
+              UnorderedElementsAreArray(valid_response.artifact_ids()));
+}
+
+TEST_F(GroupCommitterTest, WriteLeavesGroupAtDeadline) {
+  // The group waits for a third write, well past the deadline of the second.
+  GroupCommitConfig config;
+  config.set_max_delay_micros(absl::ToInt64Microseconds(absl::Seconds(2)));
+  config.set_max_group_size(3);
+  GroupCommitter group_committer(config, pool_.get());
+
+  PutArtifactsResponse first_response;
+  absl::Status first_status;
+  std::thread first_write([&]() {
+    PutArtifactsRequest request;
+    request.add_artifacts()->set_type_id(type_id_);
+    first_status = group_committer.Commit([&](MetadataStore* metadata_store) {
+      return metadata_store->PutArtifacts(request, &first_response);
+    });
+  });
+  absl::SleepFor(absl::Milliseconds(200));
+  std::atomic<int> num_late_write_runs(0);
+  PutArtifactsRequest request;
+  request.add_artifacts()->set_type_id(type_id_);
+  PutArtifactsResponse response;
+  const absl::Status late_status = group_committer.Commit(
+      [&](MetadataStore* metadata_store) {
+        ++num_late_write_runs;
+        return metadata_store->PutArtifacts(request, &response);
+      },
+      absl::Now() + absl::Milliseconds(200));
+  first_write.join();
+
+  EXPECT_TRUE(absl::IsDeadlineExceeded(late_status));
+  EXPECT_EQ(0, num_late_write_runs);
+  EXPECT_EQ(absl::OkStatus(), first_status);
+  EXPECT_THAT(GetArtifactIds(),
+              UnorderedElementsAreArray(first_response.artifact_ids()));
+}
+
+TEST_F(GroupCommitterTest, CommitsSingleWriteAfterMaxDelay) {
+  GroupCommitConfig config;
+  config.set_max_delay_micros(1000);
+  GroupCommitter group_committer(config, pool_.get());
+
+  PutArtifactsRequest request;
+  request.add_artifacts()->set_type_id(type_id_);
+  PutArtifactsResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            group_committer.Commit([&](MetadataStore* metadata_store) {
+              return metadata_store->PutArtifacts(request, &response);
+            }));
+  EXPECT_THAT(GetArtifactIds(),
+              UnorderedElementsAreArray(response.artifact_ids()));
+}
+
+}  // namespace
+}  // namespace ml_metadata
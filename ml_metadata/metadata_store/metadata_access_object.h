@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "google/protobuf/field_mask.pb.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/types/optional.h"
@@ -201,6 +202,13 @@ class MetadataAccessObject {
   virtual absl::Status CreateArtifact(const Artifact& artifact,
                                       int64* artifact_id) = 0;
 
+  // Creates the `artifacts` as CreateArtifact, with bulk inserts of the
+  // artifacts and their properties, and returns the assigned ids in the order
+  // of `artifacts`. Either all of them are created, or none.
+  // Returns the same errors as CreateArtifact for any of the artifacts.
+  virtual absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                                       std::vector<int64>* artifact_ids) = 0;
+
   // Retrieves artifacts matching the given 'artifact_ids'.
   // Returns NOT_FOUND error, if any of the given artifact_ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -265,6 +273,32 @@ class MetadataAccessObject {
                                     std::vector<Context>* contexts,
                                     std::string* next_page_token) = 0;
 
+  // Queries up to `max_num_artifacts` artifacts with ids greater than
+  // `after_id` in ascending order of id. Unlike ListArtifacts, it walks the
+  // artifacts by their primary key without page tokens, which is used to read
+  // all of them in large batches.
+  // RETURNS INVALID_ARGUMENT if `max_num_artifacts` is not positive or
+  //    `artifacts` is not empty.
+  virtual absl::Status ListArtifactsAfterId(
+      int64 after_id, int max_num_artifacts,
+      std::vector<Artifact>* artifacts) = 0;
+
+  // Queries up to `max_num_executions` executions with ids greater than
+  // `after_id` in ascending order of id.
+  // RETURNS INVALID_ARGUMENT if `max_num_executions` is not positive or
+  //    `executions` is not empty.
+  virtual absl::Status ListExecutionsAfterId(
+      int64 after_id, int max_num_executions,
+      std::vector<Execution>* executions) = 0;
+
+  // Queries up to `max_num_contexts` contexts with ids greater than `after_id`
+  // in ascending order of id.
+  // RETURNS INVALID_ARGUMENT if `max_num_contexts` is not positive or
+  //    `contexts` is not empty.
+  virtual absl::Status ListContextsAfterId(int64 after_id,
+                                           int max_num_contexts,
+                                           std::vector<Context>* contexts) = 0;
+
   // Queries an artifact by its type_id and name.
   // Returns NOT_FOUND error, if no artifact can be found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -294,6 +328,25 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateArtifact(const Artifact& artifact) = 0;
 
+  // Updates the fields of an artifact listed in `update_mask` without reading
+  // it first. The paths are "uri", "state", "properties.<name>" and
+  // "custom_properties.<name>"; a listed property which is not in the artifact
+  // is deleted. If `last_update_time` is given, the artifact is only updated
+  // if its last_update_time_since_epoch is still the same.
+  // Returns INVALID_ARGUMENT error, if the id field is not given.
+  // Returns INVALID_ARGUMENT error, if a path of `update_mask` is unknown.
+  // Returns INVALID_ARGUMENT error, if properties are listed and the type_id
+  // is not given, or they do not align with the ArtifactType on file.
+  // Returns INVALID_ARGUMENT error, if no artifact is found with the given id.
+  // Returns INVALID_ARGUMENT error, if type_id is given and is different from
+  // the one stored.
+  // Returns FAILED_PRECONDITION error, if the last_update_time_since_epoch of
+  // the artifact is different from `last_update_time`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status UpdateArtifact(
+      const Artifact& artifact, const google::protobuf::FieldMask& update_mask,
+      absl::optional<int64> last_update_time) = 0;
+
   // Creates an execution, returns the assigned execution id. The id field of
   // the execution is ignored.
   // Returns INVALID_ARGUMENT error, if the ExecutionType is not given.
@@ -308,6 +361,10 @@ class MetadataAccessObject {
   virtual absl::Status CreateExecution(const Execution& execution,
                                        int64* execution_id) = 0;
 
+  // Creates the `executions` as CreateArtifacts.
+  virtual absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves executions matching the given 'ids'.
   // Returns NOT_FOUND error, if any of the given ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -344,6 +401,14 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateExecution(const Execution& execution) = 0;
 
+  // Updates the fields of an execution listed in `update_mask` without reading
+  // it first, as UpdateArtifact. The paths are "last_known_state",
+  // "properties.<name>" and "custom_properties.<name>".
+  virtual absl::Status UpdateExecution(
+      const Execution& execution,
+      const google::protobuf::FieldMask& update_mask,
+      absl::optional<int64> last_update_time) = 0;
+
   // Creates a context, returns the assigned context id. The id field of the
   // context is ignored. The name field of the context must not be empty and it
   // should be unique in the same ContextType.
@@ -359,6 +424,10 @@ class MetadataAccessObject {
   virtual absl::Status CreateContext(const Context& context,
                                      int64* context_id) = 0;
 
+  // Creates the `contexts` as CreateArtifacts.
+  virtual absl::Status CreateContexts(absl::Span<const Context> contexts,
+                                      std::vector<int64>* context_ids) = 0;
+
   // Retrieves contexts matching a collection of ids.
   // Returns NOT_FOUND if any of the given ids are not found.
   // Returns detailed INTERNAL error if query execution fails.
@@ -395,6 +464,15 @@ class MetadataAccessObject {
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status UpdateContext(const Context& context) = 0;
 
+  // Updates the fields of a context listed in `update_mask` without reading it
+  // first, as UpdateArtifact. The paths are "name", "properties.<name>" and
+  // "custom_properties.<name>".
+  // Returns ALREADY_EXISTS error, if the updated name is used by another
+  // context of the same ContextType.
+  virtual absl::Status UpdateContext(
+      const Context& context, const google::protobuf::FieldMask& update_mask,
+      absl::optional<int64> last_update_time) = 0;
+
   // Creates an event, returns the assigned event id. If the event occurrence
   // time is not given, the insertion time is used.
   // TODO(huimiao) Allow to have a unknown event time.
@@ -404,6 +482,13 @@ class MetadataAccessObject {
   // Returns ALREADY_EXIST error, if duplicated event is found.
   virtual absl::Status CreateEvent(const Event& event, int64* event_id) = 0;
 
+  // Creates an event as CreateEvent above. If `is_already_validated` is true,
+  // the artifact and the execution of the event are known to exist, e.g., as
+  // they have been stored in the same transaction, and are not looked up.
+  virtual absl::Status CreateEvent(const Event& event,
+                                   bool is_already_validated,
+                                   int64* event_id) = 0;
+
   // Queries the events associated with a collection of artifact_ids.
   // Returns NOT_FOUND error, if no `events` can be found.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
@@ -423,6 +508,13 @@ class MetadataAccessObject {
   virtual absl::Status CreateAssociation(const Association& association,
                                          int64* association_id) = 0;
 
+  // Creates an association as CreateAssociation above. If
+  // `is_already_validated` is true, the context and the execution of the
+  // association are known to exist, and are not looked up.
+  virtual absl::Status CreateAssociation(const Association& association,
+                                         bool is_already_validated,
+                                         int64* association_id) = 0;
+
 
   // Queries the contexts that an execution_id is associated with.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
@@ -447,6 +539,13 @@ class MetadataAccessObject {
   virtual absl::Status CreateAttribution(const Attribution& attribution,
                                          int64* attribution_id) = 0;
 
+  // Creates an attribution as CreateAttribution above. If
+  // `is_already_validated` is true, the context and the artifact of the
+  // attribution are known to exist, and are not looked up.
+  virtual absl::Status CreateAttribution(const Attribution& attribution,
+                                         bool is_already_validated,
+                                         int64* attribution_id) = 0;
+
   // Queries the contexts that an artifact_id is attributed to.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindContextsByArtifact(
@@ -32,7 +32,7 @@ namespace {
 absl::Status CreateRDBMSMetadataAccessObject(
     const MetadataSourceQueryConfig& query_config,
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
-    std::unique_ptr<MetadataAccessObject>* result) {
+    TypeCache* type_cache, std::unique_ptr<MetadataAccessObject>* result) {
   if (!metadata_source->is_connected())
     MLMD_RETURN_IF_ERROR(metadata_source->Connect());
   std::unique_ptr<QueryExecutor> executor =
@@ -41,8 +41,8 @@ absl::Status CreateRDBMSMetadataAccessObject(
                 query_config, metadata_source, *schema_version))
           : absl::WrapUnique(
                 new QueryConfigExecutor(query_config, metadata_source));
-  *result =
-      absl::WrapUnique(new RDBMSMetadataAccessObject(std::move(executor)));
+  *result = absl::WrapUnique(
+      new RDBMSMetadataAccessObject(std::move(executor), type_cache));
   return absl::OkStatus();
 }
 
@@ -62,16 +62,27 @@ absl::Status CreateMetadataAccessObject(
     const MetadataSourceQueryConfig& query_config,
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
     std::unique_ptr<MetadataAccessObject>* result) {
+  return CreateMetadataAccessObject(query_config, metadata_source,
+                                    schema_version, /*type_cache=*/nullptr,
+                                    result);
+}
+
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, std::unique_ptr<MetadataAccessObject>* result) {
   switch (query_config.metadata_source_type()) {
     case UNKNOWN_METADATA_SOURCE:
       return absl::InvalidArgumentError(
           "Metadata source type is not specified.");
     case MYSQL_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
-                                             schema_version, result);
+                                             schema_version, type_cache,
+                                             result);
     case SQLITE_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
-                                             schema_version, result);
+                                             schema_version, type_cache,
+                                             result);
     default:
       return absl::UnimplementedError("Unknown Metadata source type.");
   }
@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
 namespace ml_metadata {
@@ -44,6 +45,14 @@ absl::Status CreateMetadataAccessObject(
     MetadataSource* const metadata_source, absl::optional<int64> schema_version,
     std::unique_ptr<MetadataAccessObject>* result);
 
+// The MetadataAccessObject caches the types in `type_cache` if it is not null.
+// The cache must be shared only by the connections to the same database, and
+// outlive the MetadataAccessObject.
+absl::Status CreateMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    TypeCache* type_cache, std::unique_ptr<MetadataAccessObject>* result);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_METADATA_ACCESS_OBJECT_FACTORY_H_
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "gflags/gflags.h"
 #include <glog/logging.h>
+#include "google/protobuf/field_mask.pb.h"
 #include "google/protobuf/repeated_field.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -1594,6 +1595,69 @@ TEST_P(MetadataAccessObjectTest, CreateArtifactWithDuplicatedNameError) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateArtifacts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  std::vector<Artifact> artifacts = {
+      ParseTextProtoOrDie<Artifact>(R"(
+        uri: 'testuri://testing/uri1'
+        name: 'artifact_1'
+        properties {
+          key: 'property_1'
+          value: { int_value: 3 }
+        }
+        custom_properties {
+          key: 'custom_property_1'
+          value: { double_value: 3.0 }
+        }
+      )"),
+      ParseTextProtoOrDie<Artifact>(R"(
+        uri: 'testuri://testing/uri2'
+        state: LIVE
+        properties {
+          key: 'property_2'
+          value: { string_value: '3' }
+        }
+      )")};
+  for (Artifact& artifact : artifacts) {
+    artifact.set_type_id(type_id);
+  }
+
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  artifacts, &artifact_ids));
+  ASSERT_THAT(artifact_ids, SizeIs(2));
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &got_artifacts));
+  for (int i = 0; i < 2; ++i) {
+    artifacts[i].set_id(artifact_ids[i]);
+  }
+  EXPECT_THAT(got_artifacts,
+              UnorderedPointwise(
+                  EqualsProto<Artifact>(/*ignore_fields=*/{
+                      "type", "create_time_since_epoch",
+                      "last_update_time_since_epoch"}),
+                  artifacts));
+
+  // Creates none of the artifacts if any of them already exists.
+  Artifact new_artifact = artifacts[1];
+  new_artifact.clear_id();
+  new_artifact.set_name("artifact_3");
+  artifacts[0].clear_id();
+  EXPECT_TRUE(absl::IsAlreadyExists(metadata_access_object_->CreateArtifacts(
+      {new_artifact, artifacts[0]}, &artifact_ids)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+}
+
 TEST_P(MetadataAccessObjectTest, FindArtifactById) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -4780,6 +4844,190 @@ TEST_P(MetadataAccessObjectTest, UpdateArtifactError) {
   EXPECT_TRUE(absl::IsInvalidArgument(s));
 }
 
+TEST_P(MetadataAccessObjectTest, UpdateArtifactWithMask) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: DOUBLE }
+    properties { key: 'property_3' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact stored_artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    properties {
+      key: 'property_1'
+      value: { int_value: 3 }
+    }
+    properties {
+      key: 'property_3'
+      value: { string_value: '3' }
+    }
+    custom_properties {
+      key: 'custom_property_1'
+      value: { string_value: '5' }
+    }
+    state: LIVE
+  )");
+  stored_artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifact(
+                                  stored_artifact, &artifact_id));
+  Artifact got_artifact_before_update;
+  {
+    std::vector<Artifact> artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                    {artifact_id}, &artifacts));
+    got_artifact_before_update = artifacts.at(0);
+  }
+
+  // update the uri and `property_1`, add `property_2` and
+  // `custom_property_2`, and drop `property_3`; the state and
+  // `custom_property_1` are not listed, so they are kept.
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://changed/uri'
+    properties {
+      key: 'property_1'
+      value: { int_value: 5 }
+    }
+    properties {
+      key: 'property_2'
+      value: { double_value: 3.0 }
+    }
+    custom_properties {
+      key: 'custom_property_2'
+      value: { int_value: 3 }
+    }
+    state: DELETED
+  )");
+  artifact.set_id(artifact_id);
+  artifact.set_type_id(type_id);
+  const google::protobuf::FieldMask update_mask =
+      ParseTextProtoOrDie<google::protobuf::FieldMask>(R"(
+        paths: 'uri'
+        paths: 'properties.property_1'
+        paths: 'properties.property_2'
+        paths: 'properties.property_3'
+        paths: 'custom_properties.custom_property_2'
+      )");
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->UpdateArtifact(
+                artifact, update_mask,
+                got_artifact_before_update.last_update_time_since_epoch()));
+
+  Artifact want_artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://changed/uri'
+    properties {
+      key: 'property_1'
+      value: { int_value: 5 }
+    }
+    properties {
+      key: 'property_2'
+      value: { double_value: 3.0 }
+    }
+    custom_properties {
+      key: 'custom_property_1'
+      value: { string_value: '5' }
+    }
+    custom_properties {
+      key: 'custom_property_2'
+      value: { int_value: 3 }
+    }
+    state: LIVE
+  )");
+  want_artifact.set_id(artifact_id);
+  want_artifact.set_type_id(type_id);
+  Artifact got_artifact_after_update;
+  {
+    std::vector<Artifact> artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                    {artifact_id}, &artifacts));
+    got_artifact_after_update = artifacts.at(0);
+  }
+  EXPECT_THAT(got_artifact_after_update,
+              EqualsProto(want_artifact,
+                          /*ignore_fields=*/{"create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+  EXPECT_LT(got_artifact_before_update.last_update_time_since_epoch(),
+            got_artifact_after_update.last_update_time_since_epoch());
+}
+
+TEST_P(MetadataAccessObjectTest, UpdateArtifactWithMaskError) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+  )");
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  {
+    std::vector<Artifact> artifacts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                    {artifact_id}, &artifacts));
+    artifact = artifacts.at(0);
+  }
+  google::protobuf::FieldMask uri_mask;
+  uri_mask.add_paths("uri");
+
+  // no artifact id given
+  Artifact wrong_artifact;
+  absl::Status s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, uri_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // unknown path
+  wrong_artifact.set_id(artifact_id);
+  google::protobuf::FieldMask unknown_mask;
+  unknown_mask.add_paths("create_time_since_epoch");
+  s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, unknown_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // properties are updated without type_id
+  (*wrong_artifact.mutable_properties())["property_1"].set_int_value(1);
+  google::protobuf::FieldMask property_mask;
+  property_mask.add_paths("properties.property_1");
+  s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, property_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // property does not match with the type
+  wrong_artifact.set_type_id(type_id);
+  (*wrong_artifact.mutable_properties())["property_1"].set_string_value("1");
+  s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, property_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // artifact id cannot be found
+  wrong_artifact.clear_properties();
+  wrong_artifact.set_id(artifact_id + 1);
+  s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, uri_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // type_id if given is not aligned with the stored one
+  wrong_artifact.set_id(artifact_id);
+  wrong_artifact.set_type_id(type_id + 1);
+  s = metadata_access_object_->UpdateArtifact(
+      wrong_artifact, uri_mask, /*last_update_time=*/absl::nullopt);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+
+  // the artifact has been updated after the given last_update_time
+  s = metadata_access_object_->UpdateArtifact(
+      artifact, uri_mask, artifact.last_update_time_since_epoch() - 1);
+  EXPECT_TRUE(absl::IsFailedPrecondition(s));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateAndFindExecution) {
   ASSERT_EQ(absl::OkStatus(), Init());
   // Creates execution 1 with type 1
@@ -5610,6 +5858,52 @@ TEST_P(MetadataAccessObjectTest, UpdateContext) {
             got_context_after_update.last_update_time_since_epoch());
 }
 
+TEST_P(MetadataAccessObjectTest, UpdateContextWithMask) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 type_id = InsertType<ContextType>("test_type");
+  Context context1 = ParseTextProtoOrDie<Context>(R"(
+    name: "context1"
+    custom_properties {
+      key: 'custom_property_1'
+      value: { string_value: '5' }
+    }
+  )");
+  context1.set_type_id(type_id);
+  Context context2 = ParseTextProtoOrDie<Context>("name: 'context2'");
+  context2.set_type_id(type_id);
+  int64 context1_id, context2_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context1, &context1_id));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateContext(context2, &context2_id));
+
+  // rename context1 and drop `custom_property_1`
+  Context context;
+  context.set_id(context1_id);
+  context.set_name("renamed context1");
+  const google::protobuf::FieldMask update_mask =
+      ParseTextProtoOrDie<google::protobuf::FieldMask>(R"(
+        paths: 'name'
+        paths: 'custom_properties.custom_property_1'
+      )");
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->UpdateContext(
+                context, update_mask, /*last_update_time=*/absl::nullopt));
+  {
+    std::vector<Context> contexts;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsById(
+                                    {context1_id}, &contexts));
+    ASSERT_THAT(contexts, ::testing::SizeIs(1));
+    EXPECT_EQ("renamed context1", contexts[0].name());
+    EXPECT_THAT(contexts[0].custom_properties(), ::testing::IsEmpty());
+  }
+
+  // the name is used by context2 of the same type
+  context.set_name("context2");
+  EXPECT_TRUE(absl::IsAlreadyExists(metadata_access_object_->UpdateContext(
+      context, update_mask, /*last_update_time=*/absl::nullopt)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateAndUseAssociation) {
   ASSERT_EQ(absl::OkStatus(), Init());
   int64 execution_type_id = InsertType<ExecutionType>("execution_type");
@@ -14,7 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_source.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
@@ -40,11 +47,125 @@ absl::Status MetadataSource::Close() {
 
 absl::Status MetadataSource::ExecuteQuery(const std::string& query,
                                           RecordSet* results) {
+  if (results == nullptr) {
+    return ExecuteQuery(query, static_cast<ResultSet*>(nullptr));
+  }
+  ResultSet result_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query, &result_set));
+  *results = result_set.ToRecordSet();
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::CheckQueryPreconditions() const {
   if (!is_connected_)
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  return ExecuteQueryImpl(query, results);
+  return CheckQueryDeadline();
+}
+
+absl::Status MetadataSource::ExecuteQuery(const std::string& query,
+                                          ResultSet* results) {
+  MLMD_RETURN_IF_ERROR(CheckQueryPreconditions());
+  if (results != nullptr) {
+    results->Clear();
+  }
+  MLMD_RETURN_IF_ERROR(ExecuteQueryImpl(query, results));
+  ++num_queries_;
+  if (results != nullptr) {
+    num_rows_ += results->num_rows();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteTemplateQuery(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters, ResultSet* results) {
+  MLMD_RETURN_IF_ERROR(CheckQueryPreconditions());
+  if (results != nullptr) {
+    results->Clear();
+  }
+  MLMD_RETURN_IF_ERROR(
+      ExecuteTemplateQueryImpl(query_template, parameters, results));
+  ++num_queries_;
+  if (results != nullptr) {
+    num_rows_ += results->num_rows();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteTemplateQueryImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters, ResultSet* results) {
+  return ExecuteQueryImpl(ComposeQuery(query_template, parameters), results);
+}
+
+std::string MetadataSource::ComposeQuery(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters) const {
+  return query_template.Substitute(
+      parameters,
+      [this](absl::string_view value) { return EscapeString(value); });
+}
+
+absl::Status MetadataSource::ExecuteQueryStreaming(
+    const std::string& query, const RowBatchCallback callback) {
+  MLMD_RETURN_IF_ERROR(CheckQueryPreconditions());
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQueryStreamingImpl(query, [&](const ResultSet& rows) {
+        num_rows_ += rows.num_rows();
+        return callback(rows);
+      }));
+  ++num_queries_;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteTemplateQueryStreaming(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    const RowBatchCallback callback) {
+  MLMD_RETURN_IF_ERROR(CheckQueryPreconditions());
+  MLMD_RETURN_IF_ERROR(ExecuteTemplateQueryStreamingImpl(
+      query_template, parameters, [&](const ResultSet& rows) {
+        num_rows_ += rows.num_rows();
+        return callback(rows);
+      }));
+  ++num_queries_;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteQueryStreamingImpl(
+    const std::string& query, const RowBatchCallback callback) {
+  ResultSet results;
+  MLMD_RETURN_IF_ERROR(ExecuteQueryImpl(query, &results));
+  if (results.num_rows() == 0) return absl::OkStatus();
+  return callback(results);
+}
+
+absl::Status MetadataSource::ExecuteTemplateQueryStreamingImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    const RowBatchCallback callback) {
+  return ExecuteQueryStreamingImpl(ComposeQuery(query_template, parameters),
+                                   callback);
+}
+
+absl::Status MetadataSource::ExecuteBatch(
+    const absl::Span<const BatchedQuery> queries) {
+  MLMD_RETURN_IF_ERROR(CheckQueryPreconditions());
+  if (queries.empty()) return absl::OkStatus();
+  MLMD_RETURN_IF_ERROR(ExecuteBatchImpl(queries));
+  num_queries_ += queries.size();
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::ExecuteBatchImpl(
+    const absl::Span<const BatchedQuery> queries) {
+  for (const BatchedQuery& query : queries) {
+    MLMD_RETURN_IF_ERROR(ExecuteTemplateQueryImpl(
+        *query.query_template, query.parameters, /*results=*/nullptr));
+  }
+  return absl::OkStatus();
 }
 
 absl::Status MetadataSource::Begin() {
@@ -54,9 +175,24 @@ absl::Status MetadataSource::Begin() {
     return absl::FailedPreconditionError("Transaction already open.");
   MLMD_RETURN_IF_ERROR(BeginImpl());
   transaction_open_ = true;
+  transaction_read_only_ = false;
+  ++num_transactions_;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::BeginReadOnly() {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (transaction_open_)
+    return absl::FailedPreconditionError("Transaction already open.");
+  MLMD_RETURN_IF_ERROR(BeginReadOnlyImpl());
+  transaction_open_ = true;
+  transaction_read_only_ = true;
+  ++num_transactions_;
   return absl::OkStatus();
 }
 
+absl::Status MetadataSource::BeginReadOnlyImpl() { return BeginImpl(); }
 
 absl::Status MetadataSource::Commit() {
   if (!is_connected_)
@@ -78,4 +214,40 @@ absl::Status MetadataSource::Rollback() {
   return absl::OkStatus();
 }
 
+absl::Status MetadataSource::Savepoint(const absl::string_view name) {
+  return ExecuteQuery(absl::StrCat("SAVEPOINT ", name), nullptr);
+}
+
+absl::Status MetadataSource::RollbackToSavepoint(const absl::string_view name) {
+  return ExecuteQuery(absl::StrCat("ROLLBACK TO SAVEPOINT ", name), nullptr);
+}
+
+absl::Status MetadataSource::ReleaseSavepoint(const absl::string_view name) {
+  return ExecuteQuery(absl::StrCat("RELEASE SAVEPOINT ", name), nullptr);
+}
+
+void MetadataSource::SetQueryDeadline(absl::Time deadline,
+                                      std::function<bool()> is_cancelled) {
+  query_deadline_ = deadline;
+  is_query_cancelled_ = std::move(is_cancelled);
+}
+
+void MetadataSource::ClearQueryDeadline() {
+  query_deadline_ = absl::InfiniteFuture();
+  is_query_cancelled_ = nullptr;
+  ClearQueryDeadlineImpl();
+}
+
+absl::Status MetadataSource::CheckQueryDeadline() const {
+  if (query_deadline_ != absl::InfiniteFuture() &&
+      absl::Now() >= query_deadline_) {
+    return absl::DeadlineExceededError(
+        "The deadline of the query has passed.");
+  }
+  if (is_query_cancelled_ != nullptr && is_query_cancelled_()) {
+    return absl::CancelledError("The query is cancelled.");
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace ml_metadata
@@ -15,11 +15,19 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_SOURCE_H_
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
@@ -53,6 +61,18 @@ namespace ml_metadata {
 // the MetadataSource using ScopedTransaction below.
 class MetadataSource {
  public:
+  // Receives the consecutive batches of the rows of a streamed query. The rows
+  // are only valid during the call. A non-OK status stops the query.
+  using RowBatchCallback =
+      absl::FunctionRef<absl::Status(const ResultSet& rows)>;
+
+  // A template query and its parameters, as given to ExecuteTemplateQuery.
+  // The template is not owned, and must outlast the batch.
+  struct BatchedQuery {
+    const QueryTemplate* query_template;
+    std::vector<QueryParameter> parameters;
+  };
+
   MetadataSource() = default;
   // Releases opened resources if any during destruction.
   virtual ~MetadataSource() = default;
@@ -83,11 +103,75 @@ class MetadataSource {
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(const std::string& query, RecordSet* results);
 
+  // Runs a query as above, and returns the rows with the types of their values.
+  absl::Status ExecuteQuery(const std::string& query, ResultSet* results);
+
+  // Runs a query as above, whose results are ignored.
+  absl::Status ExecuteQuery(const std::string& query, std::nullptr_t) {
+    return ExecuteQuery(query, static_cast<ResultSet*>(nullptr));
+  }
+
+  // Runs the query of `query_template` whose placeholders `$0`, `$1`, ... are
+  // given by the `parameters`. Backends may prepare the statement of a
+  // template once and bind the values among the parameters to it, instead of
+  // parsing the query composed with them each time.
+  // Returns the same errors as ExecuteQuery.
+  absl::Status ExecuteTemplateQuery(const QueryTemplate& query_template,
+                                    absl::Span<const QueryParameter> parameters,
+                                    ResultSet* results);
+
+  // Runs a template query as above, which is compiled for this query only.
+  absl::Status ExecuteTemplateQuery(const std::string& query_template,
+                                    absl::Span<const QueryParameter> parameters,
+                                    ResultSet* results) {
+    return ExecuteTemplateQuery(
+        QueryTemplate(query_template, /*is_reused=*/false), parameters,
+        results);
+  }
+
+  // Runs a query as ExecuteQuery, and passes its rows to `callback` in batches
+  // as they are read from the backend, instead of keeping all of them in
+  // memory, e.g., to scan tables larger than the memory. The callback must not
+  // run queries on this source, as the rows of the streamed query may still be
+  // pending on the connection.
+  // Returns the error of `callback`, if it fails, and the same errors as
+  // ExecuteQuery otherwise.
+  absl::Status ExecuteQueryStreaming(const std::string& query,
+                                     RowBatchCallback callback);
+
+  // Runs a template query as ExecuteTemplateQuery, and streams its rows as
+  // ExecuteQueryStreaming.
+  absl::Status ExecuteTemplateQueryStreaming(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters, RowBatchCallback callback);
+
+  // Streams a template query as above, which is compiled for this query only.
+  absl::Status ExecuteTemplateQueryStreaming(
+      const std::string& query_template,
+      absl::Span<const QueryParameter> parameters, RowBatchCallback callback) {
+    return ExecuteTemplateQueryStreaming(
+        QueryTemplate(query_template, /*is_reused=*/false), parameters,
+        callback);
+  }
+
+  // Runs the template queries of `queries` in order, whose results are
+  // ignored, and stops at the first failed one. The backends which can send
+  // several statements at once do so, e.g., to save the round trips of the
+  // writes of a transaction which do not depend on each other.
+  // Returns the error of the failed query, and the same errors as ExecuteQuery.
+  absl::Status ExecuteBatch(absl::Span<const BatchedQuery> queries);
+
   // Begins (opens) a transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns FAILED_PRECONDITION error, if a transaction has already begun.
   absl::Status Begin();
 
+  // Begins (opens) a transaction which only reads, and so runs with less
+  // locking where the backend allows it, e.g., on a snapshot which neither
+  // waits for nor blocks the writers. The queries in the transaction must not
+  // write; the backends which enforce it fail the writes.
+  // Returns the same errors as Begin.
+  absl::Status BeginReadOnly();
 
   // Commits a transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
@@ -102,16 +186,78 @@ class MetadataSource {
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status Rollback();
 
+  // Sets the savepoint `name` in the open transaction, to which the
+  // transaction can be rolled back without undoing its earlier updates.
+  // `name` must be an SQL identifier.
+  // Returns the same errors as ExecuteQuery.
+  absl::Status Savepoint(absl::string_view name);
+
+  // Undoes the updates made since the savepoint `name`, which is kept.
+  // Returns the same errors as ExecuteQuery.
+  absl::Status RollbackToSavepoint(absl::string_view name);
+
+  // Removes the savepoint `name` and the ones set after it, while their
+  // updates are kept in the transaction.
+  // Returns the same errors as ExecuteQuery.
+  absl::Status ReleaseSavepoint(absl::string_view name);
+
+  // Stops the queries which are still running at `deadline` with
+  // DEADLINE_EXCEEDED error, and the ones running once `is_cancelled` returns
+  // true with CANCELLED error, e.g., when the client of the request they serve
+  // has given up. Queries are not started once the deadline has passed, and
+  // the backends which can interrupt a running statement do so. `is_cancelled`
+  // may be null, and must be cheap, as it is polled while queries run.
+  // The deadline applies to all the following queries until it is cleared.
+  void SetQueryDeadline(absl::Time deadline,
+                        std::function<bool()> is_cancelled);
+
+  // Clears the deadline set with SetQueryDeadline.
+  void ClearQueryDeadline();
+
+  // Returns DEADLINE_EXCEEDED error, if the query deadline has passed, or
+  // CANCELLED error, if the queries are cancelled.
+  absl::Status CheckQueryDeadline() const;
+
   // Utility method to escape characters specific to the metadata source. The
   // returned string is used to bind text parameters for query composition. The
   // escaping characters and method depends on the metadata source backend.
   virtual std::string EscapeString(absl::string_view value) const = 0;
 
+  // Returns the text of the query of `query_template` with the `parameters`,
+  // whose strings are escaped with EscapeString.
+  std::string ComposeQuery(const QueryTemplate& query_template,
+                           absl::Span<const QueryParameter> parameters) const;
+
   bool is_connected() const { return is_connected_; }
 
- protected:
   bool transaction_open() const { return transaction_open_; }
 
+  // Returns true if the open transaction has begun with BeginReadOnly.
+  bool transaction_read_only() const { return transaction_read_only_; }
+
+  // Returns the number of queries run successfully on this source.
+  int64 num_queries() const { return num_queries_; }
+
+  // Returns the number of rows returned by the queries run on this source.
+  int64 num_rows() const { return num_rows_; }
+
+  // Returns the number of transactions begun on this source, which tells the
+  // transactions apart, e.g., to keep state for the open one.
+  int64 num_transactions() const { return num_transactions_; }
+
+ protected:
+  // Returns true if a query deadline or cancellation check is set.
+  bool has_query_deadline() const {
+    return query_deadline_ != absl::InfiniteFuture() ||
+           is_query_cancelled_ != nullptr;
+  }
+
+  // Returns the query deadline, or absl::InfiniteFuture() if there is none.
+  absl::Time query_deadline() const { return query_deadline_; }
+
+  // The max number of rows passed at once to the callback of a streamed query.
+  static constexpr int kRowBatchSize = 1024;
+
   void set_transaction_open(bool transaction_open) {
     transaction_open_ = transaction_open;
   }
@@ -125,11 +271,42 @@ class MetadataSource {
 
   // Implementation of executing queries.
   virtual absl::Status ExecuteQueryImpl(const std::string& query,
-                                        RecordSet* results) = 0;
+                                        ResultSet* results) = 0;
+
+  // Implementation of executing template queries. By default, it runs the
+  // query composed with ComposeQuery with ExecuteQueryImpl.
+  virtual absl::Status ExecuteTemplateQueryImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters, ResultSet* results);
+
+  // Implementation of streaming the rows of queries. By default, it reads all
+  // the rows with ExecuteQueryImpl and passes them at once.
+  virtual absl::Status ExecuteQueryStreamingImpl(const std::string& query,
+                                                 RowBatchCallback callback);
+
+  // Implementation of streaming the rows of template queries. By default, it
+  // runs the query composed with ComposeQuery with ExecuteQueryStreamingImpl.
+  virtual absl::Status ExecuteTemplateQueryStreamingImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters, RowBatchCallback callback);
+
+  // Implementation of running a batch of queries. By default, it runs each of
+  // them with ExecuteTemplateQueryImpl.
+  virtual absl::Status ExecuteBatchImpl(absl::Span<const BatchedQuery> queries);
+
+  // Implementation of clearing the query deadline, which undoes the state set
+  // on the backend for it, if any. By default, there is none.
+  virtual void ClearQueryDeadlineImpl() {}
+
+  // Checks that a query can run on the connection and transaction.
+  absl::Status CheckQueryPreconditions() const;
 
   // Implementation of opening a transaction.
   virtual absl::Status BeginImpl() = 0;
 
+  // Implementation of opening a read-only transaction. By default, it opens a
+  // transaction with BeginImpl.
+  virtual absl::Status BeginReadOnlyImpl();
 
   // Implementation of a transaction commit.
   virtual absl::Status CommitImpl() = 0;
@@ -139,6 +316,14 @@ class MetadataSource {
 
   bool is_connected_ = false;
   bool transaction_open_ = false;
+  bool transaction_read_only_ = false;
+
+  absl::Time query_deadline_ = absl::InfiniteFuture();
+  std::function<bool()> is_query_cancelled_;
+
+  int64 num_queries_ = 0;
+  int64 num_rows_ = 0;
+  int64 num_transactions_ = 0;
 };
 
 }  // namespace ml_metadata
@@ -17,17 +17,20 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
 namespace ml_metadata {
 
+using ::testing::_;
+
 class MockMetadataSource : public MetadataSource {
  public:
   MOCK_METHOD(absl::Status, ConnectImpl, (), (override));
   MOCK_METHOD(absl::Status, CloseImpl, (), (override));
   MOCK_METHOD(absl::Status, BeginImpl, (), (override));
   MOCK_METHOD(absl::Status, ExecuteQueryImpl,
-              (const std::string& query, RecordSet* results), (override));
+              (const std::string& query, ResultSet* results), (override));
   MOCK_METHOD(absl::Status, CommitImpl, (), (override));
   MOCK_METHOD(absl::Status, RollbackImpl, (), (override));
   MOCK_METHOD(std::string, EscapeString, (absl::string_view value),
@@ -68,7 +71,7 @@ TEST(MetadataSourceTest, TestExecuteQueryWithoutConnect) {
   MockMetadataSource mock_metadata_source;
   std::string query = "some query";
   RecordSet result;
-  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result)).Times(0);
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, _)).Times(0);
   absl::Status s = mock_metadata_source.ExecuteQuery(query, &result);
   EXPECT_TRUE(absl::IsFailedPrecondition(s));
 }
@@ -77,7 +80,7 @@ TEST(MetadataSourceTest, TestExecuteQueryWithoutBegin) {
   MockMetadataSource mock_metadata_source;
   std::string query = "some query";
   RecordSet result;
-  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result)).Times(0);
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, _)).Times(0);
   EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
   absl::Status s = mock_metadata_source.ExecuteQuery(query, &result);
   EXPECT_TRUE(absl::IsFailedPrecondition(s));
@@ -15,11 +15,15 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
 
 #include <memory>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/test_util.h"
 
 namespace ml_metadata {
@@ -191,6 +195,57 @@ TEST_P(MetadataSourceTestSuite, TestMultiQueryTransaction) {
   }
 }
 
+// Test a read-only transaction.
+// Initialization: creates an empty table t1 (c1 INT, c2 VARCHAR(255)) with test
+// schema and adds 3 rows to this table: (1,'v1'), (2,'v2'), (3, 'v3').
+// Execution: Select all the rows of t1 in a read-only transaction.
+// Expectation: the 3 rows are returned, and another transaction cannot begin
+// until the read-only one is committed.
+TEST_P(MetadataSourceTestSuite, TestReadOnlyTransaction) {
+  metadata_source_container_->InitSchemaAndPopulateRows();
+  RecordSet query_results;
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->BeginReadOnly());
+  EXPECT_TRUE(metadata_source_->transaction_open());
+  EXPECT_TRUE(absl::IsFailedPrecondition(metadata_source_->Begin()));
+  EXPECT_TRUE(absl::IsFailedPrecondition(metadata_source_->BeginReadOnly()));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->ExecuteQuery(
+                                  "SELECT * FROM t1", &query_results));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  EXPECT_EQ(3, query_results.records().size());
+}
+
+// Test the rollback to a savepoint.
+// Initialization: creates an empty table t1 (c1 INT, c2 VARCHAR(255)) with test
+// schema and adds 3 rows to this table: (1,'v1'), (2,'v2'), (3, 'v3').
+// Execution: Insert (4, 'v4'), set a savepoint, insert (5, 'v5'), roll back to
+// the savepoint and release it, then commit.
+// Expectation: (4, 'v4') is stored and (5, 'v5') is not.
+TEST_P(MetadataSourceTestSuite, TestRollbackToSavepoint) {
+  metadata_source_container_->InitSchemaAndPopulateRows();
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4')",
+                                           nullptr));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Savepoint("test_savepoint"));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("INSERT INTO t1 VALUES (5, 'v5')",
+                                           nullptr));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->RollbackToSavepoint("test_savepoint"));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ReleaseSavepoint("test_savepoint"));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  RecordSet query_results;
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT c1 FROM t1 WHERE c1 > 3",
+                                           &query_results));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  ASSERT_EQ(1, query_results.records_size());
+  EXPECT_EQ("4", query_results.records(0).values(0));
+}
+
 // Test Insert execution with NULL values.
 // Initialization: creates an empty table t1 (c1 INT, c2 VARCHAR(255)) with test
 // schema.
@@ -215,6 +270,99 @@ TEST_P(MetadataSourceTestSuite, TestNull) {
   EXPECT_THAT(query_results, EqualsProto(expected_results));
 }
 
+// Test streaming the rows of a query.
+// Initialization: creates an empty table t1 (c1 INT, c2 VARCHAR(255)) with test
+// schema, and inserts more rows than a batch of streamed rows.
+// Execution: Stream all the rows in t1, and stop streaming them at a batch.
+// Expectation: all the rows are streamed in batches, the error of the stopped
+// query is returned, and the following queries run.
+TEST_P(MetadataSourceTestSuite, TestExecuteQueryStreaming) {
+  metadata_source_container_->InitTestSchema();
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  constexpr int kNumRows = 2500;
+  for (int i = 0; i < kNumRows; ++i) {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_source_->ExecuteQuery(
+                  absl::Substitute("INSERT INTO t1 VALUES ($0, 'v$0')", i),
+                  nullptr));
+  }
+
+  int num_batches = 0;
+  std::vector<int64> ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQueryStreaming(
+                "SELECT c1, c2 FROM t1 ORDER BY c1",
+                [&](const ResultSet& rows) {
+                  ++num_batches;
+                  EXPECT_EQ(2, rows.num_columns());
+                  for (int row = 0; row < rows.num_rows(); ++row) {
+                    ids.push_back(rows.GetInt(row, 0));
+                    EXPECT_EQ(absl::StrCat("v", ids.back()),
+                              rows.ToString(row, 1));
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_GT(num_batches, 1);
+  ASSERT_EQ(kNumRows, ids.size());
+  for (int i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ(i, ids[i]);
+  }
+
+  EXPECT_TRUE(absl::IsCancelled(metadata_source_->ExecuteQueryStreaming(
+      "SELECT * FROM t1", [](const ResultSet& rows) {
+        return absl::CancelledError("stopped");
+      })));
+  RecordSet query_results;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT COUNT(*) FROM t1",
+                                           &query_results));
+  EXPECT_EQ(absl::StrCat(kNumRows), query_results.records(0).values(0));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+}
+
+TEST_P(MetadataSourceTestSuite, TestExecuteBatch) {
+  metadata_source_container_->InitSchemaAndPopulateRows();
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  const QueryTemplate insert_query("INSERT INTO t1 VALUES ($0, $1);");
+  const QueryTemplate update_query("UPDATE t1 SET c2 = $0 WHERE c1 = $1;");
+  const QueryTemplate delete_query("DELETE FROM t1 WHERE c1 = $0");
+  const std::vector<MetadataSource::BatchedQuery> queries = {
+      {&insert_query, {QueryParameter::Int(4), QueryParameter::String("v4")}},
+      {&update_query,
+       {QueryParameter::String("v1_updated"), QueryParameter::Int(1)}},
+      {&delete_query, {QueryParameter::Int(2)}},
+      {&insert_query, {QueryParameter::Int(5), QueryParameter::String("v5")}}};
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->ExecuteBatch(queries));
+  RecordSet query_results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT c1, c2 FROM t1 ORDER BY c1",
+                                           &query_results));
+  EXPECT_THAT(query_results, EqualsProto(ParseTextProtoOrDie<RecordSet>(R"(
+                column_names: "c1"
+                column_names: "c2"
+                records { values: "1" values: "v1_updated" }
+                records { values: "3" values: "v3" }
+                records { values: "4" values: "v4" }
+                records { values: "5" values: "v5" }
+              )")));
+
+  // The queries after a failed one are not run.
+  const QueryTemplate missing_table_query("INSERT INTO t2 VALUES ($0);");
+  const std::vector<MetadataSource::BatchedQuery> failed_queries = {
+      {&insert_query, {QueryParameter::Int(6), QueryParameter::String("v6")}},
+      {&missing_table_query, {QueryParameter::Int(7)}},
+      {&insert_query, {QueryParameter::Int(8), QueryParameter::String("v8")}}};
+  EXPECT_FALSE(metadata_source_->ExecuteBatch(failed_queries).ok());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT c1 FROM t1 WHERE c1 > 5",
+                                           &query_results));
+  EXPECT_THAT(query_results, EqualsProto(ParseTextProtoOrDie<RecordSet>(R"(
+                column_names: "c1"
+                records { values: "6" }
+              )")));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+}
+
 }  // namespace
 }  // namespace testing
 }  // namespace ml_metadata
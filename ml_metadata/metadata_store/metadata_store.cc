@@ -15,10 +15,13 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_store.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 #include <glog/logging.h>
+#include "google/protobuf/field_mask.pb.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/repeated_field.h"
 #include "absl/algorithm/container.h"
@@ -32,6 +35,8 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
 #include "ml_metadata/metadata_store/simple_types_util.h"
@@ -45,6 +50,14 @@ namespace ml_metadata {
 namespace {
 using std::unique_ptr;
 
+// Returns the `transaction_options` of a request which only reads the store,
+// so that its transaction runs as a read-only one.
+TransactionOptions ReadOnly(const TransactionOptions& transaction_options) {
+  TransactionOptions read_only_options = transaction_options;
+  read_only_options.set_read_only(true);
+  return read_only_options;
+}
+
 // Checks if the `stored_type` and `other_type` have the same names.
 // In addition, it checks whether the types are inconsistent:
 // a) `stored_type` and `other_type` have conflicting property value type
@@ -249,12 +262,21 @@ absl::Status UpsertSimpleTypes(MetadataAccessObject* metadata_access_object) {
 }
 
 // Updates or inserts an artifact. If the artifact.id is given, it updates the
-// stored artifact, otherwise, it creates a new artifact.
-absl::Status UpsertArtifact(const Artifact& artifact,
-                            MetadataAccessObject* metadata_access_object,
-                            int64* artifact_id) {
+// stored artifact, otherwise, it creates a new artifact. If `update_mask` has
+// paths, only the listed fields are updated, without reading the artifact,
+// and only if it still has the `last_update_time` when given.
+absl::Status UpsertArtifact(
+    const Artifact& artifact, MetadataAccessObject* metadata_access_object,
+    int64* artifact_id,
+    const google::protobuf::FieldMask& update_mask =
+        google::protobuf::FieldMask::default_instance(),
+    const absl::optional<int64> last_update_time = absl::nullopt) {
   CHECK(artifact_id) << "artifact_id should not be null";
-  if (artifact.has_id()) {
+  if (artifact.has_id() && update_mask.paths_size() > 0) {
+    MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateArtifact(
+        artifact, update_mask, last_update_time));
+    *artifact_id = artifact.id();
+  } else if (artifact.has_id()) {
     MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateArtifact(artifact));
     *artifact_id = artifact.id();
   } else {
@@ -265,12 +287,19 @@ absl::Status UpsertArtifact(const Artifact& artifact,
 }
 
 // Updates or inserts an execution. If the execution.id is given, it updates the
-// stored execution, otherwise, it creates a new execution.
-absl::Status UpsertExecution(const Execution& execution,
-                             MetadataAccessObject* metadata_access_object,
-                             int64* execution_id) {
+// stored execution, otherwise, it creates a new execution. If `update_mask`
+// has paths, only the listed fields are updated, without reading it.
+absl::Status UpsertExecution(
+    const Execution& execution, MetadataAccessObject* metadata_access_object,
+    int64* execution_id,
+    const google::protobuf::FieldMask& update_mask =
+        google::protobuf::FieldMask::default_instance()) {
   CHECK(execution_id) << "execution_id should not be null";
-  if (execution.has_id()) {
+  if (execution.has_id() && update_mask.paths_size() > 0) {
+    MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateExecution(
+        execution, update_mask, /*last_update_time=*/absl::nullopt));
+    *execution_id = execution.id();
+  } else if (execution.has_id()) {
     MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateExecution(execution));
     *execution_id = execution.id();
   } else {
@@ -281,12 +310,19 @@ absl::Status UpsertExecution(const Execution& execution,
 }
 
 // Updates or inserts a context. If the context.id is given, it updates the
-// stored context, otherwise, it creates a new context.
-absl::Status UpsertContext(const Context& context,
-                           MetadataAccessObject* metadata_access_object,
-                           int64* context_id) {
+// stored context, otherwise, it creates a new context. If `update_mask` has
+// paths, only the listed fields are updated, without reading it.
+absl::Status UpsertContext(
+    const Context& context, MetadataAccessObject* metadata_access_object,
+    int64* context_id,
+    const google::protobuf::FieldMask& update_mask =
+        google::protobuf::FieldMask::default_instance()) {
   CHECK(context_id) << "context_id should not be null";
-  if (context.has_id()) {
+  if (context.has_id() && update_mask.paths_size() > 0) {
+    MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateContext(
+        context, update_mask, /*last_update_time=*/absl::nullopt));
+    *context_id = context.id();
+  } else if (context.has_id()) {
     MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateContext(context));
     *context_id = context.id();
   } else {
@@ -296,6 +332,84 @@ absl::Status UpsertContext(const Context& context,
   return absl::OkStatus();
 }
 
+// Returns true if `status` is the error of a single item of a put request,
+// e.g., a duplicated name, after which the other items can still be put.
+bool IsItemError(const absl::Status& status) {
+  return absl::IsAlreadyExists(status) || absl::IsInvalidArgument(status) ||
+         absl::IsNotFound(status) || absl::IsFailedPrecondition(status);
+}
+
+// Puts the `num_items` items of a put request with `put_item`, which puts the
+// item at an index and returns its id, and adds the ids to `ids`. If
+// `best_effort`, each item is put in a savepoint, and the items failing with an
+// item error are undone and added to `errors` instead of failing the request.
+template <typename Ids>
+absl::Status PutItems(
+    const int num_items, const bool best_effort,
+    const TransactionExecutor& transaction_executor,
+    const std::function<absl::Status(int, int64*)>& put_item, Ids* ids,
+    google::protobuf::RepeatedPtrField<PutItemError>* errors) {
+  ids->Reserve(num_items);
+  for (int i = 0; i < num_items; ++i) {
+    int64 id = -1;
+    if (!best_effort) {
+      MLMD_RETURN_IF_ERROR(put_item(i, &id));
+      ids->Add(id);
+      continue;
+    }
+    const absl::Status status = transaction_executor.ExecuteInSavepoint(
+        [&put_item, i, &id]() { return put_item(i, &id); });
+    if (!status.ok()) {
+      if (!IsItemError(status)) return status;
+      id = -1;
+      PutItemError* error = errors->Add();
+      error->set_index(i);
+      error->set_code(static_cast<int>(status.code()));
+      error->set_message(std::string(status.message()));
+    }
+    ids->Add(id);
+  }
+  return absl::OkStatus();
+}
+
+// Puts the `nodes` of a put request as PutItems. Unless `best_effort`, the new
+// nodes without ids are created together with `create_nodes` after the other
+// nodes are updated, which sends a few multi-row inserts instead of a few
+// statements per node.
+template <typename Node, typename Ids>
+absl::Status PutNodes(
+    const google::protobuf::RepeatedPtrField<Node>& nodes, const bool best_effort,
+    const TransactionExecutor& transaction_executor,
+    const std::function<absl::Status(int, int64*)>& put_item,
+    const std::function<absl::Status(absl::Span<const Node>,
+                                     std::vector<int64>*)>& create_nodes,
+    Ids* ids, google::protobuf::RepeatedPtrField<PutItemError>* errors) {
+  if (best_effort) {
+    return PutItems(nodes.size(), best_effort, transaction_executor, put_item,
+                    ids, errors);
+  }
+  std::vector<int64> node_ids(nodes.size(), -1);
+  std::vector<Node> new_nodes;
+  std::vector<int> new_node_indices;
+  for (int i = 0; i < nodes.size(); ++i) {
+    if (!nodes.Get(i).has_id()) {
+      new_nodes.push_back(nodes.Get(i));
+      new_node_indices.push_back(i);
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(put_item(i, &node_ids[i]));
+  }
+  if (!new_nodes.empty()) {
+    std::vector<int64> new_node_ids;
+    MLMD_RETURN_IF_ERROR(create_nodes(new_nodes, &new_node_ids));
+    for (size_t i = 0; i < new_node_indices.size(); ++i) {
+      node_ids[new_node_indices[i]] = new_node_ids[i];
+    }
+  }
+  ids->Add(node_ids.begin(), node_ids.end());
+  return absl::OkStatus();
+}
+
 // Updates, inserts, or finds context. If `reuse_context_if_already_exist`, it
 // tries to find the existing context before trying to upsert the context.
 absl::Status UpsertContextWithOptions(
@@ -344,15 +458,16 @@ absl::Status UpsertContextWithOptions(
 }
 
 // Inserts an association. If the association already exists it returns OK.
+// If `is_already_validated`, the context and the execution are known to exist.
 absl::Status InsertAssociationIfNotExist(
-    int64 context_id, int64 execution_id,
+    int64 context_id, int64 execution_id, bool is_already_validated,
     MetadataAccessObject* metadata_access_object) {
   Association association;
   association.set_execution_id(execution_id);
   association.set_context_id(context_id);
   int64 dummy_assocation_id;
   absl::Status status = metadata_access_object->CreateAssociation(
-      association, &dummy_assocation_id);
+      association, is_already_validated, &dummy_assocation_id);
   if (!status.ok() && !absl::IsAlreadyExists(status)) {
     return status;
   }
@@ -360,15 +475,16 @@ absl::Status InsertAssociationIfNotExist(
 }
 
 // Inserts an attribution. If the attribution already exists it returns OK.
+// If `is_already_validated`, the context and the artifact are known to exist.
 absl::Status InsertAttributionIfNotExist(
-    int64 context_id, int64 artifact_id,
+    int64 context_id, int64 artifact_id, bool is_already_validated,
     MetadataAccessObject* metadata_access_object) {
   Attribution attribution;
   attribution.set_artifact_id(artifact_id);
   attribution.set_context_id(context_id);
   int64 dummy_attribution_id;
   absl::Status status = metadata_access_object->CreateAttribution(
-      attribution, &dummy_attribution_id);
+      attribution, is_already_validated, &dummy_attribution_id);
   if (!status.ok() && !absl::IsAlreadyExists(status)) {
     return status;
   }
@@ -565,6 +681,170 @@ absl::Status CheckEventEdges(const PutLineageSubgraphRequest& request) {
 
   return absl::OkStatus();
 }
+
+// The number of pages read in one transaction by the List{Nodes} methods.
+constexpr int kListOperationPagesPerTransaction = 10;
+
+// The number of nodes read in one transaction by the List{Nodes} methods when
+// they walk the nodes by id.
+constexpr int kListNodesByIdBatchSize = 1000;
+
+// Returns true if the nodes listed with `options` can be walked by id, i.e.,
+// they are not filtered and are ordered by ascending id, and sets `after_id`
+// to the id after which they are listed. Otherwise, e.g., if the options or
+// the next page token are invalid, the nodes are listed page by page, which
+// reports the errors.
+bool GetListNodesAfterId(const ListOperationOptions& options, int64& after_id) {
+  if (options.has_filter_query() || options.max_result_size() <= 0 ||
+      options.order_by_field().field() !=
+          ListOperationOptions::OrderByField::ID ||
+      !options.order_by_field().is_asc()) {
+    return false;
+  }
+  after_id = 0;
+  if (options.next_page_token().empty()) {
+    return true;
+  }
+  ListOperationNextPageToken next_page_token;
+  if (!DecodeListOperationNextPageToken(options.next_page_token(),
+                                        next_page_token)
+           .ok() ||
+      !ValidateListOperationOptionsAreIdentical(next_page_token.set_options(),
+                                                options)
+           .ok()) {
+    return false;
+  }
+  after_id = next_page_token.id_offset();
+  return true;
+}
+
+// Lists the nodes with ids greater than `after_id` with `list_nodes_after_id`
+// and passes them to `callback` as `Response`s of `options.max_result_size()`
+// nodes, each with the next page token to resume after it but the last. The
+// nodes are read by their primary key in batches of `kListNodesByIdBatchSize`
+// nodes per transaction, and are passed to `callback` once it commits.
+template <typename Node, typename Request, typename Response>
+absl::Status ListNodesByIdInBatches(
+    const Request& request, const ListOperationOptions& options,
+    int64 after_id, const TransactionExecutor& transaction_executor,
+    MetadataAccessObject* metadata_access_object,
+    absl::Status (MetadataAccessObject::*list_nodes_after_id)(
+        int64, int, std::vector<Node>*),
+    google::protobuf::RepeatedPtrField<Node>* (Response::*mutable_nodes)(),
+    const std::function<absl::Status(const Response&)>& callback) {
+  const int page_size =
+      std::min(options.max_result_size(), kDefaultMaxListOperationResultSize);
+  bool is_first_batch = true;
+  bool is_last_batch = false;
+  while (!is_last_batch) {
+    std::vector<Node> nodes;
+    MLMD_RETURN_IF_ERROR(transaction_executor.Execute(
+        [&]() -> absl::Status {
+          nodes.clear();
+          // Reads one more node to detect the last batch.
+          return (metadata_access_object->*list_nodes_after_id)(
+              after_id, kListNodesByIdBatchSize + 1, &nodes);
+        },
+        ReadOnly(request.transaction_options())));
+    is_last_batch = nodes.size() <= kListNodesByIdBatchSize;
+    if (!is_last_batch) {
+      nodes.pop_back();
+    }
+    if (nodes.empty() && is_first_batch) {
+      MLMD_RETURN_IF_ERROR(callback(Response()));
+    }
+    is_first_batch = false;
+    for (size_t begin = 0; begin < nodes.size(); begin += page_size) {
+      const size_t end = std::min(begin + page_size, nodes.size());
+      Response page;
+      if (end < nodes.size() || !is_last_batch) {
+        std::string next_page_token;
+        MLMD_RETURN_IF_ERROR(BuildListOperationNextPageToken<Node>(
+            absl::MakeConstSpan(nodes).subspan(begin, end - begin), options,
+            &next_page_token));
+        page.set_next_page_token(next_page_token);
+      }
+      after_id = nodes[end - 1].id();
+      google::protobuf::RepeatedPtrField<Node>* page_nodes =
+          (page.*mutable_nodes)();
+      page_nodes->Reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+        *page_nodes->Add() = std::move(nodes[i]);
+      }
+      MLMD_RETURN_IF_ERROR(callback(page));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Lists the nodes matching `request.options()` and passes them to `callback`
+// as `Response`s of `max_result_size` nodes. Unfiltered nodes in ascending
+// order of id are walked by id with `list_nodes_after_id`, see
+// ListNodesByIdInBatches. Otherwise, the nodes are listed page by page with
+// `list_nodes`, following the next page tokens. The pages are read in batches
+// of `kListOperationPagesPerTransaction` pages per transaction, and are passed
+// to `callback` once it commits, so that a slow consumer does not keep the
+// transaction open.
+template <typename Node, typename Request, typename Response>
+absl::Status ListNodesInBatches(
+    const Request& request, const TransactionExecutor& transaction_executor,
+    MetadataAccessObject* metadata_access_object,
+    absl::Status (MetadataAccessObject::*list_nodes)(
+        const ListOperationOptions&, std::vector<Node>*, std::string*),
+    absl::Status (MetadataAccessObject::*list_nodes_after_id)(
+        int64, int, std::vector<Node>*),
+    google::protobuf::RepeatedPtrField<Node>* (Response::*mutable_nodes)(),
+    const std::function<absl::Status(const Response&)>& callback) {
+  ListOperationOptions options = request.options();
+  if (!options.has_max_result_size()) {
+    options.set_max_result_size(kDefaultMaxListOperationResultSize);
+  }
+  int64 after_id;
+  if (GetListNodesAfterId(options, after_id)) {
+    return ListNodesByIdInBatches(request, options, after_id,
+                                  transaction_executor, metadata_access_object,
+                                  list_nodes_after_id, mutable_nodes, callback);
+  }
+  bool is_last_page = false;
+  while (!is_last_page) {
+    std::vector<Response> pages;
+    MLMD_RETURN_IF_ERROR(transaction_executor.Execute(
+        [&]() -> absl::Status {
+          pages.clear();
+          ListOperationOptions page_options = options;
+          for (int i = 0; i < kListOperationPagesPerTransaction; ++i) {
+            std::vector<Node> nodes;
+            std::string next_page_token;
+            const absl::Status status = (metadata_access_object->*list_nodes)(
+                page_options, &nodes, &next_page_token);
+            if (!status.ok() && !absl::IsNotFound(status)) {
+              return status;
+            }
+            Response& page = pages.emplace_back();
+            google::protobuf::RepeatedPtrField<Node>* page_nodes =
+                (page.*mutable_nodes)();
+            page_nodes->Reserve(nodes.size());
+            for (Node& node : nodes) {
+              *page_nodes->Add() = std::move(node);
+            }
+            if (next_page_token.empty()) break;
+            page.set_next_page_token(next_page_token);
+            page_options.set_next_page_token(next_page_token);
+          }
+          return absl::OkStatus();
+        },
+        ReadOnly(request.transaction_options())));
+    for (const Response& page : pages) {
+      MLMD_RETURN_IF_ERROR(callback(page));
+    }
+    is_last_page = pages.empty() || !pages.back().has_next_page_token();
+    if (!is_last_page) {
+      options.set_next_page_token(pages.back().next_page_token());
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::Status MetadataStore::InitMetadataStore() {
@@ -603,7 +883,28 @@ absl::Status MetadataStore::InitMetadataStoreIfNotExists(
       options);
 }
 
+absl::Status MetadataStore::HealthCheck() {
+  TransactionOptions options;
+  options.set_tag("HealthCheck");
+  options.set_read_only(true);
+  return transaction_executor_->Execute(
+      []() -> absl::Status { return absl::OkStatus(); }, options);
+}
+
+absl::Status MetadataStore::ExecuteTransaction(
+    const std::function<absl::Status()>& txn_body,
+    const TransactionOptions& transaction_options) {
+  return transaction_executor_->Execute(txn_body, transaction_options);
+}
 
+void MetadataStore::SetQueryDeadline(absl::Time deadline,
+                                     std::function<bool()> is_cancelled) {
+  metadata_source_->SetQueryDeadline(deadline, std::move(is_cancelled));
+}
+
+void MetadataStore::ClearQueryDeadline() {
+  metadata_source_->ClearQueryDeadline();
+}
 
 absl::Status MetadataStore::PutTypes(const PutTypesRequest& request,
                                      PutTypesResponse* response) {
@@ -694,7 +995,7 @@ absl::Status MetadataStore::GetArtifactType(
         *response->mutable_artifact_type() = type;
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionType(
@@ -713,7 +1014,7 @@ absl::Status MetadataStore::GetExecutionType(
         *response->mutable_execution_type() = type;
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextType(const GetContextTypeRequest& request,
@@ -725,7 +1026,7 @@ absl::Status MetadataStore::GetContextType(const GetContextTypeRequest& request,
             request.type_name(), GetRequestTypeVersion(request),
             response->mutable_context_type());
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactTypesByID(
@@ -753,7 +1054,7 @@ absl::Status MetadataStore::GetArtifactTypesByID(
                 metadata_access_object_.get()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionTypesByID(
@@ -780,7 +1081,7 @@ absl::Status MetadataStore::GetExecutionTypesByID(
                 metadata_access_object_.get()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextTypesByID(
@@ -801,7 +1102,7 @@ absl::Status MetadataStore::GetContextTypesByID(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactsByID(
@@ -822,7 +1123,7 @@ absl::Status MetadataStore::GetArtifactsByID(
                                     response->mutable_artifacts()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionsByID(
@@ -843,7 +1144,7 @@ absl::Status MetadataStore::GetExecutionsByID(
                                      response->mutable_executions()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextsByID(
@@ -863,7 +1164,7 @@ absl::Status MetadataStore::GetContextsByID(
                                    response->mutable_contexts()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::PutArtifacts(const PutArtifactsRequest& request,
@@ -871,11 +1172,23 @@ absl::Status MetadataStore::PutArtifacts(const PutArtifactsRequest& request,
   return transaction_executor_->Execute([this, &request,
                                          &response]() -> absl::Status {
     response->Clear();
-    for (const Artifact& artifact : request.artifacts()) {
-      int64 artifact_id = -1;
+    const auto put_artifact = [this, &request](
+                                  const int i,
+                                  int64* artifact_id) -> absl::Status {
+      const Artifact& artifact = request.artifacts(i);
+      const bool abort_if_latest_updated_time_changed =
+          request.options().abort_if_latest_updated_time_changed();
+      // A masked update compares the latest_updated_time in its own query.
+      if (request.update_mask().paths_size() > 0) {
+        return UpsertArtifact(
+            artifact, metadata_access_object_.get(), artifact_id,
+            request.update_mask(),
+            abort_if_latest_updated_time_changed
+                ? absl::make_optional(artifact.last_update_time_since_epoch())
+                : absl::nullopt);
+      }
       // Verify the latest_updated_time before upserting the artifact.
-      if (artifact.has_id() &&
-          request.options().abort_if_latest_updated_time_changed()) {
+      if (artifact.has_id() && abort_if_latest_updated_time_changed) {
         Artifact existing_artifact;
         absl::Status status;
         {
@@ -904,11 +1217,18 @@ absl::Status MetadataStore::PutArtifacts(const PutArtifactsRequest& request,
           absl::SleepFor(absl::Milliseconds(1));
         }
       }
-      MLMD_RETURN_IF_ERROR(UpsertArtifact(
-          artifact, metadata_access_object_.get(), &artifact_id));
-      response->add_artifact_ids(artifact_id);
-    }
-    return absl::OkStatus();
+      return UpsertArtifact(artifact, metadata_access_object_.get(),
+                            artifact_id);
+    };
+    return PutNodes<Artifact>(
+        request.artifacts(), request.best_effort(), *transaction_executor_,
+        put_artifact,
+        [this](absl::Span<const Artifact> artifacts,
+               std::vector<int64>* artifact_ids) {
+          return metadata_access_object_->CreateArtifacts(artifacts,
+                                                          artifact_ids);
+        },
+        response->mutable_artifact_ids(), response->mutable_errors());
   },
   request.transaction_options());
 }
@@ -918,13 +1238,20 @@ absl::Status MetadataStore::PutExecutions(const PutExecutionsRequest& request,
   return transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Execution& execution : request.executions()) {
-          int64 execution_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertExecution(
-              execution, metadata_access_object_.get(), &execution_id));
-          response->add_execution_ids(execution_id);
-        }
-        return absl::OkStatus();
+        return PutNodes<Execution>(
+            request.executions(), request.best_effort(),
+            *transaction_executor_,
+            [this, &request](const int i, int64* execution_id) {
+              return UpsertExecution(request.executions(i),
+                                     metadata_access_object_.get(),
+                                     execution_id, request.update_mask());
+            },
+            [this](absl::Span<const Execution> executions,
+                   std::vector<int64>* execution_ids) {
+              return metadata_access_object_->CreateExecutions(executions,
+                                                               execution_ids);
+            },
+            response->mutable_execution_ids(), response->mutable_errors());
       },
       request.transaction_options());
 }
@@ -934,13 +1261,19 @@ absl::Status MetadataStore::PutContexts(const PutContextsRequest& request,
   return transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Context& context : request.contexts()) {
-          int64 context_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertContext(
-              context, metadata_access_object_.get(), &context_id));
-          response->add_context_ids(context_id);
-        }
-        return absl::OkStatus();
+        return PutNodes<Context>(
+            request.contexts(), request.best_effort(), *transaction_executor_,
+            [this, &request](const int i, int64* context_id) {
+              return UpsertContext(request.contexts(i),
+                                   metadata_access_object_.get(), context_id,
+                                   request.update_mask());
+            },
+            [this](absl::Span<const Context> contexts,
+                   std::vector<int64>* context_ids) {
+              return metadata_access_object_->CreateContexts(contexts,
+                                                             context_ids);
+            },
+            response->mutable_context_ids(), response->mutable_errors());
       },
       request.transaction_options());
 }
@@ -951,9 +1284,21 @@ absl::Status MetadataStore::Create(
     unique_ptr<MetadataSource> metadata_source,
     unique_ptr<TransactionExecutor> transaction_executor,
     unique_ptr<MetadataStore>* result) {
+  return Create(query_config, migration_options, std::move(metadata_source),
+                std::move(transaction_executor), /*type_cache=*/nullptr,
+                result);
+}
+
+absl::Status MetadataStore::Create(
+    const MetadataSourceQueryConfig& query_config,
+    const MigrationOptions& migration_options,
+    unique_ptr<MetadataSource> metadata_source,
+    unique_ptr<TransactionExecutor> transaction_executor,
+    TypeCache* type_cache, unique_ptr<MetadataStore>* result) {
   unique_ptr<MetadataAccessObject> metadata_access_object;
   MLMD_RETURN_IF_ERROR(CreateMetadataAccessObject(
-      query_config, metadata_source.get(), &metadata_access_object));
+      query_config, metadata_source.get(), /*schema_version=*/absl::nullopt,
+      type_cache, &metadata_access_object));
   // if downgrade migration is specified
   if (migration_options.downgrade_to_schema_version() >= 0) {
     MLMD_RETURN_IF_ERROR(transaction_executor->Execute(
@@ -1033,10 +1378,12 @@ absl::Status MetadataStore::PutExecution(const PutExecutionRequest& request,
       MLMD_RETURN_IF_ERROR(status);
       response->add_context_ids(context_id);
       MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-          context_id, response->execution_id(), metadata_access_object_.get()));
+          context_id, response->execution_id(),
+          /*is_already_validated=*/false, metadata_access_object_.get()));
       for (const int64 artifact_id : response->artifact_ids()) {
         MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-            context_id, artifact_id, metadata_access_object_.get()));
+            context_id, artifact_id, /*is_already_validated=*/false,
+            metadata_access_object_.get()));
       }
     }
     return absl::OkStatus();
@@ -1044,7 +1391,74 @@ absl::Status MetadataStore::PutExecution(const PutExecutionRequest& request,
   request.transaction_options());
 }
 
-
+absl::Status MetadataStore::PutLineageSubgraph(
+    const PutLineageSubgraphRequest& request,
+    PutLineageSubgraphResponse* response) {
+  MLMD_RETURN_IF_ERROR(CheckEventEdges(request));
+  return transaction_executor_->Execute(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        // 1. Upsert contexts.
+        for (const Context& context : request.contexts()) {
+          int64 context_id = -1;
+          MLMD_RETURN_IF_ERROR(UpsertContextWithOptions(
+              context, metadata_access_object_.get(),
+              request.options().reuse_context_if_already_exist(),
+              &context_id));
+          response->add_context_ids(context_id);
+        }
+        // 2. Upsert artifacts.
+        for (const Artifact& artifact : request.artifacts()) {
+          int64 artifact_id = -1;
+          MLMD_RETURN_IF_ERROR(UpsertArtifact(
+              artifact, metadata_access_object_.get(), &artifact_id));
+          response->add_artifact_ids(artifact_id);
+        }
+        // 3. Upsert executions.
+        for (const Execution& execution : request.executions()) {
+          int64 execution_id = -1;
+          MLMD_RETURN_IF_ERROR(UpsertExecution(
+              execution, metadata_access_object_.get(), &execution_id));
+          response->add_execution_ids(execution_id);
+        }
+        // 4. Insert associations and attributions. The nodes have just been
+        // upserted, so they are not looked up again.
+        for (const int64 context_id : response->context_ids()) {
+          for (const int64 execution_id : response->execution_ids()) {
+            MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
+                context_id, execution_id, /*is_already_validated=*/true,
+                metadata_access_object_.get()));
+          }
+          for (const int64 artifact_id : response->artifact_ids()) {
+            MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
+                context_id, artifact_id, /*is_already_validated=*/true,
+                metadata_access_object_.get()));
+          }
+        }
+        // 5. Insert events. Only the nodes referenced by id instead of by
+        // index in the request are looked up.
+        for (const PutLineageSubgraphRequest::EventEdge& event_edge :
+             request.event_edges()) {
+          Event event = event_edge.event();
+          if (event_edge.has_execution_index()) {
+            event.set_execution_id(
+                response->execution_ids(event_edge.execution_index()));
+          }
+          if (event_edge.has_artifact_index()) {
+            event.set_artifact_id(
+                response->artifact_ids(event_edge.artifact_index()));
+          }
+          int64 dummy_event_id = -1;
+          MLMD_RETURN_IF_ERROR(metadata_access_object_->CreateEvent(
+              event,
+              /*is_already_validated=*/event_edge.has_execution_index() &&
+                  event_edge.has_artifact_index(),
+              &dummy_event_id));
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
 
 absl::Status MetadataStore::GetEventsByExecutionIDs(
     const GetEventsByExecutionIDsRequest& request,
@@ -1068,7 +1482,7 @@ absl::Status MetadataStore::GetEventsByExecutionIDs(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetEventsByArtifactIDs(
@@ -1093,7 +1507,7 @@ absl::Status MetadataStore::GetEventsByArtifactIDs(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutions(const GetExecutionsRequest& request,
@@ -1126,7 +1540,7 @@ absl::Status MetadataStore::GetExecutions(const GetExecutionsRequest& request,
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifacts(const GetArtifactsRequest& request,
@@ -1160,7 +1574,38 @@ absl::Status MetadataStore::GetArtifacts(const GetArtifactsRequest& request,
 
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
+}
+
+absl::Status MetadataStore::ListArtifacts(
+    const ListArtifactsRequest& request,
+    const std::function<absl::Status(const ListArtifactsResponse&)>& callback) {
+  return ListNodesInBatches<Artifact>(
+      request, *transaction_executor_, metadata_access_object_.get(),
+      &MetadataAccessObject::ListArtifacts,
+      &MetadataAccessObject::ListArtifactsAfterId,
+      &ListArtifactsResponse::mutable_artifacts, callback);
+}
+
+absl::Status MetadataStore::ListExecutions(
+    const ListExecutionsRequest& request,
+    const std::function<absl::Status(const ListExecutionsResponse&)>&
+        callback) {
+  return ListNodesInBatches<Execution>(
+      request, *transaction_executor_, metadata_access_object_.get(),
+      &MetadataAccessObject::ListExecutions,
+      &MetadataAccessObject::ListExecutionsAfterId,
+      &ListExecutionsResponse::mutable_executions, callback);
+}
+
+absl::Status MetadataStore::ListContexts(
+    const ListContextsRequest& request,
+    const std::function<absl::Status(const ListContextsResponse&)>& callback) {
+  return ListNodesInBatches<Context>(
+      request, *transaction_executor_, metadata_access_object_.get(),
+      &MetadataAccessObject::ListContexts,
+      &MetadataAccessObject::ListContextsAfterId,
+      &ListContextsResponse::mutable_contexts, callback);
 }
 
 absl::Status MetadataStore::GetContexts(const GetContextsRequest& request,
@@ -1194,7 +1639,7 @@ absl::Status MetadataStore::GetContexts(const GetContextsRequest& request,
 
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactTypes(
@@ -1229,7 +1674,7 @@ absl::Status MetadataStore::GetArtifactTypes(
                 metadata_access_object_.get()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionTypes(
@@ -1264,7 +1709,7 @@ absl::Status MetadataStore::GetExecutionTypes(
                 metadata_access_object_.get()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextTypes(
@@ -1285,7 +1730,7 @@ absl::Status MetadataStore::GetContextTypes(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactsByURI(
@@ -1323,7 +1768,7 @@ absl::Status MetadataStore::GetArtifactsByURI(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactsByType(
@@ -1362,7 +1807,7 @@ absl::Status MetadataStore::GetArtifactsByType(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactByTypeAndName(
@@ -1392,7 +1837,7 @@ absl::Status MetadataStore::GetArtifactByTypeAndName(
         *response->mutable_artifact() = artifact;
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionsByType(
@@ -1431,7 +1876,7 @@ absl::Status MetadataStore::GetExecutionsByType(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionByTypeAndName(
@@ -1461,7 +1906,7 @@ absl::Status MetadataStore::GetExecutionByTypeAndName(
         *response->mutable_execution() = execution;
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextsByType(
@@ -1505,7 +1950,7 @@ absl::Status MetadataStore::GetContextsByType(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextByTypeAndName(
@@ -1536,7 +1981,7 @@ absl::Status MetadataStore::GetContextByTypeAndName(
         *response->mutable_context() = context;
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::PutAttributionsAndAssociations(
@@ -1548,12 +1993,12 @@ absl::Status MetadataStore::PutAttributionsAndAssociations(
         for (const Attribution& attribution : request.attributions()) {
           MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
               attribution.context_id(), attribution.artifact_id(),
-              metadata_access_object_.get()));
+              /*is_already_validated=*/false, metadata_access_object_.get()));
         }
         for (const Association& association : request.associations()) {
           MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
               association.context_id(), association.execution_id(),
-              metadata_access_object_.get()));
+              /*is_already_validated=*/false, metadata_access_object_.get()));
         }
         return absl::OkStatus();
       },
@@ -1589,7 +2034,7 @@ absl::Status MetadataStore::GetContextsByArtifact(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetContextsByExecution(
@@ -1606,7 +2051,7 @@ absl::Status MetadataStore::GetContextsByExecution(
         }
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetArtifactsByContext(
@@ -1633,7 +2078,7 @@ absl::Status MetadataStore::GetArtifactsByContext(
 
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetExecutionsByContext(
@@ -1661,7 +2106,7 @@ absl::Status MetadataStore::GetExecutionsByContext(
 
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetParentContextsByContext(
@@ -1681,7 +2126,7 @@ absl::Status MetadataStore::GetParentContextsByContext(
                                           response->mutable_contexts()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 absl::Status MetadataStore::GetChildrenContextsByContext(
@@ -1701,7 +2146,7 @@ absl::Status MetadataStore::GetChildrenContextsByContext(
                                          response->mutable_contexts()));
         return absl::OkStatus();
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 
@@ -1765,7 +2210,7 @@ absl::Status MetadataStore::GetLineageGraph(
                 : absl::nullopt,
             *response->mutable_subgraph());
       },
-      request.transaction_options());
+      ReadOnly(request.transaction_options()));
 }
 
 
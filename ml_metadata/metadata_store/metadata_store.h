@@ -15,13 +15,16 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 
+#include <functional>
 #include <memory>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store_service_interface.h"
 #include "ml_metadata/metadata_store/transaction_executor.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.pb.h"
 
@@ -47,6 +50,16 @@ class MetadataStore : public MetadataStoreServiceInterface {
       std::unique_ptr<TransactionExecutor> transaction_executor,
       std::unique_ptr<MetadataStore>* result);
 
+  // Creates a MetadataStore which caches the types in `type_cache` if it is
+  // not null. The cache must be shared only by the stores of the same
+  // database, and outlive the MetadataStore.
+  static absl::Status Create(
+      const MetadataSourceQueryConfig& query_config,
+      const MigrationOptions& migration_options,
+      std::unique_ptr<MetadataSource> metadata_source,
+      std::unique_ptr<TransactionExecutor> transaction_executor,
+      TypeCache* type_cache, std::unique_ptr<MetadataStore>* result);
+
   // Initializes the metadata source and creates schema. Any existing data in
   // the metadata is dropped.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -62,6 +75,37 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status InitMetadataStoreIfNotExists(
       bool enable_upgrade_migration = false);
 
+  // Checks that the connection to the metadata source is usable by running an
+  // empty transaction.
+  // Returns detailed INTERNAL error, if the transaction cannot be executed.
+  absl::Status HealthCheck();
+
+  // Runs `txn_body` in a single transaction. The methods of this store called
+  // by `txn_body` run in that transaction instead of committing their own, so
+  // that several requests can be committed together.
+  // If the transaction is aborted by the database, e.g., by a deadlock, it is
+  // rolled back and `txn_body` is run again after a backoff. So `txn_body`
+  // must be idempotent: it must clear its outputs, e.g., the responses of the
+  // requests, before filling them, and must not have effects outside of the
+  // transaction which cannot be repeated.
+  // Returns the error of `txn_body`, which rolls back all of its updates, or
+  // detailed INTERNAL error, if the transaction cannot be committed.
+  // Returns ABORTED error, if the last run of the transaction is aborted.
+  absl::Status ExecuteTransaction(
+      const std::function<absl::Status()>& txn_body,
+      const TransactionOptions& transaction_options = TransactionOptions());
+
+  // Stops the queries of the following calls which are still running at
+  // `deadline`, or once `is_cancelled` returns true, e.g., when the client of
+  // the request has given up, so that abandoned calls release the database.
+  // The calls return DEADLINE_EXCEEDED or CANCELLED error respectively.
+  // `is_cancelled` may be null.
+  void SetQueryDeadline(absl::Time deadline,
+                        std::function<bool()> is_cancelled);
+
+  // Clears the deadline set with SetQueryDeadline.
+  void ClearQueryDeadline();
+
 
 
   // Inserts or updates a ArtifactType/ExecutionType/ContextType.
@@ -254,7 +298,35 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status PutExecution(const PutExecutionRequest& request,
                             PutExecutionResponse* response) override;
 
-
+  // Inserts or updates a lineage subgraph, i.e., a collection of executions,
+  // artifacts and contexts, and the events between the executions and the
+  // artifacts, atomically in a single transaction. The `event_edges` in the
+  // request include an Event and the indices of its execution and artifact in
+  // the `executions` and `artifacts` of the request. The `contexts` are
+  // associated with all the `executions` and attributed to all the
+  // `artifacts`.
+  //
+  // If an execution_id, artifact_id or context_id is specified, it is an
+  // update, otherwise it does an insertion. For insertion, type must be
+  // specified. If event.timestamp is not set, it will be set to the current
+  // time. The nodes of the request are not looked up again to create their
+  // events, associations and attributions.
+  //
+  // Returns a list of execution, artifact, and context ids index-aligned with
+  // the input.
+  // Returns INVALID_ARGUMENT error, if no artifact, execution, or context
+  // matches the id.
+  // Returns INVALID_ARGUMENT error, if an event_edge has no event, or refers
+  // to neither an execution nor an artifact, or its ids do not match the ones
+  // of the nodes at its indices.
+  // Returns OUT_OF_RANGE error, if an index of an event_edge is out of bounds.
+  // Returns INVALID_ARGUMENT error, if type_id is different from stored one.
+  // Returns INVALID_ARGUMENT error, if property names and types do not align.
+  // Returns INVALID_ARGUMENT error, if the event.type field is UNKNOWN.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status PutLineageSubgraph(
+      const PutLineageSubgraphRequest& request,
+      PutLineageSubgraphResponse* response) override;
 
   // Gets all events with matching execution ids.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -281,6 +353,18 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status GetArtifacts(const GetArtifactsRequest& request,
                             GetArtifactsResponse* response) override;
 
+  // Lists all artifacts matching `request.options` and passes them to
+  // `callback` in batches of `max_result_size` artifacts, each with the next
+  // page token to resume listing after it. Consecutive batches are read in
+  // the same transaction, and are passed to `callback` after it commits.
+  // Returns the first error returned by `callback`.
+  // Returns INVALID_ARGUMENT error, if the list options are invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ListArtifacts(
+      const ListArtifactsRequest& request,
+      const std::function<absl::Status(const ListArtifactsResponse&)>&
+          callback);
+
   // Gets all the artifacts of a given type. If no artifacts found, it returns
   // OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -314,6 +398,18 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status GetExecutions(const GetExecutionsRequest& request,
                              GetExecutionsResponse* response) override;
 
+  // Lists all executions matching `request.options` and passes them to
+  // `callback` in batches of `max_result_size` executions, each with the next
+  // page token to resume listing after it. Consecutive batches are read in
+  // the same transaction, and are passed to `callback` after it commits.
+  // Returns the first error returned by `callback`.
+  // Returns INVALID_ARGUMENT error, if the list options are invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ListExecutions(
+      const ListExecutionsRequest& request,
+      const std::function<absl::Status(const ListExecutionsResponse&)>&
+          callback);
+
   // Gets all the executions of a given type. If no executions found, it returns
   // OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -341,6 +437,18 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status GetContexts(const GetContextsRequest& request,
                            GetContextsResponse* response) override;
 
+  // Lists all contexts matching `request.options` and passes them to
+  // `callback` in batches of `max_result_size` contexts, each with the next
+  // page token to resume listing after it. Consecutive batches are read in
+  // the same transaction, and are passed to `callback` after it commits.
+  // Returns the first error returned by `callback`.
+  // Returns INVALID_ARGUMENT error, if the list options are invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ListContexts(
+      const ListContextsRequest& request,
+      const std::function<absl::Status(const ListContextsResponse&)>&
+          callback);
+
   // Gets all the contexts of a given type. If no contexts found, it returns
   // OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -100,8 +100,13 @@ class MetadataStore(object):
       self._using_db_connection = True
       migration_options = metadata_store_pb2.MigrationOptions()
       migration_options.enable_upgrade_migration = enable_upgrade_migration
+      # The aborted calls are retried by _call, instead of the library.
+      library_config = proto.ConnectionConfig()
+      library_config.CopyFrom(config)
+      library_config.ClearField('retry_options')
       self._metadata_store = metadata_store_serialized.CreateMetadataStore(
-          config.SerializeToString(), migration_options.SerializeToString())
+          library_config.SerializeToString(),
+          migration_options.SerializeToString())
       logging.log(logging.INFO, 'MetadataStore with DB connection initialized')
       logging.log(logging.DEBUG, 'ConnectionConfig: %s', config)
       if config.HasField('retry_options'):
@@ -0,0 +1,453 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <functional>
+
+#include <glog/logging.h>
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/async_stream.h"
+#include "grpcpp/support/async_unary_call.h"
+#include "grpcpp/support/status_code_enum.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+using RequestClass = RequestScheduler::RequestClass;
+
+// Converts from absl Status to GRPC Status.
+::grpc::Status ToGRPCStatus(const ::absl::Status& status) {
+  // Note: the absl and grpc status codes align with each other.
+  return ::grpc::Status(static_cast<::grpc::StatusCode>(status.code()),
+                        std::string(status.message()));
+}
+
+// The parts of the server shared by the calls on a completion queue.
+struct CallContext {
+  MetadataStoreService::AsyncService* async_service;
+  MetadataStoreServiceImpl* service;
+  RequestScheduler* request_scheduler;
+  ::grpc::ServerCompletionQueue* completion_queue;
+};
+
+// A handler of completion queue events. Each event is tagged with its handler.
+class Tag {
+ public:
+  virtual ~Tag() = default;
+
+  // Handles a completed event tagged with this. `ok` is false if the event
+  // failed, e.g., the completion queue is shutting down.
+  virtual void Proceed(bool ok) = 0;
+};
+
+// A call in progress on a completion queue. Besides the events of the call, it
+// is notified once the call is done, i.e., finished or cancelled, which makes
+// ServerContext::IsCancelled usable while the call runs, so that the queries
+// of a cancelled call can be stopped.
+class Call : public Tag {
+ public:
+  Call() : done_tag_(this) {}
+
+ protected:
+  // Asks for the done notification of the call of `server_context`. Must be
+  // called before the call is requested.
+  void NotifyWhenDone(::grpc::ServerContext* server_context) {
+    server_context->AsyncNotifyWhenDone(&done_tag_);
+  }
+
+  // Deletes the call once its last event is handled and it is done. A call
+  // which has not started, i.e., whose request failed, is not notified.
+  void Release(const bool is_started) {
+    if (!is_started || is_done_) {
+      delete this;
+      return;
+    }
+    is_released_ = true;
+  }
+
+ private:
+  class DoneTag final : public Tag {
+   public:
+    explicit DoneTag(Call* call) : call_(call) {}
+
+    void Proceed(bool ok) override { call_->OnDone(); }
+
+   private:
+    Call* const call_;
+  };
+
+  void OnDone() {
+    if (is_released_) {
+      delete this;
+      return;
+    }
+    is_done_ = true;
+  }
+
+  // The events of a call are handled by the thread polling its queue, so these
+  // are not guarded.
+  DoneTag done_tag_;
+  bool is_done_ = false;
+  bool is_released_ = false;
+};
+
+// A unary call of a MetadataStoreService method. The call deletes itself once
+// the response is sent. A call without a `handle_method` is answered with
+// UNIMPLEMENTED error by the polling thread, without taking a worker.
+template <typename Request, typename Response>
+class UnaryCall final : public Call {
+ public:
+  using RequestMethod = void (MetadataStoreService::AsyncService::*)(
+      ::grpc::ServerContext*, Request*,
+      ::grpc::ServerAsyncResponseWriter<Response>*, ::grpc::CompletionQueue*,
+      ::grpc::ServerCompletionQueue*, void*);
+  using HandleMethod = ::grpc::Status (MetadataStoreService::Service::*)(
+      ::grpc::ServerContext*, const Request*, Response*);
+
+  // Creates a call which waits for the next request of the method.
+  UnaryCall(const CallContext& call_context, const char* method_name,
+            RequestMethod request_method, HandleMethod handle_method,
+            RequestClass request_class)
+      : call_context_(call_context),
+        method_name_(method_name),
+        request_method_(request_method),
+        handle_method_(handle_method),
+        request_class_(request_class),
+        responder_(&server_context_) {
+    NotifyWhenDone(&server_context_);
+    (call_context_.async_service->*request_method_)(
+        &server_context_, &request_, &responder_,
+        call_context_.completion_queue, call_context_.completion_queue, this);
+  }
+
+  void Proceed(const bool ok) override {
+    if (state_ == State::kFinishing || !ok) {
+      Release(/*is_started=*/state_ == State::kFinishing);
+      return;
+    }
+    // A request has arrived. Waits for the next one of the same method, and
+    // queues this one to be run by a worker.
+    new UnaryCall(call_context_, method_name_, request_method_, handle_method_,
+                  request_class_);
+    state_ = State::kFinishing;
+    if (handle_method_ == nullptr) {
+      responder_.FinishWithError(
+          ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                         absl::StrCat(method_name_, " is not implemented.")),
+          this);
+      return;
+    }
+    const absl::Status status = call_context_.request_scheduler->Schedule(
+        request_class_, [this]() { Handle(); });
+    if (!status.ok()) {
+      LOG(WARNING) << method_name_ << " rejected: " << status;
+      responder_.FinishWithError(ToGRPCStatus(status), this);
+    }
+  }
+
+ private:
+  enum class State { kWaitingForRequest, kFinishing };
+
+  // Runs the request on a worker thread and sends the response.
+  void Handle() {
+    if (server_context_.deadline() <= std::chrono::system_clock::now()) {
+      responder_.FinishWithError(
+          ::grpc::Status(::grpc::StatusCode::DEADLINE_EXCEEDED,
+                         "The deadline expired before the call was executed."),
+          this);
+      return;
+    }
+    const ::grpc::Status status = (call_context_.service->*handle_method_)(
+        &server_context_, &request_, &response_);
+    if (status.ok()) {
+      responder_.Finish(response_, status, this);
+    } else {
+      responder_.FinishWithError(status, this);
+    }
+  }
+
+  const CallContext call_context_;
+  const char* const method_name_;
+  const RequestMethod request_method_;
+  const HandleMethod handle_method_;
+  const RequestClass request_class_;
+
+  State state_ = State::kWaitingForRequest;
+  ::grpc::ServerContext server_context_;
+  Request request_;
+  Response response_;
+  ::grpc::ServerAsyncResponseWriter<Response> responder_;
+};
+
+// A server streaming call of a MetadataStoreService method. The worker running
+// the request waits for each response to be written before producing the next
+// one, as the asynchronous API allows a single outstanding write per call. The
+// call deletes itself once the stream is finished.
+template <typename Request, typename Response>
+class ServerStreamingCall final : public Call {
+ public:
+  using RequestMethod = void (MetadataStoreService::AsyncService::*)(
+      ::grpc::ServerContext*, Request*, ::grpc::ServerAsyncWriter<Response>*,
+      ::grpc::CompletionQueue*, ::grpc::ServerCompletionQueue*, void*);
+  using HandleMethod = ::grpc::Status (MetadataStoreServiceImpl::*)(
+      ::grpc::ServerContext*, const Request*,
+      const std::function<bool(const Response&)>&);
+
+  // Creates a call which waits for the next request of the method.
+  ServerStreamingCall(const CallContext& call_context, const char* method_name,
+                      RequestMethod request_method, HandleMethod handle_method,
+                      RequestClass request_class)
+      : call_context_(call_context),
+        method_name_(method_name),
+        request_method_(request_method),
+        handle_method_(handle_method),
+        request_class_(request_class),
+        writer_(&server_context_) {
+    NotifyWhenDone(&server_context_);
+    (call_context_.async_service->*request_method_)(
+        &server_context_, &request_, &writer_, call_context_.completion_queue,
+        call_context_.completion_queue, this);
+  }
+
+  void Proceed(const bool ok) override {
+    State state;
+    {
+      absl::MutexLock lock(&mu_);
+      state = state_;
+      if (state == State::kStreaming) {
+        // A response has been written. Resumes the worker.
+        write_ok_ = ok;
+        is_writing_ = false;
+        return;
+      }
+    }
+    if (state == State::kFinishing || !ok) {
+      Release(/*is_started=*/state != State::kWaitingForRequest);
+      return;
+    }
+    new ServerStreamingCall(call_context_, method_name_, request_method_,
+                            handle_method_, request_class_);
+    {
+      absl::MutexLock lock(&mu_);
+      state_ = State::kStreaming;
+    }
+    const absl::Status status = call_context_.request_scheduler->Schedule(
+        request_class_, [this]() { Handle(); });
+    if (!status.ok()) {
+      LOG(WARNING) << method_name_ << " rejected: " << status;
+      Finish(ToGRPCStatus(status));
+    }
+  }
+
+ private:
+  enum class State { kWaitingForRequest, kStreaming, kFinishing };
+
+  // Runs the request on a worker thread and streams the responses.
+  void Handle() {
+    if (server_context_.deadline() <= std::chrono::system_clock::now()) {
+      Finish(::grpc::Status(
+          ::grpc::StatusCode::DEADLINE_EXCEEDED,
+          "The deadline expired before the call was executed."));
+      return;
+    }
+    Finish((call_context_.service->*handle_method_)(
+        &server_context_, &request_,
+        [this](const Response& response) { return Write(response); }));
+  }
+
+  // Writes the `response` and waits until it is sent. Returns false if the
+  // stream is closed.
+  bool Write(const Response& response) {
+    absl::MutexLock lock(&mu_);
+    is_writing_ = true;
+    writer_.Write(response, this);
+    mu_.Await(absl::Condition(
+        +[](bool* is_writing) { return !*is_writing; }, &is_writing_));
+    return write_ok_;
+  }
+
+  void Finish(const ::grpc::Status& status) {
+    {
+      absl::MutexLock lock(&mu_);
+      state_ = State::kFinishing;
+    }
+    writer_.Finish(status, this);
+  }
+
+  const CallContext call_context_;
+  const char* const method_name_;
+  const RequestMethod request_method_;
+  const HandleMethod handle_method_;
+  const RequestClass request_class_;
+
+  absl::Mutex mu_;
+  State state_ ABSL_GUARDED_BY(mu_) = State::kWaitingForRequest;
+  bool is_writing_ ABSL_GUARDED_BY(mu_) = false;
+  bool write_ok_ ABSL_GUARDED_BY(mu_) = false;
+  ::grpc::ServerContext server_context_;
+  Request request_;
+  ::grpc::ServerAsyncWriter<Response> writer_;
+};
+
+// Waits for the next request of each MetadataStoreService method on the
+// completion queue of `call_context`.
+void ListenForRequests(const CallContext& call_context) {
+#define MLMD_LISTEN_FOR_REQUESTS(method, request_class)                     \
+  new UnaryCall<method##Request, method##Response>(                         \
+      call_context, #method,                                                \
+      &MetadataStoreService::AsyncService::Request##method,                 \
+      &MetadataStoreService::Service::method, RequestClass::request_class);
+#define MLMD_LISTEN_FOR_STREAMING_REQUESTS(method, request_class)           \
+  new ServerStreamingCall<method##Request, method##Response>(               \
+      call_context, #method,                                                \
+      &MetadataStoreService::AsyncService::Request##method,                 \
+      &MetadataStoreServiceImpl::method, RequestClass::request_class);
+  // The methods which MetadataStoreServiceImpl does not implement are still
+  // requested, as the calls of an asynchronous method which is never requested
+  // wait for it until their deadline.
+#define MLMD_LISTEN_FOR_UNIMPLEMENTED_REQUESTS(method)                      \
+  new UnaryCall<method##Request, method##Response>(                         \
+      call_context, #method,                                                \
+      &MetadataStoreService::AsyncService::Request##method,                 \
+      /*handle_method=*/nullptr, RequestClass::kRegular);
+
+  // LINT.IfChange
+  MLMD_LISTEN_FOR_REQUESTS(PutArtifactType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutExecutionType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutContextType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutTypes, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutArtifacts, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutExecutions, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutEvents, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutExecution, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutLineageSubgraph, kHeavy)
+  MLMD_LISTEN_FOR_REQUESTS(PutContexts, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutAttributionsAndAssociations, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(PutParentContexts, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactTypesByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactTypes, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionTypesByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionTypes, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextTypesByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextTypes, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifacts, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutions, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContexts, kRegular)
+  MLMD_LISTEN_FOR_STREAMING_REQUESTS(ListArtifacts, kHeavy)
+  MLMD_LISTEN_FOR_STREAMING_REQUESTS(ListExecutions, kHeavy)
+  MLMD_LISTEN_FOR_STREAMING_REQUESTS(ListContexts, kHeavy)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactsByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionsByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextsByID, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactsByType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionsByType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextsByType, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactByTypeAndName, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionByTypeAndName, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextByTypeAndName, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactsByURI, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetEventsByExecutionIDs, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetEventsByArtifactIDs, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextsByArtifact, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetContextsByExecution, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetParentContextsByContext, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetChildrenContextsByContext, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetArtifactsByContext, kRegular)
+  MLMD_LISTEN_FOR_REQUESTS(GetExecutionsByContext, kRegular)
+  MLMD_LISTEN_FOR_UNIMPLEMENTED_REQUESTS(GetLineageGraph)
+  MLMD_LISTEN_FOR_REQUESTS(GetServerStats, kRegular)
+  // LINT.ThenChange(../proto/metadata_store_service.proto)
+
+#undef MLMD_LISTEN_FOR_UNIMPLEMENTED_REQUESTS
+#undef MLMD_LISTEN_FOR_STREAMING_REQUESTS
+#undef MLMD_LISTEN_FOR_REQUESTS
+}
+
+// Dispatches the events of `completion_queue` until it is shut down.
+void PollCompletionQueue(::grpc::ServerCompletionQueue* completion_queue) {
+  void* tag;
+  bool ok;
+  while (completion_queue->Next(&tag, &ok)) {
+    static_cast<Tag*>(tag)->Proceed(ok);
+  }
+}
+
+}  // namespace
+
+MetadataStoreAsyncServer::MetadataStoreAsyncServer(
+    MetadataStoreServiceImpl* service, const AsyncServerConfig& config,
+    const int num_worker_threads)
+    : service_(service),
+      num_completion_queues_(std::max(config.num_completion_queues(), 1)) {
+  const int num_workers = config.num_worker_threads() > 0
+                              ? config.num_worker_threads()
+                              : num_worker_threads;
+  const int max_concurrent_heavy_requests =
+      config.max_concurrent_heavy_requests() > 0
+          ? config.max_concurrent_heavy_requests()
+          : num_workers / 2;
+  request_scheduler_ = absl::make_unique<RequestScheduler>(
+      num_workers, config.max_queue_depth(), max_concurrent_heavy_requests);
+}
+
+MetadataStoreAsyncServer::~MetadataStoreAsyncServer() { Shutdown(); }
+
+void MetadataStoreAsyncServer::RegisterWith(::grpc::ServerBuilder* builder) {
+  builder->RegisterService(&async_service_);
+  for (int i = 0; i < num_completion_queues_; ++i) {
+    completion_queues_.push_back(builder->AddCompletionQueue());
+  }
+}
+
+void MetadataStoreAsyncServer::Start() {
+  for (const auto& completion_queue : completion_queues_) {
+    ListenForRequests({&async_service_, service_, request_scheduler_.get(),
+                       completion_queue.get()});
+    polling_threads_.emplace_back(PollCompletionQueue,
+                                  completion_queue.get());
+  }
+}
+
+void MetadataStoreAsyncServer::Shutdown() {
+  if (is_shut_down_) return;
+  is_shut_down_ = true;
+  // Runs the queued requests, whose responses are sent through the completion
+  // queues, before the queues are shut down.
+  request_scheduler_->Shutdown();
+  for (const auto& completion_queue : completion_queues_) {
+    completion_queue->Shutdown();
+  }
+  if (polling_threads_.empty()) {
+    // The queues must be drained even if the server was never started.
+    for (const auto& completion_queue : completion_queues_) {
+      PollCompletionQueue(completion_queue.get());
+    }
+  }
+  for (std::thread& polling_thread : polling_threads_) {
+    polling_thread.join();
+  }
+  polling_threads_.clear();
+}
+
+}  // namespace ml_metadata
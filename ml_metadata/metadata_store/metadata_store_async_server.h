@@ -0,0 +1,88 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "grpcpp/completion_queue.h"
+#include "grpcpp/server_builder.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/metadata_store/request_scheduler.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+
+namespace ml_metadata {
+
+// Serves MetadataStoreService with the asynchronous gRPC API.
+//
+// Requests are received on completion queues polled by dedicated threads and
+// executed by a fixed pool of worker threads through a RequestScheduler, which
+// bounds the number of waiting requests and rejects the ones beyond the limit
+// with RESOURCE_EXHAUSTED error. The requests are executed by the given
+// `service`, which must outlive this object.
+//
+// Usage:
+//   MetadataStoreAsyncServer async_server(&service, config);
+//   ::grpc::ServerBuilder builder;
+//   async_server.RegisterWith(&builder);
+//   std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+//   async_server.Start();
+//   ...
+//   server->Shutdown();
+//   async_server.Shutdown();
+class MetadataStoreAsyncServer {
+ public:
+  // Creates the server. `num_worker_threads` is used if the config does not
+  // specify the number of worker threads.
+  MetadataStoreAsyncServer(MetadataStoreServiceImpl* service,
+                           const AsyncServerConfig& config,
+                           int num_worker_threads);
+
+  // Disallow copy and assign.
+  MetadataStoreAsyncServer(const MetadataStoreAsyncServer&) = delete;
+  MetadataStoreAsyncServer& operator=(const MetadataStoreAsyncServer&) =
+      delete;
+
+  ~MetadataStoreAsyncServer();
+
+  // Registers the asynchronous service and its completion queues with the
+  // `builder`. Must be called once before the server is built.
+  void RegisterWith(::grpc::ServerBuilder* builder);
+
+  // Starts accepting requests. Must be called after the server is built.
+  void Start();
+
+  // Runs the accepted requests and stops polling the completion queues. The
+  // gRPC server must be shut down before.
+  void Shutdown();
+
+ private:
+  MetadataStoreServiceImpl* const service_;
+  const int num_completion_queues_;
+
+  MetadataStoreService::AsyncService async_service_;
+  std::unique_ptr<RequestScheduler> request_scheduler_;
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>>
+      completion_queues_;
+  std::vector<std::thread> polling_threads_;
+  bool is_shut_down_ = false;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVER_H_
@@ -0,0 +1,193 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "grpcpp/grpcpp.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAreArray;
+
+// Serves a fake database with the asynchronous server, and calls it through a
+// gRPC channel.
+class MetadataStoreAsyncServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MetadataStoreServerConfig server_config;
+    server_config.mutable_connection_config()->mutable_fake_database();
+    service_ = absl::make_unique<MetadataStoreServiceImpl>(server_config);
+    async_server_ = absl::make_unique<MetadataStoreAsyncServer>(
+        service_.get(), ParseTextProtoOrDie<AsyncServerConfig>(R"(
+          num_worker_threads: 2
+          num_completion_queues: 2
+        )"),
+        /*num_worker_threads=*/1);
+
+    ::grpc::ServerBuilder builder;
+    int port = 0;
+    builder.AddListeningPort("127.0.0.1:0",
+                             ::grpc::InsecureServerCredentials(), &port);
+    async_server_->RegisterWith(&builder);
+    server_ = builder.BuildAndStart();
+    ASSERT_NE(server_, nullptr);
+    async_server_->Start();
+    stub_ = MetadataStoreService::NewStub(
+        ::grpc::CreateChannel(absl::StrCat("127.0.0.1:", port),
+                              ::grpc::InsecureChannelCredentials()));
+  }
+
+  void TearDown() override {
+    server_->Shutdown();
+    async_server_->Shutdown();
+  }
+
+  std::unique_ptr<MetadataStoreServiceImpl> service_;
+  std::unique_ptr<MetadataStoreAsyncServer> async_server_;
+  std::unique_ptr<::grpc::Server> server_;
+  std::unique_ptr<MetadataStoreService::Stub> stub_;
+};
+
+TEST_F(MetadataStoreAsyncServerTest, ServesUnaryCalls) {
+  PutArtifactTypeRequest put_request;
+  put_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_response;
+  {
+    ::grpc::ClientContext context;
+    const ::grpc::Status status =
+        stub_->PutArtifactType(&context, put_request, &put_response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+  }
+
+  GetArtifactTypeRequest get_request;
+  get_request.set_type_name("test_type");
+  GetArtifactTypeResponse get_response;
+  {
+    ::grpc::ClientContext context;
+    const ::grpc::Status status =
+        stub_->GetArtifactType(&context, get_request, &get_response);
+    ASSERT_TRUE(status.ok()) << status.error_message();
+  }
+  EXPECT_EQ(get_response.artifact_type().id(), put_response.type_id());
+
+  // The errors of the service are returned with their codes.
+  get_request.set_type_name("unknown_type");
+  ::grpc::ClientContext context;
+  EXPECT_EQ(
+      stub_->GetArtifactType(&context, get_request, &get_response).error_code(),
+      ::grpc::StatusCode::NOT_FOUND);
+}
+
+TEST_F(MetadataStoreAsyncServerTest, StreamsResponses) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  {
+    ::grpc::ClientContext context;
+    ASSERT_TRUE(stub_
+                    ->PutArtifactType(&context, put_type_request,
+                                      &put_type_response)
+                    .ok());
+  }
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 25; ++i) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  {
+    ::grpc::ClientContext context;
+    ASSERT_TRUE(stub_
+                    ->PutArtifacts(&context, put_artifacts_request,
+                                   &put_artifacts_response)
+                    .ok());
+  }
+
+  ListArtifactsRequest list_request;
+  list_request.mutable_options()->set_max_result_size(10);
+  ::grpc::ClientContext context;
+  std::unique_ptr<::grpc::ClientReader<ListArtifactsResponse>> reader =
+      stub_->ListArtifacts(&context, list_request);
+  ListArtifactsResponse list_response;
+  std::vector<int> page_sizes;
+  std::vector<int64> listed_ids;
+  while (reader->Read(&list_response)) {
+    page_sizes.push_back(list_response.artifacts_size());
+    for (const Artifact& artifact : list_response.artifacts()) {
+      listed_ids.push_back(artifact.id());
+    }
+  }
+  const ::grpc::Status status = reader->Finish();
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_THAT(page_sizes, ElementsAreArray({10, 10, 5}));
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids()));
+}
+
+TEST_F(MetadataStoreAsyncServerTest, ServesConcurrentCalls) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([this, i]() {
+      PutArtifactTypeRequest request;
+      request.mutable_artifact_type()->set_name(absl::StrCat("type_", i));
+      PutArtifactTypeResponse response;
+      ::grpc::ClientContext context;
+      EXPECT_TRUE(stub_->PutArtifactType(&context, request, &response).ok());
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  GetArtifactTypesResponse response;
+  ::grpc::ClientContext context;
+  ASSERT_TRUE(
+      stub_->GetArtifactTypes(&context, GetArtifactTypesRequest(), &response)
+          .ok());
+  int num_put_types = 0;
+  for (const ArtifactType& type : response.artifact_types()) {
+    if (absl::StartsWith(type.name(), "type_")) ++num_put_types;
+  }
+  EXPECT_EQ(num_put_types, 8);
+}
+
+TEST_F(MetadataStoreAsyncServerTest, AnswersUnimplementedMethods) {
+  GetLineageGraphResponse response;
+  ::grpc::ClientContext context;
+  EXPECT_EQ(stub_
+                ->GetLineageGraph(&context, GetLineageGraphRequest(),
+                                  &response)
+                .error_code(),
+            ::grpc::StatusCode::UNIMPLEMENTED);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -16,8 +16,10 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/transaction_executor.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #ifndef _WIN32
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 #endif
@@ -31,21 +33,39 @@ namespace {
 
 #ifndef _WIN32
 absl::Status CreateMySQLMetadataStore(const MySQLDatabaseConfig& config,
+                                      const RetryOptions& retry_options,
                                       const MigrationOptions& migration_options,
+                                      const bool init_schema,
                                       std::unique_ptr<MetadataStore>* result) {
-  auto metadata_source = absl::make_unique<MySqlMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  std::unique_ptr<MySqlMetadataSource> metadata_source;
+  if (init_schema) {
+    metadata_source = absl::make_unique<MySqlMetadataSource>(config);
+  } else {
+    // The database has been created together with the schema.
+    MySQLDatabaseConfig light_config = config;
+    light_config.set_skip_db_creation(true);
+    metadata_source = absl::make_unique<MySqlMetadataSource>(light_config);
+  }
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
+  // The types are cached for the stores connected to the same database.
+  TypeCache* type_cache = TypeCache::ForDatabase(
+      absl::StrCat("mysql://", config.host(), ":", config.port(), ":",
+                   config.socket(), "/", config.database()));
   MLMD_RETURN_IF_ERROR(MetadataStore::Create(
       util::GetMySqlMetadataSourceQueryConfig(), migration_options,
-      std::move(metadata_source), std::move(transaction_executor), result));
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      result));
+  if (!init_schema) {
+    return absl::OkStatus();
+  }
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
 #else
 absl::Status CreateMySQLMetadataStore(
-    const MySQLDatabaseConfig& config,
-    const MigrationOptions& migration_options,
+    const MySQLDatabaseConfig& config, const RetryOptions& retry_options,
+    const MigrationOptions& migration_options, const bool init_schema,
     std::unique_ptr<MetadataStore>* result) {
   return absl::UnimplementedError(
              "MySQL is not supported in Windows yet");
@@ -53,24 +73,35 @@ absl::Status CreateMySQLMetadataStore(
 #endif
 
 absl::Status CreateSqliteMetadataStore(
-    const SqliteMetadataSourceConfig& config,
-    const MigrationOptions& migration_options,
+    const SqliteMetadataSourceConfig& config, const RetryOptions& retry_options,
+    const MigrationOptions& migration_options, const bool init_schema,
     std::unique_ptr<MetadataStore>* result) {
   auto metadata_source = absl::make_unique<SqliteMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
+  // The types are cached for the stores connected to the same database file.
+  // Each in-memory database has its own types, so they are not cached.
+  TypeCache* type_cache =
+      config.filename_uri().empty()
+          ? nullptr
+          : TypeCache::ForDatabase(
+                absl::StrCat("sqlite://", config.filename_uri()));
   MLMD_RETURN_IF_ERROR(MetadataStore::Create(
       util::GetSqliteMetadataSourceQueryConfig(), migration_options,
-      std::move(metadata_source), std::move(transaction_executor), result));
+      std::move(metadata_source), std::move(transaction_executor), type_cache,
+      result));
+  // Each connection to an in-memory database opens a new empty database, so
+  // its schema is always created.
+  if (!init_schema && !config.filename_uri().empty()) {
+    return absl::OkStatus();
+  }
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
 
-
-}  // namespace
-
 absl::Status CreateMetadataStore(const ConnectionConfig& config,
                                  const MigrationOptions& options,
+                                 const bool init_schema,
                                  std::unique_ptr<MetadataStore>* result) {
   switch (config.config_case()) {
     case ConnectionConfig::CONFIG_NOT_SET:
@@ -79,20 +110,36 @@ absl::Status CreateMetadataStore(const ConnectionConfig& config,
       return absl::InvalidArgumentError("Unset");
     case ConnectionConfig::kFakeDatabase:
       // Creates an in-memory SQLite database for testing.
-      return CreateSqliteMetadataStore(SqliteMetadataSourceConfig(), options,
-                                       result);
+      return CreateSqliteMetadataStore(SqliteMetadataSourceConfig(),
+                                       config.retry_options(), options,
+                                       init_schema, result);
     case ConnectionConfig::kMysql:
-      return CreateMySQLMetadataStore(config.mysql(), options, result);
+      return CreateMySQLMetadataStore(config.mysql(), config.retry_options(),
+                                      options, init_schema, result);
     case ConnectionConfig::kSqlite:
-      return CreateSqliteMetadataStore(config.sqlite(), options, result);
+      return CreateSqliteMetadataStore(config.sqlite(), config.retry_options(),
+                                       options, init_schema, result);
     default:
       return absl::UnimplementedError("Unknown database type.");
   }
 }
 
+}  // namespace
+
+absl::Status CreateMetadataStore(const ConnectionConfig& config,
+                                 const MigrationOptions& options,
+                                 std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStore(config, options, /*init_schema=*/true, result);
+}
+
 absl::Status CreateMetadataStore(const ConnectionConfig& config,
                                  std::unique_ptr<MetadataStore>* result) {
   return CreateMetadataStore(config, {}, result);
 }
 
+absl::Status CreateMetadataStoreLight(const ConnectionConfig& config,
+                                      std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStore(config, {}, /*init_schema=*/false, result);
+}
+
 }  // namespace ml_metadata
@@ -32,6 +32,17 @@ absl::Status CreateMetadataStore(const ConnectionConfig& config,
                                  const MigrationOptions& options,
                                  std::unique_ptr<MetadataStore>* result);
 
+// Creates a MetadataStore without checking or initializing the schema of the
+// metadata source. It assumes the schema is already in place and up-to-date,
+// e.g., it has been verified by CreateMetadataStore with the same config, and
+// avoids repeating the schema checks and simple type upserts per connection.
+// In-memory databases are always initialized, as each connection opens a new
+// empty database.
+// If the method returns OK, the method MUST set result to contain
+// a non-null pointer.
+absl::Status CreateMetadataStoreLight(const ConnectionConfig& config,
+                                      std::unique_ptr<MetadataStore>* result);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_METADATA_STORE_FACTORY_H_
@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
+#include <cstdio>
 #include <memory>
+#include <string>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
-
+#include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/test_util.h"
@@ -73,5 +75,106 @@ TEST(MetadataStoreFactoryTest, CreateSQLiteMetadataStore) {
   TestPutAndGetArtifactType(connection_config);
 }
 
+TEST(MetadataStoreFactoryTest, CreateMetadataStoreLightWithInitializedSchema) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd_factory_light_test.db"));
+  std::unique_ptr<MetadataStore> store;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+
+  std::unique_ptr<MetadataStore> light_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStoreLight(connection_config, &light_store));
+  PutArtifactTypeRequest put_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(
+          R"(
+            all_fields_match: true
+            artifact_type: { name: 'test_type' }
+          )");
+  PutArtifactTypeResponse put_response;
+  ASSERT_EQ(absl::OkStatus(),
+            light_store->PutArtifactType(put_request, &put_response));
+  GetArtifactTypesRequest get_request;
+  GetArtifactTypesResponse get_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->GetArtifactTypes(get_request, &get_response));
+  EXPECT_THAT(get_response.artifact_types(),
+              ::testing::Contains(::testing::Property(
+                  &ArtifactType::name, ::testing::Eq("test_type"))));
+}
+
+TEST(MetadataStoreFactoryTest, TypesChangedByOtherStoreAreNotServedStale) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "mlmd_factory_type_cache_test.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> store;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+  std::unique_ptr<MetadataStore> other_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStore(connection_config, &other_store));
+
+  PutArtifactTypeRequest put_type_request =
+      ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+        artifact_type: {
+          name: 'cached_type'
+          properties { key: 'p1' value: INT }
+        }
+      )");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutArtifactType(put_type_request, &put_type_response));
+  GetArtifactTypeRequest get_type_request;
+  get_type_request.set_type_name("cached_type");
+  GetArtifactTypeResponse get_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->GetArtifactType(get_type_request, &get_type_response));
+
+  // The other store adds a property to the type read by the store.
+  put_type_request.set_can_add_fields(true);
+  (*put_type_request.mutable_artifact_type()->mutable_properties())["p2"] =
+      STRING;
+  ASSERT_EQ(absl::OkStatus(),
+            other_store->PutArtifactType(put_type_request, &put_type_response));
+
+  ASSERT_EQ(absl::OkStatus(),
+            store->GetArtifactType(get_type_request, &get_type_response));
+  EXPECT_TRUE(get_type_response.artifact_type().properties().contains("p2"));
+  PutArtifactsRequest put_artifacts_request;
+  Artifact* artifact = put_artifacts_request.add_artifacts();
+  artifact->set_type_id(put_type_response.type_id());
+  (*artifact->mutable_properties())["p2"].set_string_value("value");
+  PutArtifactsResponse put_artifacts_response;
+  EXPECT_EQ(absl::OkStatus(), store->PutArtifacts(put_artifacts_request,
+                                                  &put_artifacts_response));
+}
+
+TEST(MetadataStoreFactoryTest, CreateMetadataStoreLightSkipsSchemaCheck) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "mlmd_factory_light_empty_test.db"));
+  std::unique_ptr<MetadataStore> light_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStoreLight(connection_config, &light_store));
+  // The schema is not created, so the queries fail.
+  GetArtifactTypesRequest get_request;
+  GetArtifactTypesResponse get_response;
+  EXPECT_FALSE(light_store->GetArtifactTypes(get_request, &get_response).ok());
+}
+
+TEST(MetadataStoreFactoryTest, CreateMetadataStoreLightWithFakeDatabase) {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  std::unique_ptr<MetadataStore> light_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStoreLight(connection_config, &light_store));
+  // In-memory databases are always initialized.
+  GetArtifactTypesRequest get_request;
+  GetArtifactTypesResponse get_response;
+  EXPECT_EQ(absl::OkStatus(),
+            light_store->GetArtifactTypes(get_request, &get_response));
+}
+
 }  // namespace
 }  // namespace ml_metadata
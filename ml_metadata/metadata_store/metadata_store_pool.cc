@@ -0,0 +1,139 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/time/clock.h"
+
+namespace ml_metadata {
+
+MetadataStorePool::ScopedMetadataStore::ScopedMetadataStore(
+    ScopedMetadataStore&& other)
+    : pool_(other.pool_), metadata_store_(std::move(other.metadata_store_)) {
+  other.pool_ = nullptr;
+}
+
+MetadataStorePool::ScopedMetadataStore&
+MetadataStorePool::ScopedMetadataStore::operator=(
+    ScopedMetadataStore&& other) {
+  if (this != &other) {
+    Reset();
+    pool_ = other.pool_;
+    metadata_store_ = std::move(other.metadata_store_);
+    other.pool_ = nullptr;
+  }
+  return *this;
+}
+
+void MetadataStorePool::ScopedMetadataStore::Reset() {
+  if (pool_ != nullptr && metadata_store_ != nullptr) {
+    pool_->Release(std::move(metadata_store_));
+  }
+  pool_ = nullptr;
+  metadata_store_.reset();
+}
+
+MetadataStorePool::MetadataStorePool(
+    const ConnectionPoolConfig& config,
+    MetadataStoreFactory metadata_store_factory)
+    : max_pool_size_(std::max(config.max_pool_size(), 1)),
+      max_idle_time_(config.max_idle_time_sec() > 0
+                         ? absl::Seconds(config.max_idle_time_sec())
+                         : absl::InfiniteDuration()),
+      health_check_idle_time_(
+          absl::Seconds(std::max(config.health_check_idle_time_sec(), 0.0))),
+      metadata_store_factory_(std::move(metadata_store_factory)) {}
+
+MetadataStorePool::~MetadataStorePool() {
+  absl::MutexLock lock(&mu_);
+  CHECK_EQ(num_open_stores_, idle_stores_.size())
+      << "MetadataStorePool destroyed with checked out stores.";
+}
+
+absl::Status MetadataStorePool::Acquire(ScopedMetadataStore* result) {
+  result->Reset();
+  IdleStore idle_store;
+  {
+    absl::MutexLock lock(&mu_);
+    auto can_acquire = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return !idle_stores_.empty() || num_open_stores_ < max_pool_size_;
+    };
+    mu_.Await(absl::Condition(&can_acquire));
+    CloseExpiredIdleStores();
+    if (!idle_stores_.empty()) {
+      idle_store = std::move(idle_stores_.back());
+      idle_stores_.pop_back();
+    } else {
+      // Reserves the slot for the new store, so that it is accounted for while
+      // the store is created outside of the lock.
+      ++num_open_stores_;
+    }
+  }
+
+  std::unique_ptr<MetadataStore> metadata_store =
+      std::move(idle_store.metadata_store);
+  if (metadata_store != nullptr &&
+      absl::Now() - idle_store.last_used_time >= health_check_idle_time_) {
+    const absl::Status health_status = metadata_store->HealthCheck();
+    if (!health_status.ok()) {
+      LOG(WARNING) << "Replacing a pooled metadata store which failed the "
+                   << "health check: " << health_status;
+      metadata_store.reset();
+    }
+  }
+  if (metadata_store == nullptr) {
+    const absl::Status status = metadata_store_factory_(&metadata_store);
+    if (!status.ok()) {
+      absl::MutexLock lock(&mu_);
+      --num_open_stores_;
+      return status;
+    }
+  }
+  result->pool_ = this;
+  result->metadata_store_ = std::move(metadata_store);
+  return absl::OkStatus();
+}
+
+void MetadataStorePool::Release(
+    std::unique_ptr<MetadataStore> metadata_store) {
+  // The deadline of the caller does not apply to the next one.
+  metadata_store->ClearQueryDeadline();
+  absl::MutexLock lock(&mu_);
+  idle_stores_.push_back({std::move(metadata_store), absl::Now()});
+}
+
+void MetadataStorePool::CloseExpiredIdleStores() {
+  const absl::Time now = absl::Now();
+  while (!idle_stores_.empty() &&
+         now - idle_stores_.front().last_used_time > max_idle_time_) {
+    idle_stores_.pop_front();
+    --num_open_stores_;
+  }
+}
+
+int MetadataStorePool::num_open_stores() const {
+  absl::MutexLock lock(&mu_);
+  return num_open_stores_;
+}
+
+int MetadataStorePool::num_idle_stores() const {
+  absl::MutexLock lock(&mu_);
+  return idle_stores_.size();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,128 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A bounded pool of connected MetadataStores. A MetadataStore is not
+// thread-safe, so each checked out store is used by a single caller at a time
+// and is returned to the pool when the caller is done with it.
+//
+// Stores are created on demand with the given factory function, up to
+// `max_pool_size` open stores. Idle stores are reused in LIFO order, so a
+// small working set of connections stays warm, and stores that have been idle
+// for longer than `max_idle_time_sec` are closed. A store that has been idle
+// for longer than `health_check_idle_time_sec` is health checked before being
+// handed out and is replaced by a new store if the check fails.
+//
+// This class is thread-safe.
+class MetadataStorePool {
+ public:
+  // Creates a connected MetadataStore in `result`.
+  using MetadataStoreFactory =
+      std::function<absl::Status(std::unique_ptr<MetadataStore>* result)>;
+
+  // A MetadataStore checked out from a MetadataStorePool. The store is
+  // returned to the pool when this object is destroyed or reset.
+  class ScopedMetadataStore {
+   public:
+    ScopedMetadataStore() = default;
+    ~ScopedMetadataStore() { Reset(); }
+
+    ScopedMetadataStore(ScopedMetadataStore&& other);
+    ScopedMetadataStore& operator=(ScopedMetadataStore&& other);
+
+    // Disallow copy and assign.
+    ScopedMetadataStore(const ScopedMetadataStore&) = delete;
+    ScopedMetadataStore& operator=(const ScopedMetadataStore&) = delete;
+
+    MetadataStore* get() const { return metadata_store_.get(); }
+    MetadataStore* operator->() const { return metadata_store_.get(); }
+    explicit operator bool() const { return metadata_store_ != nullptr; }
+
+    // Returns the store to the pool it was checked out from.
+    void Reset();
+
+   private:
+    friend class MetadataStorePool;
+
+    MetadataStorePool* pool_ = nullptr;
+    std::unique_ptr<MetadataStore> metadata_store_;
+  };
+
+  // Creates a pool which uses `metadata_store_factory` to open new stores.
+  MetadataStorePool(const ConnectionPoolConfig& config,
+                    MetadataStoreFactory metadata_store_factory);
+
+  // Disallow copy and assign.
+  MetadataStorePool(const MetadataStorePool&) = delete;
+  MetadataStorePool& operator=(const MetadataStorePool&) = delete;
+
+  // All checked out stores must be returned before the pool is destroyed.
+  ~MetadataStorePool();
+
+  // Checks out a store into `result`. If all `max_pool_size` stores are in
+  // use, blocks until one of them is returned to the pool.
+  // Returns detailed error, if a new store cannot be created.
+  absl::Status Acquire(ScopedMetadataStore* result);
+
+  // Returns the number of open stores, including the ones checked out.
+  int num_open_stores() const;
+
+  // Returns the number of open stores which are not checked out.
+  int num_idle_stores() const;
+
+ private:
+  // An open store which is not checked out, and when it was last returned.
+  struct IdleStore {
+    std::unique_ptr<MetadataStore> metadata_store;
+    absl::Time last_used_time;
+  };
+
+  // Returns a checked out store to the pool.
+  void Release(std::unique_ptr<MetadataStore> metadata_store);
+
+  // Closes the idle stores which have exceeded `max_idle_time_`.
+  void CloseExpiredIdleStores() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int max_pool_size_;
+  const absl::Duration max_idle_time_;
+  const absl::Duration health_check_idle_time_;
+  const MetadataStoreFactory metadata_store_factory_;
+
+  mutable absl::Mutex mu_;
+  // The idle stores ordered by the time they were returned to the pool, with
+  // the least recently used store at the front.
+  std::deque<IdleStore> idle_stores_ ABSL_GUARDED_BY(mu_);
+  // The number of open stores, including the checked out ones and the ones
+  // being created.
+  int num_open_stores_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
@@ -0,0 +1,165 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+// A factory which creates in-memory sqlite stores and counts its calls.
+class CountingMetadataStoreFactory {
+ public:
+  MetadataStorePool::MetadataStoreFactory factory() {
+    return [this](std::unique_ptr<MetadataStore>* result) {
+      ++num_calls_;
+      ConnectionConfig connection_config;
+      connection_config.mutable_fake_database();
+      return CreateMetadataStore(connection_config, result);
+    };
+  }
+
+  int num_calls() const { return num_calls_; }
+
+ private:
+  int num_calls_ = 0;
+};
+
+TEST(MetadataStorePoolTest, ReusesReleasedStore) {
+  CountingMetadataStoreFactory factory;
+  MetadataStorePool pool(ConnectionPoolConfig(), factory.factory());
+
+  MetadataStore* first_store = nullptr;
+  {
+    MetadataStorePool::ScopedMetadataStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+    first_store = store.get();
+    const PutArtifactTypeRequest request =
+        ParseTextProtoOrDie<PutArtifactTypeRequest>(R"(
+          all_fields_match: true
+          artifact_type: { name: 'test_type' }
+        )");
+    PutArtifactTypeResponse response;
+    ASSERT_EQ(absl::OkStatus(), store->PutArtifactType(request, &response));
+    EXPECT_EQ(1, pool.num_open_stores());
+    EXPECT_EQ(0, pool.num_idle_stores());
+  }
+  EXPECT_EQ(1, pool.num_idle_stores());
+
+  MetadataStorePool::ScopedMetadataStore store;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  EXPECT_EQ(first_store, store.get());
+  EXPECT_EQ(1, factory.num_calls());
+  // The in-memory database is kept alive by the pooled connection.
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  GetArtifactTypeResponse response;
+  ASSERT_EQ(absl::OkStatus(), store->GetArtifactType(request, &response));
+  EXPECT_EQ("test_type", response.artifact_type().name());
+}
+
+TEST(MetadataStorePoolTest, OpensNewStoresUpToMaxPoolSize) {
+  CountingMetadataStoreFactory factory;
+  ConnectionPoolConfig config;
+  config.set_max_pool_size(2);
+  MetadataStorePool pool(config, factory.factory());
+
+  MetadataStorePool::ScopedMetadataStore store1, store2;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store1));
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store2));
+  EXPECT_NE(store1.get(), store2.get());
+  EXPECT_EQ(2, factory.num_calls());
+  EXPECT_EQ(2, pool.num_open_stores());
+
+  // A third caller waits until one of the stores is returned.
+  absl::Notification acquired;
+  MetadataStore* released_store = store1.get();
+  MetadataStore* store3_ptr = nullptr;
+  std::thread waiter([&pool, &acquired, &store3_ptr]() {
+    MetadataStorePool::ScopedMetadataStore store3;
+    CHECK_EQ(absl::OkStatus(), pool.Acquire(&store3));
+    store3_ptr = store3.get();
+    acquired.Notify();
+  });
+  EXPECT_FALSE(acquired.WaitForNotificationWithTimeout(absl::Seconds(0.2)));
+  store1.Reset();
+  acquired.WaitForNotification();
+  waiter.join();
+  EXPECT_EQ(released_store, store3_ptr);
+  EXPECT_EQ(2, factory.num_calls());
+  EXPECT_EQ(2, pool.num_open_stores());
+}
+
+TEST(MetadataStorePoolTest, ClosesExpiredIdleStores) {
+  CountingMetadataStoreFactory factory;
+  ConnectionPoolConfig config;
+  config.set_max_idle_time_sec(0.05);
+  MetadataStorePool pool(config, factory.factory());
+  {
+    MetadataStorePool::ScopedMetadataStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  }
+  absl::SleepFor(absl::Seconds(0.1));
+
+  MetadataStorePool::ScopedMetadataStore store;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  EXPECT_EQ(2, factory.num_calls());
+  EXPECT_EQ(1, pool.num_open_stores());
+}
+
+TEST(MetadataStorePoolTest, HealthChecksIdleStores) {
+  CountingMetadataStoreFactory factory;
+  ConnectionPoolConfig config;
+  config.set_health_check_idle_time_sec(0);
+  MetadataStorePool pool(config, factory.factory());
+  for (int i = 0; i < 3; ++i) {
+    MetadataStorePool::ScopedMetadataStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  }
+  // Healthy stores are reused.
+  EXPECT_EQ(1, factory.num_calls());
+}
+
+TEST(MetadataStorePoolTest, FactoryErrorReleasesSlot) {
+  ConnectionPoolConfig config;
+  config.set_max_pool_size(1);
+  MetadataStorePool pool(config, [](std::unique_ptr<MetadataStore>* result) {
+    return absl::InternalError("cannot connect");
+  });
+  MetadataStorePool::ScopedMetadataStore store;
+  EXPECT_TRUE(absl::IsInternal(pool.Acquire(&store)));
+  EXPECT_FALSE(store);
+  EXPECT_EQ(0, pool.num_open_stores());
+  // The failed attempt does not hold on to the only slot of the pool.
+  EXPECT_TRUE(absl::IsInternal(pool.Acquire(&store)));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -16,9 +16,16 @@ limitations under the License.
 // gRPC server binary, which supports methods to interact with ml.metadata store
 // defined in third_party/ml_metadata/proto/metadata_store_service.proto.
 
+#include <pthread.h>
+#include <signal.h>
+
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -26,6 +33,7 @@ limitations under the License.
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
@@ -33,7 +41,9 @@ limitations under the License.
 #include "grpcpp/security/server_credentials.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
+#include "grpcpp/support/server_interceptor.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_async_server.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -153,6 +163,15 @@ DEFINE_int32(grpc_port, 8080, "Port to listen on for gRPC API. (default 8080)");
 DEFINE_string(grpc_channel_arguments, "",
               "A comma separated list of arguments to be passed to the grpc "
               "server. (e.g. grpc.max_connection_age_ms=2000)");
+DEFINE_bool(enable_async_server, false,
+            "If true, serves requests with the asynchronous gRPC API and a "
+            "fixed pool of worker threads. The async_server_config in "
+            "--metadata_store_server_config_file also enables it and "
+            "configures the worker pool.");
+DEFINE_int32(shutdown_grace_period_sec, 10,
+             "The seconds given to the calls in progress to finish once the "
+             "server receives SIGINT or SIGTERM, after which they are "
+             "cancelled.");
 
 // metadata store server options
 DEFINE_string(metadata_store_server_config_file, "",
@@ -193,6 +212,14 @@ DEFINE_int64(downgrade_db_schema_version, -1,
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
+  // SIGINT and SIGTERM are blocked before any thread starts, so that they are
+  // only received by the thread which shuts the server down below.
+  sigset_t shutdown_signals;
+  sigemptyset(&shutdown_signals);
+  sigaddset(&shutdown_signals, SIGINT);
+  sigaddset(&shutdown_signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+
   if ((FLAGS_grpc_port) <= 0) {
     LOG(ERROR) << "grpc_port is invalid: " << (FLAGS_grpc_port);
     return -1;
@@ -238,8 +265,8 @@ int main(int argc, char** argv) {
   // At this point, schema initialization and migration are done.
   metadata_store.reset();
 
-  ml_metadata::MetadataStoreServiceImpl metadata_store_service(
-      connection_config);
+  *server_config.mutable_connection_config() = connection_config;
+  ml_metadata::MetadataStoreServiceImpl metadata_store_service(server_config);
 
   const string server_address =
       absl::StrCat("0.0.0.0:", (FLAGS_grpc_port));
@@ -253,12 +280,50 @@ int main(int argc, char** argv) {
 
   builder.AddListeningPort(server_address, credentials);
   AddGrpcChannelArgs((FLAGS_grpc_channel_arguments), &builder);
-  builder.RegisterService(&metadata_store_service);
+  // Records the latency of each call for GetServerStats.
+  std::vector<
+      std::unique_ptr<::grpc::experimental::ServerInterceptorFactoryInterface>>
+      interceptor_creators;
+  interceptor_creators.push_back(
+      metadata_store_service.CreateStatsInterceptorFactory());
+  builder.experimental().SetInterceptorCreators(
+      std::move(interceptor_creators));
+  std::unique_ptr<ml_metadata::MetadataStoreAsyncServer> async_server;
+  if ((FLAGS_enable_async_server) || server_config.has_async_server_config()) {
+    // The worker threads are sized to the connection pool by default, so that
+    // each worker can hold a connection.
+    async_server = absl::make_unique<ml_metadata::MetadataStoreAsyncServer>(
+        &metadata_store_service, server_config.async_server_config(),
+        server_config.connection_pool_config().max_pool_size());
+    async_server->RegisterWith(&builder);
+  } else {
+    builder.RegisterService(&metadata_store_service);
+  }
   std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  if (async_server != nullptr) {
+    async_server->Start();
+  }
   LOG(INFO) << "Server listening on " << server_address;
 
+  // Once a shutdown signal is received, the server stops accepting calls, and
+  // the calls in progress are given a grace period to finish before they are
+  // cancelled.
+  std::thread shutdown_thread([&shutdown_signals, &server]() {
+    int signal;
+    sigwait(&shutdown_signals, &signal);
+    LOG(INFO) << "Received signal " << signal << ", shutting down the server";
+    server->Shutdown(std::chrono::system_clock::now() +
+                     std::chrono::seconds(FLAGS_shutdown_grace_period_sec));
+  });
+
   // keep the program running until the server shuts down.
   server->Wait();
+  shutdown_thread.join();
+  // Runs the accepted requests, and drains the completion queues.
+  if (async_server != nullptr) {
+    async_server->Shutdown();
+  }
+  LOG(INFO) << "Server shut down";
 
   return 0;
 }
@@ -14,11 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 
+#include <chrono>  // NOLINT
+
 #include <glog/logging.h>
+#include "grpcpp/support/server_interceptor.h"
 #include "grpcpp/support/status_code_enum.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/read_coalescer.h"
+#include "ml_metadata/metadata_store/read_your_writes_guard.h"
+#include "ml_metadata/metadata_store/server_stats.h"
+#include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
 namespace {
@@ -30,25 +42,320 @@ namespace {
                         std::string(status.message()));
 }
 
-// Creates a store on demand. The store created does not handle migration.
+// Returns the deadline of the call of `context`, or the infinite future if it
+// has none.
+absl::Time GetCallDeadline(::grpc::ServerContext* context) {
+  if (context == nullptr) return absl::InfiniteFuture();
+  const std::chrono::system_clock::time_point deadline = context->deadline();
+  return deadline == std::chrono::system_clock::time_point::max()
+             ? absl::InfiniteFuture()
+             : absl::FromChrono(deadline);
+}
+
+// Stops the queries run by `metadata_store` for the call of `context` once the
+// deadline of the call has passed or the client has cancelled it.
+void SetQueryDeadline(::grpc::ServerContext* context,
+                      MetadataStore* metadata_store) {
+  if (context == nullptr) return;
+  metadata_store->SetQueryDeadline(
+      GetCallDeadline(context),
+      [context]() { return context->IsCancelled(); });
+}
+
+// Checks out a store from the pool for the call of `context`. New stores are
+// created on demand and do not handle migration, nor check the schema which is
+// verified once when the server starts.
 ::grpc::Status ConnectMetadataStore(
+    MetadataStorePool* metadata_store_pool, ::grpc::ServerContext* context,
+    MetadataStorePool::ScopedMetadataStore* metadata_store) {
+  const absl::Status status = metadata_store_pool->Acquire(metadata_store);
+  if (status.ok()) {
+    SetQueryDeadline(context, metadata_store->get());
+  }
+  return ToGRPCStatus(status);
+}
+
+// Sends `response` to a stream with `write`.
+// Returns CANCELLED error, if the stream is closed.
+template <typename Response>
+absl::Status WriteToStream(
+    const std::function<bool(const Response&)>& write,
+    const Response& response) {
+  if (!write(response)) {
+    return absl::CancelledError("The stream is closed by the client.");
+  }
+  return absl::OkStatus();
+}
+
+// Records the latency and the status of a call in ServerStats.
+class StatsInterceptor : public ::grpc::experimental::Interceptor {
+ public:
+  StatsInterceptor(::grpc::experimental::ServerRpcInfo* info,
+                   ServerStats* server_stats)
+      : method_(info->method() != nullptr ? info->method() : ""),
+        server_stats_(server_stats),
+        start_time_(absl::Now()) {
+    server_stats_->CallStarted(method_);
+  }
+
+  // Records the calls which end without sending a status, e.g., the calls
+  // cancelled by the clients, as errors.
+  ~StatsInterceptor() override {
+    if (!finished_) {
+      server_stats_->CallFinished(method_, absl::Now() - start_time_,
+                                  /*ok=*/false);
+    }
+  }
+
+  void Intercept(
+      ::grpc::experimental::InterceptorBatchMethods* methods) override {
+    if (methods->QueryInterceptionHookPoint(
+            ::grpc::experimental::InterceptionHookPoints::PRE_SEND_STATUS)) {
+      finished_ = true;
+      server_stats_->CallFinished(method_, absl::Now() - start_time_,
+                                  methods->GetSendStatus().ok());
+    }
+    methods->Proceed();
+  }
+
+ private:
+  const std::string method_;
+  ServerStats* const server_stats_;
+  const absl::Time start_time_;
+  bool finished_ = false;
+};
+
+class StatsInterceptorFactory
+    : public ::grpc::experimental::ServerInterceptorFactoryInterface {
+ public:
+  explicit StatsInterceptorFactory(ServerStats* server_stats)
+      : server_stats_(server_stats) {}
+
+  ::grpc::experimental::Interceptor* CreateServerInterceptor(
+      ::grpc::experimental::ServerRpcInfo* info) override {
+    return new StatsInterceptor(info, server_stats_);
+  }
+
+ private:
+  ServerStats* const server_stats_;
+};
+
+// Returns true if each connection with `connection_config` opens its own
+// in-memory database.
+bool IsInMemoryDatabase(const ConnectionConfig& connection_config) {
+  return connection_config.has_fake_database() ||
+         (connection_config.has_sqlite() &&
+          connection_config.sqlite().filename_uri().empty());
+}
+
+// The key of the metadata which identifies the client of a request for the
+// read-your-writes guard of the read replicas.
+constexpr char kReadYourWritesTokenKey[] = "mlmd-read-your-writes-token";
+
+// Returns the read-your-writes token of the request of `context`, or an empty
+// string if it has none.
+absl::string_view GetReadYourWritesToken(::grpc::ServerContext* context) {
+  if (context == nullptr) return "";
+  const auto it = context->client_metadata().find(kReadYourWritesTokenKey);
+  if (it == context->client_metadata().end()) return "";
+  return absl::string_view(it->second.data(), it->second.length());
+}
+
+// Returns a pool of stores connected with `connection_config`, which is
+// assumed to have an up-to-date schema.
+std::unique_ptr<MetadataStorePool> CreateMetadataStorePool(
     const ConnectionConfig& connection_config,
-    std::unique_ptr<MetadataStore>* metadata_store) {
-  return ToGRPCStatus(CreateMetadataStore(connection_config, metadata_store));
+    ConnectionPoolConfig pool_config) {
+  if (IsInMemoryDatabase(connection_config)) {
+    pool_config.set_max_pool_size(1);
+    pool_config.set_max_idle_time_sec(0);
+  }
+  return absl::make_unique<MetadataStorePool>(
+      pool_config,
+      [connection_config](std::unique_ptr<MetadataStore>* result) {
+        return CreateMetadataStoreLight(connection_config, result);
+      });
+}
+
+// Returns true if the reads of a SQLite database file in WAL mode are served
+// by read-only connections of their own.
+bool HasSqliteReaderConnections(const ConnectionConfig& connection_config) {
+  return connection_config.has_sqlite() &&
+         !IsInMemoryDatabase(connection_config) &&
+         connection_config.sqlite().journal_mode() ==
+             SqliteMetadataSourceConfig::JOURNAL_MODE_WAL &&
+         connection_config.sqlite().max_num_reader_connections() > 0;
 }
 
 }  // namespace
 
 MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     const ConnectionConfig& connection_config)
-    : connection_config_(connection_config) {}
+    : MetadataStoreServiceImpl(connection_config, ConnectionPoolConfig()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const ConnectionConfig& connection_config,
+    const ConnectionPoolConfig& connection_pool_config)
+    : MetadataStoreServiceImpl([&]() {
+        MetadataStoreServerConfig server_config;
+        *server_config.mutable_connection_config() = connection_config;
+        *server_config.mutable_connection_pool_config() =
+            connection_pool_config;
+        return server_config;
+      }()) {}
+
+MetadataStoreServiceImpl::MetadataStoreServiceImpl(
+    const MetadataStoreServerConfig& server_config)
+    : connection_config_(server_config.connection_config()) {
+  ConnectionPoolConfig pool_config = server_config.connection_pool_config();
+  if (HasSqliteReaderConnections(connection_config_)) {
+    // A SQLite database has a single writer at a time, so the writes share one
+    // connection instead of waiting for the lock of each other, and the reads
+    // are sent to the readers as if they were read replicas. The readers see
+    // the committed writes at once, as they share the database file.
+    pool_config.set_max_pool_size(1);
+    ConnectionConfig reader_config = connection_config_;
+    reader_config.mutable_sqlite()->set_connection_mode(
+        SqliteMetadataSourceConfig::READONLY);
+    // The journal mode is persistent, and is set by the writer.
+    reader_config.mutable_sqlite()->clear_journal_mode();
+    ConnectionPoolConfig reader_pool_config =
+        server_config.connection_pool_config();
+    reader_pool_config.set_max_pool_size(
+        connection_config_.sqlite().max_num_reader_connections());
+    read_replica_pools_.push_back(
+        CreateMetadataStorePool(reader_config, reader_pool_config));
+  }
+  metadata_store_pool_ =
+      CreateMetadataStorePool(connection_config_, pool_config);
+  for (const ConnectionConfig& replica_connection_config :
+       server_config.read_replica_config().connection_configs()) {
+    read_replica_pools_.push_back(CreateMetadataStorePool(
+        replica_connection_config, server_config.connection_pool_config()));
+  }
+  if (!read_replica_pools_.empty() &&
+      server_config.read_replica_config().read_your_writes_window_micros() >
+          0) {
+    read_your_writes_guard_ = absl::make_unique<ReadYourWritesGuard>(
+        absl::Microseconds(server_config.read_replica_config()
+                               .read_your_writes_window_micros()));
+  }
+  if (server_config.has_group_commit_config()) {
+    group_committer_ = absl::make_unique<GroupCommitter>(
+        server_config.group_commit_config(), metadata_store_pool_.get());
+  }
+  if (server_config.coalesce_reads()) {
+    read_coalescer_ = absl::make_unique<ReadCoalescer>();
+  }
+}
+
+absl::Status MetadataStoreServiceImpl::CommitWrite(
+    ::grpc::ServerContext* context,
+    const TransactionOptions& transaction_options,
+    const GroupCommitter::Write& write) {
+  // The requests with transaction options, e.g., a tag, are committed on their
+  // own, as the options apply to the whole transaction. The grouped requests
+  // share their queries, which are stopped once all of their deadlines have
+  // passed.
+  absl::Status status;
+  if (group_committer_ != nullptr && transaction_options.ByteSizeLong() == 0) {
+    status = group_committer_->Commit(write, GetCallDeadline(context));
+  } else {
+    MetadataStorePool::ScopedMetadataStore metadata_store;
+    MLMD_RETURN_IF_ERROR(metadata_store_pool_->Acquire(&metadata_store));
+    SetQueryDeadline(context, metadata_store.get());
+    status = write(metadata_store.get());
+  }
+  WriteFinished(context);
+  return status;
+}
+
+void MetadataStoreServiceImpl::WriteFinished(::grpc::ServerContext* context) {
+  if (read_coalescer_ != nullptr) {
+    read_coalescer_->WriteFinished();
+  }
+  if (read_your_writes_guard_ != nullptr) {
+    const absl::string_view token = GetReadYourWritesToken(context);
+    if (!token.empty()) {
+      read_your_writes_guard_->WriteFinished(token);
+    }
+  }
+}
+
+bool MetadataStoreServiceImpl::ReadsFromPrimary(
+    ::grpc::ServerContext* context) {
+  if (read_replica_pools_.empty()) return true;
+  if (read_your_writes_guard_ == nullptr) return false;
+  const absl::string_view token = GetReadYourWritesToken(context);
+  return !token.empty() && read_your_writes_guard_->HasRecentWrite(token);
+}
+
+absl::Status MetadataStoreServiceImpl::AcquireReadStore(
+    ::grpc::ServerContext* context, const bool read_from_primary,
+    MetadataStorePool::ScopedMetadataStore* metadata_store) {
+  if (!read_from_primary) {
+    // The replicas are used in turn.
+    const int replica_index =
+        next_read_replica_.fetch_add(1) % read_replica_pools_.size();
+    const absl::Status replica_status =
+        read_replica_pools_[replica_index]->Acquire(metadata_store);
+    if (replica_status.ok()) {
+      SetQueryDeadline(context, metadata_store->get());
+      return absl::OkStatus();
+    }
+    LOG(WARNING) << "Failed to connect to read replica " << replica_index
+                 << ", reading from the primary database: "
+                 << replica_status.message();
+  }
+  MLMD_RETURN_IF_ERROR(metadata_store_pool_->Acquire(metadata_store));
+  SetQueryDeadline(context, metadata_store->get());
+  return absl::OkStatus();
+}
+
+template <typename Request, typename Response>
+::grpc::Status MetadataStoreServiceImpl::ReadFromStore(
+    const absl::string_view method_name, ::grpc::ServerContext* context,
+    const Request& request, Response* response,
+    absl::Status (MetadataStore::*read)(const Request&, Response*)) {
+  const bool read_from_primary = ReadsFromPrimary(context);
+  const ReadCoalescer::Read run_read =
+      [&](google::protobuf::Message* read_response) -> absl::Status {
+    MetadataStorePool::ScopedMetadataStore metadata_store;
+    const absl::Status connection_status =
+        AcquireReadStore(context, read_from_primary, &metadata_store);
+    if (!connection_status.ok()) {
+      LOG(WARNING) << "Failed to connect to the database: "
+                   << connection_status.message();
+      return connection_status;
+    }
+    return (metadata_store.get()->*read)(
+        request, static_cast<Response*>(read_response));
+  };
+  absl::Status status;
+  if (read_coalescer_ == nullptr) {
+    status = run_read(response);
+  } else if (read_from_primary && !read_replica_pools_.empty()) {
+    // The reads of the clients guarded from the replication lag only share
+    // the reads from the primary database.
+    status = read_coalescer_->Coalesce(absl::StrCat(method_name, "@primary"),
+                                       request, response, run_read,
+                                       GetCallDeadline(context));
+  } else {
+    status = read_coalescer_->Coalesce(method_name, request, response,
+                                       run_read, GetCallDeadline(context));
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << method_name << " failed: " << status.message();
+  }
+  return ToGRPCStatus(status);
+}
 
 ::grpc::Status MetadataStoreServiceImpl::PutArtifactType(
     ::grpc::ServerContext* context, const PutArtifactTypeRequest* request,
     PutArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ConnectMetadataStore(
+      metadata_store_pool_.get(), context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -56,6 +363,7 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   }
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutArtifactType(*request, response));
+  WriteFinished(context);
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutArtifactType failed: "
                  << transaction_status.error_message();
@@ -66,69 +374,30 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactType(
     ::grpc::ServerContext* context, const GetArtifactTypeRequest* request,
     GetArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactType", context, *request, response,
+                       &MetadataStore::GetArtifactType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypesByID(
     ::grpc::ServerContext* context, const GetArtifactTypesByIDRequest* request,
     GetArtifactTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactTypesByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactTypesByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactTypesByID", context, *request, response,
+                       &MetadataStore::GetArtifactTypesByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypes(
     ::grpc::ServerContext* context, const GetArtifactTypesRequest* request,
     GetArtifactTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactTypes(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactTypes failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactTypes", context, *request, response,
+                       &MetadataStore::GetArtifactTypes);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutExecutionType(
     ::grpc::ServerContext* context, const PutExecutionTypeRequest* request,
     PutExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ConnectMetadataStore(
+      metadata_store_pool_.get(), context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -136,6 +405,7 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   }
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutExecutionType(*request, response));
+  WriteFinished(context);
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutExecutionType failed: "
                  << transaction_status.error_message();
@@ -146,69 +416,30 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionType(
     ::grpc::ServerContext* context, const GetExecutionTypeRequest* request,
     GetExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionType", context, *request, response,
+                       &MetadataStore::GetExecutionType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypesByID(
     ::grpc::ServerContext* context, const GetExecutionTypesByIDRequest* request,
     GetExecutionTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionTypesByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionTypesByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionTypesByID", context, *request, response,
+                       &MetadataStore::GetExecutionTypesByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypes(
     ::grpc::ServerContext* context, const GetExecutionTypesRequest* request,
     GetExecutionTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionTypes(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionTypesByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionTypes", context, *request, response,
+                       &MetadataStore::GetExecutionTypes);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutContextType(
     ::grpc::ServerContext* context, const PutContextTypeRequest* request,
     PutContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ConnectMetadataStore(
+      metadata_store_pool_.get(), context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -216,6 +447,7 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   }
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutContextType(*request, response));
+  WriteFinished(context);
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutContextType failed: "
                  << transaction_status.error_message();
@@ -226,76 +458,32 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextType(
     ::grpc::ServerContext* context, const GetContextTypeRequest* request,
     GetContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextType", context, *request, response,
+                       &MetadataStore::GetContextType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypesByID(
     ::grpc::ServerContext* context, const GetContextTypesByIDRequest* request,
     GetContextTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextTypesByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextTypesByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextTypesByID", context, *request, response,
+                       &MetadataStore::GetContextTypesByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypes(
     ::grpc::ServerContext* context, const GetContextTypesRequest* request,
     GetContextTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextTypes(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextTypes failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextTypes", context, *request, response,
+                       &MetadataStore::GetContextTypes);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutArtifacts(
     ::grpc::ServerContext* context, const PutArtifactsRequest* request,
     PutArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutArtifacts(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutArtifacts(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutArtifacts failed: "
                  << transaction_status.error_message();
@@ -306,16 +494,11 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecutions(
     ::grpc::ServerContext* context, const PutExecutionsRequest* request,
     PutExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutExecutions(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutExecutions(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutExecutions failed: "
                  << transaction_status.error_message();
@@ -326,9 +509,9 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutTypes(
     ::grpc::ServerContext* context, const PutTypesRequest* request,
     PutTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ConnectMetadataStore(
+      metadata_store_pool_.get(), context, &metadata_store);
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
@@ -336,6 +519,7 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   }
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutTypes(*request, response));
+  WriteFinished(context);
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutTypes failed: " << transaction_status.error_message();
   }
@@ -345,56 +529,25 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByID(
     ::grpc::ServerContext* context, const GetArtifactsByIDRequest* request,
     GetArtifactsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactsByID", context, *request, response,
+                       &MetadataStore::GetArtifactsByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByID(
     ::grpc::ServerContext* context, const GetExecutionsByIDRequest* request,
     GetExecutionsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionsByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionsByID", context, *request, response,
+                       &MetadataStore::GetExecutionsByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutEvents(
     ::grpc::ServerContext* context, const PutEventsRequest* request,
     PutEventsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutEvents(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutEvents(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutEvents failed: " << transaction_status.error_message();
   }
@@ -404,16 +557,11 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecution(
     ::grpc::ServerContext* context, const PutExecutionRequest* request,
     PutExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutExecution(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutExecution(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutExecution failed: "
                  << transaction_status.error_message();
@@ -421,203 +569,96 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetEventsByArtifactIDs(
-    ::grpc::ServerContext* context,
-    const GetEventsByArtifactIDsRequest* request,
-    GetEventsByArtifactIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetEventsByArtifactIDs(*request, response));
+::grpc::Status MetadataStoreServiceImpl::PutLineageSubgraph(
+    ::grpc::ServerContext* context, const PutLineageSubgraphRequest* request,
+    PutLineageSubgraphResponse* response) {
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutLineageSubgraph(*request, response);
+      }));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetEventsByArtifactIDs failed: "
+    LOG(WARNING) << "PutLineageSubgraph failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetEventsByArtifactIDs(
+    ::grpc::ServerContext* context,
+    const GetEventsByArtifactIDsRequest* request,
+    GetEventsByArtifactIDsResponse* response) {
+  return ReadFromStore("GetEventsByArtifactIDs", context, *request, response,
+                       &MetadataStore::GetEventsByArtifactIDs);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetEventsByExecutionIDs(
     ::grpc::ServerContext* context,
     const GetEventsByExecutionIDsRequest* request,
     GetEventsByExecutionIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetEventsByExecutionIDs(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetEventsByExecutionIDs failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetEventsByExecutionIDs", context, *request, response,
+                       &MetadataStore::GetEventsByExecutionIDs);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifacts(
     ::grpc::ServerContext* context, const GetArtifactsRequest* request,
     GetArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifacts(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifacts failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifacts", context, *request, response,
+                       &MetadataStore::GetArtifacts);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByType(
     ::grpc::ServerContext* context, const GetArtifactsByTypeRequest* request,
     GetArtifactsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactsByType", context, *request, response,
+                       &MetadataStore::GetArtifactsByType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactByTypeAndName(
     ::grpc::ServerContext* context,
     const GetArtifactByTypeAndNameRequest* request,
     GetArtifactByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetArtifactByTypeAndName(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactByTypeAndName failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactByTypeAndName", context, *request, response,
+                       &MetadataStore::GetArtifactByTypeAndName);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByURI(
     ::grpc::ServerContext* context, const GetArtifactsByURIRequest* request,
     GetArtifactsByURIResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByURI(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByURI failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactsByURI", context, *request, response,
+                       &MetadataStore::GetArtifactsByURI);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutions(
     ::grpc::ServerContext* context, const GetExecutionsRequest* request,
     GetExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutions(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutions failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutions", context, *request, response,
+                       &MetadataStore::GetExecutions);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByType(
     ::grpc::ServerContext* context, const GetExecutionsByTypeRequest* request,
     GetExecutionsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionsByType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionsByType", context, *request, response,
+                       &MetadataStore::GetExecutionsByType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionByTypeAndName(
     ::grpc::ServerContext* context,
     const GetExecutionByTypeAndNameRequest* request,
     GetExecutionByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetExecutionByTypeAndName(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionByTypeAndName failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionByTypeAndName", context, *request, response,
+                       &MetadataStore::GetExecutionByTypeAndName);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutContexts(
     ::grpc::ServerContext* context, const PutContextsRequest* request,
     PutContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutContexts(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutContexts(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutContexts failed: "
                  << transaction_status.error_message();
@@ -628,98 +669,138 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByID(
     ::grpc::ServerContext* context, const GetContextsByIDRequest* request,
     GetContextsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+  return ReadFromStore("GetContextsByID", context, *request, response,
+                       &MetadataStore::GetContextsByID);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContexts(
+    ::grpc::ServerContext* context, const GetContextsRequest* request,
+    GetContextsResponse* response) {
+  return ReadFromStore("GetContexts", context, *request, response,
+                       &MetadataStore::GetContexts);
+}
+
+::grpc::Status MetadataStoreServiceImpl::ListArtifacts(
+    ::grpc::ServerContext* context, const ListArtifactsRequest* request,
+    ::grpc::ServerWriter<ListArtifactsResponse>* writer) {
+  return ListArtifacts(context, request,
+                      [writer](const ListArtifactsResponse& response) {
+                        return writer->Write(response);
+                      });
+}
+
+::grpc::Status MetadataStoreServiceImpl::ListArtifacts(
+    ::grpc::ServerContext* context, const ListArtifactsRequest* request,
+    const std::function<bool(const ListArtifactsResponse&)>& write) {
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ToGRPCStatus(AcquireReadStore(
+      context, ReadsFromPrimary(context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByID(*request, response));
+      ToGRPCStatus(metadata_store->ListArtifacts(
+          *request, [&write](const ListArtifactsResponse& response) {
+            return WriteToStream(write, response);
+          }));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByID failed: "
+    LOG(WARNING) << "ListArtifacts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetContexts(
-    ::grpc::ServerContext* context, const GetContextsRequest* request,
-    GetContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+::grpc::Status MetadataStoreServiceImpl::ListExecutions(
+    ::grpc::ServerContext* context, const ListExecutionsRequest* request,
+    ::grpc::ServerWriter<ListExecutionsResponse>* writer) {
+  return ListExecutions(context, request,
+                       [writer](const ListExecutionsResponse& response) {
+                         return writer->Write(response);
+                       });
+}
+
+::grpc::Status MetadataStoreServiceImpl::ListExecutions(
+    ::grpc::ServerContext* context, const ListExecutionsRequest* request,
+    const std::function<bool(const ListExecutionsResponse&)>& write) {
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ToGRPCStatus(AcquireReadStore(
+      context, ReadsFromPrimary(context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContexts(*request, response));
+      ToGRPCStatus(metadata_store->ListExecutions(
+          *request, [&write](const ListExecutionsResponse& response) {
+            return WriteToStream(write, response);
+          }));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContexts failed: "
+    LOG(WARNING) << "ListExecutions failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetContextsByType(
-    ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
-    GetContextsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+::grpc::Status MetadataStoreServiceImpl::ListContexts(
+    ::grpc::ServerContext* context, const ListContextsRequest* request,
+    ::grpc::ServerWriter<ListContextsResponse>* writer) {
+  return ListContexts(context, request,
+                      [writer](const ListContextsResponse& response) {
+                        return writer->Write(response);
+                      });
+}
+
+::grpc::Status MetadataStoreServiceImpl::ListContexts(
+    ::grpc::ServerContext* context, const ListContextsRequest* request,
+    const std::function<bool(const ListContextsResponse&)>& write) {
+  MetadataStorePool::ScopedMetadataStore metadata_store;
+  const ::grpc::Status connection_status = ToGRPCStatus(AcquireReadStore(
+      context, ReadsFromPrimary(context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByType(*request, response));
+      ToGRPCStatus(metadata_store->ListContexts(
+          *request, [&write](const ListContextsResponse& response) {
+            return WriteToStream(write, response);
+          }));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByType failed: "
+    LOG(WARNING) << "ListContexts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetContextsByType(
+    ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
+    GetContextsByTypeResponse* response) {
+  return ReadFromStore("GetContextsByType", context, *request, response,
+                       &MetadataStore::GetContextsByType);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetContextByTypeAndName(
     ::grpc::ServerContext* context,
     const GetContextByTypeAndNameRequest* request,
     GetContextByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextByTypeAndName(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextByTypeAndName failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextByTypeAndName", context, *request, response,
+                       &MetadataStore::GetContextByTypeAndName);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutAttributionsAndAssociations(
     ::grpc::ServerContext* context,
     const PutAttributionsAndAssociationsRequest* request,
     PutAttributionsAndAssociationsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->PutAttributionsAndAssociations(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutAttributionsAndAssociations(*request,
+                                                              response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutAttributionsAndAssociations failed: "
                  << transaction_status.error_message();
@@ -730,16 +811,11 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutParentContexts(
     ::grpc::ServerContext* context, const PutParentContextsRequest* request,
     PutParentContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutParentContexts(*request, response));
+  const ::grpc::Status transaction_status = ToGRPCStatus(CommitWrite(
+      context, request->transaction_options(),
+      [request, response](MetadataStore* metadata_store) {
+        return metadata_store->PutParentContexts(*request, response);
+      }));
   if (!transaction_status.ok()) {
     LOG(WARNING) << "PutParentContexts failed: "
                  << transaction_status.error_message();
@@ -750,125 +826,59 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByArtifact(
     ::grpc::ServerContext* context, const GetContextsByArtifactRequest* request,
     GetContextsByArtifactResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByArtifact(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByArtifact failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextsByArtifact", context, *request, response,
+                       &MetadataStore::GetContextsByArtifact);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByExecution(
     ::grpc::ServerContext* context,
     const GetContextsByExecutionRequest* request,
     GetContextsByExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByExecution(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByExecution failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetContextsByExecution", context, *request, response,
+                       &MetadataStore::GetContextsByExecution);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByContext(
     ::grpc::ServerContext* context, const GetArtifactsByContextRequest* request,
     GetArtifactsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByContext(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByContext failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetArtifactsByContext", context, *request, response,
+                       &MetadataStore::GetArtifactsByContext);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByContext(
     ::grpc::ServerContext* context,
     const GetExecutionsByContextRequest* request,
     GetExecutionsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByContext(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionsByContext failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetExecutionsByContext", context, *request, response,
+                       &MetadataStore::GetExecutionsByContext);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetParentContextsByContext(
     ::grpc::ServerContext* context,
     const GetParentContextsByContextRequest* request,
     GetParentContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetParentContextsByContext(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetParentContextsByContext failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetParentContextsByContext", context, *request,
+                       response, &MetadataStore::GetParentContextsByContext);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetChildrenContextsByContext(
     ::grpc::ServerContext* context,
     const GetChildrenContextsByContextRequest* request,
     GetChildrenContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetChildrenContextsByContext(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetChildrenContextsByContext failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  return ReadFromStore("GetChildrenContextsByContext", context, *request,
+                       response, &MetadataStore::GetChildrenContextsByContext);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetServerStats(
+    ::grpc::ServerContext* context, const GetServerStatsRequest* request,
+    GetServerStatsResponse* response) {
+  server_stats_.Export(response);
+  return ::grpc::Status::OK;
+}
+
+std::unique_ptr<::grpc::experimental::ServerInterceptorFactoryInterface>
+MetadataStoreServiceImpl::CreateStatsInterceptorFactory() {
+  return absl::make_unique<StatsInterceptorFactory>(&server_stats_);
 }
 
 }  // namespace ml_metadata
@@ -15,7 +15,20 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "grpcpp/support/server_interceptor.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/group_committer.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/read_coalescer.h"
+#include "ml_metadata/metadata_store/read_your_writes_guard.h"
+#include "ml_metadata/metadata_store/server_stats.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
 
@@ -23,13 +36,29 @@ namespace ml_metadata {
 
 // A metadata store gRPC server that implements MetadataStoreService defined in
 // proto/metadata_store_service.proto. It is thread-safe.
-// Note, concurrent call to methods in different threads are sequential.
-// TODO(b/123039345) Add a connection pool in metadata_store or grpc service.
+// Each call checks out a MetadataStore from a bounded pool of connections, so
+// concurrent calls in different threads run in parallel up to the pool size.
+// The schema of the metadata source must be initialized before the service is
+// created, e.g., with CreateMetadataStore, as the service does not check it.
 class MetadataStoreServiceImpl final
     : public MetadataStoreService::Service {
  public:
   explicit MetadataStoreServiceImpl(const ConnectionConfig& connection_config);
 
+  // Creates the service with the given connection pool settings. For in-memory
+  // databases, the pool keeps a single connection open for the lifetime of the
+  // service, so that all calls share the same database.
+  MetadataStoreServiceImpl(const ConnectionConfig& connection_config,
+                           const ConnectionPoolConfig& connection_pool_config);
+
+  // Creates the service with the connection and the settings of the
+  // `server_config`. If its group_commit_config is given, concurrent write
+  // requests are committed together. If its coalesce_reads is true, identical
+  // concurrent read requests share their execution. If its read_replica_config
+  // is given, the read requests are served by the read replicas.
+  explicit MetadataStoreServiceImpl(
+      const MetadataStoreServerConfig& server_config);
+
   // default & copy constructors are disallowed.
   MetadataStoreServiceImpl() = delete;
   MetadataStoreServiceImpl(const MetadataStoreServiceImpl&) = delete;
@@ -109,6 +138,10 @@ class MetadataStoreServiceImpl final
                               const PutExecutionRequest* request,
                               PutExecutionResponse* response) override;
 
+  ::grpc::Status PutLineageSubgraph(
+      ::grpc::ServerContext* context, const PutLineageSubgraphRequest* request,
+      PutLineageSubgraphResponse* response) override;
+
   ::grpc::Status PutTypes(::grpc::ServerContext* context,
                           const PutTypesRequest* request,
                           PutTypesResponse* response) override;
@@ -165,6 +198,18 @@ class MetadataStoreServiceImpl final
                              const GetContextsRequest* request,
                              GetContextsResponse* response) override;
 
+  ::grpc::Status ListArtifacts(
+      ::grpc::ServerContext* context, const ListArtifactsRequest* request,
+      ::grpc::ServerWriter<ListArtifactsResponse>* writer) override;
+
+  ::grpc::Status ListExecutions(
+      ::grpc::ServerContext* context, const ListExecutionsRequest* request,
+      ::grpc::ServerWriter<ListExecutionsResponse>* writer) override;
+
+  ::grpc::Status ListContexts(
+      ::grpc::ServerContext* context, const ListContextsRequest* request,
+      ::grpc::ServerWriter<ListContextsResponse>* writer) override;
+
   ::grpc::Status GetContextsByType(
       ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
       GetContextsByTypeResponse* response) override;
@@ -213,8 +258,91 @@ class MetadataStoreServiceImpl final
       const GetChildrenContextsByContextRequest* request,
       GetChildrenContextsByContextResponse* response) override;
 
+  // Variants of the streaming methods which send each response with `write`
+  // instead of a ServerWriter, so that they can be used with the asynchronous
+  // gRPC API. `write` returns false if the stream is closed.
+  ::grpc::Status ListArtifacts(
+      ::grpc::ServerContext* context, const ListArtifactsRequest* request,
+      const std::function<bool(const ListArtifactsResponse&)>& write);
+
+  ::grpc::Status ListExecutions(
+      ::grpc::ServerContext* context, const ListExecutionsRequest* request,
+      const std::function<bool(const ListExecutionsResponse&)>& write);
+
+  ::grpc::Status ListContexts(
+      ::grpc::ServerContext* context, const ListContextsRequest* request,
+      const std::function<bool(const ListContextsResponse&)>& write);
+
+  ::grpc::Status GetServerStats(::grpc::ServerContext* context,
+                                const GetServerStatsRequest* request,
+                                GetServerStatsResponse* response) override;
+
+  // Creates the factory of the server interceptors which record the latency
+  // and the status of each call in the statistics returned by GetServerStats.
+  // The latency of a call is measured from when the server starts handling it
+  // until its status is sent. The factory must be given to the ServerBuilder
+  // of the server, and must not outlive this service.
+  std::unique_ptr<::grpc::experimental::ServerInterceptorFactoryInterface>
+  CreateStatsInterceptorFactory();
+
  private:
+  // Runs the `write` of the request of `context` with the given
+  // `transaction_options` on a store from the pool. If group commit is
+  // enabled, the write may share its transaction with concurrent ones.
+  absl::Status CommitWrite(::grpc::ServerContext* context,
+                           const TransactionOptions& transaction_options,
+                           const GroupCommitter::Write& write);
+
+  // Runs the `read` method of MetadataStore named `method_name` for the
+  // `request` of `context` on a store from the pool. If read coalescing is
+  // enabled, the read may share its execution with identical concurrent ones.
+  template <typename Request, typename Response>
+  ::grpc::Status ReadFromStore(
+      absl::string_view method_name, ::grpc::ServerContext* context,
+      const Request& request, Response* response,
+      absl::Status (MetadataStore::*read)(const Request&, Response*));
+
+  // Records that the write request of `context` has finished, so that the
+  // later reads see it.
+  void WriteFinished(::grpc::ServerContext* context);
+
+  // Returns true if the read request of `context` must be served by the
+  // primary database, i.e., if there are no read replicas, or the client of
+  // the request has written recently.
+  bool ReadsFromPrimary(::grpc::ServerContext* context);
+
+  // Checks out a store for the read request of `context`, from the primary
+  // database if `read_from_primary`, or else from the next read replica. If
+  // the replica cannot be connected, the primary database is used instead.
+  absl::Status AcquireReadStore(
+      ::grpc::ServerContext* context, bool read_from_primary,
+      MetadataStorePool::ScopedMetadataStore* metadata_store);
+
   const ConnectionConfig connection_config_;
+
+  // The pool of connected stores shared by all calls.
+  std::unique_ptr<MetadataStorePool> metadata_store_pool_;
+
+  // The pools of stores connected to the read replicas, if any.
+  std::vector<std::unique_ptr<MetadataStorePool>> read_replica_pools_;
+
+  // The index of the next read replica to use, modulo the number of replicas.
+  std::atomic<uint32> next_read_replica_{0};
+
+  // Sends the reads of the clients which have written recently to the primary
+  // database, or null if there are no read replicas or no guard window.
+  std::unique_ptr<ReadYourWritesGuard> read_your_writes_guard_;
+
+  // Commits concurrent write requests together, or null if group commit is
+  // not enabled.
+  std::unique_ptr<GroupCommitter> group_committer_;
+
+  // Shares the execution of identical concurrent reads, or null if read
+  // coalescing is not enabled.
+  std::unique_ptr<ReadCoalescer> read_coalescer_;
+
+  // The statistics of the calls recorded by the stats interceptors.
+  ServerStats server_stats_;
 };
 
 }  // namespace ml_metadata
@@ -44,6 +44,7 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutContexts)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutAttributionsAndAssociations)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutParentContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutLineageSubgraph)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypesByID)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypes)
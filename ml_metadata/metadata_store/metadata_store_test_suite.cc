@@ -37,6 +37,7 @@ namespace {
 using ::ml_metadata::testing::EqualsProto;
 using ::ml_metadata::testing::ParseTextProtoOrDie;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::IsEmpty;
 using ::testing::Pointwise;
 using ::testing::SizeIs;
@@ -1560,6 +1561,159 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsWithListOptions) {
                                              "last_update_time_since_epoch"}));
 }
 
+TEST_P(MetadataStoreTestSuite, ListArtifactsInBatches) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 25; ++i) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // The 13 pages are read by id in one transaction.
+  ListArtifactsRequest list_request =
+      ParseTextProtoOrDie<ListArtifactsRequest>(R"(
+        options: {
+          max_result_size: 2,
+          order_by_field: { field: ID is_asc: true }
+        }
+      )");
+  std::vector<int64> listed_ids;
+  std::vector<std::string> next_page_tokens;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListArtifacts(
+                list_request, [&](const ListArtifactsResponse& response) {
+                  EXPECT_LE(response.artifacts_size(), 2);
+                  for (const Artifact& artifact : response.artifacts()) {
+                    listed_ids.push_back(artifact.id());
+                  }
+                  next_page_tokens.push_back(response.next_page_token());
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids()));
+  ASSERT_THAT(next_page_tokens, SizeIs(13));
+  EXPECT_THAT(next_page_tokens.back(), IsEmpty());
+
+  // Listing resumes after a received response.
+  list_request.mutable_options()->set_next_page_token(next_page_tokens[10]);
+  listed_ids.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListArtifacts(
+                list_request, [&](const ListArtifactsResponse& response) {
+                  for (const Artifact& artifact : response.artifacts()) {
+                    listed_ids.push_back(artifact.id());
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(listed_ids, ElementsAre(put_artifacts_response.artifact_ids(22),
+                                      put_artifacts_response.artifact_ids(23),
+                                      put_artifacts_response.artifact_ids(24)));
+
+  // An error of the callback stops the listing.
+  int num_responses = 0;
+  EXPECT_TRUE(absl::IsCancelled(metadata_store_->ListArtifacts(
+      list_request, [&](const ListArtifactsResponse& response) {
+        ++num_responses;
+        return absl::CancelledError("stream closed");
+      })));
+  EXPECT_EQ(1, num_responses);
+}
+
+TEST_P(MetadataStoreTestSuite, ListArtifactsInBatchesOfTransactions) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 2050; ++i) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // The artifacts are read by id in 3 transactions, and passed in pages of
+  // the default size.
+  std::vector<int64> listed_ids;
+  std::vector<std::string> next_page_tokens;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListArtifacts(
+                ListArtifactsRequest(),
+                [&](const ListArtifactsResponse& response) {
+                  EXPECT_LE(response.artifacts_size(), 100);
+                  for (const Artifact& artifact : response.artifacts()) {
+                    listed_ids.push_back(artifact.id());
+                  }
+                  next_page_tokens.push_back(response.next_page_token());
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids()));
+  ASSERT_THAT(next_page_tokens, SizeIs(21));
+  EXPECT_THAT(next_page_tokens.back(), IsEmpty());
+
+  // Listing resumes after a received response of an earlier transaction.
+  ListArtifactsRequest list_request;
+  list_request.mutable_options()->set_next_page_token(next_page_tokens[9]);
+  listed_ids.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListArtifacts(
+                list_request, [&](const ListArtifactsResponse& response) {
+                  for (const Artifact& artifact : response.artifacts()) {
+                    listed_ids.push_back(artifact.id());
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids().begin() +
+                                   1000,
+                               put_artifacts_response.artifact_ids().end()));
+
+  // The artifacts not ordered by ascending id are listed page by page.
+  list_request = ParseTextProtoOrDie<ListArtifactsRequest>(R"(
+    options: {
+      max_result_size: 100,
+      order_by_field: { field: ID is_asc: false }
+    }
+  )");
+  listed_ids.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListArtifacts(
+                list_request, [&](const ListArtifactsResponse& response) {
+                  for (const Artifact& artifact : response.artifacts()) {
+                    listed_ids.push_back(artifact.id());
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids().rbegin(),
+                               put_artifacts_response.artifact_ids().rend()));
+}
+
+TEST_P(MetadataStoreTestSuite, ListContextsWithoutContexts) {
+  std::vector<ListContextsResponse> responses;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ListContexts(
+                ListContextsRequest(), [&](const ListContextsResponse& r) {
+                  responses.push_back(r);
+                  return absl::OkStatus();
+                }));
+  ASSERT_THAT(responses, SizeIs(1));
+  EXPECT_THAT(responses[0].contexts(), IsEmpty());
+  EXPECT_FALSE(responses[0].has_next_page_token());
+}
+
 TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   PutArtifactTypeRequest put_type_request;
   put_type_request.mutable_artifact_type()->set_name("test_type");
@@ -1602,6 +1756,46 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   EXPECT_THAT(update_artifact_response.artifact_ids(), SizeIs(0));
 }
 
+TEST_P(MetadataStoreTestSuite,
+       PutArtifactsWithUpdateMaskWhenLatestUpdatedTimeChanged) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_type_response.type_id());
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+
+  // `latest_updated_time` match with the stored one. The update succeeds.
+  PutArtifactsRequest update_artifact_request;
+  Artifact* updated_artifact = update_artifact_request.add_artifacts();
+  *updated_artifact = get_artifacts_response.artifacts(0);
+  updated_artifact->set_state(Artifact::LIVE);
+  update_artifact_request.mutable_update_mask()->add_paths("state");
+  update_artifact_request.mutable_options()
+      ->set_abort_if_latest_updated_time_changed(true);
+  PutArtifactsResponse update_artifact_response;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(update_artifact_request,
+                                          &update_artifact_response));
+
+  // If update it again with the old `latest_updated_time`, the call fails
+  // with FailedPrecondition error.
+  absl::Status status = metadata_store_->PutArtifacts(
+      update_artifact_request, &update_artifact_response);
+  EXPECT_TRUE(absl::IsFailedPrecondition(status));
+  EXPECT_THAT(update_artifact_response.artifact_ids(), SizeIs(0));
+}
+
 // Test creating an execution and then updating one of its properties.
 TEST_P(MetadataStoreTestSuite, PutExecutionsUpdateGetExecutionsByID) {
   const PutExecutionTypeRequest put_execution_type_request =
@@ -1670,6 +1864,90 @@ TEST_P(MetadataStoreTestSuite, PutExecutionsUpdateGetExecutionsByID) {
                                              "last_update_time_since_epoch"}));
 }
 
+// Test updating the state and a custom property of an execution with a mask,
+// which keeps its other fields and properties.
+TEST_P(MetadataStoreTestSuite, PutExecutionsWithUpdateMask) {
+  const PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(
+          R"(
+            all_fields_match: true
+            execution_type: {
+              name: 'test_type2'
+              properties { key: 'property' value: STRING }
+            }
+          )");
+  PutExecutionTypeResponse put_execution_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutionType(put_execution_type_request,
+                                              &put_execution_type_response));
+  const int64 type_id = put_execution_type_response.type_id();
+
+  PutExecutionsRequest put_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: {
+          properties {
+            key: 'property'
+            value: { string_value: '3' }
+          }
+          last_known_state: RUNNING
+        }
+      )");
+  put_executions_request.mutable_executions(0)->set_type_id(type_id);
+  PutExecutionsResponse put_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutions(put_executions_request,
+                                           &put_executions_response));
+  ASSERT_THAT(put_executions_response.execution_ids(), SizeIs(1));
+  const int64 execution_id = put_executions_response.execution_ids(0);
+
+  PutExecutionsRequest update_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: {
+          custom_properties {
+            key: 'note'
+            value: { string_value: 'done' }
+          }
+          last_known_state: COMPLETE
+        }
+        update_mask {
+          paths: 'last_known_state'
+          paths: 'custom_properties.note'
+        }
+      )");
+  update_executions_request.mutable_executions(0)->set_id(execution_id);
+  PutExecutionsResponse update_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutions(update_executions_request,
+                                           &update_executions_response));
+  EXPECT_THAT(update_executions_response.execution_ids(),
+              ElementsAre(execution_id));
+
+  GetExecutionsByIDRequest get_executions_by_id_request;
+  get_executions_by_id_request.add_execution_ids(execution_id);
+  GetExecutionsByIDResponse get_executions_by_id_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByID(get_executions_by_id_request,
+                                               &get_executions_by_id_response));
+  Execution want_execution = ParseTextProtoOrDie<Execution>(R"(
+    properties {
+      key: 'property'
+      value: { string_value: '3' }
+    }
+    custom_properties {
+      key: 'note'
+      value: { string_value: 'done' }
+    }
+    last_known_state: COMPLETE
+  )");
+  want_execution.set_id(execution_id);
+  want_execution.set_type_id(type_id);
+  EXPECT_THAT(get_executions_by_id_response.executions(),
+              ElementsAre(EqualsProto(
+                  want_execution,
+                  /*ignore_fields=*/{"type", "create_time_since_epoch",
+                                     "last_update_time_since_epoch"})));
+}
+
 TEST_P(MetadataStoreTestSuite, PutExecutionTypeGetExecutionType) {
   const PutExecutionTypeRequest put_request =
       ParseTextProtoOrDie<PutExecutionTypeRequest>(
@@ -3385,6 +3663,54 @@ TEST_P(MetadataStoreTestSuite, PutContextTypeUpsert) {
 }
 
 // Test creating a context and then updating one of its properties.
+TEST_P(MetadataStoreTestSuite, PutContextsBestEffort) {
+  const PutContextTypeRequest put_context_type_request =
+      ParseTextProtoOrDie<PutContextTypeRequest>(R"(
+        context_type: { name: 'test_type' }
+      )");
+  PutContextTypeResponse put_context_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutContextType(put_context_type_request,
+                                            &put_context_type_response));
+  const int64 type_id = put_context_type_response.type_id();
+
+  // The second context has the same name as the first one.
+  PutContextsRequest put_contexts_request =
+      ParseTextProtoOrDie<PutContextsRequest>(R"(
+        contexts: { name: 'context1' }
+        contexts: { name: 'context1' }
+        contexts: { name: 'context2' }
+      )");
+  for (Context& context : *put_contexts_request.mutable_contexts()) {
+    context.set_type_id(type_id);
+  }
+  PutContextsResponse put_contexts_response;
+  EXPECT_TRUE(absl::IsAlreadyExists(metadata_store_->PutContexts(
+      put_contexts_request, &put_contexts_response)));
+
+  // A best-effort request stores the other contexts.
+  put_contexts_request.set_best_effort(true);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutContexts(put_contexts_request,
+                                         &put_contexts_response));
+  ASSERT_THAT(put_contexts_response.context_ids(), SizeIs(3));
+  EXPECT_EQ(-1, put_contexts_response.context_ids(1));
+  ASSERT_THAT(put_contexts_response.errors(), SizeIs(1));
+  EXPECT_EQ(1, put_contexts_response.errors(0).index());
+  EXPECT_EQ(static_cast<int>(absl::StatusCode::kAlreadyExists),
+            put_contexts_response.errors(0).code());
+
+  GetContextsResponse get_contexts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetContexts(GetContextsRequest(),
+                                         &get_contexts_response));
+  std::vector<std::string> context_names;
+  for (const Context& context : get_contexts_response.contexts()) {
+    context_names.push_back(context.name());
+  }
+  EXPECT_THAT(context_names, UnorderedElementsAre("context1", "context2"));
+}
+
 TEST_P(MetadataStoreTestSuite, PutContextsUpdateGetContexts) {
   // Create two context types
   const PutContextTypeRequest put_context_type_request =
@@ -3576,6 +3902,122 @@ TEST_P(MetadataStoreTestSuite, PutContextsUpdateGetContexts) {
   }
 }
 
+TEST_P(MetadataStoreTestSuite, PutLineageSubgraphAndGetLineage) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+        context_types: { name: 'context_type' }
+      )");
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_types_request, &put_types_response));
+  // An existing artifact which is referred to by id.
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+  const int64 existing_artifact_id = put_artifacts_response.artifact_ids(0);
+
+  PutLineageSubgraphRequest request;
+  for (int i = 0; i < 2; ++i) {
+    request.add_executions()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    request.add_artifacts()->set_type_id(
+        put_types_response.artifact_type_ids(0));
+  }
+  Context* context = request.add_contexts();
+  context->set_type_id(put_types_response.context_type_ids(0));
+  context->set_name("run");
+  PutLineageSubgraphRequest::EventEdge* edge = request.add_event_edges();
+  edge->set_execution_index(0);
+  edge->set_artifact_index(0);
+  edge->mutable_event()->set_type(Event::INPUT);
+  edge = request.add_event_edges();
+  edge->set_execution_index(0);
+  edge->set_artifact_index(1);
+  edge->mutable_event()->set_type(Event::OUTPUT);
+  edge = request.add_event_edges();
+  edge->set_execution_index(1);
+  edge->mutable_event()->set_artifact_id(existing_artifact_id);
+  edge->mutable_event()->set_type(Event::INPUT);
+  PutLineageSubgraphResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutLineageSubgraph(request, &response));
+  ASSERT_THAT(response.execution_ids(), SizeIs(2));
+  ASSERT_THAT(response.artifact_ids(), SizeIs(2));
+  ASSERT_THAT(response.context_ids(), SizeIs(1));
+
+  GetEventsByExecutionIDsRequest get_events_request;
+  get_events_request.mutable_execution_ids()->CopyFrom(
+      response.execution_ids());
+  GetEventsByExecutionIDsResponse get_events_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByExecutionIDs(get_events_request,
+                                                     &get_events_response));
+  std::vector<std::pair<int64, int64>> edges;
+  for (const Event& event : get_events_response.events()) {
+    edges.push_back({event.execution_id(), event.artifact_id()});
+  }
+  EXPECT_THAT(
+      edges,
+      UnorderedElementsAre(
+          std::make_pair(response.execution_ids(0), response.artifact_ids(0)),
+          std::make_pair(response.execution_ids(0), response.artifact_ids(1)),
+          std::make_pair(response.execution_ids(1), existing_artifact_id)));
+
+  GetExecutionsByContextRequest get_executions_request;
+  get_executions_request.set_context_id(response.context_ids(0));
+  GetExecutionsByContextResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByContext(get_executions_request,
+                                                    &get_executions_response));
+  EXPECT_THAT(get_executions_response.executions(), SizeIs(2));
+  GetArtifactsByContextRequest get_artifacts_request;
+  get_artifacts_request.set_context_id(response.context_ids(0));
+  GetArtifactsByContextResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifactsByContext(get_artifacts_request,
+                                                   &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(2));
+}
+
+TEST_P(MetadataStoreTestSuite, PutLineageSubgraphWithInvalidEventEdges) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'execution_type' }
+      )");
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutLineageSubgraphRequest request;
+  request.add_executions()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  request.add_artifacts()->set_type_id(put_types_response.artifact_type_ids(0));
+  PutLineageSubgraphRequest::EventEdge* edge = request.add_event_edges();
+  edge->set_execution_index(0);
+  edge->set_artifact_index(1);
+  edge->mutable_event()->set_type(Event::INPUT);
+  PutLineageSubgraphResponse response;
+  EXPECT_TRUE(absl::IsOutOfRange(
+      metadata_store_->PutLineageSubgraph(request, &response)));
+
+  // An unknown artifact id fails the whole subgraph.
+  edge->clear_artifact_index();
+  edge->mutable_event()->set_artifact_id(12345);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store_->PutLineageSubgraph(request, &response)));
+  GetExecutionsResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutions(GetExecutionsRequest(),
+                                           &get_executions_response));
+  EXPECT_THAT(get_executions_response.executions(), IsEmpty());
+}
+
 TEST_P(MetadataStoreTestSuite, PutAndUseAttributionsAndAssociations) {
   const PutTypesRequest put_types_request =
       ParseTextProtoOrDie<PutTypesRequest>(R"(
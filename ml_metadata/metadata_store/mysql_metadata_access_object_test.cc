@@ -26,7 +26,9 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 #include "ml_metadata/metadata_store/test_mysql_metadata_source_initializer.h"
+#include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
 
 namespace ml_metadata {
@@ -83,6 +85,66 @@ class MySqlMetadataAccessObjectContainer
   std::unique_ptr<MetadataAccessObject> metadata_access_object_;
 };
 
+// The nodes are read with their properties by one query, which joins the node
+// and property tables and tells their columns apart by their aliases.
+TEST(MySqlMetadataAccessObjectExtendedTest, FindsNodesWithPropertiesById) {
+  MySqlMetadataAccessObjectContainer container;
+  ASSERT_EQ(absl::OkStatus(), container.Init());
+  MetadataAccessObject* metadata_access_object =
+      container.GetMetadataAccessObject();
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: STRING }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateType(type, &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    name: 'test_artifact'
+    properties {
+      key: 'property_1'
+      value: { int_value: 3 }
+    }
+    properties {
+      key: 'property_2'
+      value: { string_value: '3' }
+    }
+    custom_properties {
+      key: 'custom_property_1'
+      value: { double_value: 3.0 }
+    }
+  )");
+  artifact.set_type_id(type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(artifact, &artifact_id));
+  artifact.set_id(artifact_id);
+  // An artifact without properties has a single row with null properties.
+  Artifact artifact_without_properties;
+  artifact_without_properties.set_type_id(type_id);
+  int64 artifact_without_properties_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->CreateArtifact(
+                artifact_without_properties, &artifact_without_properties_id));
+  artifact_without_properties.set_id(artifact_without_properties_id);
+
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object->FindArtifactsById(
+                {artifact_id, artifact_without_properties_id}, &artifacts));
+  EXPECT_THAT(artifacts,
+              ::testing::UnorderedElementsAre(
+                  EqualsProto(artifact, /*ignore_fields=*/{
+                                  "type", "create_time_since_epoch",
+                                  "last_update_time_since_epoch"}),
+                  EqualsProto(artifact_without_properties,
+                              /*ignore_fields=*/{
+                                  "type", "create_time_since_epoch",
+                                  "last_update_time_since_epoch"})));
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
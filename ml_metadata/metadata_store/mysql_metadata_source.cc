@@ -14,17 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
@@ -39,9 +45,20 @@ using absl::Status;
 
 constexpr char kSetIsolationLevel[] = "SET TRANSACTION ISOLATION LEVEL ";
 constexpr char kBeginTransaction[] = "START TRANSACTION";
+constexpr char kBeginReadOnlyTransaction[] =
+    "START TRANSACTION WITH CONSISTENT SNAPSHOT, READ ONLY";
 constexpr char kCommitTransaction[] = "COMMIT";
 constexpr char kRollbackTransaction[] = "ROLLBACK";
 
+// The max number of prepared statements cached by a connection. The server
+// limits the prepared statements of all its connections with
+// max_prepared_stmt_count.
+constexpr int kMaxPreparedStatements = 200;
+
+// The max number of bytes of the statements sent at once by a batch, which is
+// kept below the default max_allowed_packet of the server.
+constexpr int kMaxBatchBytes = 1 << 20;
+
 // url key used for storing ustom error information in the absl::Status payload.
 constexpr char kStatusErrorInfoUrl[] = "mysql-error-info";
 
@@ -117,6 +134,92 @@ absl::Status BuildErrorStatus(const absl::StatusCode status_code,
                           absl::Cord(error_info.SerializeAsString()));
   return error_status;
 }
+
+// Returns true if `mysql_error_code` reports that the connection is lost:
+// 2006: the server has gone away, e.g., it has closed the idle connection.
+// 2013: the connection to the server is lost during the query.
+bool IsConnectionLost(const int64 mysql_error_code) {
+  return mysql_error_code == 2006 || mysql_error_code == 2013;
+}
+
+// Builds absl::Status for a query which `operation` has failed to run with
+// `mysql_error_code`.
+absl::Status BuildQueryErrorStatus(
+    const absl::string_view operation, const int64 mysql_error_code,
+    const absl::string_view mysql_error_message) {
+  // When running concurrent transactions for error codes:
+  // 1213: Deadlock detection on wait lock.
+  // 1205: Lock wait timeout.
+  // returns Aborted for client side to retry.
+  if (mysql_error_code == 1213 || mysql_error_code == 1205) {
+    return BuildErrorStatus(absl::StatusCode::kAborted,
+                            absl::StrCat(operation, " aborted"),
+                            mysql_error_code, mysql_error_message);
+  }
+  // 3024: Query exceeds the max execution time given by the query deadline.
+  if (mysql_error_code == 3024) {
+    return BuildErrorStatus(absl::StatusCode::kDeadlineExceeded,
+                            absl::StrCat(operation, " exceeded the deadline"),
+                            mysql_error_code, mysql_error_message);
+  }
+  // 1317: Query is interrupted, e.g., killed with KILL QUERY.
+  if (mysql_error_code == 1317) {
+    return BuildErrorStatus(absl::StatusCode::kCancelled,
+                            absl::StrCat(operation, " interrupted"),
+                            mysql_error_code, mysql_error_message);
+  }
+  return BuildErrorStatus(absl::StatusCode::kInternal,
+                          absl::StrCat(operation, " failed"), mysql_error_code,
+                          mysql_error_message);
+}
+
+// Returns true if the values of columns of `type` are fetched as integers.
+bool IsIntegerColumn(const enum_field_types type) {
+  return type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_SHORT ||
+         type == MYSQL_TYPE_INT24 || type == MYSQL_TYPE_LONG ||
+         type == MYSQL_TYPE_LONGLONG;
+}
+
+// Returns true if the values of columns of `type` are fetched as doubles.
+bool IsFloatingPointColumn(const enum_field_types type) {
+  return type == MYSQL_TYPE_FLOAT || type == MYSQL_TYPE_DOUBLE;
+}
+
+// Adds the columns of `mysql_result` to `results`, and returns their fields.
+// The columns are named by their aliases, if any, as in SQLite; the columns of
+// the joined tables are told apart by them, e.g., `property_name`.
+absl::Status AddMySqlColumns(MYSQL_RES* mysql_result,
+                             std::vector<MYSQL_FIELD*>* fields,
+                             ResultSet* results) {
+  const uint32 num_cols = mysql_num_fields(mysql_result);
+  fields->resize(num_cols);
+  for (uint32 col = 0; col < num_cols; ++col) {
+    (*fields)[col] = mysql_fetch_field_direct(mysql_result, col);
+    if ((*fields)[col] == nullptr) {
+      return absl::InternalError(absl::StrCat(
+          "Error in retrieving column description for index ", col));
+    }
+    results->AddColumn((*fields)[col]->name);
+  }
+  return absl::OkStatus();
+}
+
+// Appends the fetched `row` of `mysql_result` to `results`. The text protocol
+// returns strings, which are parsed when they are read.
+void AppendMySqlRow(MYSQL_RES* mysql_result,
+                    const std::vector<MYSQL_FIELD*>& fields,
+                    const MYSQL_ROW row, ResultSet* results) {
+  const unsigned long* lengths = mysql_fetch_lengths(mysql_result);  // NOLINT
+  for (uint32 col = 0; col < fields.size(); ++col) {
+    if (row[col] == nullptr && !(fields[col]->flags & NOT_NULL_FLAG)) {
+      results->AppendNull(col);
+    } else if (row[col] == nullptr) {
+      results->AppendString(col, "");
+    } else {
+      results->AppendString(col, absl::string_view(row[col], lengths[col]));
+    }
+  }
+}
 }  // namespace
 
 MySqlMetadataSource::MySqlMetadataSource(const MySQLDatabaseConfig& config)
@@ -157,14 +260,15 @@ Status MySqlMetadataSource::ConnectImpl() {
     mysql_options(db_, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_server_cert);
   }
 
-  // Connect to the MYSQL server.
+  // Connect to the MYSQL server. Multiple statements in a query are only
+  // allowed while a batch runs, see RunMultiStatementQuery.
   db_ = mysql_real_connect(
           db_, config_.host().empty() ? nullptr : config_.host().c_str(),
           config_.user().empty() ? nullptr : config_.user().c_str(),
           config_.password().empty() ? nullptr : config_.password().c_str(),
           /*db=*/nullptr, config_.port(),
           config_.socket().empty() ? nullptr : config_.socket().c_str(),
-          /*clientflag=*/0UL);
+          /*clientflag=*/0);
 
   if (!db_) {
     return BuildErrorStatus(absl::StatusCode::kInternal,
@@ -196,13 +300,78 @@ Status MySqlMetadataSource::ConnectImpl() {
                                     "Changing to database ", database_name_,
                                     " in ConnectImpl");
 
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(SetUpWaitTimeout(),
+                                    "Setting up wait_timeout in ConnectImpl");
+  max_execution_time_ms_ = 0;
+  connect_time_ = absl::Now();
+  last_use_time_ = connect_time_;
+  is_connection_lost_ = false;
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::SetUpWaitTimeout() {
+  if (config_.wait_timeout_sec() > 0) {
+    MLMD_RETURN_IF_ERROR(RunQuery(absl::StrCat("SET SESSION wait_timeout = ",
+                                               config_.wait_timeout_sec())));
+    wait_timeout_ = absl::Seconds(config_.wait_timeout_sec());
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(RunQuery("SELECT @@SESSION.wait_timeout"));
+  ResultSet result_set;
+  MLMD_RETURN_IF_ERROR(ConvertMySqlRowSetToResultSet(&result_set));
+  int64 wait_timeout_sec;
+  if (result_set.num_rows() != 1 || result_set.num_columns() != 1 ||
+      !absl::SimpleAtoi(result_set.ToString(0, 0), &wait_timeout_sec)) {
+    return absl::InternalError(
+        absl::StrCat("Unexpected wait_timeout of the session: ",
+                     result_set.ToRecordSet().DebugString()));
+  }
+  wait_timeout_ = absl::Seconds(wait_timeout_sec);
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::SetUpMaxExecutionTime() {
+  int64 max_execution_time_ms = 0;
+  if (query_deadline() != absl::InfiniteFuture()) {
+    max_execution_time_ms = std::max<int64>(
+        absl::ToInt64Milliseconds(query_deadline() - absl::Now()), 1);
+  }
+  if (max_execution_time_ms == max_execution_time_ms_) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(
+      RunQuery(absl::StrCat("SET SESSION max_execution_time = ",
+                            max_execution_time_ms)));
+  max_execution_time_ms_ = max_execution_time_ms;
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::MaybeReconnect() {
+  const absl::Time now = absl::Now();
+  const absl::Duration idle_time = now - last_use_time_;
+  bool reconnect = is_connection_lost_ || idle_time >= wait_timeout_ ||
+                   (config_.max_connection_age_sec() > 0 &&
+                    now - connect_time_ >=
+                        absl::Seconds(config_.max_connection_age_sec()));
+  if (!reconnect && config_.ping_after_idle_sec() >= 0 &&
+      idle_time >= absl::Seconds(config_.ping_after_idle_sec())) {
+    DiscardResultSet();
+    reconnect = mysql_ping(db_) != 0;
+  }
+  if (!reconnect) {
+    return absl::OkStatus();
+  }
+  // The connection is opened again by the next transaction if it fails now.
+  is_connection_lost_ = true;
+  MLMD_RETURN_IF_ERROR(CloseImpl());
+  return ConnectImpl();
+}
+
 Status MySqlMetadataSource::CloseImpl() {
   if (db_ != nullptr) {
     MLMD_RETURN_IF_ERROR(ThreadInitAccess());
     DiscardResultSet();
+    ClosePreparedStatements();
     mysql_close(db_);
     db_ = nullptr;
   }
@@ -210,40 +379,191 @@ Status MySqlMetadataSource::CloseImpl() {
 }
 
 Status MySqlMetadataSource::ExecuteQueryImpl(const std::string& query,
-                                             RecordSet* results) {
+                                             ResultSet* results) {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
       ThreadInitAccess(), "MySql thread init failed at ExecuteQueryImpl");
 
-  // Run the query.
+  // Run the query. A SELECT query is stopped by the server at the deadline.
+  MLMD_RETURN_IF_ERROR(SetUpMaxExecutionTime());
   MLMD_RETURN_IF_ERROR(RunQuery(query));
 
   // If query is successfull, convert the results.
-  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ConvertMySqlRowSetToRecordSet(results),
-                                    "ConvertMySqlRowSetToRecordSet for query ",
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ConvertMySqlRowSetToResultSet(results),
+                                    "ConvertMySqlRowSetToResultSet for query ",
                                     query);
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::ExecuteQueryStreamingImpl(
+    const std::string& query, const RowBatchCallback callback) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecuteQueryStreamingImpl");
+  MLMD_RETURN_IF_ERROR(SetUpMaxExecutionTime());
+  MLMD_RETURN_IF_ERROR(RunQuery(query, /*stream_rows=*/true));
+  const Status status = StreamMySqlRowSet(callback);
+  // Reads the rows left by a failed callback, as MySQL requires it before the
+  // next query.
+  DiscardResultSet();
+  return status;
+}
+
+MYSQL_STMT* MySqlMetadataSource::FindPreparedStatement(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    std::vector<const QueryParameter*>* bound_values) {
+  PreparedStatementKey key;
+  const bool is_reusable =
+      query_template.GetPreparedStatementKey(parameters, &key, bound_values);
+  auto it = prepared_statements_.find(key);
+  if (it != prepared_statements_.end()) {
+    return it->second;
+  }
+  if (!is_reusable || prepared_statements_.size() >= kMaxPreparedStatements) {
+    return nullptr;
+  }
+  const std::string query = query_template.ComposePreparedStatement(
+      parameters,
+      [this](absl::string_view value) { return EscapeString(value); });
+  DiscardResultSet();
+  MYSQL_STMT* statement = mysql_stmt_init(db_);
+  my_bool update_max_length = 1;
+  if (statement != nullptr &&
+      mysql_stmt_prepare(statement, query.data(), query.size()) == 0 &&
+      mysql_stmt_param_count(statement) == bound_values->size() &&
+      mysql_stmt_attr_set(statement, STMT_ATTR_UPDATE_MAX_LENGTH,
+                          &update_max_length) == 0) {
+    prepared_statements_[std::move(key)] = statement;
+    return statement;
+  }
+  // The query, e.g., one with several statements, or one rejected by the
+  // server's limit of prepared statements, is run as a text query, which
+  // reports its own errors.
+  if (statement != nullptr) mysql_stmt_close(statement);
+  return nullptr;
+}
+
+Status MySqlMetadataSource::ExecuteTemplateQueryImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters, ResultSet* results) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecuteTemplateQueryImpl");
+  std::vector<const QueryParameter*> bound_values;
+  MYSQL_STMT* statement =
+      FindPreparedStatement(query_template, parameters, &bound_values);
+  if (statement == nullptr) {
+    return ExecuteQueryImpl(ComposeQuery(query_template, parameters), results);
+  }
+  MLMD_RETURN_IF_ERROR(SetUpMaxExecutionTime());
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      RunPreparedStatement(statement, bound_values, results),
+      "RunPreparedStatement for query ", query_template.query());
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::ExecuteTemplateQueryStreamingImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    const RowBatchCallback callback) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecuteTemplateQueryStreamingImpl");
+  std::vector<const QueryParameter*> bound_values;
+  MYSQL_STMT* statement =
+      FindPreparedStatement(query_template, parameters, &bound_values);
+  if (statement == nullptr) {
+    return ExecuteQueryStreamingImpl(ComposeQuery(query_template, parameters),
+                                     callback);
+  }
+  MLMD_RETURN_IF_ERROR(SetUpMaxExecutionTime());
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      RunPreparedStatement(statement, bound_values, /*results=*/nullptr,
+                           &callback),
+      "RunPreparedStatement for query ", query_template.query());
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::ExecuteBatchImpl(
+    const absl::Span<const BatchedQuery> queries) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at ExecuteBatchImpl");
+  // A single query is run with its prepared statement.
+  if (queries.size() == 1) {
+    return ExecuteTemplateQueryImpl(*queries[0].query_template,
+                                    queries[0].parameters,
+                                    /*results=*/nullptr);
+  }
+  std::string statements;
+  for (const BatchedQuery& query : queries) {
+    const std::string statement = std::string(absl::StripSuffix(
+        absl::StripTrailingAsciiWhitespace(
+            ComposeQuery(*query.query_template, query.parameters)),
+        ";"));
+    if (!statements.empty() &&
+        statements.size() + statement.size() > kMaxBatchBytes) {
+      MLMD_RETURN_IF_ERROR(RunMultiStatementQuery(statements));
+      statements.clear();
+      // The writes cannot be bounded by the server, so the deadline is
+      // checked before each packet of statements instead.
+      MLMD_RETURN_IF_ERROR(CheckQueryDeadline());
+    }
+    if (!statements.empty()) {
+      statements.append(";\n");
+    }
+    statements.append(statement);
+  }
+  return RunMultiStatementQuery(statements);
+}
+
+void MySqlMetadataSource::ClearQueryDeadlineImpl() {
+  if (db_ == nullptr || max_execution_time_ms_ == 0 ||
+      !ThreadInitAccess().ok()) {
+    return;
+  }
+  const Status status = SetUpMaxExecutionTime();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to reset max_execution_time: " << status;
+  }
+}
+
 Status MySqlMetadataSource::CommitImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at CommitImpl");
-  return RunQuery(kCommitTransaction);
+  const Status status = RunQuery(kCommitTransaction);
+  last_use_time_ = absl::Now();
+  return status;
 }
 
 Status MySqlMetadataSource::RollbackImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at RollbackImpl");
 
-  return RunQuery(kRollbackTransaction);
+  const Status status = RunQuery(kRollbackTransaction);
+  last_use_time_ = absl::Now();
+  // The server discards the transaction of a lost connection, which is opened
+  // again by the next transaction.
+  if (!status.ok() && IsConnectionLost(mysql_errno(db_))) {
+    is_connection_lost_ = true;
+    return absl::OkStatus();
+  }
+  return status;
 }
 
 Status MySqlMetadataSource::BeginImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at BeginImpl");
-
+  MLMD_RETURN_IF_ERROR(MaybeReconnect());
   return RunQuery(kBeginTransaction);
 }
 
+Status MySqlMetadataSource::BeginReadOnlyImpl() {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at BeginReadOnlyImpl");
+  MLMD_RETURN_IF_ERROR(MaybeReconnect());
+  return RunQuery(kBeginReadOnlyTransaction);
+}
+
 
 Status MySqlMetadataSource::CheckTransactionSupport() {
   constexpr char kCheckTransactionSupport[] =
@@ -251,57 +571,49 @@ Status MySqlMetadataSource::CheckTransactionSupport() {
       "ENGINE=(SELECT @@default_storage_engine)";
   MLMD_RETURN_IF_ERROR(RunQuery(kCheckTransactionSupport));
 
-  RecordSet record_set;
-  MLMD_RETURN_IF_ERROR(ConvertMySqlRowSetToRecordSet(&record_set));
-  if (record_set.records_size() != 1 ||
-      record_set.records(0).values_size() != 2) {
+  ResultSet result_set;
+  MLMD_RETURN_IF_ERROR(ConvertMySqlRowSetToResultSet(&result_set));
+  if (result_set.num_rows() != 1 || result_set.num_columns() != 2) {
     return absl::InternalError(
         absl::StrCat("Expected query ", kCheckTransactionSupport,
                      " to generate exactly single row with 2 columns, but got ",
-                     record_set.DebugString()));
+                     result_set.ToRecordSet().DebugString()));
   }
-  const RecordSet::Record& record = record_set.records(0);
-  if (record.values(1) != "YES") {
+  if (result_set.ToString(0, 1) != "YES") {
     return absl::InternalError(
         absl::StrCat("no transaction support for default_storage_engine ",
-                     record.values(0)));
+                     result_set.ToString(0, 0)));
   }
 
   return absl::OkStatus();
 }
 
-Status MySqlMetadataSource::RunQuery(const std::string& query) {
+Status MySqlMetadataSource::RunQuery(const std::string& query,
+                                     const bool stream_rows) {
   DiscardResultSet();
 
   int query_status = mysql_query(db_, query.c_str());
   if (query_status) {
     int64 error_number = mysql_errno(db_);
-    // 2006: sever closes the connection due to inactive client;
-    // client reports server has gone away, we reconnect the server for the
+    // The server may close the connection, e.g., due to inactive client,
+    // after the checks of MaybeReconnect. We reconnect the server for the
     // client if the query is begin transaction.
-    if (error_number == 2006 && query == kBeginTransaction) {
+    if (IsConnectionLost(error_number) &&
+        (query == kBeginTransaction || query == kBeginReadOnlyTransaction)) {
       MLMD_RETURN_IF_ERROR(CloseImpl());
       MLMD_RETURN_IF_ERROR(ConnectImpl());
 
-      return RunQuery(query);
+      return RunQuery(query, stream_rows);
     }
-    // When running concurrent transactions for error codes:
-    // 1213: Deadlock detection on wait lock.
-    // 1205: Lock wait timeout.
-    // returns Aborted for client side to retry.
-    if (error_number == 1213 || error_number == 1205) {
-      return BuildErrorStatus(absl::StatusCode::kAborted, "mysql_query aborted",
-                              error_number, mysql_error(db_));
-    }
-
-    return BuildErrorStatus(absl::StatusCode::kInternal, "mysql_query failed",
-                            error_number, mysql_error(db_));
+    return BuildQueryErrorStatus("mysql_query", error_number,
+                                 mysql_error(db_));
   }
   // Updated database_name_ if the incoming query was "USE <database>" query and
   // run successfully.
   MaybeUpdateDatabaseNameFromQuery(query);
 
-  result_set_ = mysql_store_result(db_);
+  result_set_ =
+      stream_rows ? mysql_use_result(db_) : mysql_store_result(db_);
   if (!result_set_ && mysql_field_count(db_) != 0) {
     return BuildErrorStatus(
         absl::StatusCode::kInternal,
@@ -313,6 +625,223 @@ Status MySqlMetadataSource::RunQuery(const std::string& query) {
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::RunMultiStatementQuery(
+    const std::string& statements) {
+  DiscardResultSet();
+  if (mysql_set_server_option(db_, MYSQL_OPTION_MULTI_STATEMENTS_ON)) {
+    return BuildQueryErrorStatus("mysql_set_server_option", mysql_errno(db_),
+                                 mysql_error(db_));
+  }
+  const Status status = RunStatements(statements);
+  if (mysql_set_server_option(db_, MYSQL_OPTION_MULTI_STATEMENTS_OFF) &&
+      status.ok()) {
+    return BuildQueryErrorStatus("mysql_set_server_option", mysql_errno(db_),
+                                 mysql_error(db_));
+  }
+  return status;
+}
+
+Status MySqlMetadataSource::RunStatements(const std::string& statements) {
+  if (mysql_real_query(db_, statements.data(), statements.size())) {
+    return BuildQueryErrorStatus("mysql_query", mysql_errno(db_),
+                                 mysql_error(db_));
+  }
+  // The server stops at the first failed statement, whose error is returned
+  // when its result is read.
+  while (true) {
+    MYSQL_RES* result = mysql_store_result(db_);
+    if (result != nullptr) {
+      mysql_free_result(result);
+    }
+    const int next_result_status = mysql_next_result(db_);
+    if (next_result_status < 0) break;
+    if (next_result_status > 0) {
+      return BuildQueryErrorStatus("mysql_next_result", mysql_errno(db_),
+                                   mysql_error(db_));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::RunPreparedStatement(
+    MYSQL_STMT* statement, const absl::Span<const QueryParameter* const> values,
+    ResultSet* results, const RowBatchCallback* callback) {
+  DiscardResultSet();
+  // The int64 and double values are copied, as MYSQL_BIND takes non-const
+  // buffers, and the strings are sent from the parameters as they are.
+  std::vector<MYSQL_BIND> parameters(values.size());
+  std::vector<int64> int_parameters(values.size());
+  std::vector<double> double_parameters(values.size());
+  for (int i = 0; i < values.size(); ++i) {
+    const QueryParameter& value = *values[i];
+    MYSQL_BIND& parameter = parameters[i];
+    switch (value.type()) {
+      case QueryParameter::Type::kInt:
+        int_parameters[i] = value.int_value();
+        parameter.buffer_type = MYSQL_TYPE_LONGLONG;
+        parameter.buffer = &int_parameters[i];
+        break;
+      case QueryParameter::Type::kDouble:
+        double_parameters[i] = value.double_value();
+        parameter.buffer_type = MYSQL_TYPE_DOUBLE;
+        parameter.buffer = &double_parameters[i];
+        break;
+      case QueryParameter::Type::kString:
+        parameter.buffer_type = MYSQL_TYPE_STRING;
+        parameter.buffer = const_cast<char*>(value.text().data());
+        parameter.buffer_length = value.text().size();
+        break;
+      default:
+        parameter.buffer_type = MYSQL_TYPE_NULL;
+    }
+  }
+  if ((!parameters.empty() &&
+       mysql_stmt_bind_param(statement, parameters.data())) ||
+      mysql_stmt_execute(statement)) {
+    return BuildQueryErrorStatus("mysql_stmt_execute",
+                                 mysql_stmt_errno(statement),
+                                 mysql_stmt_error(statement));
+  }
+  // Statements which return no rows, e.g., inserts, have no result metadata.
+  MYSQL_RES* metadata = mysql_stmt_result_metadata(statement);
+  if (metadata == nullptr) {
+    return absl::OkStatus();
+  }
+  // Streamed rows are left on the server, and read from it as they are
+  // fetched.
+  if (callback == nullptr && mysql_stmt_store_result(statement)) {
+    mysql_free_result(metadata);
+    return BuildQueryErrorStatus("mysql_stmt_store_result",
+                                 mysql_stmt_errno(statement),
+                                 mysql_stmt_error(statement));
+  }
+
+  // Integers and floating points are fetched as binary values, and the other
+  // values as strings, whose max length is known once the rows are stored.
+  // The strings of streamed rows, or longer than their buffers, are fetched
+  // again into larger buffers.
+  const uint32 num_cols = mysql_num_fields(metadata);
+  std::vector<MYSQL_BIND> columns(num_cols);
+  std::vector<int64> int_values(num_cols);
+  std::vector<double> double_values(num_cols);
+  std::vector<std::string> string_values(num_cols);
+  std::vector<unsigned long> lengths(num_cols);  // NOLINT
+  std::vector<my_bool> is_nulls(num_cols);
+  std::vector<my_bool> is_truncated(num_cols);
+  std::vector<std::string> col_names;
+  for (uint32 col = 0; col < num_cols; ++col) {
+    MYSQL_FIELD* field = mysql_fetch_field_direct(metadata, col);
+    if (field == nullptr) {
+      mysql_free_result(metadata);
+      mysql_stmt_free_result(statement);
+      return absl::InternalError(absl::StrCat(
+          "Error in retrieving column description for index ", col));
+    }
+    // Named by the alias, as in AddMySqlColumns.
+    col_names.push_back(field->name);
+    MYSQL_BIND& column = columns[col];
+    if (IsIntegerColumn(field->type)) {
+      column.buffer_type = MYSQL_TYPE_LONGLONG;
+      column.buffer = &int_values[col];
+      column.is_unsigned = (field->flags & UNSIGNED_FLAG) ? 1 : 0;
+    } else if (IsFloatingPointColumn(field->type)) {
+      column.buffer_type = MYSQL_TYPE_DOUBLE;
+      column.buffer = &double_values[col];
+    } else {
+      string_values[col].resize(field->max_length);
+      column.buffer_type = MYSQL_TYPE_STRING;
+      column.buffer = &string_values[col][0];
+      column.buffer_length = field->max_length;
+    }
+    column.length = &lengths[col];
+    column.is_null = &is_nulls[col];
+    column.error = &is_truncated[col];
+  }
+  mysql_free_result(metadata);
+
+  // Streamed rows are passed to `callback` in batches of kRowBatchSize rows.
+  ResultSet batch;
+  ResultSet* rows = callback != nullptr ? &batch : results;
+  if (rows != nullptr) {
+    for (const std::string& col_name : col_names) {
+      rows->AddColumn(col_name);
+    }
+  }
+  Status status;
+  int fetch_status = mysql_stmt_bind_result(statement, columns.data());
+  while (fetch_status == 0 &&
+         ((fetch_status = mysql_stmt_fetch(statement)) == 0 ||
+          fetch_status == MYSQL_DATA_TRUNCATED)) {
+    if (fetch_status == MYSQL_DATA_TRUNCATED) {
+      for (uint32 col = 0; col < num_cols; ++col) {
+        MYSQL_BIND& column = columns[col];
+        if (!is_truncated[col] || column.buffer_type != MYSQL_TYPE_STRING) {
+          continue;
+        }
+        string_values[col].resize(lengths[col]);
+        column.buffer = &string_values[col][0];
+        column.buffer_length = lengths[col];
+        if (mysql_stmt_fetch_column(statement, &column, col, /*offset=*/0)) {
+          break;
+        }
+        is_truncated[col] = 0;
+      }
+      // A truncated number, or a failed fetch, is an error. Otherwise the
+      // larger buffers are bound for the following rows.
+      if (std::any_of(is_truncated.begin(), is_truncated.end(),
+                      [](my_bool truncated) { return truncated != 0; }) ||
+          mysql_stmt_bind_result(statement, columns.data())) {
+        break;
+      }
+      fetch_status = 0;
+    }
+    if (rows == nullptr) continue;
+    for (uint32 col = 0; col < num_cols; ++col) {
+      const MYSQL_BIND& column = columns[col];
+      if (is_nulls[col]) {
+        rows->AppendNull(col);
+      } else if (column.buffer_type == MYSQL_TYPE_LONGLONG) {
+        if (column.is_unsigned && int_values[col] < 0) {
+          // Unsigned values beyond the range of int64 are kept as strings.
+          rows->AppendString(
+              col, absl::StrCat(static_cast<unsigned long long>(  // NOLINT
+                       int_values[col])));
+        } else {
+          rows->AppendInt(col, int_values[col]);
+        }
+      } else if (column.buffer_type == MYSQL_TYPE_DOUBLE) {
+        rows->AppendDouble(col, double_values[col]);
+      } else {
+        rows->AppendString(
+            col, absl::string_view(string_values[col].data(), lengths[col]));
+      }
+    }
+    if (callback != nullptr && rows->num_rows() >= kRowBatchSize) {
+      status = (*callback)(*rows);
+      if (!status.ok()) break;
+      rows->ClearRows();
+    }
+  }
+  // Frees the stored rows, or reads the streamed rows left by a failed
+  // callback, as MySQL requires it before the next query.
+  mysql_stmt_free_result(statement);
+  if (!status.ok()) return status;
+  if (fetch_status != MYSQL_NO_DATA) {
+    return BuildQueryErrorStatus("mysql_stmt_fetch",
+                                 mysql_stmt_errno(statement),
+                                 mysql_stmt_error(statement));
+  }
+  if (callback == nullptr || rows->num_rows() == 0) return absl::OkStatus();
+  return (*callback)(*rows);
+}
+
+void MySqlMetadataSource::ClosePreparedStatements() {
+  for (const auto& query_and_statement : prepared_statements_) {
+    mysql_stmt_close(query_and_statement.second);
+  }
+  prepared_statements_.clear();
+}
+
 void MySqlMetadataSource::MaybeUpdateDatabaseNameFromQuery(
     const std::string& query) {
   std::vector<absl::string_view> tokens =
@@ -337,48 +866,45 @@ void MySqlMetadataSource::DiscardResultSet() {
   }
 }
 
-Status MySqlMetadataSource::ConvertMySqlRowSetToRecordSet(
-    RecordSet* record_set_out) {
-  RecordSet record_set;
-
-  if (result_set_ == nullptr) {
+Status MySqlMetadataSource::ConvertMySqlRowSetToResultSet(
+    ResultSet* result_set) {
+  if (result_set_ == nullptr || result_set == nullptr) {
     return absl::OkStatus();
   }
 
+  std::vector<MYSQL_FIELD*> fields;
+  MLMD_RETURN_IF_ERROR(AddMySqlColumns(result_set_, &fields, result_set));
   MYSQL_ROW row;
   while ((row = mysql_fetch_row(result_set_)) != nullptr) {
-    RecordSet::Record record;
-    std::vector<std::string> col_names;
-
-    uint32 num_cols = mysql_num_fields(result_set_);
-    for (uint32 col = 0; col < num_cols; ++col) {
-      MYSQL_FIELD* field = mysql_fetch_field_direct(result_set_, col);
-      if (field == nullptr) {
-        return absl::InternalError(absl::StrCat(
-            "Error in retrieving column description for index ", col));
-      }
-      const std::string col_name(field->org_name);
-      if (record_set.column_names().empty()) {
-        col_names.push_back(col_name);
-      }
-
-      if (row[col] == nullptr && !(field->flags & NOT_NULL_FLAG)) {
-        record.add_values(kMetadataSourceNull);
-      } else {
-        record.add_values(absl::StrCat(row[col]));
-      }
-    }
-    *record_set.mutable_records()->Add() = record;
+    AppendMySqlRow(result_set_, fields, row, result_set);
+  }
+  return absl::OkStatus();
+}
 
-    if (record_set.column_names().empty()) {
-      *record_set.mutable_column_names() = {col_names.begin(), col_names.end()};
+Status MySqlMetadataSource::StreamMySqlRowSet(
+    const RowBatchCallback callback) {
+  if (result_set_ == nullptr) {
+    return absl::OkStatus();
+  }
+  ResultSet rows;
+  std::vector<MYSQL_FIELD*> fields;
+  MLMD_RETURN_IF_ERROR(AddMySqlColumns(result_set_, &fields, &rows));
+  MYSQL_ROW row;
+  while ((row = mysql_fetch_row(result_set_)) != nullptr) {
+    AppendMySqlRow(result_set_, fields, row, &rows);
+    if (rows.num_rows() >= kRowBatchSize) {
+      MLMD_RETURN_IF_ERROR(callback(rows));
+      rows.ClearRows();
     }
   }
-
-  if (record_set_out != nullptr) {
-    *record_set_out = std::move(record_set);
+  // The rows are read from the server as they are fetched, so that reading
+  // them may fail, e.g., once the query deadline has passed.
+  if (mysql_errno(db_) != 0) {
+    return BuildQueryErrorStatus("mysql_fetch_row", mysql_errno(db_),
+                                 mysql_error(db_));
   }
-  return absl::OkStatus();
+  if (rows.num_rows() == 0) return absl::OkStatus();
+  return callback(rows);
 }
 
 std::string MySqlMetadataSource::EscapeString(absl::string_view value) const {
@@ -16,16 +16,25 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_MYSQL_METADATA_SOURCE_H_
 
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "mysql.h"
 
 namespace ml_metadata {
 
-// A MetadataSource based on a MYSQL backend.
+// A MetadataSource based on a MYSQL backend. The statements of template queries
+// are prepared once per connection on the server, and run with the literal
+// parameters bound to them. The connection is checked before each transaction
+// begins, and opened again if it is lost or too old (see MySQLDatabaseConfig).
 // This class is thread-unsafe.
 class MySqlMetadataSource : public MetadataSource {
  public:
@@ -53,30 +62,122 @@ class MySqlMetadataSource : public MetadataSource {
   // Any existing MYSQL_RES in `result_set_` is also cleaned up.
   absl::Status CloseImpl() final;
 
-  // Opens a transaction.
+  // Opens a transaction, once the connection is checked with MaybeReconnect.
   absl::Status BeginImpl() final;
 
+  // Opens a read-only transaction on a consistent snapshot, which takes no
+  // locks and keeps no undo log for its reads.
+  absl::Status BeginReadOnlyImpl() final;
 
-  // Executes a SQL statement and returns the rows if any.
+  // Executes a SQL statement and returns the rows if any. A SELECT statement
+  // is bounded by the server with the query deadline, if any, which is given
+  // as the max_execution_time of the session, see SetUpMaxExecutionTime.
+  // Returns DEADLINE_EXCEEDED error if the statement runs past the deadline.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
   absl::Status ExecuteQueryImpl(const std::string& query,
-                                RecordSet* results) final;
+                                ResultSet* results) final;
+
+  // Executes a template query with the prepared statement of the template,
+  // which is cached for the following queries. The values among the
+  // parameters are bound to the statement as they are, and the rows are
+  // fetched in the binary protocol, while the query deadline bounds them as
+  // the text queries. Queries with other parameters, e.g., id lists, are run
+  // with ExecuteQueryImpl.
+  absl::Status ExecuteTemplateQueryImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters, ResultSet* results) final;
+
+  // Executes a SQL statement as ExecuteQueryImpl, and reads its rows from the
+  // server as they are passed in batches to `callback`, instead of storing all
+  // of them in the client.
+  absl::Status ExecuteQueryStreamingImpl(const std::string& query,
+                                         RowBatchCallback callback) final;
+
+  // Streams a template query as ExecuteQueryStreamingImpl with the cached
+  // prepared statement of ExecuteTemplateQueryImpl, whose rows are fetched in
+  // the binary protocol. Queries that are not prepared are streamed as text
+  // queries.
+  absl::Status ExecuteTemplateQueryStreamingImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters,
+      RowBatchCallback callback) final;
+
+  // Executes the queries of a batch as the statements of a single text query,
+  // so that the batch takes one round trip to the server unless it is larger
+  // than a packet. The statements are writes, which MAX_EXECUTION_TIME does
+  // not bound, so the query deadline is only checked before each packet, and
+  // a packet started before the deadline runs to its end.
+  absl::Status ExecuteBatchImpl(absl::Span<const BatchedQuery> queries) final;
+
+  // Resets the max_execution_time of the session set for the query deadline.
+  // If the server cannot be reached, it is reset before the next statement.
+  void ClearQueryDeadlineImpl() final;
 
   // Commits the currently open transaction.
   absl::Status CommitImpl() final;
 
-  // Rollbacks the currently open transaction.
+  // Rollbacks the currently open transaction. If the connection is lost, the
+  // transaction is discarded by the server, and it returns OK.
   absl::Status RollbackImpl() final;
 
+  // Sets the session wait_timeout given by the config, or reads the one set by
+  // the server, into `wait_timeout_`.
+  absl::Status SetUpWaitTimeout();
+
+  // Connects again if the connection is lost, has been open for longer than
+  // max_connection_age_sec, or has been idle for longer than `wait_timeout_`.
+  // Otherwise pings the connection idle for ping_after_idle_sec, and connects
+  // again if the ping fails.
+  absl::Status MaybeReconnect();
+
+  // Sets the max_execution_time of the session to the time left before the
+  // query deadline, or resets it if there is no deadline, so that the server
+  // stops the following SELECT statement, prepared or not, at the deadline.
+  // The session is only updated if the value changes.
+  absl::Status SetUpMaxExecutionTime();
+
   // Returns an error if the default storage engine doesn't support transaction
   // or OK otherwise.
   absl::Status CheckTransactionSupport();
 
-  // Runs the given query and stores the MYSQL_RES in result_set_.
+  // Runs the given query and stores the MYSQL_RES in result_set_. If
+  // `stream_rows` is true, the rows are left on the server, and read from it
+  // as they are fetched.
   // Any existing MYSQL_RES in `result_set_` is cleaned up prior to issuing
   // the given query.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
-  absl::Status RunQuery(const std::string& query);
+  absl::Status RunQuery(const std::string& query, bool stream_rows = false);
+
+  // Runs the `statements` separated by semicolons, and discards their results.
+  // Multiple statements are allowed on the connection for this query only, so
+  // that the other queries cannot run statements injected into them.
+  // Returns the error of the first failed statement, after which the following
+  // ones are not run.
+  absl::Status RunMultiStatementQuery(const std::string& statements);
+
+  // Runs the `statements` of RunMultiStatementQuery, once multiple statements
+  // are allowed.
+  absl::Status RunStatements(const std::string& statements);
+
+  // Returns the cached prepared statement of `query_template` with the
+  // `parameters`, which is prepared and cached if it is not yet, and sets the
+  // `bound_values` to bind to it. Returns nullptr if the query cannot be
+  // prepared.
+  MYSQL_STMT* FindPreparedStatement(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters,
+      std::vector<const QueryParameter*>* bound_values);
+
+  // Runs the prepared `statement` with the `values` bound to it, and converts
+  // the rows it returns to `results`. If `callback` is given, the rows are
+  // instead read from the server as they are passed in batches to it.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status RunPreparedStatement(
+      MYSQL_STMT* statement, absl::Span<const QueryParameter* const> values,
+      ResultSet* results, const RowBatchCallback* callback = nullptr);
+
+  // Closes the cached prepared statements.
+  void ClosePreparedStatements();
 
   // Checks whether incoming query is a `USE <database>` query. And if so,
   // update database_name_ field.
@@ -85,8 +186,12 @@ class MySqlMetadataSource : public MetadataSource {
   // Discards any existing MYSQL_RES in `result_set_`.
   void DiscardResultSet();
 
-  // Converts the MYSQL_RES in `result_set_` to `record_set_out`.
-  absl::Status ConvertMySqlRowSetToRecordSet(RecordSet* record_set_out);
+  // Converts the MYSQL_RES in `result_set_` to `result_set`.
+  absl::Status ConvertMySqlRowSetToResultSet(ResultSet* result_set);
+
+  // Fetches the rows of the MYSQL_RES in `result_set_`, and passes them in
+  // batches to `callback`.
+  absl::Status StreamMySqlRowSet(RowBatchCallback callback);
 
   // The handler for the connection to the MYSQL backend.
   // Initialized in ConnectImpl().
@@ -95,9 +200,28 @@ class MySqlMetadataSource : public MetadataSource {
   // The ResultSet from the previously executed query in RunQuery.
   MYSQL_RES* result_set_ = nullptr;
 
+  // The prepared statements of the template queries by their keys.
+  absl::flat_hash_map<PreparedStatementKey, MYSQL_STMT*> prepared_statements_;
+
   // Config to connect to the MYSQL backend.
   const MySQLDatabaseConfig config_;
 
+  // The time when the connection is opened.
+  absl::Time connect_time_;
+
+  // The time when the last transaction has ended, or the connection is opened.
+  absl::Time last_use_time_;
+
+  // The idle time after which the server closes the connection.
+  absl::Duration wait_timeout_ = absl::InfiniteDuration();
+
+  // True if the connection is lost, or failed to be opened again.
+  bool is_connection_lost_ = false;
+
+  // The max_execution_time of the session in milliseconds, where 0 does not
+  // bound the statements.
+  int64 max_execution_time_ms_ = 0;
+
   // database_name_ stores the lasted database that the MetadataSoure has been
   // connected to through USE query. database_name_ may contains `;` at the end
   // which is not included in mysql db, and the state is used for concatenating
@@ -15,6 +15,7 @@ limitations under the License.
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 
 #include <memory>
+#include <vector>
 
 #include "gflags/gflags.h"
 #include <glog/logging.h>
@@ -22,8 +23,13 @@ limitations under the License.
 #include <gtest/gtest.h>
 
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/test_mysql_metadata_source_initializer.h"
 
 DEFINE_bool(enable_sockets, true, "Whether to run socket tests.");
@@ -101,7 +107,206 @@ TEST(MySqlMetadataSourceExtendedTest, TestConnectBySocket) {
   metadata_source_initializer->Cleanup();
 }
 
+// The connection closed by the server is opened again by the next transaction.
+TEST(MySqlMetadataSourceExtendedTest, TestReconnectsLostConnection) {
+  auto metadata_source_initializer = GetTestMySqlMetadataSourceInitializer();
+  auto metadata_source = metadata_source_initializer->Init(
+      TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  // Killing its own connection fails the query.
+  EXPECT_FALSE(
+      metadata_source->ExecuteQuery("KILL CONNECTION_ID()", nullptr).ok());
+  // The transaction is discarded with the lost connection.
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Rollback());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("SELECT 1", &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(1, record_set.records_size());
+  metadata_source_initializer->Cleanup();
+}
+
+// The columns are named by their aliases, by both the text protocol and the
+// prepared statements, so that the columns of joined tables can be told apart.
+TEST(MySqlMetadataSourceExtendedTest, TestNamesColumnsByAlias) {
+  auto metadata_source_initializer = GetTestMySqlMetadataSourceInitializer();
+  auto metadata_source = metadata_source_initializer->Init(
+      TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "CREATE TABLE t1 (c1 INT, c2 VARCHAR(255));", nullptr));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1')",
+                                          nullptr));
 
+  ResultSet text_results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "SELECT `c1`, T.`c2` AS `name` FROM `t1` AS T", &text_results));
+  const QueryTemplate select(
+      "SELECT `c1`, T.`c2` AS `name` FROM `t1` AS T WHERE `c1` = $0");
+  ResultSet prepared_results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                select, {QueryParameter::Int(1)}, &prepared_results));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  for (const ResultSet* results : {&text_results, &prepared_results}) {
+    EXPECT_EQ(results->FindColumn("c1"), 0);
+    EXPECT_EQ(results->FindColumn("name"), 1);
+    EXPECT_EQ(results->FindColumn("c2"), -1);
+    ASSERT_EQ(results->num_rows(), 1);
+    EXPECT_EQ(results->ToString(0, 1), "v1");
+  }
+  metadata_source_initializer->Cleanup();
+}
+
+// Multiple statements are only allowed in the batches, which send them in a
+// single query.
+TEST(MySqlMetadataSourceExtendedTest, TestRunsMultipleStatementsInBatchesOnly) {
+  auto metadata_source_initializer = GetTestMySqlMetadataSourceInitializer();
+  auto metadata_source = metadata_source_initializer->Init(
+      TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "CREATE TABLE t1 (c1 INT, c2 VARCHAR(255));", nullptr));
+  EXPECT_FALSE(metadata_source
+                   ->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1'); "
+                                  "INSERT INTO t1 VALUES (2, 'v2');",
+                                  nullptr)
+                   .ok());
+
+  const QueryTemplate insert("INSERT INTO t1 VALUES ($0, $1);");
+  const std::vector<MetadataSource::BatchedQuery> queries = {
+      {&insert, {QueryParameter::Int(3), QueryParameter::String("v3")}},
+      {&insert, {QueryParameter::Int(4), QueryParameter::String("v4")}}};
+  ASSERT_EQ(absl::OkStatus(), metadata_source->ExecuteBatch(queries));
+  ResultSet results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("SELECT c1 FROM t1 ORDER BY c1",
+                                          &results));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_EQ(results.num_rows(), 2);
+  EXPECT_EQ(results.GetInt(0, 0), 3);
+  EXPECT_EQ(results.GetInt(1, 0), 4);
+  metadata_source_initializer->Cleanup();
+}
+
+// Streamed template queries fetch their rows with the prepared statements,
+// whose string buffers grow with the fetched strings.
+TEST(MySqlMetadataSourceExtendedTest,
+     TestStreamsTemplateQueriesWithPreparedStatements) {
+  auto metadata_source_initializer = GetTestMySqlMetadataSourceInitializer();
+  auto metadata_source = metadata_source_initializer->Init(
+      TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "CREATE TABLE t1 (c1 INT, c2 VARCHAR(255));", nullptr));
+  const QueryTemplate insert("INSERT INTO t1 VALUES ($0, $1);");
+  std::vector<MetadataSource::BatchedQuery> queries;
+  for (int i = 0; i < 1500; ++i) {
+    queries.push_back({&insert,
+                       {QueryParameter::Int(i),
+                        QueryParameter::String(std::string(i % 200, 'v'))}});
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source->ExecuteBatch(queries));
+
+  const QueryTemplate select(
+      "SELECT `c1`, `c2` FROM `t1` WHERE `c1` >= $0 ORDER BY `c1`;");
+  std::vector<int> batch_sizes;
+  int num_rows = 0;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQueryStreaming(
+                select, {QueryParameter::Int(0)}, [&](const ResultSet& rows) {
+                  batch_sizes.push_back(rows.num_rows());
+                  for (int row = 0; row < rows.num_rows(); ++row) {
+                    EXPECT_EQ(rows.GetInt(row, 0), num_rows);
+                    EXPECT_EQ(rows.ToString(row, 1),
+                              std::string(num_rows % 200, 'v'));
+                    ++num_rows;
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(batch_sizes, ::testing::ElementsAre(1024, 476));
+
+  // The rows left by a failed callback are discarded before the next query.
+  EXPECT_TRUE(absl::IsCancelled(metadata_source->ExecuteTemplateQueryStreaming(
+      select, {QueryParameter::Int(0)}, [](const ResultSet& rows) {
+        return absl::CancelledError("stream closed");
+      })));
+  ResultSet results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                select, {QueryParameter::Int(1499)}, &results));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_EQ(results.num_rows(), 1);
+  EXPECT_EQ(results.GetInt(0, 0), 1499);
+  metadata_source_initializer->Cleanup();
+}
+
+// Returns the number of prepared statements run on the session of
+// `metadata_source`.
+int64 GetNumPreparedStatementsRun(MetadataSource* metadata_source) {
+  ResultSet results;
+  CHECK_EQ(absl::OkStatus(),
+           metadata_source->ExecuteQuery(
+               "SHOW SESSION STATUS LIKE 'Com_stmt_execute'", &results));
+  CHECK_EQ(results.num_rows(), 1);
+  return results.GetInt(0, 1);
+}
+
+// Template queries with a deadline keep their prepared statements, as the
+// deadline is given as the max_execution_time of the session.
+TEST(MySqlMetadataSourceExtendedTest,
+     TestRunsTemplateQueriesWithDeadlineWithPreparedStatements) {
+  auto metadata_source_initializer = GetTestMySqlMetadataSourceInitializer();
+  auto metadata_source = metadata_source_initializer->Init(
+      TestMySqlMetadataSourceInitializer::ConnectionType::kTcp);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "CREATE TABLE t1 (c1 INT, c2 VARCHAR(255));", nullptr));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("INSERT INTO t1 VALUES (1, 'v1')",
+                                          nullptr));
+
+  metadata_source->SetQueryDeadline(absl::Now() + absl::Minutes(1),
+                                    /*is_cancelled=*/nullptr);
+  const int64 num_prepared_statements_run =
+      GetNumPreparedStatementsRun(metadata_source);
+  const QueryTemplate select("SELECT `c2` FROM `t1` WHERE `c1` = $0;");
+  ResultSet results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                select, {QueryParameter::Int(1)}, &results));
+  ASSERT_EQ(results.num_rows(), 1);
+  EXPECT_EQ(results.ToString(0, 0), "v1");
+  EXPECT_EQ(GetNumPreparedStatementsRun(metadata_source),
+            num_prepared_statements_run + 1);
+  ResultSet max_execution_time;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "SELECT @@SESSION.max_execution_time", &max_execution_time));
+  EXPECT_GT(max_execution_time.GetInt(0, 0), 0);
+
+  // The session is no longer bounded once the deadline is cleared.
+  metadata_source->ClearQueryDeadline();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery(
+                "SELECT @@SESSION.max_execution_time", &max_execution_time));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  EXPECT_EQ(max_execution_time.GetInt(0, 0), 0);
+  metadata_source_initializer->Cleanup();
+}
 
 // Test EscapeString utility method.
 // Same here, we adopt a fixtureless test here because it is using TCP
@@ -19,15 +19,17 @@ limitations under the License.
 
 #include "google/protobuf/struct.pb.h"
 #include "google/protobuf/descriptor.h"
-#include "google/protobuf/text_format.h"
 #include "google/protobuf/util/json_util.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -46,15 +48,27 @@ namespace ml_metadata {
 
 namespace {
 
-// Prepares a template query used for earlier query schema version.
-absl::Status GetTemplateQueryOrDie(
-    const std::string& query,
-    MetadataSourceQueryConfig::TemplateQuery& output) {
-  if (!google::protobuf::TextFormat::ParseFromString(query, &output)) {
-    return absl::InternalError(absl::StrCat(
-        "query: `", query, "`, cannot be parsed to a TemplateQuery."));
+// The most rows of a multi-row insert statement.
+constexpr size_t kMaxRowsPerInsert = 500;
+
+// The size of the rows of a multi-row insert statement after which no more
+// rows are added, which keeps it well within the packet size of MySQL.
+constexpr size_t kMaxBytesPerInsert = 1 << 20;
+
+// The number of values in a row of the multi-row property inserts.
+constexpr size_t kPropertyRowSize = 6;
+
+// Returns `query` without its trailing LOCK IN SHARE MODE clause, or nullopt
+// if it has none.
+absl::optional<std::string> StripSharedLockClause(absl::string_view query) {
+  constexpr absl::string_view kLockInShareMode = "LOCK IN SHARE MODE";
+  absl::string_view statement = absl::StripTrailingAsciiWhitespace(
+      absl::StripSuffix(absl::StripTrailingAsciiWhitespace(query), ";"));
+  if (!absl::EndsWithIgnoreCase(statement, kLockInShareMode)) {
+    return absl::nullopt;
   }
-  return absl::OkStatus();
+  statement.remove_suffix(kLockInShareMode.size());
+  return absl::StrCat(statement, ";");
 }
 
 }  // namespace
@@ -64,7 +78,53 @@ QueryConfigExecutor::QueryConfigExecutor(
     int64 query_version)
     : QueryExecutor(query_version),
       query_config_(query_config),
-      metadata_source_(source) {}
+      metadata_source_(source) {
+  CompileQueryTemplates();
+}
+
+void QueryConfigExecutor::CompileQueryTemplates() {
+  // The templates are keyed by their address in `query_config_`, which is not
+  // changed after the construction.
+  const google::protobuf::Descriptor* descriptor =
+      query_config_.GetDescriptor();
+  const google::protobuf::Reflection* reflection =
+      query_config_.GetReflection();
+  const auto add_template = [&](const google::protobuf::Message& message) {
+    const auto& template_query =
+        static_cast<const MetadataSourceQueryConfig::TemplateQuery&>(message);
+    query_templates_.try_emplace(&template_query, template_query.query());
+    if (absl::optional<std::string> query =
+            StripSharedLockClause(template_query.query())) {
+      read_only_query_templates_.try_emplace(&template_query, *query);
+    }
+  };
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (field->message_type() !=
+        MetadataSourceQueryConfig::TemplateQuery::descriptor()) {
+      continue;
+    }
+    if (field->is_repeated()) {
+      for (int j = 0; j < reflection->FieldSize(query_config_, field); ++j) {
+        add_template(reflection->GetRepeatedMessage(query_config_, field, j));
+      }
+    } else if (reflection->HasField(query_config_, field)) {
+      add_template(reflection->GetMessage(query_config_, field));
+    }
+  }
+}
+
+const QueryTemplate* QueryConfigExecutor::FindQueryTemplate(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query) const {
+  if (metadata_source_->transaction_read_only()) {
+    auto it = read_only_query_templates_.find(&template_query);
+    if (it != read_only_query_templates_.end()) {
+      return &it->second;
+    }
+  }
+  auto it = query_templates_.find(&template_query);
+  return it != query_templates_.end() ? &it->second : nullptr;
+}
 
 absl::Status QueryConfigExecutor::CheckParentTypeTable() {
   return ExecuteQuery(query_config_.check_parent_type_table());
@@ -83,7 +143,7 @@ absl::Status QueryConfigExecutor::DeleteParentType(int64 type_id,
 }
 
 absl::Status QueryConfigExecutor::SelectParentTypesByTypeID(
-    const absl::Span<const int64> type_ids, RecordSet* record_set) {
+    const absl::Span<const int64> type_ids, ResultSet* record_set) {
   return ExecuteQuery(query_config_.select_parent_type_by_type_id(),
                       {Bind(type_ids)}, record_set);
 }
@@ -96,17 +156,166 @@ absl::Status QueryConfigExecutor::InsertEventPath(
   // $2 is the is_index_step indicates the step value case
   // $3 is the value of the step
   if (step.has_index()) {
-    return ExecuteQuery(
+    return ExecuteWrite(
         query_config_.insert_event_path(),
-        {Bind(event_id), "step_index", Bind(true), Bind(step.index())});
+        {Bind(event_id), QueryParameter::Identifier("step_index"), Bind(true),
+         Bind(step.index())});
   } else if (step.has_key()) {
-    return ExecuteQuery(
+    return ExecuteWrite(
         query_config_.insert_event_path(),
-        {Bind(event_id), "step_key", Bind(false), Bind(step.key())});
+        {Bind(event_id), QueryParameter::Identifier("step_key"), Bind(false),
+         Bind(step.key())});
   }
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::InsertEventPaths(int64 event_id,
+                                                   const Event::Path& path) {
+  constexpr size_t kRowSize = 4;
+  std::vector<QueryParameter> values;
+  values.reserve(path.steps_size() * kRowSize);
+  for (const Event::Path::Step& step : path.steps()) {
+    if (step.has_index()) {
+      values.push_back(Bind(event_id));
+      values.push_back(Bind(true));
+      values.push_back(Bind(step.index()));
+      values.push_back(QueryParameter());
+    } else if (step.has_key()) {
+      values.push_back(Bind(event_id));
+      values.push_back(Bind(false));
+      values.push_back(QueryParameter());
+      values.push_back(Bind(step.key()));
+    }
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_event_paths(), values,
+                               kRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertArtifacts(
+    const absl::Span<const Artifact> artifacts, const absl::Time create_time,
+    std::vector<int64>* artifact_ids) {
+  constexpr size_t kRowSize = 6;
+  const QueryParameter time = Bind(absl::ToUnixMillis(create_time));
+  std::vector<QueryParameter> values;
+  values.reserve(artifacts.size() * kRowSize);
+  for (const Artifact& artifact : artifacts) {
+    values.push_back(Bind(artifact.type_id()));
+    values.push_back(Bind(artifact.uri()));
+    values.push_back(artifact.has_state() ? Bind(artifact.state())
+                                          : QueryParameter());
+    values.push_back(artifact.has_name() ? Bind(artifact.name())
+                                         : QueryParameter());
+    values.push_back(time);
+    values.push_back(time);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_artifacts(), values,
+                               kRowSize, artifact_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertArtifactProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_artifact_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::UpsertArtifactProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.upsert_artifact_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertExecutions(
+    const absl::Span<const Execution> executions, const absl::Time create_time,
+    std::vector<int64>* execution_ids) {
+  constexpr size_t kRowSize = 5;
+  const QueryParameter time = Bind(absl::ToUnixMillis(create_time));
+  std::vector<QueryParameter> values;
+  values.reserve(executions.size() * kRowSize);
+  for (const Execution& execution : executions) {
+    values.push_back(Bind(execution.type_id()));
+    values.push_back(execution.has_last_known_state()
+                         ? Bind(execution.last_known_state())
+                         : QueryParameter());
+    values.push_back(execution.has_name() ? Bind(execution.name())
+                                          : QueryParameter());
+    values.push_back(time);
+    values.push_back(time);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_executions(), values,
+                               kRowSize, execution_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertExecutionProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_execution_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::UpsertExecutionProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.upsert_execution_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertContexts(
+    const absl::Span<const Context> contexts, const absl::Time create_time,
+    std::vector<int64>* context_ids) {
+  constexpr size_t kRowSize = 4;
+  const QueryParameter time = Bind(absl::ToUnixMillis(create_time));
+  std::vector<QueryParameter> values;
+  values.reserve(contexts.size() * kRowSize);
+  for (const Context& context : contexts) {
+    values.push_back(Bind(context.type_id()));
+    values.push_back(Bind(context.name()));
+    values.push_back(time);
+    values.push_back(time);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_contexts(), values,
+                               kRowSize, context_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertContextProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_context_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::UpsertContextProperties(
+    const absl::Span<const NodeProperty> properties) {
+  std::vector<QueryParameter> values;
+  values.reserve(properties.size() * kPropertyRowSize);
+  for (const NodeProperty& property : properties) {
+    BindPropertyRow(property, &values);
+  }
+  return ExecuteMultiRowInsert(query_config_.upsert_context_properties(),
+                               values, kPropertyRowSize, /*ids=*/nullptr);
+}
+
 absl::Status QueryConfigExecutor::CheckParentContextTable() {
   return ExecuteQuery(query_config_.check_parent_context_table());
 }
@@ -118,37 +327,37 @@ absl::Status QueryConfigExecutor::InsertParentContext(int64 parent_id,
 }
 
 absl::Status QueryConfigExecutor::SelectParentContextsByContextID(
-    int64 context_id, RecordSet* record_set) {
+    int64 context_id, ResultSet* record_set) {
   return ExecuteQuery(query_config_.select_parent_context_by_context_id(),
                       {Bind(context_id)}, record_set);
 }
 
 absl::Status QueryConfigExecutor::SelectChildContextsByContextID(
-    int64 context_id, RecordSet* record_set) {
+    int64 context_id, ResultSet* record_set) {
   return ExecuteQuery(
       query_config_.select_parent_context_by_parent_context_id(),
       {Bind(context_id)}, record_set);
 }
 
 absl::Status QueryConfigExecutor::GetSchemaVersion(int64* db_version) {
-  RecordSet record_set;
+  ResultSet record_set;
   absl::Status maybe_schema_version_status =
       ExecuteQuery(query_config_.check_mlmd_env_table(), {}, &record_set);
   if (maybe_schema_version_status.ok()) {
-    if (record_set.records_size() == 0) {
+    if (record_set.num_rows() == 0) {
       return absl::AbortedError(
           "In the given db, MLMDEnv table exists but no schema_version can be "
           "found. This may be due to concurrent connection to the empty "
           "database. Please retry connection.");
 
-    } else if (record_set.records_size() > 1) {
+    } else if (record_set.num_rows() > 1) {
       return absl::DataLossError(absl::StrCat(
           "In the given db, MLMDEnv table exists but schema_version cannot be "
           "resolved due to there being more than one rows with the schema "
           "version. Expecting a single row: ",
-          record_set.DebugString()));
+          record_set.ToRecordSet().DebugString()));
     }
-    CHECK(absl::SimpleAtoi(record_set.records(0).values(0), db_version));
+    *db_version = record_set.GetInt(0, 0);
     return absl::OkStatus();
   }
   // if MLMDEnv does not exist, it may be the v0.13.2 release or an empty db.
@@ -220,22 +429,79 @@ absl::Status QueryConfigExecutor::UpgradeMetadataSourceIfOutOfDate(
 }
 
 absl::Status QueryConfigExecutor::SelectLastInsertID(int64* last_insert_id) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       ExecuteQuery(query_config_.select_last_insert_id(), {}, &record_set));
-  if (record_set.records_size() == 0) {
+  if (record_set.num_rows() == 0) {
     return absl::InternalError("Could not find last insert ID: no record");
   }
-  const RecordSet::Record& record = record_set.records(0);
-  if (record.values_size() == 0) {
+  if (record_set.num_columns() == 0 || record_set.IsNull(0, 0)) {
     return absl::InternalError("Could not find last insert ID: missing value");
   }
-  if (!absl::SimpleAtoi(record.values(0), last_insert_id)) {
+  if (record_set.type(0, 0) != ResultSet::Type::kString) {
+    *last_insert_id = record_set.GetInt(0, 0);
+  } else if (!absl::SimpleAtoi(record_set.GetString(0, 0), last_insert_id)) {
     return absl::InternalError("Could not parse last insert ID as string");
   }
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::SelectFirstInsertID(int64* first_insert_id) {
+  ResultSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_first_insert_id(), {}, &record_set));
+  if (record_set.num_rows() == 0 || record_set.num_columns() == 0 ||
+      record_set.IsNull(0, 0)) {
+    return absl::InternalError("Could not find first insert ID");
+  }
+  if (record_set.type(0, 0) != ResultSet::Type::kString) {
+    *first_insert_id = record_set.GetInt(0, 0);
+  } else if (!absl::SimpleAtoi(record_set.GetString(0, 0), first_insert_id)) {
+    return absl::InternalError("Could not parse first insert ID as string");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectConsecutiveInsertIDs(
+    bool* consecutive_insert_ids) {
+  if (!consecutive_insert_ids_.has_value()) {
+    // The query configs without the query, e.g., custom ones, are assumed not
+    // to give consecutive ids.
+    if (!query_config_.has_select_consecutive_insert_ids()) {
+      consecutive_insert_ids_ = false;
+    } else {
+      ResultSet record_set;
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.select_consecutive_insert_ids(), {}, &record_set));
+      if (record_set.num_rows() == 0 || record_set.num_columns() == 0 ||
+          record_set.IsNull(0, 0)) {
+        return absl::InternalError(
+            "Could not find whether the insert ids are consecutive");
+      }
+      consecutive_insert_ids_ = record_set.GetBool(0, 0);
+    }
+  }
+  *consecutive_insert_ids = *consecutive_insert_ids_;
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectNumChangedRows(int64* num_rows) {
+  ResultSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_num_changed_rows(), {}, &record_set));
+  if (record_set.num_rows() == 0 || record_set.num_columns() == 0 ||
+      record_set.IsNull(0, 0)) {
+    return absl::InternalError("Could not find the number of changed rows");
+  }
+  if (record_set.type(0, 0) != ResultSet::Type::kString) {
+    *num_rows = record_set.GetInt(0, 0);
+  } else if (!absl::SimpleAtoi(record_set.GetString(0, 0), num_rows)) {
+    return absl::InternalError(
+        "Could not parse the number of changed rows as string");
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ml_metadata::QueryConfigExecutor::CheckTablesIn_V0_13_2() {
   return ExecuteQuery(query_config_.check_tables_in_v0_13_2());
 }
@@ -291,55 +557,57 @@ absl::Status QueryConfigExecutor::DowngradeMetadataSource(
   return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(const char* value) {
-  return absl::StrCat("'", metadata_source_->EscapeString(value), "'");
+QueryParameter QueryConfigExecutor::Bind(const char* value) {
+  return QueryParameter::String(value);
 }
 
-std::string QueryConfigExecutor::Bind(absl::string_view value) {
-  return absl::StrCat("'", metadata_source_->EscapeString(value), "'");
+QueryParameter QueryConfigExecutor::Bind(absl::string_view value) {
+  return QueryParameter::String(std::string(value));
 }
 
-std::string QueryConfigExecutor::Bind(int value) {
-  return std::to_string(value);
+QueryParameter QueryConfigExecutor::Bind(int value) {
+  return QueryParameter::Int(value);
 }
 
-std::string QueryConfigExecutor::Bind(int64 value) {
-  return std::to_string(value);
+QueryParameter QueryConfigExecutor::Bind(int64 value) {
+  return QueryParameter::Int(value);
 }
 
-std::string QueryConfigExecutor::Bind(double value) {
-  return std::to_string(value);
+QueryParameter QueryConfigExecutor::Bind(double value) {
+  return QueryParameter::Double(value);
 }
 
-std::string QueryConfigExecutor::Bind(bool value) { return value ? "1" : "0"; }
+QueryParameter QueryConfigExecutor::Bind(bool value) {
+  return QueryParameter::Int(value ? 1 : 0);
+}
 
 // Utility method to bind an Event::Type enum value to a SQL clause.
 // Event::Type is an enum (integer), EscapeString is not applicable.
-std::string QueryConfigExecutor::Bind(const Event::Type value) {
-  return std::to_string(value);
+QueryParameter QueryConfigExecutor::Bind(const Event::Type value) {
+  return QueryParameter::Int(value);
 }
 
-std::string QueryConfigExecutor::Bind(PropertyType value) {
-  return std::to_string((int)value);
+QueryParameter QueryConfigExecutor::Bind(PropertyType value) {
+  return QueryParameter::Int((int)value);
 }
 
-std::string QueryConfigExecutor::Bind(TypeKind value) {
-  return std::to_string((int)value);
+QueryParameter QueryConfigExecutor::Bind(TypeKind value) {
+  return QueryParameter::Int((int)value);
 }
 
-std::string QueryConfigExecutor::Bind(Artifact::State value) {
-  return std::to_string((int)value);
+QueryParameter QueryConfigExecutor::Bind(Artifact::State value) {
+  return QueryParameter::Int((int)value);
 }
 
-std::string QueryConfigExecutor::Bind(Execution::State value) {
-  return std::to_string((int)value);
+QueryParameter QueryConfigExecutor::Bind(Execution::State value) {
+  return QueryParameter::Int((int)value);
 }
 
-std::string QueryConfigExecutor::Bind(const absl::Span<const int64> value) {
-  return absl::StrJoin(value, ", ");
+QueryParameter QueryConfigExecutor::Bind(const absl::Span<const int64> value) {
+  return QueryParameter::Sql(absl::StrJoin(value, ", "));
 }
 
-std::string QueryConfigExecutor::BindValue(const Value& value) {
+QueryParameter QueryConfigExecutor::BindValue(const Value& value) {
   switch (value.value_case()) {
     case PropertyType::INT:
       return Bind(value.int_value());
@@ -357,19 +625,19 @@ std::string QueryConfigExecutor::BindValue(const Value& value) {
   }
 }
 
-std::string QueryConfigExecutor::BindDataType(const Value& value) {
+QueryParameter QueryConfigExecutor::BindDataType(const Value& value) {
   switch (value.value_case()) {
     case PropertyType::INT: {
-      return "int_value";
+      return QueryParameter::Identifier("int_value");
       break;
     }
     case PropertyType::DOUBLE: {
-      return "double_value";
+      return QueryParameter::Identifier("double_value");
       break;
     }
     case PropertyType::STRING:
     case PropertyType::STRUCT: {
-      return "string_value";
+      return QueryParameter::Identifier("string_value");
       break;
     }
     default: {
@@ -378,37 +646,173 @@ std::string QueryConfigExecutor::BindDataType(const Value& value) {
   }
 }
 
-std::string QueryConfigExecutor::Bind(const ArtifactStructType* message) {
+void QueryConfigExecutor::AppendRow(
+    const absl::Span<const QueryParameter> values, std::string* rows) {
+  const auto escape_string = [this](absl::string_view value) {
+    return metadata_source_->EscapeString(value);
+  };
+  rows->push_back('(');
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) rows->append(", ");
+    values[i].AppendTo(escape_string, rows);
+  }
+  rows->push_back(')');
+}
+
+void QueryConfigExecutor::BindPropertyRow(const NodeProperty& property,
+                                          std::vector<QueryParameter>* values) {
+  const Value& value = *property.value;
+  const QueryParameter data_type = BindDataType(value);
+  values->push_back(Bind(property.node_id));
+  values->push_back(Bind(property.name));
+  values->push_back(Bind(property.is_custom_property));
+  for (const char* column : {"int_value", "double_value", "string_value"}) {
+    values->push_back(data_type.text() == column ? BindValue(value)
+                                                 : QueryParameter());
+  }
+}
+
+QueryParameter QueryConfigExecutor::Bind(const ArtifactStructType* message) {
   if (message) {
     std::string json_output;
     CHECK(::google::protobuf::util::MessageToJsonString(*message, &json_output).ok())
         << "Could not write proto to JSON: " << message->DebugString();
-    return Bind(json_output);
+    return QueryParameter::String(std::move(json_output));
   } else {
-    return "null";
+    return QueryParameter();
   }
 }
 
 #if (!defined(__APPLE__) && !defined(_WIN32))
-string QueryConfigExecutor::Bind(
+QueryParameter QueryConfigExecutor::Bind(
     const google::protobuf::int64 value) {
-  return std::to_string(value);
+  return QueryParameter::Int(value);
 }
 #endif
 
 absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query) {
-  RecordSet record_set;
+  ResultSet record_set;
   return metadata_source_->ExecuteQuery(query, &record_set);
 }
 
 absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query,
-                                               RecordSet* record_set) {
+                                               ResultSet* record_set) {
   return metadata_source_->ExecuteQuery(query, record_set);
 }
 
 absl::Status QueryConfigExecutor::ExecuteQuery(
     const MetadataSourceQueryConfig::TemplateQuery& template_query,
-    const absl::Span<const std::string> parameters, RecordSet* record_set) {
+    const absl::Span<const QueryParameter> parameters, ResultSet* record_set) {
+  if (parameters.size() > 10) {
+    return absl::InvalidArgumentError(
+        "Template query has too many parameters (at most 10 is supported).");
+  }
+  if (template_query.parameter_num() != parameters.size()) {
+    LOG(FATAL) << "Template query parameter_num does not match with given "
+               << "parameters size (" << parameters.size()
+               << "): " << template_query.DebugString();
+  }
+  if (const QueryTemplate* query_template = FindQueryTemplate(template_query)) {
+    return metadata_source_->ExecuteTemplateQuery(*query_template, parameters,
+                                                  record_set);
+  }
+  return metadata_source_->ExecuteTemplateQuery(template_query.query(),
+                                                parameters, record_set);
+}
+
+absl::Status QueryConfigExecutor::ExecuteWrite(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const QueryParameter> parameters) {
+  if (write_batch_ == nullptr) {
+    return ExecuteQuery(template_query, parameters);
+  }
+  if (template_query.parameter_num() != parameters.size()) {
+    LOG(FATAL) << "Template query parameter_num does not match with given "
+               << "parameters size (" << parameters.size()
+               << "): " << template_query.DebugString();
+  }
+  const QueryTemplate* query_template = FindQueryTemplate(template_query);
+  if (query_template == nullptr) {
+    query_template =
+        &write_batch_->compiled_templates.emplace_back(template_query.query(),
+                                                       /*is_reused=*/false);
+  }
+  write_batch_->queries.push_back(
+      {query_template,
+       std::vector<QueryParameter>(parameters.begin(), parameters.end())});
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::ExecuteMultiRowInsert(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const QueryParameter> values, const size_t row_size,
+    std::vector<int64>* ids) {
+  const size_t num_rows = values.size() / row_size;
+  if (ids != nullptr && num_rows > 0) {
+    bool consecutive_insert_ids;
+    MLMD_RETURN_IF_ERROR(SelectConsecutiveInsertIDs(&consecutive_insert_ids));
+    if (!consecutive_insert_ids) {
+      for (size_t i = 0; i < num_rows; ++i) {
+        std::string row;
+        AppendRow(values.subspan(i * row_size, row_size), &row);
+        int64 id;
+        MLMD_RETURN_IF_ERROR(ExecuteQuerySelectLastInsertID(
+            template_query, {QueryParameter::Sql(std::move(row))}, &id));
+        ids->push_back(id);
+      }
+      return absl::OkStatus();
+    }
+  }
+  size_t row = 0;
+  while (row < num_rows) {
+    // The rows are rendered straight into the VALUES list of the statement,
+    // which takes at least one row, so that any row can be inserted.
+    std::string rows;
+    size_t num_statement_rows = 0;
+    for (; row < num_rows && num_statement_rows < kMaxRowsPerInsert; ++row) {
+      const size_t size = rows.size();
+      if (num_statement_rows > 0) rows.append(", ");
+      AppendRow(values.subspan(row * row_size, row_size), &rows);
+      if (num_statement_rows > 0 && rows.size() > kMaxBytesPerInsert) {
+        // The row is left to the next statement.
+        rows.resize(size);
+        break;
+      }
+      ++num_statement_rows;
+    }
+    if (ids == nullptr) {
+      MLMD_RETURN_IF_ERROR(ExecuteWrite(
+          template_query, {QueryParameter::Sql(std::move(rows))}));
+    } else {
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          template_query, {QueryParameter::Sql(std::move(rows))}));
+      int64 first_id;
+      MLMD_RETURN_IF_ERROR(SelectFirstInsertID(&first_id));
+      for (size_t i = 0; i < num_statement_rows; ++i) {
+        ids->push_back(first_id + i);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::BatchWrites(
+    const absl::FunctionRef<absl::Status()> writes) {
+  if (write_batch_ != nullptr) {
+    return writes();
+  }
+  WriteBatch write_batch;
+  write_batch_ = &write_batch;
+  const absl::Status status = writes();
+  write_batch_ = nullptr;
+  MLMD_RETURN_IF_ERROR(status);
+  return metadata_source_->ExecuteBatch(write_batch.queries);
+}
+
+absl::Status QueryConfigExecutor::ExecuteQueryStreaming(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    const absl::Span<const QueryParameter> parameters,
+    const MetadataSource::RowBatchCallback callback) {
   if (parameters.size() > 10) {
     return absl::InvalidArgumentError(
         "Template query has too many parameters (at most 10 is supported).");
@@ -418,13 +822,12 @@ absl::Status QueryConfigExecutor::ExecuteQuery(
                << "parameters size (" << parameters.size()
                << "): " << template_query.DebugString();
   }
-  std::vector<std::pair<const std::string, const std::string>> replacements;
-  replacements.reserve(parameters.size());
-  for (int i = 0; i < parameters.size(); i++) {
-    replacements.push_back({absl::StrCat("$", i), parameters[i]});
+  if (const QueryTemplate* query_template = FindQueryTemplate(template_query)) {
+    return metadata_source_->ExecuteTemplateQueryStreaming(
+        *query_template, parameters, callback);
   }
-  return metadata_source_->ExecuteQuery(
-      absl::StrReplaceAll(template_query.query(), replacements), record_set);
+  return metadata_source_->ExecuteTemplateQueryStreaming(
+      template_query.query(), parameters, callback);
 }
 
 absl::Status QueryConfigExecutor::IsCompatible(int64 db_version,
@@ -436,6 +839,41 @@ absl::Status QueryConfigExecutor::IsCompatible(int64 db_version,
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::SelectTypeGeneration(
+    absl::optional<int64>* type_generation) {
+  *type_generation = absl::nullopt;
+  if (query_schema_version() || !metadata_source_->transaction_open()) {
+    return absl::OkStatus();
+  }
+  const int64 transaction = metadata_source_->num_transactions();
+  if (type_generation_read_.transaction != transaction) {
+    ResultSet record_set;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_type_generation(),
+                                      {}, &record_set));
+    if (record_set.num_rows() != 1) {
+      return absl::DataLossError(absl::StrCat(
+          "The type generation cannot be resolved, as the MLMDEnv table has ",
+          record_set.num_rows(), " rows. Expecting a single row."));
+    }
+    type_generation_read_ = {transaction, record_set.GetInt(0, 0)};
+  }
+  *type_generation = type_generation_read_.type_generation;
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::IncrementTypeGeneration() {
+  if (query_schema_version()) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.increment_type_generation()));
+  // The change may still be rolled back, so the types read later in the
+  // transaction are not cached.
+  type_generation_read_ = {metadata_source_->num_transactions(),
+                           absl::nullopt};
+  return absl::OkStatus();
+}
+
 absl::Status QueryConfigExecutor::InitMetadataSource() {
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_type_table()));
   MLMD_RETURN_IF_ERROR(
@@ -472,7 +910,15 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
   int64 library_version = GetLibraryVersion();
   absl::Status insert_schema_version_status =
       InsertSchemaVersion(library_version);
-  if (!insert_schema_version_status.ok()) {
+  if (insert_schema_version_status.ok()) {
+    // A db created again under the same name starts with a type generation
+    // above the ones cached for its predecessors.
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.set_type_generation(),
+                     {Bind(absl::ToUnixMicros(absl::Now()))}));
+    type_generation_read_ = {metadata_source_->num_transactions(),
+                             absl::nullopt};
+  } else {
     int64 db_version = -1;
     MLMD_RETURN_IF_ERROR(GetSchemaVersion(&db_version));
     if (db_version != library_version) {
@@ -578,21 +1024,21 @@ absl::Status QueryConfigExecutor::InsertContextType(
 
 absl::Status QueryConfigExecutor::SelectTypesByID(
     const absl::Span<const int64> type_ids, TypeKind type_kind,
-    RecordSet* record_set) {
+    ResultSet* record_set) {
   return ExecuteQuery(query_config_.select_types_by_id(),
                       {Bind(type_ids), Bind(type_kind)}, record_set);
 }
 
 absl::Status QueryConfigExecutor::SelectTypeByID(int64 type_id,
                                                  TypeKind type_kind,
-                                                 RecordSet* record_set) {
+                                                 ResultSet* record_set) {
   return ExecuteQuery(query_config_.select_type_by_id(),
                       {Bind(type_id), Bind(type_kind)}, record_set);
 }
 
 absl::Status QueryConfigExecutor::SelectTypeByNameAndVersion(
     absl::string_view type_name, absl::optional<absl::string_view> type_version,
-    TypeKind type_kind, RecordSet* record_set) {
+    TypeKind type_kind, ResultSet* record_set) {
   if (type_version && !type_version->empty()) {
     return ExecuteQuery(query_config_.select_type_by_name_and_version(),
                         {Bind(type_name), Bind(*type_version), Bind(type_kind)},
@@ -604,7 +1050,7 @@ absl::Status QueryConfigExecutor::SelectTypeByNameAndVersion(
 }
 
 absl::Status QueryConfigExecutor::SelectAllTypes(TypeKind type_kind,
-                                                 RecordSet* record_set) {
+                                                 ResultSet* record_set) {
   return ExecuteQuery(query_config_.select_all_types(), {Bind(type_kind)},
                       record_set);
 }
@@ -613,7 +1059,7 @@ template <typename Node>
 absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set) {
+    ResultSet* record_set) {
   // Skip query if candidate_ids are set with an empty collection.
   if (candidate_ids && candidate_ids->empty()) {
     return absl::OkStatus();
@@ -659,7 +1105,7 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
 
   if (candidate_ids) {
     absl::SubstituteAndAppend(&sql_query, " `id` IN ($0) AND ",
-                              Bind(*candidate_ids));
+                              absl::StrJoin(*candidate_ids, ", "));
   }
   MLMD_RETURN_IF_ERROR(
       AppendOrderingThresholdClause(options, node_table_alias, sql_query));
@@ -672,21 +1118,21 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
 absl::Status QueryConfigExecutor::ListArtifactIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set) {
+    ResultSet* record_set) {
   return ListNodeIDsUsingOptions<Artifact>(options, candidate_ids, record_set);
 }
 
 absl::Status QueryConfigExecutor::ListExecutionIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set) {
+    ResultSet* record_set) {
   return ListNodeIDsUsingOptions<Execution>(options, candidate_ids, record_set);
 }
 
 absl::Status QueryConfigExecutor::ListContextIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set) {
+    ResultSet* record_set) {
   return ListNodeIDsUsingOptions<Context>(options, candidate_ids, record_set);
 }
 
@@ -15,13 +15,20 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_QUERY_CONFIG_EXECUTOR_H_
 #define ML_METADATA_METADATA_STORE_QUERY_CONFIG_EXECUTOR_H_
 
+#include <deque>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glog/logging.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/query_executor.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/util/return_utils.h"
@@ -46,7 +53,9 @@ class QueryConfigExecutor : public QueryExecutor {
   // The MetadataSource is not owned by this object, and must outlast it.
   QueryConfigExecutor(const MetadataSourceQueryConfig& query_config,
                       MetadataSource* source)
-      : query_config_(query_config), metadata_source_(source) {}
+      : query_config_(query_config), metadata_source_(source) {
+    CompileQueryTemplates();
+  }
 
   // A `query_version` can be passed to the QueryConfigExecutor to work with
   // an existing db with an earlier schema version.
@@ -98,17 +107,17 @@ class QueryConfigExecutor : public QueryExecutor {
                                  int64* type_id) final;
 
   absl::Status SelectTypesByID(const absl::Span<const int64> type_ids,
-                               TypeKind type_kind, RecordSet* record_set) final;
+                               TypeKind type_kind, ResultSet* record_set) final;
 
   absl::Status SelectTypeByID(int64 type_id, TypeKind type_kind,
-                              RecordSet* record_set) final;
+                              ResultSet* record_set) final;
 
   absl::Status SelectTypeByNameAndVersion(
       absl::string_view type_name,
       absl::optional<absl::string_view> type_version, TypeKind type_kind,
-      RecordSet* record_set) final;
+      ResultSet* record_set) final;
 
-  absl::Status SelectAllTypes(TypeKind type_kind, RecordSet* record_set) final;
+  absl::Status SelectAllTypes(TypeKind type_kind, ResultSet* record_set) final;
 
   absl::Status CheckTypePropertyTable() final {
     return ExecuteQuery(query_config_.check_type_property_table());
@@ -123,7 +132,7 @@ class QueryConfigExecutor : public QueryExecutor {
   }
 
   absl::Status SelectPropertiesByTypeID(const absl::Span<const int64> type_ids,
-                                        RecordSet* record_set) final {
+                                        ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_properties_by_type_id(),
                         {Bind(type_ids)}, record_set);
   }
@@ -136,11 +145,18 @@ class QueryConfigExecutor : public QueryExecutor {
                                 int64 parent_type_id) final;
 
   absl::Status SelectParentTypesByTypeID(const absl::Span<const int64> type_ids,
-                                         RecordSet* record_set) final;
+                                         ResultSet* record_set) final;
 
   // Queries the last inserted id.
   absl::Status SelectLastInsertID(int64* id);
 
+  // Queries the first id inserted by the last insert.
+  absl::Status SelectFirstInsertID(int64* id);
+
+  // Queries whether the rows of a multi-row insert get consecutive ids, which
+  // is read once and then kept, as it depends on the server settings.
+  absl::Status SelectConsecutiveInsertIDs(bool* consecutive_insert_ids);
+
   absl::Status CheckArtifactTable() final {
     return ExecuteQuery(query_config_.check_artifact_table());
   }
@@ -159,27 +175,52 @@ class QueryConfigExecutor : public QueryExecutor {
         artifact_id);
   }
 
+  absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                               absl::Time create_time,
+                               std::vector<int64>* artifact_ids) final;
+
   absl::Status SelectArtifactsByID(const absl::Span<const int64> artifact_ids,
-                                   RecordSet* record_set) final {
+                                   ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifact_by_id(),
                         {Bind(artifact_ids)}, record_set);
   }
 
+  absl::Status SelectArtifactsByID(
+      const absl::Span<const int64> artifact_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(query_config_.select_artifact_by_id(),
+                                 {Bind(artifact_ids)}, callback);
+  }
+
+  absl::Status SelectArtifactsWithPropertiesByID(
+      const absl::Span<const int64> artifact_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_artifacts_with_properties_by_id(),
+        {Bind(artifact_ids)}, callback);
+  }
+
+  absl::Status SelectArtifactIDsAfterID(int64 after_id, int64 max_num_ids,
+                                        ResultSet* record_set) final {
+    return ExecuteQuery(query_config_.select_artifact_ids_after_id(),
+                        {Bind(after_id), Bind(max_num_ids)}, record_set);
+  }
+
   absl::Status SelectArtifactByTypeIDAndArtifactName(
       int64 artifact_type_id, const absl::string_view name,
-      RecordSet* record_set) final {
+      ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifact_by_type_id_and_name(),
                         {Bind(artifact_type_id), Bind(name)}, record_set);
   }
 
   absl::Status SelectArtifactsByTypeID(int64 artifact_type_id,
-                                       RecordSet* record_set) final {
+                                       ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifacts_by_type_id(),
                         {Bind(artifact_type_id)}, record_set);
   }
 
   absl::Status SelectArtifactsByURI(const absl::string_view uri,
-                                    RecordSet* record_set) final {
+                                    ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifacts_by_uri(), {Bind(uri)},
                         record_set);
   }
@@ -193,6 +234,19 @@ class QueryConfigExecutor : public QueryExecutor {
                          Bind(state), Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateArtifactFields(
+      int64 artifact_id, absl::optional<int64> type_id,
+      absl::optional<int64> last_update_time, bool update_uri,
+      const std::string& uri, bool update_state,
+      const absl::optional<Artifact::State>& state,
+      const absl::Time update_time) final {
+    return ExecuteWrite(
+        query_config_.update_artifact_fields(),
+        {Bind(artifact_id), Bind(type_id), Bind(last_update_time),
+         Bind(update_uri), Bind(uri), Bind(update_state), Bind(state),
+         Bind(absl::ToUnixMillis(update_time))});
+  }
+
   absl::Status CheckArtifactPropertyTable() final {
     return ExecuteQuery(query_config_.check_artifact_property_table());
   }
@@ -201,22 +255,36 @@ class QueryConfigExecutor : public QueryExecutor {
                                       absl::string_view artifact_property_name,
                                       bool is_custom_property,
                                       const Value& property_value) final {
-    return ExecuteQuery(query_config_.insert_artifact_property(),
+    return ExecuteWrite(query_config_.insert_artifact_property(),
                         {BindDataType(property_value), Bind(artifact_id),
                          Bind(artifact_property_name), Bind(is_custom_property),
                          BindValue(property_value)});
   }
 
+  absl::Status InsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) final;
+
+  absl::Status UpsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) final;
+
   absl::Status SelectArtifactPropertyByArtifactID(
-      const absl::Span<const int64> artifact_ids, RecordSet* record_set) final {
+      const absl::Span<const int64> artifact_ids, ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifact_property_by_artifact_id(),
                         {Bind(artifact_ids)}, record_set);
   }
 
+  absl::Status SelectArtifactPropertyByArtifactID(
+      const absl::Span<const int64> artifact_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_artifact_property_by_artifact_id(),
+        {Bind(artifact_ids)}, callback);
+  }
+
   absl::Status UpdateArtifactProperty(int64 artifact_id,
                                       const absl::string_view property_name,
                                       const Value& property_value) final {
-    return ExecuteQuery(
+    return ExecuteWrite(
         query_config_.update_artifact_property(),
         {BindDataType(property_value), BindValue(property_value),
          Bind(artifact_id), Bind(property_name)});
@@ -224,7 +292,7 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status DeleteArtifactProperty(
       int64 artifact_id, const absl::string_view property_name) final {
-    return ExecuteQuery(query_config_.delete_artifact_property(),
+    return ExecuteWrite(query_config_.delete_artifact_property(),
                         {Bind(artifact_id), Bind(property_name)});
   }
 
@@ -244,21 +312,46 @@ class QueryConfigExecutor : public QueryExecutor {
         execution_id);
   }
 
+  absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                absl::Time create_time,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status SelectExecutionsByID(const absl::Span<const int64> ids,
-                                    RecordSet* record_set) final {
+                                    ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_execution_by_id(), {Bind(ids)},
                         record_set);
   }
 
+  absl::Status SelectExecutionsByID(
+      const absl::Span<const int64> ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(query_config_.select_execution_by_id(),
+                                 {Bind(ids)}, callback);
+  }
+
+  absl::Status SelectExecutionsWithPropertiesByID(
+      const absl::Span<const int64> ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_executions_with_properties_by_id(), {Bind(ids)},
+        callback);
+  }
+
+  absl::Status SelectExecutionIDsAfterID(int64 after_id, int64 max_num_ids,
+                                         ResultSet* record_set) final {
+    return ExecuteQuery(query_config_.select_execution_ids_after_id(),
+                        {Bind(after_id), Bind(max_num_ids)}, record_set);
+  }
+
   absl::Status SelectExecutionByTypeIDAndExecutionName(
       int64 execution_type_id, const absl::string_view name,
-      RecordSet* record_set) final {
+      ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_execution_by_type_id_and_name(),
                         {Bind(execution_type_id), Bind(name)}, record_set);
   }
 
   absl::Status SelectExecutionsByTypeID(int64 execution_type_id,
-                                        RecordSet* record_set) final {
+                                        ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_executions_by_type_id(),
                         {Bind(execution_type_id)}, record_set);
   }
@@ -273,6 +366,18 @@ class QueryConfigExecutor : public QueryExecutor {
          Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateExecutionFields(
+      int64 execution_id, absl::optional<int64> type_id,
+      absl::optional<int64> last_update_time, bool update_last_known_state,
+      const absl::optional<Execution::State>& last_known_state,
+      const absl::Time update_time) final {
+    return ExecuteWrite(
+        query_config_.update_execution_fields(),
+        {Bind(execution_id), Bind(type_id), Bind(last_update_time),
+         Bind(update_last_known_state), Bind(last_known_state),
+         Bind(absl::ToUnixMillis(update_time))});
+  }
+
   absl::Status CheckExecutionPropertyTable() final {
     return ExecuteQuery(query_config_.check_execution_property_table());
   }
@@ -281,29 +386,43 @@ class QueryConfigExecutor : public QueryExecutor {
                                        const absl::string_view name,
                                        bool is_custom_property,
                                        const Value& value) final {
-    return ExecuteQuery(query_config_.insert_execution_property(),
+    return ExecuteWrite(query_config_.insert_execution_property(),
                         {BindDataType(value), Bind(execution_id), Bind(name),
                          Bind(is_custom_property), BindValue(value)});
   }
 
+  absl::Status InsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) final;
+
+  absl::Status UpsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) final;
+
   absl::Status SelectExecutionPropertyByExecutionID(
-      const absl::Span<const int64> ids, RecordSet* record_set) final {
+      const absl::Span<const int64> ids, ResultSet* record_set) final {
     return ExecuteQuery(
         query_config_.select_execution_property_by_execution_id(), {Bind(ids)},
         record_set);
   }
 
+  absl::Status SelectExecutionPropertyByExecutionID(
+      const absl::Span<const int64> ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_execution_property_by_execution_id(), {Bind(ids)},
+        callback);
+  }
+
   absl::Status UpdateExecutionProperty(int64 execution_id,
                                        const absl::string_view name,
                                        const Value& value) final {
-    return ExecuteQuery(query_config_.update_execution_property(),
+    return ExecuteWrite(query_config_.update_execution_property(),
                         {BindDataType(value), BindValue(value),
                          Bind(execution_id), Bind(name)});
   }
 
   absl::Status DeleteExecutionProperty(int64 execution_id,
                                        const absl::string_view name) final {
-    return ExecuteQuery(query_config_.delete_execution_property(),
+    return ExecuteWrite(query_config_.delete_execution_property(),
                         {Bind(execution_id), Bind(name)});
   }
 
@@ -322,21 +441,46 @@ class QueryConfigExecutor : public QueryExecutor {
         context_id);
   }
 
+  absl::Status InsertContexts(absl::Span<const Context> contexts,
+                              absl::Time create_time,
+                              std::vector<int64>* context_ids) final;
+
   absl::Status SelectContextsByID(const absl::Span<const int64> context_ids,
-                                  RecordSet* record_set) final {
+                                  ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_context_by_id(),
                         {Bind(context_ids)}, record_set);
   }
 
+  absl::Status SelectContextsByID(
+      const absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(query_config_.select_context_by_id(),
+                                 {Bind(context_ids)}, callback);
+  }
+
+  absl::Status SelectContextsWithPropertiesByID(
+      const absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_contexts_with_properties_by_id(),
+        {Bind(context_ids)}, callback);
+  }
+
+  absl::Status SelectContextIDsAfterID(int64 after_id, int64 max_num_ids,
+                                       ResultSet* record_set) final {
+    return ExecuteQuery(query_config_.select_context_ids_after_id(),
+                        {Bind(after_id), Bind(max_num_ids)}, record_set);
+  }
+
   absl::Status SelectContextsByTypeID(int64 context_type_id,
-                                      RecordSet* record_set) final {
+                                      ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_contexts_by_type_id(),
                         {Bind(context_type_id)}, record_set);
   }
 
   absl::Status SelectContextByTypeIDAndContextName(
       int64 context_type_id, const absl::string_view name,
-      RecordSet* record_set) final {
+      ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_context_by_type_id_and_name(),
                         {Bind(context_type_id), Bind(name)}, record_set);
   }
@@ -350,6 +494,19 @@ class QueryConfigExecutor : public QueryExecutor {
          Bind(absl::ToUnixMillis(update_time))});
   }
 
+  absl::Status UpdateContextFields(int64 context_id,
+                                   absl::optional<int64> type_id,
+                                   absl::optional<int64> last_update_time,
+                                   bool update_name,
+                                   const std::string& context_name,
+                                   const absl::Time update_time) final {
+    return ExecuteWrite(
+        query_config_.update_context_fields(),
+        {Bind(context_id), Bind(type_id), Bind(last_update_time),
+         Bind(update_name), Bind(context_name),
+         Bind(absl::ToUnixMillis(update_time))});
+  }
+
   absl::Status CheckContextPropertyTable() final {
     return ExecuteQuery(query_config_.check_context_property_table());
   }
@@ -358,21 +515,35 @@ class QueryConfigExecutor : public QueryExecutor {
                                      const absl::string_view name,
                                      bool custom_property,
                                      const Value& value) final {
-    return ExecuteQuery(query_config_.insert_context_property(),
+    return ExecuteWrite(query_config_.insert_context_property(),
                         {BindDataType(value), Bind(context_id), Bind(name),
                          Bind(custom_property), BindValue(value)});
   }
 
+  absl::Status InsertContextProperties(
+      absl::Span<const NodeProperty> properties) final;
+
+  absl::Status UpsertContextProperties(
+      absl::Span<const NodeProperty> properties) final;
+
   absl::Status SelectContextPropertyByContextID(
-      const absl::Span<const int64> context_ids, RecordSet* record_set) final {
+      const absl::Span<const int64> context_ids, ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_context_property_by_context_id(),
                         {Bind(context_ids)}, record_set);
   }
 
+  absl::Status SelectContextPropertyByContextID(
+      const absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) final {
+    return ExecuteQueryStreaming(
+        query_config_.select_context_property_by_context_id(),
+        {Bind(context_ids)}, callback);
+  }
+
   absl::Status UpdateContextProperty(int64 context_id,
                                      const absl::string_view property_name,
                                      const Value& property_value) final {
-    return ExecuteQuery(
+    return ExecuteWrite(
         query_config_.update_context_property(),
         {BindDataType(property_value), BindValue(property_value),
          Bind(context_id), Bind(property_name)});
@@ -380,7 +551,7 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status DeleteContextProperty(
       const int64 context_id, const absl::string_view property_name) final {
-    return ExecuteQuery(query_config_.delete_context_property(),
+    return ExecuteWrite(query_config_.delete_context_property(),
                         {Bind(context_id), Bind(property_name)});
   }
 
@@ -400,14 +571,14 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status SelectEventByArtifactIDs(
       const absl::Span<const int64> artifact_ids,
-      RecordSet* event_record_set) final {
+      ResultSet* event_record_set) final {
     return ExecuteQuery(query_config_.select_event_by_artifact_ids(),
                         {Bind(artifact_ids)}, event_record_set);
   }
 
   absl::Status SelectEventByExecutionIDs(
       const absl::Span<const int64> execution_ids,
-      RecordSet* event_record_set) final {
+      ResultSet* event_record_set) final {
     return ExecuteQuery(query_config_.select_event_by_execution_ids(),
                         {Bind(execution_ids)}, event_record_set);
   }
@@ -419,8 +590,10 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status InsertEventPath(int64 event_id,
                                const Event::Path::Step& step) final;
 
+  absl::Status InsertEventPaths(int64 event_id, const Event::Path& path) final;
+
   absl::Status SelectEventPathByEventIDs(
-      const absl::Span<const int64> event_ids, RecordSet* record_set) final {
+      const absl::Span<const int64> event_ids, ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_event_path_by_event_ids(),
                         {Bind(event_ids)}, record_set);
   }
@@ -437,13 +610,13 @@ class QueryConfigExecutor : public QueryExecutor {
   }
 
   absl::Status SelectAssociationByContextIDs(absl::Span<const int64> context_id,
-                                             RecordSet* record_set) final {
+                                             ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_context_id(),
                         {Bind(context_id)}, record_set);
   }
 
   absl::Status SelectAssociationByExecutionID(int64 execution_id,
-                                              RecordSet* record_set) final {
+                                              ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_execution_id(),
                         {Bind(execution_id)}, record_set);
   }
@@ -460,13 +633,13 @@ class QueryConfigExecutor : public QueryExecutor {
   }
 
   absl::Status SelectAttributionByContextID(int64 context_id,
-                                            RecordSet* record_set) final {
+                                            ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_attribution_by_context_id(),
                         {Bind(context_id)}, record_set);
   }
 
   absl::Status SelectAttributionByArtifactID(int64 artifact_id,
-                                             RecordSet* record_set) final {
+                                             ResultSet* record_set) final {
     return ExecuteQuery(query_config_.select_attribution_by_artifact_id(),
                         {Bind(artifact_id)}, record_set);
   }
@@ -476,10 +649,10 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status InsertParentContext(int64 parent_id, int64 child_id) final;
 
   absl::Status SelectParentContextsByContextID(int64 context_id,
-                                               RecordSet* record_set) final;
+                                               ResultSet* record_set) final;
 
   absl::Status SelectChildContextsByContextID(int64 context_id,
-                                              RecordSet* record_set) final;
+                                              ResultSet* record_set) final;
 
   absl::Status CheckMLMDEnvTable() final {
     return ExecuteQuery(query_config_.check_mlmd_env_table());
@@ -497,17 +670,22 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(schema_version)});
   }
 
+  absl::Status SelectTypeGeneration(
+      absl::optional<int64>* type_generation) final;
+
+  absl::Status IncrementTypeGeneration() final;
+
   absl::Status CheckTablesIn_V0_13_2() final;
 
-  absl::Status SelectAllArtifactIDs(RecordSet* set) final {
+  absl::Status SelectAllArtifactIDs(ResultSet* set) final {
     return ExecuteQuery("select `id` from `Artifact`;", set);
   }
 
-  absl::Status SelectAllExecutionIDs(RecordSet* set) final {
+  absl::Status SelectAllExecutionIDs(ResultSet* set) final {
     return ExecuteQuery("select `id` from `Execution`;", set);
   }
 
-  absl::Status SelectAllContextIDs(RecordSet* set) final {
+  absl::Status SelectAllContextIDs(ResultSet* set) final {
     return ExecuteQuery("select `id` from `Context`;", set);
   }
 
@@ -516,22 +694,26 @@ class QueryConfigExecutor : public QueryExecutor {
     return query_config_.schema_version();
   }
 
+  absl::Status BatchWrites(absl::FunctionRef<absl::Status()> writes) final;
+
+  absl::Status SelectNumChangedRows(int64* num_rows) final;
+
   absl::Status DowngradeMetadataSource(const int64 to_schema_version) final;
 
   absl::Status ListArtifactIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) final;
+      ResultSet* record_set) final;
 
   absl::Status ListExecutionIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) final;
+      ResultSet* record_set) final;
 
   absl::Status ListContextIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) final;
+      ResultSet* record_set) final;
 
 
   absl::Status DeleteArtifactsById(absl::Span<const int64> artifact_ids) final;
@@ -568,78 +750,116 @@ class QueryConfigExecutor : public QueryExecutor {
  private:
   // Utility method to bind an nullable value.
   template <typename T>
-  std::string Bind(const absl::optional<T>& v) {
-    return v ? Bind(v.value()) : "NULL";
+  QueryParameter Bind(const absl::optional<T>& v) {
+    return v ? Bind(v.value()) : QueryParameter();
   }
 
   // Utility method to bind an string_view value to a SQL clause.
-  std::string Bind(absl::string_view value);
+  QueryParameter Bind(absl::string_view value);
 
   // Utility method to bind an string_view value to a SQL clause.
-  std::string Bind(const char* value);
+  QueryParameter Bind(const char* value);
 
   // Utility method to bind an int value to a SQL clause.
-  std::string Bind(int value);
+  QueryParameter Bind(int value);
 
   // Utility method to bind an int64 value to a SQL clause.
-  std::string Bind(int64 value);
+  QueryParameter Bind(int64 value);
 
   // Utility method to bind a boolean value to a SQL clause.
-  std::string Bind(bool value);
+  QueryParameter Bind(bool value);
 
   // Utility method to bind an double value to a SQL clause.
-  std::string Bind(const double value);
+  QueryParameter Bind(const double value);
 
   // Utility method to bind an PropertyType enum value to a SQL clause.
   // PropertyType is an enum (integer), EscapeString is not applicable.
-  std::string Bind(const PropertyType value);
+  QueryParameter Bind(const PropertyType value);
 
   // Utility method to bind an Event::Type enum value to a SQL clause.
   // Event::Type is an enum (integer), EscapeString is not applicable.
-  std::string Bind(const Event::Type value);
+  QueryParameter Bind(const Event::Type value);
+
+  // Utility methods to bind the value, and the name of the column of its data
+  // type, to a SQL clause.
+  QueryParameter BindValue(const Value& value);
+  QueryParameter BindDataType(const Value& value);
 
-  // Utility methods to bind the value to a SQL clause.
-  std::string BindValue(const Value& value);
-  std::string BindDataType(const Value& value);
-  std::string Bind(const ArtifactStructType* message);
+  // Utility method to append the `values` of a row of the multi-row inserts to
+  // `rows`, as a parenthesized list of SQL literals.
+  void AppendRow(absl::Span<const QueryParameter> values, std::string* rows);
+
+  // Utility method to append the values of a row of the multi-row property
+  // inserts to `values`, with the value of `property` in the column of its
+  // data type and NULL in the others.
+  void BindPropertyRow(const NodeProperty& property,
+                       std::vector<QueryParameter>* values);
+  QueryParameter Bind(const ArtifactStructType* message);
 
   // Utility method to bind an TypeKind to a SQL clause.
   // TypeKind is an enum (integer), EscapeString is not applicable.
-  std::string Bind(TypeKind value);
+  QueryParameter Bind(TypeKind value);
 
   // Utility methods to bind Artifact::State/Execution::State to SQL clause.
-  std::string Bind(Artifact::State value);
-  std::string Bind(Execution::State value);
+  QueryParameter Bind(Artifact::State value);
+  QueryParameter Bind(Execution::State value);
 
-  // Utility method to bind an in64 vector to a string joined with "," that can
-  // fit into SQL IN(...) clause.
-  std::string Bind(absl::Span<const int64> value);
+  // Utility method to bind an in64 vector to a list joined with "," that can
+  // fit into SQL IN(...) clause, which is substituted into the statement.
+  QueryParameter Bind(absl::Span<const int64> value);
 
   #if (!defined(__APPLE__) && !defined(_WIN32))
-  std::string Bind(const google::protobuf::int64 value);
+  QueryParameter Bind(const google::protobuf::int64 value);
   #endif
 
-  // Execute a template query. All strings in parameters should already be
-  // in a format appropriate for the SQL variant being used (at this point,
-  // they are just inserted).
-  // Results consist of zero or more rows represented in RecordSet.
+  // Execute a template query with the `parameters` composed by Bind. The
+  // values among them are bound to the prepared statement of the query, or
+  // rendered as SQL literals for the SQL variant being used.
+  // Results consist of zero or more rows represented in ResultSet.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(
       const MetadataSourceQueryConfig::TemplateQuery& template_query,
-      absl::Span<const std::string> parameters, RecordSet* record_set);
+      absl::Span<const QueryParameter> parameters, ResultSet* record_set);
+
+  // Execute a template query, and pass its rows to `callback` in batches as
+  // they are read.
+  // Returns the same errors as ExecuteQuery above, and the error of `callback`
+  // if it fails.
+  absl::Status ExecuteQueryStreaming(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const QueryParameter> parameters,
+      MetadataSource::RowBatchCallback callback);
+
+  // Execute a template query without results, which is queued instead if a
+  // batch of writes is open.
+  // Returns the same errors as ExecuteQuery, or OK if the query is queued.
+  absl::Status ExecuteWrite(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const QueryParameter> parameters);
+
+  // Execute a multi-row insert `template_query` of the rows of `values`, each
+  // of which has `row_size` values, in statements of bounded size. If `ids` is
+  // given, the ids of the inserted rows are appended to it, and the rows are
+  // inserted one by one unless they get consecutive ids, as the ids of a
+  // multi-row insert are known from its first id only. Otherwise, the
+  // statements are queued if a batch of writes is open.
+  // Returns the same errors as ExecuteQuery, or INTERNAL error, if it cannot
+  // find the inserted ids.
+  absl::Status ExecuteMultiRowInsert(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      absl::Span<const QueryParameter> values, size_t row_size,
+      std::vector<int64>* ids);
 
   // Execute a template query and ignore the result.
-  // All strings in parameters should already be in a format appropriate for the
-  // SQL variant being used (at this point, they are just inserted).
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(
       const MetadataSourceQueryConfig::TemplateQuery& template_query,
-      const absl::Span<const std::string> parameters) {
-    RecordSet record_set;
+      const absl::Span<const QueryParameter> parameters) {
+    ResultSet record_set;
     return ExecuteQuery(template_query, parameters, &record_set);
   }
 
@@ -659,17 +879,17 @@ class QueryConfigExecutor : public QueryExecutor {
   // Returns INTERNAL error, if it cannot find the last insert ID.
   absl::Status ExecuteQuerySelectLastInsertID(
       const MetadataSourceQueryConfig::TemplateQuery& query,
-      const absl::Span<const std::string> arguments, int64* last_insert_id) {
+      const absl::Span<const QueryParameter> arguments, int64* last_insert_id) {
     MLMD_RETURN_IF_ERROR(ExecuteQuery(query, arguments));
     return SelectLastInsertID(last_insert_id);
   }
 
   // Execute a query without arguments.
-  // Results consist of zero or more rows represented in RecordSet.
+  // Results consist of zero or more rows represented in ResultSet.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
-  absl::Status ExecuteQuery(const std::string& query, RecordSet* record_set);
+  absl::Status ExecuteQuery(const std::string& query, ResultSet* record_set);
 
   // Execute a query without arguments and ignore the result.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
@@ -714,12 +934,58 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status ListNodeIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set);
+      ResultSet* record_set);
+
+  // The writes queued by a BatchWrites call.
+  struct WriteBatch {
+    std::vector<MetadataSource::BatchedQuery> queries;
+    // The templates of the queued queries which are not compiled with the
+    // query config, e.g., the ones of migrations.
+    std::deque<QueryTemplate> compiled_templates;
+  };
+
+  // Compiles the template queries of `query_config_` to `query_templates_`.
+  void CompileQueryTemplates();
+
+  // Returns the compiled `template_query`, or null if it is not one of the
+  // template queries of `query_config_`. In a read-only transaction, the
+  // queries are run without their LOCK IN SHARE MODE clause, as their reads
+  // must come from the snapshot of the transaction and take no locks.
+  const QueryTemplate* FindQueryTemplate(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query) const;
 
   MetadataSourceQueryConfig query_config_;
 
+  // The template queries of `query_config_` compiled at the construction, so
+  // that they are not scanned for their placeholders on each query.
+  absl::flat_hash_map<const MetadataSourceQueryConfig::TemplateQuery*,
+                      QueryTemplate>
+      query_templates_;
+
+  // The template queries of `query_config_` ending with LOCK IN SHARE MODE,
+  // compiled without the clause for the read-only transactions.
+  absl::flat_hash_map<const MetadataSourceQueryConfig::TemplateQuery*,
+                      QueryTemplate>
+      read_only_query_templates_;
+
   // This object does not own the MetadataSource.
   MetadataSource* metadata_source_;
+
+  // The writes queued by the open BatchWrites call, or null if there is none.
+  WriteBatch* write_batch_ = nullptr;
+
+  // Whether the rows of a multi-row insert get consecutive ids, or nullopt if
+  // it has not been read yet.
+  absl::optional<bool> consecutive_insert_ids_;
+
+  // The type generation read in a transaction, which is identified by the
+  // number of transactions begun on `metadata_source_`.
+  struct TypeGenerationRead {
+    int64 transaction = -1;
+    // The type generation, or nullopt if the transaction changed the types.
+    absl::optional<int64> type_generation;
+  };
+  TypeGenerationRead type_generation_read_;
 };
 
 }  // namespace ml_metadata
@@ -18,12 +18,15 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
@@ -34,7 +37,7 @@ namespace ml_metadata {
 // Most methods correspond to one or two queries, with a few exceptions
 // (such as InitMetadataSource).
 //
-// IMPORTANT NOTE: All Select{X}PropertyBy{X}Id methods return a RecordSet for
+// IMPORTANT NOTE: All Select{X}PropertyBy{X}Id methods return a ResultSet for
 // the properties of the input {X} type of node (X in {Artifact, Context,
 // Execution}) and use the same convention:
 // - Column 0: int: node id
@@ -47,6 +50,14 @@ namespace ml_metadata {
 // Some methods might add additional columns
 class QueryExecutor {
  public:
+  // A property of a node inserted by the Insert{X}Properties methods.
+  struct NodeProperty {
+    int64 node_id;
+    absl::string_view name;
+    bool is_custom_property;
+    const Value* value;
+  };
+
   // By default, for any empty db, the head schema should be used to init new
   // db instances. Giving an optional `query_schema_version` allows the query
   // executor to work with an existing db with an earlier schema version other
@@ -138,6 +149,21 @@ class QueryExecutor {
   // needed.
   virtual int64 GetLibraryVersion() = 0;
 
+  // Runs `writes`, in which the insertions, updates and deletions of node
+  // properties, the updates of node fields (Update{X}Fields) and the
+  // insertions of event paths are queued instead of run,
+  // and then runs the queued ones together in as few round trips to the
+  // metadata source as it allows. The queued writes are not visible to the
+  // queries of `writes`, and are dropped if it fails. Nested calls join the
+  // outermost batch.
+  // Returns the error of `writes`, or the one of the first failed queued write.
+  virtual absl::Status BatchWrites(
+      absl::FunctionRef<absl::Status()> writes) = 0;
+
+  // Queries the number of rows changed by the last write which has been run,
+  // i.e., the ones queued by an open BatchWrites are not counted yet.
+  virtual absl::Status SelectNumChangedRows(int64* num_rows) = 0;
+
   // Each of the following methods roughly corresponds to a query (or two).
   virtual absl::Status CheckTypeTable() = 0;
 
@@ -191,14 +217,14 @@ class QueryExecutor {
   // ExecutionType.
   virtual absl::Status SelectTypesByID(const absl::Span<const int64> type_ids,
                                        TypeKind type_kind,
-                                       RecordSet* record_set) = 0;
+                                       ResultSet* record_set) = 0;
   // Queries a type by its type id.
   // Returns a message that can be converted to an ArtifactType,
   // ContextType, or ExecutionType.
   // TODO(b/171597866) Improve document and describe the returned `record_set`.
   // for the query executor APIs.
   virtual absl::Status SelectTypeByID(int64 type_id, TypeKind type_kind,
-                                      RecordSet* record_set) = 0;
+                                      ResultSet* record_set) = 0;
 
   // Queries a type by its type name and an optional version. If version is
   // not given or the version is an empty string, (type_name, version = NULL)
@@ -208,13 +234,13 @@ class QueryExecutor {
   virtual absl::Status SelectTypeByNameAndVersion(
       absl::string_view type_name,
       absl::optional<absl::string_view> type_version, TypeKind type_kind,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // Queries for all type instances.
   // Returns a message that can be converted to an ArtifactType,
   // ContextType, or ExecutionType.
   virtual absl::Status SelectAllTypes(TypeKind type_kind,
-                                      RecordSet* record_set) = 0;
+                                      ResultSet* record_set) = 0;
 
   // Checks the existence of the TypeProperty table.
   virtual absl::Status CheckTypePropertyTable() = 0;
@@ -228,7 +254,7 @@ class QueryExecutor {
   // `type_ids`.
   // Returns a list of properties (type_id, name, data_type).
   virtual absl::Status SelectPropertiesByTypeID(
-      const absl::Span<const int64> type_ids, RecordSet* record_set) = 0;
+      const absl::Span<const int64> type_ids, ResultSet* record_set) = 0;
 
   // Checks the existence of the ParentType table.
   virtual absl::Status CheckParentTypeTable() = 0;
@@ -248,7 +274,7 @@ class QueryExecutor {
   // Column 0: int: type_id (= type_id in `type_ids`)
   // Column 1: int: parent_type_id
   virtual absl::Status SelectParentTypesByTypeID(
-      const absl::Span<const int64> type_ids, RecordSet* record_set) = 0;
+      const absl::Span<const int64> type_ids, ResultSet* record_set) = 0;
 
   // Checks the existence of the Artifact table.
   virtual absl::Status CheckArtifactTable() = 0;
@@ -260,6 +286,14 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* artifact_id) = 0;
 
+  // Inserts the `artifacts` into the database with multi-row inserts, and
+  // returns their ids in the order of `artifacts`. The ids, properties and
+  // times of the given artifacts are ignored; they are created at
+  // `create_time`.
+  virtual absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                                       absl::Time create_time,
+                                       std::vector<int64>* artifact_ids) = 0;
+
   // Retrieves artifacts from the database by their ids. Not found ids are
   // skipped. For each matched artifact, returns a row that contains the
   // following columns (order not important):
@@ -271,28 +305,67 @@ class QueryExecutor {
   // - int: create time (since epoch)
   // - int: last update time (since epoch)
   virtual absl::Status SelectArtifactsByID(absl::Span<const int64> ids,
-                                           RecordSet* record_set) = 0;
+                                           ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectArtifactsByID to `callback` in batches.
+  virtual absl::Status SelectArtifactsByID(
+      absl::Span<const int64> ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves artifacts and their properties from the database by the artifact
+  // ids in one query, and streams the rows sorted by artifact id to `callback`
+  // in batches. Each row has the columns of SelectArtifactsByID, followed by
+  // the columns of a property of the artifact, which are all NULL for an
+  // artifact without properties:
+  // - string: property_name
+  // - boolean: is_custom_property
+  // - int: int_value
+  // - double: double_value
+  // - string: string_value
+  virtual absl::Status SelectArtifactsWithPropertiesByID(
+      absl::Span<const int64> ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves the ids of up to `max_num_ids` artifacts with ids greater than
+  // `after_id` in ascending order, which walks the artifacts by their primary
+  // key in batches.
+  virtual absl::Status SelectArtifactIDsAfterID(int64 after_id,
+                                                int64 max_num_ids,
+                                                ResultSet* record_set) = 0;
+
   // Queries an artifact from the Artifact table by its type_id and name.
   // Returns the artifact ID.
   virtual absl::Status SelectArtifactByTypeIDAndArtifactName(
       int64 artifact_type_id, const absl::string_view name,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // Queries artifacts from the Artifact table by their type_id.
   // Returns a list of artifact IDs.
   virtual absl::Status SelectArtifactsByTypeID(int64 artifact_type_id,
-                                               RecordSet* record_set) = 0;
+                                               ResultSet* record_set) = 0;
 
   // Queries an artifact from the database by its uri.
   // Returns a list of artifact IDs.
   virtual absl::Status SelectArtifactsByURI(const absl::string_view uri,
-                                            RecordSet* record_set) = 0;
+                                            ResultSet* record_set) = 0;
 
   // Updates an artifact in the database.
   virtual absl::Status UpdateArtifactDirect(
       int64 artifact_id, int64 type_id, const std::string& uri,
       const absl::optional<Artifact::State>& state, absl::Time update_time) = 0;
 
+  // Updates the uri if `update_uri` and the state if `update_state` of an
+  // artifact without reading it, and sets its last_update_time_since_epoch to
+  // `update_time`, or increases it past the stored one if that is not earlier,
+  // so that the updated row always changes. The artifact is only updated if it
+  // has the `type_id` and the `last_update_time` which are given. Whether it
+  // is updated can be checked with SelectNumChangedRows.
+  virtual absl::Status UpdateArtifactFields(
+      int64 artifact_id, absl::optional<int64> type_id,
+      absl::optional<int64> last_update_time, bool update_uri,
+      const std::string& uri, bool update_state,
+      const absl::optional<Artifact::State>& state, absl::Time update_time) = 0;
+
   // Checks the existence of the ArtifactProperty table.
   virtual absl::Status CheckArtifactPropertyTable() = 0;
 
@@ -301,11 +374,26 @@ class QueryExecutor {
       int64 artifact_id, absl::string_view artifact_property_name,
       bool is_custom_property, const Value& property_value) = 0;
 
+  // Inserts properties of artifacts into the database with multi-row inserts.
+  virtual absl::Status InsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
+  // Inserts properties of artifacts, or updates the values of the existing
+  // ones, with multi-row upserts.
+  virtual absl::Status UpsertArtifactProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of an artifact from the database by the
   // artifact id. Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectArtifactPropertyByArtifactID(
-      absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
+      absl::Span<const int64> artifact_ids, ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectArtifactPropertyByArtifactID to `callback` in
+  // batches.
+  virtual absl::Status SelectArtifactPropertyByArtifactID(
+      absl::Span<const int64> artifact_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
 
   // Updates a property of an artifact in the database.
   virtual absl::Status UpdateArtifactProperty(
@@ -325,6 +413,11 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* execution_id) = 0;
 
+  // Inserts the `executions` into the database as InsertArtifacts.
+  virtual absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                        absl::Time create_time,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves Executions based on the given ids. Not found ids are skipped.
   // For each matched execution, returns a row that contains the following
   // columns (order not important):
@@ -335,16 +428,34 @@ class QueryExecutor {
   // - create_time_since_epoch
   // - last_update_time_since_epoch
   virtual absl::Status SelectExecutionsByID(
-      absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+      absl::Span<const int64> execution_ids, ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectExecutionsByID to `callback` in batches.
+  virtual absl::Status SelectExecutionsByID(
+      absl::Span<const int64> execution_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves executions and their properties as
+  // SelectArtifactsWithPropertiesByID.
+  virtual absl::Status SelectExecutionsWithPropertiesByID(
+      absl::Span<const int64> execution_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves the ids of up to `max_num_ids` executions with ids greater than
+  // `after_id` in ascending order, which walks the executions by their primary
+  // key in batches.
+  virtual absl::Status SelectExecutionIDsAfterID(int64 after_id,
+                                                 int64 max_num_ids,
+                                                 ResultSet* record_set) = 0;
 
   // Queries an execution from the database by its type_id and name.
   virtual absl::Status SelectExecutionByTypeIDAndExecutionName(
       int64 execution_type_id, const absl::string_view name,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // Queries an execution from the database by its type_id.
   virtual absl::Status SelectExecutionsByTypeID(int64 execution_type_id,
-                                                RecordSet* record_set) = 0;
+                                                ResultSet* record_set) = 0;
 
   // Updates an execution in the database.
   virtual absl::Status UpdateExecutionDirect(
@@ -352,6 +463,14 @@ class QueryExecutor {
       const absl::optional<Execution::State>& last_known_state,
       absl::Time update_time) = 0;
 
+  // Updates the last_known_state of an execution without reading it, if
+  // `update_last_known_state`, as UpdateArtifactFields.
+  virtual absl::Status UpdateExecutionFields(
+      int64 execution_id, absl::optional<int64> type_id,
+      absl::optional<int64> last_update_time, bool update_last_known_state,
+      const absl::optional<Execution::State>& last_known_state,
+      absl::Time update_time) = 0;
+
   // Checks the existence of the ExecutionProperty table.
   virtual absl::Status CheckExecutionPropertyTable() = 0;
 
@@ -361,11 +480,26 @@ class QueryExecutor {
                                                bool is_custom_property,
                                                const Value& value) = 0;
 
+  // Inserts properties of executions into the database with multi-row inserts.
+  virtual absl::Status InsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
+  // Inserts properties of executions, or updates the values of the existing
+  // ones, with multi-row upserts.
+  virtual absl::Status UpsertExecutionProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of executions matching the given 'ids'.
   // Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectExecutionPropertyByExecutionID(
-      absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+      absl::Span<const int64> execution_ids, ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectExecutionPropertyByExecutionID to `callback` in
+  // batches.
+  virtual absl::Status SelectExecutionPropertyByExecutionID(
+      absl::Span<const int64> execution_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
 
   // Updates a property of an execution from the database.
   virtual absl::Status UpdateExecutionProperty(int64 execution_id,
@@ -385,6 +519,11 @@ class QueryExecutor {
                                      const absl::Time update_time,
                                      int64* context_id) = 0;
 
+  // Inserts the `contexts` into the database as InsertArtifacts.
+  virtual absl::Status InsertContexts(absl::Span<const Context> contexts,
+                                      absl::Time create_time,
+                                      std::vector<int64>* context_ids) = 0;
+
   // Retrieves contexts from the database by their ids. For each context,
   // returns a row that contains the following columns (order not important):
   // - int: id
@@ -393,16 +532,34 @@ class QueryExecutor {
   // - int: create time (since epoch)
   // - int: last update time (since epoch)
   virtual absl::Status SelectContextsByID(absl::Span<const int64> context_ids,
-                                          RecordSet* record_set) = 0;
+                                          ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectContextsByID to `callback` in batches.
+  virtual absl::Status SelectContextsByID(
+      absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves contexts and their properties as
+  // SelectArtifactsWithPropertiesByID.
+  virtual absl::Status SelectContextsWithPropertiesByID(
+      absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
+
+  // Retrieves the ids of up to `max_num_ids` contexts with ids greater than
+  // `after_id` in ascending order, which walks the contexts by their primary
+  // key in batches.
+  virtual absl::Status SelectContextIDsAfterID(int64 after_id,
+                                               int64 max_num_ids,
+                                               ResultSet* record_set) = 0;
 
   // Returns ids of contexts matching the given context_type_id.
   virtual absl::Status SelectContextsByTypeID(int64 context_type_id,
-                                              RecordSet* record_set) = 0;
+                                              ResultSet* record_set) = 0;
 
   // Returns ids of contexts matching the given context_type_id and name.
   virtual absl::Status SelectContextByTypeIDAndContextName(
       int64 context_type_id, const absl::string_view name,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // Updates a context in the Context table.
   virtual absl::Status UpdateContextDirect(int64 existing_context_id,
@@ -410,6 +567,13 @@ class QueryExecutor {
                                            const std::string& context_name,
                                            const absl::Time update_time) = 0;
 
+  // Updates the name of a context without reading it, if `update_name`, as
+  // UpdateArtifactFields.
+  virtual absl::Status UpdateContextFields(
+      int64 context_id, absl::optional<int64> type_id,
+      absl::optional<int64> last_update_time, bool update_name,
+      const std::string& context_name, absl::Time update_time) = 0;
+
   // Checks the existence of the ContextProperty table.
   virtual absl::Status CheckContextPropertyTable() = 0;
 
@@ -419,10 +583,25 @@ class QueryExecutor {
                                              bool custom_property,
                                              const Value& value) = 0;
 
+  // Inserts properties of contexts into the database with multi-row inserts.
+  virtual absl::Status InsertContextProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
+  // Inserts properties of contexts, or updates the values of the existing
+  // ones, with multi-row upserts.
+  virtual absl::Status UpsertContextProperties(
+      absl::Span<const NodeProperty> properties) = 0;
+
   // Queries properties of contexts from the database by the
   // given context ids.
   virtual absl::Status SelectContextPropertyByContextID(
-      absl::Span<const int64> context_id, RecordSet* record_set) = 0;
+      absl::Span<const int64> context_id, ResultSet* record_set) = 0;
+
+  // Streams the rows of SelectContextPropertyByContextID to `callback` in
+  // batches.
+  virtual absl::Status SelectContextPropertyByContextID(
+      absl::Span<const int64> context_ids,
+      MetadataSource::RowBatchCallback callback) = 0;
 
   // Updates a property of a context in the database.
   virtual absl::Status UpdateContextProperty(
@@ -444,11 +623,11 @@ class QueryExecutor {
 
   // Queries events from the Event table by a collection of artifact ids.
   virtual absl::Status SelectEventByArtifactIDs(
-      absl::Span<const int64> artifact_ids, RecordSet* event_record_set) = 0;
+      absl::Span<const int64> artifact_ids, ResultSet* event_record_set) = 0;
 
   // Queries events from the Event table by a collection of execution ids.
   virtual absl::Status SelectEventByExecutionIDs(
-      absl::Span<const int64> execution_ids, RecordSet* event_record_set) = 0;
+      absl::Span<const int64> execution_ids, ResultSet* event_record_set) = 0;
 
   // Checks the existence of the EventPath table.
   virtual absl::Status CheckEventPathTable() = 0;
@@ -457,9 +636,14 @@ class QueryExecutor {
   virtual absl::Status InsertEventPath(int64 event_id,
                                        const Event::Path::Step& step) = 0;
 
+  // Inserts the steps of `path` into the EventPath table with multi-row
+  // inserts.
+  virtual absl::Status InsertEventPaths(int64 event_id,
+                                        const Event::Path& path) = 0;
+
   // Queries paths from the database by a collection of event ids.
   virtual absl::Status SelectEventPathByEventIDs(
-      absl::Span<const int64> event_ids, RecordSet* record_set) = 0;
+      absl::Span<const int64> event_ids, ResultSet* record_set) = 0;
 
   // Checks the existence of the Association table.
   virtual absl::Status CheckAssociationTable() = 0;
@@ -473,14 +657,14 @@ class QueryExecutor {
   // Column 1: int: context id
   // Column 2: int: execution id
   virtual absl::Status SelectAssociationByContextIDs(
-      absl::Span<const int64> context_id, RecordSet* record_set) = 0;
+      absl::Span<const int64> context_id, ResultSet* record_set) = 0;
 
   // Returns association triplets for the given context id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
   // Column 2: int: execution id
   virtual absl::Status SelectAssociationByExecutionID(
-      int64 execution_id, RecordSet* record_set) = 0;
+      int64 execution_id, ResultSet* record_set) = 0;
 
   // Checks the existence of the Attribution table.
   virtual absl::Status CheckAttributionTable() = 0;
@@ -495,14 +679,14 @@ class QueryExecutor {
   // Column 1: int: context id
   // Column 2: int: artifact id
   virtual absl::Status SelectAttributionByContextID(int64 context_id,
-                                                    RecordSet* record_set) = 0;
+                                                    ResultSet* record_set) = 0;
 
   // Returns attribution triplets for the given artifact id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
   // Column 2: int: artifact id
   virtual absl::Status SelectAttributionByArtifactID(int64 artifact_id,
-                                                     RecordSet* record_set) = 0;
+                                                     ResultSet* record_set) = 0;
 
   // Checks the existence of the ParentContext table.
   virtual absl::Status CheckParentContextTable() = 0;
@@ -516,13 +700,13 @@ class QueryExecutor {
   // Column 0: int: context id (= context_id)
   // Column 1: int: parent context id
   virtual absl::Status SelectParentContextsByContextID(
-      int64 context_id, RecordSet* record_set) = 0;
+      int64 context_id, ResultSet* record_set) = 0;
 
   // Returns child contexts for the given context id. Each record has:
   // Column 0: int: context id
   // Column 1: int: parent context id (= context_id)
   virtual absl::Status SelectChildContextsByContextID(
-      int64 context_id, RecordSet* record_set) = 0;
+      int64 context_id, ResultSet* record_set) = 0;
 
   // Checks the MLMDEnv table and query the schema version.
   // At MLMD release v0.13.2, by default it is v0.
@@ -534,6 +718,20 @@ class QueryExecutor {
   // Update schema_version
   virtual absl::Status UpdateSchemaVersion(int64 schema_version) = 0;
 
+  // Queries the type generation of the db, which is increased by the
+  // transactions changing the types, so that the types cached by the clients
+  // can be checked with a single query. The generation is read once per
+  // transaction. Sets `type_generation` to nullopt if the types cannot be
+  // cached, i.e., when no transaction is open, when the transaction has
+  // changed the types itself (its changes may still be rolled back), or when
+  // the db has an earlier schema without the type generation.
+  virtual absl::Status SelectTypeGeneration(
+      absl::optional<int64>* type_generation) = 0;
+
+  // Increases the type generation of the db, after the types are changed in
+  // the transaction. Does nothing if the db has an earlier schema.
+  virtual absl::Status IncrementTypeGeneration() = 0;
+
   // Check the database is a valid database produced by 0.13.2 MLMD release.
   // The schema version and migration are introduced after that release.
   virtual absl::Status CheckTablesIn_V0_13_2() = 0;
@@ -541,15 +739,15 @@ class QueryExecutor {
   // Note: these are not reflected in the original queries.
   // Select all artifact IDs.
   // Returns a list of IDs.
-  virtual absl::Status SelectAllArtifactIDs(RecordSet* set) = 0;
+  virtual absl::Status SelectAllArtifactIDs(ResultSet* set) = 0;
 
   // Select all execution IDs.
   // Returns a list of IDs.
-  virtual absl::Status SelectAllExecutionIDs(RecordSet* set) = 0;
+  virtual absl::Status SelectAllExecutionIDs(ResultSet* set) = 0;
 
   // Select all context IDs.
   // Returns a list of IDs.
-  virtual absl::Status SelectAllContextIDs(RecordSet* set) = 0;
+  virtual absl::Status SelectAllContextIDs(ResultSet* set) = 0;
 
   // List Artifact IDs using `options`. If `candidate_ids` is provided, then
   // returned result is only built using ids in the `candidate_ids`, when
@@ -558,7 +756,7 @@ class QueryExecutor {
   virtual absl::Status ListArtifactIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // List Execution IDs using `options`. If `candidate_ids` is provided, then
   // returned result is only built using ids in the `candidate_ids`, when
@@ -567,7 +765,7 @@ class QueryExecutor {
   virtual absl::Status ListExecutionIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
   // List Context IDs using `options`. If `candidate_ids` is provided, then
   // returned result is only built using ids in the `candidate_ids`, when
@@ -576,7 +774,7 @@ class QueryExecutor {
   virtual absl::Status ListContextIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set) = 0;
+      ResultSet* record_set) = 0;
 
 
   // Deletes a list of artifacts by id.
@@ -20,16 +20,23 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
 namespace testing {
 
+using ::testing::AnyOf;
+using ::testing::ElementsAre;
+
 constexpr absl::string_view kArtifactTypeRecordSet =
     R"pb(column_names: "id"
          column_names: "name"
@@ -79,11 +86,11 @@ constexpr absl::string_view kContextTypeRecordSet =
          }
     )pb";
 
-int GetIdColumnIndex(const RecordSet& record_set) {
+int GetIdColumnIndex(const ResultSet& record_set) {
   // For different backends, the index for column "id" varies.
   int id_column_index = -1;
-  for (int i = 0; i < record_set.column_names_size(); ++i) {
-    if (record_set.column_names()[i] == "id") {
+  for (int i = 0; i < record_set.num_columns(); ++i) {
+    if (record_set.column_name(i) == "id") {
       id_column_index = i;
       break;
     }
@@ -126,32 +133,35 @@ TEST_P(QueryExecutorTest, SelectTypesByID) {
   // Test select artifact types by ids.
   TypeKind type_kind = TypeKind::ARTIFACT_TYPE;
   std::vector<int64> type_ids = {type_id_1, type_id_2};
-  RecordSet artifact_record_set;
+  ResultSet artifact_record_set;
   ASSERT_EQ(absl::OkStatus(), query_executor_->SelectTypesByID(
                                   type_ids, type_kind, &artifact_record_set));
   RecordSet expected_record_set = testing::ParseTextProtoOrDie<RecordSet>(
       std::string(kArtifactTypeRecordSet));
-  EXPECT_THAT(artifact_record_set, testing::EqualsProto(expected_record_set));
+  EXPECT_THAT(artifact_record_set.ToRecordSet(),
+              testing::EqualsProto(expected_record_set));
 
   // Test select execution types by ids.
   type_kind = TypeKind::EXECUTION_TYPE;
   type_ids = {type_id_3, type_id_4};
-  RecordSet execution_record_set;
+  ResultSet execution_record_set;
   ASSERT_EQ(absl::OkStatus(), query_executor_->SelectTypesByID(
                                   type_ids, type_kind, &execution_record_set));
   expected_record_set = testing::ParseTextProtoOrDie<RecordSet>(
       std::string(kExecutionTypeRecordSet));
-  EXPECT_THAT(execution_record_set, testing::EqualsProto(expected_record_set));
+  EXPECT_THAT(execution_record_set.ToRecordSet(),
+              testing::EqualsProto(expected_record_set));
 
   // Test select context types by ids.
   type_kind = TypeKind::CONTEXT_TYPE;
   type_ids = {type_id_5};
-  RecordSet context_record_set;
+  ResultSet context_record_set;
   ASSERT_EQ(absl::OkStatus(), query_executor_->SelectTypesByID(
                                   type_ids, type_kind, &context_record_set));
   expected_record_set = testing::ParseTextProtoOrDie<RecordSet>(
       std::string(kContextTypeRecordSet));
-  EXPECT_THAT(context_record_set, testing::EqualsProto(expected_record_set));
+  EXPECT_THAT(context_record_set.ToRecordSet(),
+              testing::EqualsProto(expected_record_set));
 }
 
 TEST_P(QueryExecutorTest, SelectTypesByIDWithMixedTypeIDKinds) {
@@ -173,12 +183,12 @@ TEST_P(QueryExecutorTest, SelectTypesByIDWithMixedTypeIDKinds) {
   // Test select artifact types with a mixture of artifact and context type ids.
   TypeKind type_kind = TypeKind::ARTIFACT_TYPE;
   std::vector<int64> type_ids = {type_id_1, type_id_3};
-  RecordSet record_set;
+  ResultSet record_set;
   ASSERT_EQ(absl::OkStatus(),
             query_executor_->SelectTypesByID(type_ids, type_kind, &record_set));
   // Verify that only artifact with `type_id_1` is retrieved.
-  ASSERT_EQ(record_set.records_size(), 1);
-  EXPECT_EQ(record_set.records(0).values(1), "artifact_type_1");
+  ASSERT_EQ(record_set.num_rows(), 1);
+  EXPECT_EQ(record_set.ToString(0, 1), "artifact_type_1");
 }
 
 TEST_P(QueryExecutorTest, DeleteContextsById) {
@@ -247,66 +257,66 @@ TEST_P(QueryExecutorTest, DeleteContextsById) {
   // Test: empty ids
   {
     ASSERT_EQ(absl::OkStatus(), query_executor_->DeleteContextsById({}));
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectContextsByID(
                                     {context_id_1, context_id_2}, &record_set));
-    EXPECT_EQ(record_set.records_size(), 2);
+    EXPECT_EQ(record_set.num_rows(), 2);
   }
   // Test: actual deletion on context1
   {
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->DeleteContextsById({context_id_1}));
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectContextsByID(
                                     {context_id_1, context_id_2}, &record_set));
 
     // Verify: context1 was deleted; context2 still remains.
-    ASSERT_EQ(record_set.records_size(), 1);
+    ASSERT_EQ(record_set.num_rows(), 1);
     // For different backends, the index for column "id" varies.
     const int id_column_index = GetIdColumnIndex(record_set);
     ASSERT_GE(id_column_index, 0);
-    EXPECT_EQ(record_set.records(0).values(id_column_index),
+    EXPECT_EQ(record_set.ToString(0, id_column_index),
               std::to_string(context_id_2));
 
     // Verify: context properties for context1 were also deleted.
-    RecordSet property_record_set;
+    ResultSet property_record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectContextPropertyByContextID(
                   {context_id_1}, &property_record_set));
-    EXPECT_EQ(property_record_set.records_size(), 0);
+    EXPECT_EQ(property_record_set.num_rows(), 0);
 
     // Verify: arrtibution and association for context1 were not deleted.
-    RecordSet attribution_set, association_set;
+    ResultSet attribution_set, association_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectAttributionByContextID(
                                     context_id_1, &attribution_set));
-    EXPECT_EQ(attribution_set.records_size(), 1);
+    EXPECT_EQ(attribution_set.num_rows(), 1);
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectAssociationByContextIDs(
                                     {context_id_1}, &association_set));
-    EXPECT_EQ(association_set.records_size(), 1);
+    EXPECT_EQ(association_set.num_rows(), 1);
   }
   // Test: context id was wrong when deleting context2
   {
     // Still returns OK status when `context_id_2 + 1` is not found.
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->DeleteContextsById({context_id_2 + 1}));
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectContextsByID({context_id_2}, &record_set));
 
     // Verify: context2 remains because context id was wrong when deleting it.
-    ASSERT_EQ(record_set.records_size(), 1);
+    ASSERT_EQ(record_set.num_rows(), 1);
     // For different backends, the index for column "id" varies.
     const int id_column_index = GetIdColumnIndex(record_set);
     ASSERT_GE(id_column_index, 0);
-    EXPECT_EQ(record_set.records(0).values(id_column_index),
+    EXPECT_EQ(record_set.ToString(0, id_column_index),
               std::to_string(context_id_2));
 
     // Verify: context properties for context2 also remain.
-    RecordSet property_record_set;
+    ResultSet property_record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectContextPropertyByContextID(
                   {context_id_2}, &property_record_set));
-    EXPECT_EQ(property_record_set.records_size(), 1);
+    EXPECT_EQ(property_record_set.num_rows(), 1);
   }
 }
 
@@ -357,57 +367,57 @@ TEST_P(QueryExecutorTest, SelectParentTypesByTypeID) {
 
   // Test: empty ids
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectParentTypesByTypeID({}, &record_set));
-    EXPECT_EQ(record_set.records_size(), 0);
+    EXPECT_EQ(record_set.num_rows(), 0);
   }
   // Test: select parent type ids for a type without parent types.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectParentTypesByTypeID(
                                     {context_type_id}, &record_set));
-    EXPECT_EQ(record_set.records_size(), 0);
+    EXPECT_EQ(record_set.num_rows(), 0);
   }
   // Test: select a parent type that does not exist.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectParentTypesByTypeID(
                                     {execution_type_id}, &record_set));
-    ASSERT_EQ(record_set.records_size(), 2);
-    EXPECT_EQ(record_set.records(0).values(0),
+    ASSERT_EQ(record_set.num_rows(), 2);
+    EXPECT_EQ(record_set.ToString(0, 0),
               std::to_string(execution_type_id));
-    EXPECT_EQ(record_set.records(0).values(1),
+    EXPECT_EQ(record_set.ToString(0, 1),
               std::to_string(parent_execution_type_id));
     // Verify: the record is still returned although the type does not exist
     // because it only stores type ids.
-    EXPECT_EQ(record_set.records(1).values(0),
+    EXPECT_EQ(record_set.ToString(1, 0),
               std::to_string(execution_type_id));
-    EXPECT_EQ(record_set.records(1).values(1),
+    EXPECT_EQ(record_set.ToString(1, 1),
               std::to_string(non_exist_parent_type_id));
   }
   // Test: select parent type ids for a mixture of context, artifact and
   // execution type ids.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectParentTypesByTypeID(
                   {context_type_id, artifact_type_id, execution_type_id},
                   &record_set));
     // Verify: SelectParentTypesByTypeID can return a mixture of different type
     // kinds because it only stores type ids.
-    ASSERT_EQ(record_set.records_size(), 3);
-    EXPECT_EQ(record_set.records(0).values(0),
+    ASSERT_EQ(record_set.num_rows(), 3);
+    EXPECT_EQ(record_set.ToString(0, 0),
               std::to_string(artifact_type_id));
-    EXPECT_EQ(record_set.records(0).values(1),
+    EXPECT_EQ(record_set.ToString(0, 1),
               std::to_string(parent_artifact_type_id));
-    EXPECT_EQ(record_set.records(1).values(0),
+    EXPECT_EQ(record_set.ToString(1, 0),
               std::to_string(execution_type_id));
-    EXPECT_EQ(record_set.records(1).values(1),
+    EXPECT_EQ(record_set.ToString(1, 1),
               std::to_string(parent_execution_type_id));
-    EXPECT_EQ(record_set.records(2).values(0),
+    EXPECT_EQ(record_set.ToString(2, 0),
               std::to_string(execution_type_id));
-    EXPECT_EQ(record_set.records(2).values(1),
+    EXPECT_EQ(record_set.ToString(2, 1),
               std::to_string(non_exist_parent_type_id));
   }
 }
@@ -440,67 +450,217 @@ TEST_P(QueryExecutorTest, SelectPropertiesByTypeID) {
 
   // Test: empty ids
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectPropertiesByTypeID({}, &record_set));
-    EXPECT_EQ(record_set.records_size(), 0);
+    EXPECT_EQ(record_set.num_rows(), 0);
   }
   // Test: select a type with no type properties.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectPropertiesByTypeID(
                                     {artifact_type_id_2}, &record_set));
-    ASSERT_EQ(record_set.records_size(), 0);
+    ASSERT_EQ(record_set.num_rows(), 0);
   }
 
   // Test: select properties for multiple type ids.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectPropertiesByTypeID(
                   {artifact_type_id_1, artifact_type_id_2}, &record_set));
-    ASSERT_EQ(record_set.records_size(), 2);
-    EXPECT_EQ(record_set.records(0).values(0),
+    ASSERT_EQ(record_set.num_rows(), 2);
+    EXPECT_EQ(record_set.ToString(0, 0),
               std::to_string(artifact_type_id_1));
-    EXPECT_EQ(record_set.records(0).values(1), "property_1");
-    EXPECT_EQ(record_set.records(0).values(2),
+    EXPECT_EQ(record_set.ToString(0, 1), "property_1");
+    EXPECT_EQ(record_set.ToString(0, 2),
               std::to_string(PropertyType::INT));
 
-    EXPECT_EQ(record_set.records(1).values(0),
+    EXPECT_EQ(record_set.ToString(1, 0),
               std::to_string(artifact_type_id_1));
-    EXPECT_EQ(record_set.records(1).values(1), "property_2");
-    EXPECT_EQ(record_set.records(1).values(2),
+    EXPECT_EQ(record_set.ToString(1, 1), "property_2");
+    EXPECT_EQ(record_set.ToString(1, 2),
               std::to_string(PropertyType::STRING));
   }
   // Test: select properties for type ids of a mixture of context and artifact
   // types.
   {
-    RecordSet record_set;
+    ResultSet record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectPropertiesByTypeID(
                   {context_type_id, artifact_type_id_1, artifact_type_id_2},
                   &record_set));
     // Verify: SelectPropertiesByTypeID can return a mixture of different type
     // kinds because it only stores type ids.
-    ASSERT_EQ(record_set.records_size(), 3);
-    EXPECT_EQ(record_set.records(0).values(0), std::to_string(context_type_id));
-    EXPECT_EQ(record_set.records(0).values(1), "property_1");
-    EXPECT_EQ(record_set.records(0).values(2),
+    ASSERT_EQ(record_set.num_rows(), 3);
+    EXPECT_EQ(record_set.ToString(0, 0), std::to_string(context_type_id));
+    EXPECT_EQ(record_set.ToString(0, 1), "property_1");
+    EXPECT_EQ(record_set.ToString(0, 2),
               std::to_string(PropertyType::INT));
 
-    EXPECT_EQ(record_set.records(1).values(0),
+    EXPECT_EQ(record_set.ToString(1, 0),
               std::to_string(artifact_type_id_1));
-    EXPECT_EQ(record_set.records(1).values(1), "property_1");
-    EXPECT_EQ(record_set.records(1).values(2),
+    EXPECT_EQ(record_set.ToString(1, 1), "property_1");
+    EXPECT_EQ(record_set.ToString(1, 2),
               std::to_string(PropertyType::INT));
 
-    EXPECT_EQ(record_set.records(2).values(0),
+    EXPECT_EQ(record_set.ToString(2, 0),
               std::to_string(artifact_type_id_1));
-    EXPECT_EQ(record_set.records(2).values(1), "property_2");
-    EXPECT_EQ(record_set.records(2).values(2),
+    EXPECT_EQ(record_set.ToString(2, 1), "property_2");
+    EXPECT_EQ(record_set.ToString(2, 2),
               std::to_string(PropertyType::STRING));
   }
 }
 
+TEST_P(QueryExecutorTest, BatchWrites) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(), query_executor_->InsertArtifactType(
+                                  "artifact_type", absl::nullopt, absl::nullopt,
+                                  &artifact_type_id));
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->InsertArtifact(
+                artifact_type_id, "/foo/bar", absl::nullopt, "artifact",
+                absl::Now(), absl::Now(), &artifact_id));
+  Value int_value;
+  int_value.set_int_value(3);
+
+  // The writes are queued until the batch ends.
+  ASSERT_EQ(absl::OkStatus(), query_executor_->BatchWrites([&]() {
+    for (const char* name : {"property_1", "property_2", "property_3"}) {
+      MLMD_RETURN_IF_ERROR(query_executor_->InsertArtifactProperty(
+          artifact_id, name, /*is_custom_property=*/true, int_value));
+    }
+    ResultSet record_set;
+    MLMD_RETURN_IF_ERROR(query_executor_->SelectArtifactPropertyByArtifactID(
+        {artifact_id}, &record_set));
+    EXPECT_EQ(0, record_set.num_rows());
+    return query_executor_->DeleteArtifactProperty(artifact_id, "property_2");
+  }));
+  ResultSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->SelectArtifactPropertyByArtifactID({artifact_id},
+                                                                &record_set));
+  ASSERT_EQ(2, record_set.num_rows());
+
+  // The writes queued by a failed batch are dropped.
+  EXPECT_TRUE(absl::IsCancelled(query_executor_->BatchWrites([&]() {
+    MLMD_RETURN_IF_ERROR(query_executor_->DeleteArtifactProperty(
+        artifact_id, "property_1"));
+    return absl::CancelledError("stopped");
+  })));
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->SelectArtifactPropertyByArtifactID({artifact_id},
+                                                                &record_set));
+  EXPECT_EQ(2, record_set.num_rows());
+}
+
+TEST_P(QueryExecutorTest, InsertArtifactsAndProperties) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(), query_executor_->InsertArtifactType(
+                                  "artifact_type", absl::nullopt, absl::nullopt,
+                                  &artifact_type_id));
+  int64 artifact_0_id;
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->InsertArtifact(
+                artifact_type_id, "/foo/bar", absl::nullopt, "artifact_0",
+                absl::Now(), absl::Now(), &artifact_0_id));
+
+  // More artifacts than a single statement inserts.
+  std::vector<Artifact> artifacts(1201);
+  for (int i = 0; i < artifacts.size(); ++i) {
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_uri("/foo/bar");
+    artifacts[i].set_name(absl::StrCat("artifact_", i + 1));
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), query_executor_->InsertArtifacts(
+                                  artifacts, absl::Now(), &artifact_ids));
+  ASSERT_EQ(artifacts.size(), artifact_ids.size());
+  for (int i = 0; i < artifact_ids.size(); ++i) {
+    EXPECT_EQ(artifact_0_id + i + 1, artifact_ids[i]);
+  }
+  ResultSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->SelectArtifactByTypeIDAndArtifactName(
+                artifact_type_id, "artifact_1000", &record_set));
+  ASSERT_EQ(1, record_set.num_rows());
+  EXPECT_EQ(std::to_string(artifact_ids[999]), record_set.ToString(0, 0));
+
+  Value int_value;
+  int_value.set_int_value(3);
+  Value string_value;
+  string_value.set_string_value("it's");
+  const std::vector<QueryExecutor::NodeProperty> properties = {
+      {artifact_ids[0], "property_1", /*is_custom_property=*/false, &int_value},
+      {artifact_ids[0], "property_2", /*is_custom_property=*/true,
+       &string_value},
+      {artifact_ids[1], "property_1", /*is_custom_property=*/false,
+       &int_value}};
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->InsertArtifactProperties(properties));
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->SelectArtifactPropertyByArtifactID(
+                {artifact_ids[0]}, &record_set));
+  ASSERT_EQ(2, record_set.num_rows());
+  for (int row = 0; row < record_set.num_rows(); ++row) {
+    if (record_set.ToString(row, 1) == "property_1") {
+      EXPECT_EQ("3", record_set.ToString(row, 3));
+    } else {
+      EXPECT_EQ("it's", record_set.ToString(row, 5));
+    }
+  }
+}
+
+TEST_P(QueryExecutorTest, SelectArtifactsWithPropertiesByID) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(), query_executor_->InsertArtifactType(
+                                  "artifact_type", absl::nullopt, absl::nullopt,
+                                  &artifact_type_id));
+  std::vector<int64> artifact_ids(3);
+  for (int64& artifact_id : artifact_ids) {
+    ASSERT_EQ(absl::OkStatus(),
+              query_executor_->InsertArtifact(
+                  artifact_type_id, "/foo/bar", absl::nullopt, absl::nullopt,
+                  absl::Now(), absl::Now(), &artifact_id));
+  }
+  Value int_value;
+  int_value.set_int_value(3);
+  for (const char* name : {"property_1", "property_2"}) {
+    ASSERT_EQ(absl::OkStatus(), query_executor_->InsertArtifactProperty(
+                                    artifact_ids[2], name,
+                                    /*is_custom_property=*/true, int_value));
+  }
+
+  // The artifacts are joined with their properties, and sorted by id.
+  std::vector<int64> ids;
+  std::vector<std::string> property_names;
+  ASSERT_EQ(absl::OkStatus(),
+            query_executor_->SelectArtifactsWithPropertiesByID(
+                {artifact_ids[2], artifact_ids[0]},
+                [&](const ResultSet& rows) {
+                  const int id_column = rows.FindColumn("id");
+                  const int property_column = rows.FindColumn("property_name");
+                  EXPECT_GE(id_column, 0);
+                  EXPECT_GE(property_column, 0);
+                  for (int row = 0; row < rows.num_rows(); ++row) {
+                    ids.push_back(rows.GetInt(row, id_column));
+                    property_names.push_back(
+                        rows.IsNull(row, property_column)
+                            ? "NULL"
+                            : rows.ToString(row, property_column));
+                  }
+                  return absl::OkStatus();
+                }));
+  EXPECT_THAT(ids, ElementsAre(artifact_ids[0], artifact_ids[2],
+                               artifact_ids[2]));
+  EXPECT_THAT(property_names,
+              ElementsAre("NULL", AnyOf("property_1", "property_2"),
+                          AnyOf("property_1", "property_2")));
+}
+
 }  // namespace testing
 }  // namespace ml_metadata
@@ -0,0 +1,205 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/query_template.h"
+
+#include <atomic>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace ml_metadata {
+namespace {
+
+// The id of the next template which is reused.
+std::atomic<int64> next_template_id{1};
+
+// Returns true if `parameter` is bound to the prepared statement at `segment`.
+bool IsBound(const QueryTemplate::Segment& segment,
+             const QueryParameter& parameter) {
+  return !segment.is_quoted && parameter.is_value();
+}
+
+}  // namespace
+
+QueryParameter QueryParameter::Int(const int64 value) {
+  QueryParameter parameter;
+  parameter.type_ = Type::kInt;
+  parameter.int_value_ = value;
+  return parameter;
+}
+
+QueryParameter QueryParameter::Double(const double value) {
+  QueryParameter parameter;
+  parameter.type_ = Type::kDouble;
+  parameter.double_value_ = value;
+  return parameter;
+}
+
+QueryParameter QueryParameter::String(std::string value) {
+  QueryParameter parameter;
+  parameter.type_ = Type::kString;
+  parameter.text_ = std::move(value);
+  return parameter;
+}
+
+QueryParameter QueryParameter::Identifier(std::string name) {
+  QueryParameter parameter;
+  parameter.type_ = Type::kIdentifier;
+  parameter.text_ = std::move(name);
+  return parameter;
+}
+
+QueryParameter QueryParameter::Sql(std::string sql) {
+  QueryParameter parameter;
+  parameter.type_ = Type::kSql;
+  parameter.text_ = std::move(sql);
+  return parameter;
+}
+
+void QueryParameter::AppendTo(const EscapeStringFn escape_string,
+                              std::string* query) const {
+  switch (type_) {
+    case Type::kNull:
+      query->append("NULL");
+      break;
+    case Type::kInt:
+      absl::StrAppend(query, int_value_);
+      break;
+    case Type::kDouble:
+      // The doubles are written with all their digits, so that they are read
+      // back as the same value.
+      absl::StrAppendFormat(query, "%.17g", double_value_);
+      break;
+    case Type::kString:
+      absl::StrAppend(query, "'", escape_string(text_), "'");
+      break;
+    case Type::kIdentifier:
+    case Type::kSql:
+      query->append(text_);
+      break;
+  }
+}
+
+QueryTemplate::QueryTemplate(const absl::string_view query_template,
+                             const bool is_reused)
+    : id_(is_reused ? next_template_id.fetch_add(1) : 0),
+      query_(query_template) {
+  // The quote character of the quoted identifier or string being scanned.
+  char quote = 0;
+  size_t offset = 0;
+  for (size_t i = 0; i < query_.size(); ++i) {
+    const char c = query_[i];
+    if (c == '$' && i + 1 < query_.size() &&
+        absl::ascii_isdigit(query_[i + 1])) {
+      Segment segment;
+      segment.offset = offset;
+      segment.size = i - offset;
+      segment.parameter_index = 0;
+      size_t end = i + 1;
+      for (; end < query_.size() && absl::ascii_isdigit(query_[end]); ++end) {
+        segment.parameter_index = segment.parameter_index * 10 +
+                                  (query_[end] - '0');
+      }
+      segment.placeholder_size = end - i;
+      segment.is_quoted = quote != 0;
+      segments_.push_back(segment);
+      offset = end;
+      i = end - 1;
+    } else if (quote != 0) {
+      if (c == quote) quote = 0;
+    } else if (c == '`' || c == '\'' || c == '"') {
+      quote = c;
+    }
+  }
+  Segment last_segment;
+  last_segment.offset = offset;
+  last_segment.size = query_.size() - offset;
+  segments_.push_back(last_segment);
+}
+
+std::string QueryTemplate::Substitute(
+    const absl::Span<const QueryParameter> parameters,
+    const EscapeStringFn escape_string) const {
+  std::string query;
+  AppendTo(parameters, escape_string, /*bind_values=*/false, &query);
+  return query;
+}
+
+bool QueryTemplate::GetPreparedStatementKey(
+    const absl::Span<const QueryParameter> parameters,
+    PreparedStatementKey* key,
+    std::vector<const QueryParameter*>* bound_values) const {
+  key->template_id = id_;
+  key->bound_placeholders = 0;
+  key->substituted_parameters.clear();
+  // The statements of more placeholders than the bits of the key are not told
+  // apart, so they are not reused.
+  bool is_reusable = id_ != 0 && segments_.size() - 1 <= 64;
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const Segment& segment = segments_[i];
+    const int index = segment.parameter_index;
+    if (index < 0 || index >= parameters.size()) continue;
+    const QueryParameter& parameter = parameters[index];
+    if (IsBound(segment, parameter)) {
+      bound_values->push_back(&parameter);
+      if (i < 64) key->bound_placeholders |= std::uint64_t{1} << i;
+    } else {
+      is_reusable = is_reusable &&
+                    parameter.type() == QueryParameter::Type::kIdentifier;
+      key->substituted_parameters.append(parameter.text());
+      // Tells the parameters apart, as an identifier has no NUL character.
+      key->substituted_parameters.push_back('\0');
+    }
+  }
+  return is_reusable;
+}
+
+std::string QueryTemplate::ComposePreparedStatement(
+    const absl::Span<const QueryParameter> parameters,
+    const EscapeStringFn escape_string) const {
+  std::string statement;
+  AppendTo(parameters, escape_string, /*bind_values=*/true, &statement);
+  return statement;
+}
+
+void QueryTemplate::AppendTo(const absl::Span<const QueryParameter> parameters,
+                             const EscapeStringFn escape_string,
+                             const bool bind_values,
+                             std::string* query) const {
+  size_t size = query->size() + query_.size();
+  for (const Segment& segment : segments_) {
+    if (segment.parameter_index >= 0 &&
+        segment.parameter_index < parameters.size()) {
+      size += parameters[segment.parameter_index].text().size() + 2;
+    }
+  }
+  query->reserve(size);
+  for (const Segment& segment : segments_) {
+    absl::StrAppend(query, text(segment));
+    const int index = segment.parameter_index;
+    if (index < 0) continue;
+    if (index >= parameters.size()) {
+      absl::StrAppend(query, placeholder(segment));
+    } else if (bind_values && IsBound(segment, parameters[index])) {
+      query->push_back('?');
+    } else {
+      parameters[index].AppendTo(escape_string, query);
+    }
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,191 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_QUERY_TEMPLATE_H_
+#define ML_METADATA_METADATA_STORE_QUERY_TEMPLATE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Escapes `value` to be quoted as a string literal of the backend, see
+// MetadataSource::EscapeString.
+using EscapeStringFn = absl::FunctionRef<std::string(absl::string_view value)>;
+
+// A parameter of a template query, as composed by QueryConfigExecutor::Bind.
+// The values, i.e., numbers, strings and nulls, are bound as they are to the
+// prepared statements of the backends, and the identifiers, e.g., column
+// names, and the SQL fragments, e.g., id lists, are substituted into the text
+// of the statements.
+class QueryParameter {
+ public:
+  enum class Type { kNull, kInt, kDouble, kString, kIdentifier, kSql };
+
+  // Creates a null value.
+  QueryParameter() = default;
+
+  static QueryParameter Int(int64 value);
+  static QueryParameter Double(double value);
+  static QueryParameter String(std::string value);
+
+  // `name` must be an SQL identifier, e.g., a column name.
+  static QueryParameter Identifier(std::string name);
+
+  // `sql` is substituted as is, so the strings in it must be escaped with
+  // EscapeString.
+  static QueryParameter Sql(std::string sql);
+
+  Type type() const { return type_; }
+
+  // Returns true if the parameter is a value, which can be bound.
+  bool is_value() const {
+    return type_ != Type::kIdentifier && type_ != Type::kSql;
+  }
+
+  int64 int_value() const { return int_value_; }
+  double double_value() const { return double_value_; }
+
+  // Returns the string value, the identifier or the SQL fragment.
+  const std::string& text() const { return text_; }
+
+  // Appends the parameter to the text of `query`. The values are appended as
+  // SQL literals, whose strings are escaped with `escape_string`.
+  void AppendTo(EscapeStringFn escape_string, std::string* query) const;
+
+ private:
+  Type type_ = Type::kNull;
+  int64 int_value_ = 0;
+  double double_value_ = 0;
+  std::string text_;
+};
+
+// Identifies the prepared statement of a template query, as computed by
+// QueryTemplate::GetPreparedStatementKey, so that the cached statement is found
+// without composing its text.
+struct PreparedStatementKey {
+  int64 template_id = 0;
+  // The bit `i` is set if the `i`-th placeholder of the template is bound to a
+  // `?` host parameter.
+  std::uint64_t bound_placeholders = 0;
+  // The parameters substituted into the text, each followed by a NUL, which
+  // is empty if all the parameters are bound.
+  std::string substituted_parameters;
+
+  bool operator==(const PreparedStatementKey& other) const {
+    return template_id == other.template_id &&
+           bound_placeholders == other.bound_placeholders &&
+           substituted_parameters == other.substituted_parameters;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const PreparedStatementKey& key) {
+    return H::combine(std::move(h), key.template_id, key.bound_placeholders,
+                      key.substituted_parameters);
+  }
+};
+
+// A template query whose placeholders `$0`, `$1`, ... are found once, when it
+// is compiled, so that it is rendered with its parameters into a single buffer
+// instead of being scanned again for each query. A placeholder is a `$`
+// followed by all the digits after it, e.g., `$10` is the 11th parameter.
+class QueryTemplate {
+ public:
+  // The text of the template before a placeholder, or after the last one.
+  struct Segment {
+    // The offset and size of the text in the template.
+    size_t offset = 0;
+    size_t size = 0;
+    // The index of the placeholder which follows the text, or -1 if the text
+    // ends the template.
+    int parameter_index = -1;
+    // The size of the placeholder, e.g., 2 for `$1` and 3 for `$10`.
+    size_t placeholder_size = 0;
+    // True if the placeholder is within a quoted identifier or string.
+    bool is_quoted = false;
+  };
+
+  // Compiles `query_template`, which is given a new id, e.g., to key the
+  // prepared statements of the backends, unless it is not `is_reused`.
+  explicit QueryTemplate(absl::string_view query_template,
+                         bool is_reused = true);
+
+  // Returns the id of the template, which its copies share, or 0 if it is
+  // compiled for a single query.
+  int64 id() const { return id_; }
+
+  // Returns the text of the template.
+  const std::string& query() const { return query_; }
+
+  // Returns the segments of the template in order.
+  absl::Span<const Segment> segments() const { return segments_; }
+
+  // Returns the text of `segment`.
+  absl::string_view text(const Segment& segment) const {
+    return absl::string_view(query_).substr(segment.offset, segment.size);
+  }
+
+  // Returns the placeholder which follows `segment`, e.g., `$1`.
+  absl::string_view placeholder(const Segment& segment) const {
+    return absl::string_view(query_).substr(segment.offset + segment.size,
+                                            segment.placeholder_size);
+  }
+
+  // Returns the query whose placeholders are substituted by the `parameters`,
+  // which are appended as QueryParameter::AppendTo. The placeholders without
+  // a parameter are kept.
+  std::string Substitute(absl::Span<const QueryParameter> parameters,
+                         EscapeStringFn escape_string) const;
+
+  // Sets `key` to the key of the prepared statement of the template with the
+  // `parameters`, and appends the values bound to its `?` host parameters to
+  // `bound_values` in order. The values are bound unless they are within quotes
+  // in the template, and the other parameters, e.g., id lists and column names,
+  // are substituted. Returns false if the statement is unlikely to be run
+  // again, i.e., if a parameter other than an identifier is substituted, or the
+  // template is compiled for a single query.
+  bool GetPreparedStatementKey(
+      absl::Span<const QueryParameter> parameters, PreparedStatementKey* key,
+      std::vector<const QueryParameter*>* bound_values) const;
+
+  // Returns the statement to prepare with the key of GetPreparedStatementKey,
+  // in which the bound values are `?` host parameters, and the other
+  // parameters are substituted as Substitute.
+  std::string ComposePreparedStatement(
+      absl::Span<const QueryParameter> parameters,
+      EscapeStringFn escape_string) const;
+
+ private:
+  // Appends the template to `query`, with its placeholders substituted as
+  // Substitute, or replaced by `?` where GetPreparedStatementKey binds the
+  // values if `bind_values`.
+  void AppendTo(absl::Span<const QueryParameter> parameters,
+                EscapeStringFn escape_string, bool bind_values,
+                std::string* query) const;
+
+  int64 id_ = 0;
+  std::string query_;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_QUERY_TEMPLATE_H_
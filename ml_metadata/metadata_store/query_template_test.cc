@@ -0,0 +1,172 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/query_template.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+
+namespace ml_metadata {
+namespace {
+
+// Escapes strings by doubling their quotes.
+std::string EscapeDoubledQuotes(const absl::string_view value) {
+  return absl::StrReplaceAll(value, {{"'", "''"}});
+}
+
+TEST(QueryTemplateTest, Substitute) {
+  const QueryTemplate query_template(
+      "UPDATE `t` SET `$0` = $1 WHERE `id` IN ($2) AND `c` = $1;");
+  EXPECT_EQ(
+      "UPDATE `t` SET `c1` = 'v' WHERE `id` IN (1, 2) AND `c` = 'v';",
+      query_template.Substitute({QueryParameter::Identifier("c1"),
+                                 QueryParameter::String("v"),
+                                 QueryParameter::Sql("1, 2")},
+                                EscapeDoubledQuotes));
+  // The placeholders without a parameter are kept.
+  EXPECT_EQ("UPDATE `t` SET `c1` = 'v' WHERE `id` IN ($2) AND `c` = 'v';",
+            query_template.Substitute({QueryParameter::Identifier("c1"),
+                                       QueryParameter::String("v")},
+                                      EscapeDoubledQuotes));
+  // A parameter is not scanned for placeholders.
+  EXPECT_EQ(
+      "UPDATE `t` SET `c1` = '$2' WHERE `id` IN (3) AND `c` = '$2';",
+      query_template.Substitute({QueryParameter::Identifier("c1"),
+                                 QueryParameter::String("$2"),
+                                 QueryParameter::Sql("3")},
+                                EscapeDoubledQuotes));
+}
+
+TEST(QueryTemplateTest, AppendParameter) {
+  std::string query;
+  QueryParameter().AppendTo(EscapeDoubledQuotes, &query);
+  query.append(", ");
+  QueryParameter::Int(-42).AppendTo(EscapeDoubledQuotes, &query);
+  query.append(", ");
+  QueryParameter::Double(0.1).AppendTo(EscapeDoubledQuotes, &query);
+  query.append(", ");
+  QueryParameter::String("it's").AppendTo(EscapeDoubledQuotes, &query);
+  query.append(", ");
+  QueryParameter::Identifier("int_value").AppendTo(EscapeDoubledQuotes,
+                                                   &query);
+  EXPECT_EQ("NULL, -42, 0.10000000000000001, 'it''s', int_value", query);
+}
+
+TEST(QueryTemplateTest, Id) {
+  const QueryTemplate query_template("SELECT $0");
+  EXPECT_NE(0, query_template.id());
+  EXPECT_EQ(query_template.id(), QueryTemplate(query_template).id());
+  EXPECT_NE(query_template.id(), QueryTemplate("SELECT $0").id());
+  EXPECT_EQ(0, QueryTemplate("SELECT $0", /*is_reused=*/false).id());
+}
+
+TEST(QueryTemplateTest, GetPreparedStatementKey) {
+  const QueryTemplate query_template(
+      "UPDATE `t` SET `$0` = $1 WHERE `id` = $2;");
+  const std::vector<QueryParameter> parameters = {
+      QueryParameter::Identifier("string_value"),
+      QueryParameter::String("it's"), QueryParameter::Int(3)};
+  PreparedStatementKey key;
+  std::vector<const QueryParameter*> bound_values;
+  EXPECT_TRUE(
+      query_template.GetPreparedStatementKey(parameters, &key, &bound_values));
+  ASSERT_EQ(2, bound_values.size());
+  EXPECT_EQ("it's", bound_values[0]->text());
+  EXPECT_EQ(3, bound_values[1]->int_value());
+  EXPECT_EQ("UPDATE `t` SET `string_value` = ? WHERE `id` = ?;",
+            query_template.ComposePreparedStatement(parameters,
+                                                    EscapeDoubledQuotes));
+
+  // The statements of other values share the key, unlike the ones of other
+  // identifiers or templates.
+  PreparedStatementKey same_key;
+  bound_values.clear();
+  EXPECT_TRUE(query_template.GetPreparedStatementKey(
+      {QueryParameter::Identifier("string_value"), QueryParameter(),
+       QueryParameter::Int(4)},
+      &same_key, &bound_values));
+  EXPECT_EQ(key, same_key);
+  PreparedStatementKey other_key;
+  bound_values.clear();
+  query_template.GetPreparedStatementKey(
+      {QueryParameter::Identifier("int_value"), QueryParameter::Int(1),
+       QueryParameter::Int(4)},
+      &other_key, &bound_values);
+  EXPECT_FALSE(key == other_key);
+  bound_values.clear();
+  QueryTemplate(query_template.query())
+      .GetPreparedStatementKey(parameters, &other_key, &bound_values);
+  EXPECT_FALSE(key == other_key);
+}
+
+TEST(QueryTemplateTest, DoesNotReuseSubstitutedSql) {
+  const QueryTemplate query_template(
+      "SELECT * FROM `t` WHERE `id` IN ($0) AND `type` = $1;");
+  const std::vector<QueryParameter> parameters = {QueryParameter::Sql("1, 2"),
+                                                  QueryParameter::Int(4)};
+  PreparedStatementKey key;
+  std::vector<const QueryParameter*> bound_values;
+  EXPECT_FALSE(
+      query_template.GetPreparedStatementKey(parameters, &key, &bound_values));
+  ASSERT_EQ(1, bound_values.size());
+  EXPECT_EQ(4, bound_values[0]->int_value());
+  EXPECT_EQ("SELECT * FROM `t` WHERE `id` IN (1, 2) AND `type` = ?;",
+            query_template.ComposePreparedStatement(parameters,
+                                                    EscapeDoubledQuotes));
+
+  // Nor the statements of the templates compiled for a single query.
+  bound_values.clear();
+  EXPECT_FALSE(QueryTemplate("SELECT * FROM `t` WHERE `id` = $0;",
+                             /*is_reused=*/false)
+                   .GetPreparedStatementKey({QueryParameter::Int(1)}, &key,
+                                            &bound_values));
+}
+
+TEST(QueryTemplateTest, Segments) {
+  const QueryTemplate query_template("SELECT `$0` FROM t WHERE id = $1");
+  ASSERT_EQ(3, query_template.segments().size());
+  const QueryTemplate::Segment& quoted = query_template.segments()[0];
+  EXPECT_EQ("SELECT `", query_template.text(quoted));
+  EXPECT_EQ(0, quoted.parameter_index);
+  EXPECT_TRUE(quoted.is_quoted);
+  const QueryTemplate::Segment& unquoted = query_template.segments()[1];
+  EXPECT_EQ("` FROM t WHERE id = ", query_template.text(unquoted));
+  EXPECT_EQ("$1", query_template.placeholder(unquoted));
+  EXPECT_EQ(1, unquoted.parameter_index);
+  EXPECT_FALSE(unquoted.is_quoted);
+  const QueryTemplate::Segment& last = query_template.segments()[2];
+  EXPECT_EQ("", query_template.text(last));
+  EXPECT_EQ(-1, last.parameter_index);
+
+  // A placeholder has all the digits after the `$`.
+  const QueryTemplate wide_template("SELECT $10, $1 0");
+  ASSERT_EQ(3, wide_template.segments().size());
+  EXPECT_EQ("$10", wide_template.placeholder(wide_template.segments()[0]));
+  EXPECT_EQ(10, wide_template.segments()[0].parameter_index);
+  EXPECT_EQ("$1", wide_template.placeholder(wide_template.segments()[1]));
+  EXPECT_EQ(1, wide_template.segments()[1].parameter_index);
+  EXPECT_EQ(" 0", wide_template.text(wide_template.segments()[2]));
+
+  // A `$` which is not followed by a digit is text.
+  const QueryTemplate price_template("SELECT '$', $$0");
+  ASSERT_EQ(2, price_template.segments().size());
+  EXPECT_EQ("SELECT '$', $", price_template.text(price_template.segments()[0]));
+}
+
+}  // namespace
+}  // namespace ml_metadata
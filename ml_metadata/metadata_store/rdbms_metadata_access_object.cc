@@ -68,57 +68,51 @@ TypeKind ResolveTypeKind(const ContextType* const type) {
   return TypeKind::CONTEXT_TYPE;
 }
 
-// Populates 'node' properties from the rows in 'record'. The assumption is that
-// properties are encoded using the convention in
+// Populates 'node' properties from the `row` of 'result_set'. The assumption is
+// that properties are encoded using the convention in
 // QueryExecutor::Get{X}PropertyBy{X}Id() where X in {Artifact, Execution,
-// Context}.
+// Context}, starting with the property name at `name_column`.
 template <typename Node>
-absl::Status PopulateNodeProperties(const RecordSet::Record& record,
-                                    Node& node) {
+absl::Status PopulateNodeProperties(const ResultSet& result_set, const int row,
+                                    const int name_column, Node& node) {
   // Populate the property of the node.
-  const std::string& property_name = record.values(1);
-  bool is_custom_property;
-  CHECK(absl::SimpleAtob(record.values(2), &is_custom_property));
+  const std::string property_name = result_set.ToString(row, name_column);
+  const bool is_custom_property = result_set.GetBool(row, name_column + 1);
   auto& property_value =
       (is_custom_property ? (*node.mutable_custom_properties())[property_name]
                           : (*node.mutable_properties())[property_name]);
-  if (record.values(3) != kMetadataSourceNull) {
-    int64 int_value;
-    CHECK(absl::SimpleAtoi(record.values(3), &int_value));
-    property_value.set_int_value(int_value);
-  } else if (record.values(4) != kMetadataSourceNull) {
-    double double_value;
-    CHECK(absl::SimpleAtod(record.values(4), &double_value));
-    property_value.set_double_value(double_value);
+  if (!result_set.IsNull(row, name_column + 2)) {
+    property_value.set_int_value(result_set.GetInt(row, name_column + 2));
+  } else if (!result_set.IsNull(row, name_column + 3)) {
+    property_value.set_double_value(
+        result_set.GetDouble(row, name_column + 3));
   } else {
-    const std::string& string_value = record.values(5);
+    std::string string_value = result_set.ToString(row, name_column + 4);
     if (IsStructSerializedString(string_value)) {
       MLMD_RETURN_IF_ERROR(
           StringToStruct(string_value, *property_value.mutable_struct_value()));
     } else {
-      property_value.set_string_value(string_value);
+      property_value.set_string_value(std::move(string_value));
     }
   }
 
   return absl::OkStatus();
 }
 
-// Converts a record set that contains an id column at position per record to a
+// Converts a result set that contains an id column at position per row to a
 // vector.
-std::vector<int64> ConvertToIds(const RecordSet& record_set, int position = 0) {
+std::vector<int64> ConvertToIds(const ResultSet& record_set, int position = 0) {
   std::vector<int64> result;
-  result.reserve(record_set.records().size());
-  for (const RecordSet::Record& record : record_set.records()) {
-    int64 id;
-    CHECK(absl::SimpleAtoi(record.values(position), &id));
-    result.push_back(id);
+  result.reserve(record_set.num_rows());
+  for (int row = 0; row < record_set.num_rows(); ++row) {
+    result.push_back(record_set.GetInt(row, position));
   }
   return result;
 }
 
 // Extracts 2 vectors of type ids and corresponding parent type ids from the
 // parent_type triplets.
-void ConvertToTypeAndParentTypeIds(const RecordSet& record_set,
+void ConvertToTypeAndParentTypeIds(const ResultSet& record_set,
                                    std::vector<int64>& type_ids,
                                    std::vector<int64>& parent_type_ids) {
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -129,62 +123,63 @@ void ConvertToTypeAndParentTypeIds(const RecordSet& record_set,
 }
 
 // Extracts a vector of parent type ids from the parent_type triplets.
-std::vector<int64> ParentTypesToParentTypeIds(const RecordSet& record_set) {
+std::vector<int64> ParentTypesToParentTypeIds(const ResultSet& record_set) {
   return ConvertToIds(record_set, /*position=*/1);
 }
 
 // Extracts a vector of context ids from attribution triplets.
-std::vector<int64> AttributionsToContextIds(const RecordSet& record_set) {
+std::vector<int64> AttributionsToContextIds(const ResultSet& record_set) {
   return ConvertToIds(record_set, /*position=*/1);
 }
 
 // Extracts a vector of context ids from attribution triplets.
-std::vector<int64> AttributionsToArtifactIds(const RecordSet& record_set) {
+std::vector<int64> AttributionsToArtifactIds(const ResultSet& record_set) {
   return ConvertToIds(record_set, /*position=*/2);
 }
 
 // Extracts a vector of context ids from association triplets.
-std::vector<int64> AssociationsToContextIds(const RecordSet& record_set) {
+std::vector<int64> AssociationsToContextIds(const ResultSet& record_set) {
   return ConvertToIds(record_set, /*position=*/1);
 }
 
 // Extracts a vector of execution ids from association triplets.
-std::vector<int64> AssociationsToExecutionIds(const RecordSet& record_set) {
+std::vector<int64> AssociationsToExecutionIds(const ResultSet& record_set) {
   return ConvertToIds(record_set, /*position=*/2);
 }
 
 // Extracts a vector of parent context ids from parent context triplets.
 // If is_parent is true, then parent_context_ids are returned.
 // If is_parent is false, then context_ids for children are returned.
-std::vector<int64> ParentContextsToContextIds(const RecordSet& record_set,
+std::vector<int64> ParentContextsToContextIds(const ResultSet& record_set,
                                               bool is_parent) {
   const int position = is_parent ? 1 : 0;
   return ConvertToIds(record_set, position);
 }
 
-// Parses and converts a string value to a specific field in a message.
-// If the given string `value` is NULL (encoded as kMetadataSourceNull), then
-// leave the field unset.
+// Parses and converts the value at `row` and `column` of `result_set` to a
+// specific field in a message. If the value is NULL, then leave the field
+// unset.
 // The field should be a scalar field. The field type must be one of {string,
 // int64, bool, enum, message}.
 absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_descriptor,
-                               const absl::string_view value,
+                               const ResultSet& result_set, const int row,
+                               const int column,
                                google::protobuf::Message* message) {
-  if (value == kMetadataSourceNull) {
+  if (result_set.IsNull(row, column)) {
     return absl::OkStatus();
   }
   const google::protobuf::Reflection* reflection = message->GetReflection();
   switch (field_descriptor->cpp_type()) {
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_STRING: {
+      std::string value = result_set.ToString(row, column);
       if (field_descriptor->is_repeated())
-        reflection->AddString(message, field_descriptor, std::string(value));
+        reflection->AddString(message, field_descriptor, std::move(value));
       else
-        reflection->SetString(message, field_descriptor, std::string(value));
+        reflection->SetString(message, field_descriptor, std::move(value));
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_INT64: {
-      int64 int64_value;
-      CHECK(absl::SimpleAtoi(value, &int64_value));
+      const int64 int64_value = result_set.GetInt(row, column);
       if (field_descriptor->is_repeated())
         reflection->AddInt64(message, field_descriptor, int64_value);
       else
@@ -192,8 +187,7 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_BOOL: {
-      bool bool_value;
-      CHECK(absl::SimpleAtob(value, &bool_value));
+      const bool bool_value = result_set.GetBool(row, column);
       if (field_descriptor->is_repeated())
         reflection->AddBool(message, field_descriptor, bool_value);
       else
@@ -201,8 +195,7 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_ENUM: {
-      int enum_value;
-      CHECK(absl::SimpleAtoi(value, &enum_value));
+      const int enum_value = result_set.GetInt(row, column);
       if (field_descriptor->is_repeated())
         reflection->AddEnumValue(message, field_descriptor, enum_value);
       else
@@ -212,11 +205,11 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_MESSAGE: {
       CHECK(!field_descriptor->is_repeated())
           << "Cannot handle a repeated message";
+      const std::string value = result_set.ToString(row, column);
       if (!value.empty()) {
         ::google::protobuf::Message* sub_message =
             reflection->MutableMessage(message, field_descriptor);
-        if (!::google::protobuf::util::JsonStringToMessage(
-                 std::string(value.begin(), value.size()), sub_message)
+        if (!::google::protobuf::util::JsonStringToMessage(value, sub_message)
                  .ok()) {
           return absl::InternalError(
               ::absl::StrCat("Failed to parse proto: ", value));
@@ -232,46 +225,61 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
   return absl::OkStatus();
 }
 
-// Converts a RecordSet in the query result to a MessageType. In the record at
-// the `record_index`, its value of each column is assigned to a message field
-// with the same field name as the column name.
+// Returns the descriptors of the fields of MessageType with the same names as
+// the columns of `record_set`, or nullptr for the columns without a field.
 template <typename MessageType>
-absl::Status ParseRecordSetToMessage(const RecordSet& record_set,
-                                     MessageType* message,
-                                     int record_index = 0) {
-  CHECK_LT(record_index, record_set.records_size());
-  const google::protobuf::Descriptor* descriptor = message->descriptor();
-  for (int i = 0; i < record_set.column_names_size(); i++) {
-    const std::string& column_name = record_set.column_names(i);
-    const google::protobuf::FieldDescriptor* field_descriptor =
-        descriptor->FindFieldByName(column_name);
-    if (field_descriptor != nullptr) {
-      const std::string& value = record_set.records(record_index).values(i);
-      MLMD_RETURN_IF_ERROR(ParseValueToField(field_descriptor, value, message));
+std::vector<const google::protobuf::FieldDescriptor*> FindColumnFields(
+    const ResultSet& record_set) {
+  const google::protobuf::Descriptor* descriptor = MessageType::descriptor();
+  std::vector<const google::protobuf::FieldDescriptor*> fields;
+  fields.reserve(record_set.num_columns());
+  for (int i = 0; i < record_set.num_columns(); i++) {
+    fields.push_back(descriptor->FindFieldByName(record_set.column_name(i)));
+  }
+  return fields;
+}
+
+// Converts a row of a ResultSet in the query result to a MessageType. The
+// value of each column is assigned to the field in `fields` at the column
+// index, i.e., to the field with the same name as the column.
+template <typename MessageType>
+absl::Status ParseRecordSetToMessage(
+    const ResultSet& record_set,
+    absl::Span<const google::protobuf::FieldDescriptor* const> fields,
+    MessageType* message, int record_index) {
+  CHECK_LT(record_index, record_set.num_rows());
+  for (int i = 0; i < fields.size(); i++) {
+    if (fields[i] != nullptr) {
+      MLMD_RETURN_IF_ERROR(
+          ParseValueToField(fields[i], record_set, record_index, i, message));
     }
   }
   return absl::OkStatus();
 }
 
-// Converts a RecordSet in the query result to a MessageType array.
+// Converts a ResultSet in the query result to a MessageType array.
 template <typename MessageType>
-absl::Status ParseRecordSetToMessageArray(const RecordSet& record_set,
+absl::Status ParseRecordSetToMessageArray(const ResultSet& record_set,
                                           std::vector<MessageType>* messages) {
-  for (int i = 0; i < record_set.records_size(); i++) {
+  const std::vector<const google::protobuf::FieldDescriptor*> fields =
+      FindColumnFields<MessageType>(record_set);
+  messages->reserve(messages->size() + record_set.num_rows());
+  for (int i = 0; i < record_set.num_rows(); i++) {
     messages->push_back(MessageType());
     MLMD_RETURN_IF_ERROR(
-        ParseRecordSetToMessage(record_set, &messages->back(), i));
+        ParseRecordSetToMessage(record_set, fields, &messages->back(), i));
   }
   return absl::OkStatus();
 }
 
-// Converts a list of Records containing key-value pairs to a proto Map.
+// Converts the `rows` of a ResultSet containing key-value pairs to a proto Map.
 // The field_name is the map field in the MessageType. The method fills the
-// message's map field with field_name using the given records.
+// message's map field with field_name using the given rows.
 template <typename MessageType>
-absl::Status ParseRecordsToMapField(
-    const std::vector<RecordSet::Record>& records,
-    const std::string& field_name, MessageType* message) {
+absl::Status ParseRecordsToMapField(const ResultSet& record_set,
+                                    absl::Span<const int> rows,
+                                    const std::string& field_name,
+                                    MessageType* message) {
   const google::protobuf::Descriptor* descriptor = message->descriptor();
   const google::protobuf::Reflection* reflection = message->GetReflection();
   const google::protobuf::FieldDescriptor* map_field_descriptor =
@@ -286,15 +294,13 @@ absl::Status ParseRecordsToMapField(
   const google::protobuf::FieldDescriptor* value_descriptor =
       map_field_descriptor->message_type()->FindFieldByName("value");
 
-  for (const RecordSet::Record& record : records) {
+  for (const int row : rows) {
     google::protobuf::Message* map_field_message =
         reflection->AddMessage(message, map_field_descriptor);
-    const std::string& key = record.values(1);
-    const std::string& value = record.values(2);
-    MLMD_RETURN_IF_ERROR(
-        ParseValueToField(key_descriptor, key, map_field_message));
-    MLMD_RETURN_IF_ERROR(
-        ParseValueToField(value_descriptor, value, map_field_message));
+    MLMD_RETURN_IF_ERROR(ParseValueToField(key_descriptor, record_set, row,
+                                           /*column=*/1, map_field_message));
+    MLMD_RETURN_IF_ERROR(ParseValueToField(value_descriptor, record_set, row,
+                                           /*column=*/2, map_field_message));
   }
 
   return absl::OkStatus();
@@ -355,6 +361,24 @@ bool IsUniqueConstraintViolated(const absl::Status status) {
           absl::StrContains(std::string(status.message()), "UNIQUE"));
 }
 
+// Returns true if `path` names a field of an Artifact, other than its
+// properties, which can be listed in an update mask.
+bool IsUpdatableField(const Artifact&, const absl::string_view path) {
+  return path == "uri" || path == "state";
+}
+
+// Returns true if `path` names a field of an Execution, other than its
+// properties, which can be listed in an update mask.
+bool IsUpdatableField(const Execution&, const absl::string_view path) {
+  return path == "last_known_state";
+}
+
+// Returns true if `path` names a field of a Context, other than its
+// properties, which can be listed in an update mask.
+bool IsUpdatableField(const Context&, const absl::string_view path) {
+  return path == "name";
+}
+
 // A util to handle `version` in ArtifactType/ExecutionType/ContextType protos.
 template <typename T>
 absl::optional<std::string> GetTypeVersion(const T& type_message) {
@@ -375,7 +399,7 @@ absl::Status AddAncestors(int64 ancestor_id, std::vector<int64>& ancestor_ids,
         std::is_same<T, ContextType>::value)) {
     return absl::InternalError("Unexpected node type!");
   }
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor->SelectParentTypesByTypeID(
       absl::Span<const int64>({ancestor_id}), &record_set));
   for (const int64 parent_id : ParentTypesToParentTypeIds(record_set)) {
@@ -390,7 +414,7 @@ template <>
 absl::Status AddAncestors<ParentContext>(
     int64 ancestor_id, std::vector<int64>& ancestor_ids,
     std::unique_ptr<QueryExecutor>& executor) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor->SelectParentContextsByContextID(ancestor_id, &record_set));
   for (const int64 parent_id :
@@ -464,40 +488,49 @@ absl::Status RDBMSMetadataAccessObject::CreateBasicNode(const Context& context,
                                   node_id);
 }
 
+// Creates Artifacts (without properties) with bulk inserts.
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Artifact> artifacts, std::vector<int64>* node_ids) {
+  return executor_->InsertArtifacts(artifacts, absl::Now(), node_ids);
+}
+
+// Creates Executions (without properties) with bulk inserts.
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* node_ids) {
+  return executor_->InsertExecutions(executions, absl::Now(), node_ids);
+}
+
+// Creates Contexts (without properties) with bulk inserts.
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Context> contexts, std::vector<int64>* node_ids) {
+  for (const Context& context : contexts) {
+    if (!context.has_name() || context.name().empty()) {
+      return absl::InvalidArgumentError("Context name should not be empty");
+    }
+  }
+  return executor_->InsertContexts(contexts, absl::Now(), node_ids);
+}
+
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Context* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectContextPropertyByContextID(ids, properties));
-  }
-  return absl::OkStatus();
+    const absl::Span<const int64> ids,
+    const MetadataSource::RowBatchCallback callback, Context* tag) {
+  return executor_->SelectContextsWithPropertiesByID(ids, callback);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Artifact* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectArtifactPropertyByArtifactID(ids, properties));
-  }
-  return absl::OkStatus();
+    const absl::Span<const int64> ids,
+    const MetadataSource::RowBatchCallback callback, Artifact* tag) {
+  return executor_->SelectArtifactsWithPropertiesByID(ids, callback);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Execution* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectExecutionPropertyByExecutionID(ids, properties));
-  }
-  return absl::OkStatus();
+    const absl::Span<const int64> ids,
+    const MetadataSource::RowBatchCallback callback, Execution* tag) {
+  return executor_->SelectExecutionsWithPropertiesByID(ids, callback);
 }
 
 // Update an Artifact's type_id, URI and last_update_time.
@@ -530,6 +563,52 @@ absl::Status RDBMSMetadataAccessObject::RunNodeUpdate(const Context& context) {
                                         context.name(), absl::Now());
 }
 
+// Update the fields of an Artifact named by `fields` (uri, state) without
+// reading it, if it still has the `last_update_time`.
+absl::Status RDBMSMetadataAccessObject::RunNodeFieldsUpdate(
+    const Artifact& artifact, const absl::flat_hash_set<std::string>& fields,
+    const absl::optional<int64> last_update_time) {
+  return executor_->UpdateArtifactFields(
+      artifact.id(),
+      artifact.has_type_id() ? absl::make_optional(artifact.type_id())
+                             : absl::nullopt,
+      last_update_time, fields.contains("uri"), artifact.uri(),
+      fields.contains("state"),
+      artifact.has_state() ? absl::make_optional(artifact.state())
+                           : absl::nullopt,
+      absl::Now());
+}
+
+// Update the fields of an Execution named by `fields` (last_known_state).
+absl::Status RDBMSMetadataAccessObject::RunNodeFieldsUpdate(
+    const Execution& execution, const absl::flat_hash_set<std::string>& fields,
+    const absl::optional<int64> last_update_time) {
+  return executor_->UpdateExecutionFields(
+      execution.id(),
+      execution.has_type_id() ? absl::make_optional(execution.type_id())
+                              : absl::nullopt,
+      last_update_time, fields.contains("last_known_state"),
+      execution.has_last_known_state()
+          ? absl::make_optional(execution.last_known_state())
+          : absl::nullopt,
+      absl::Now());
+}
+
+// Update the fields of a Context named by `fields` (name).
+absl::Status RDBMSMetadataAccessObject::RunNodeFieldsUpdate(
+    const Context& context, const absl::flat_hash_set<std::string>& fields,
+    const absl::optional<int64> last_update_time) {
+  const bool update_name = fields.contains("name");
+  if (update_name && (!context.has_name() || context.name().empty())) {
+    return absl::InvalidArgumentError("Context name should not be empty");
+  }
+  return executor_->UpdateContextFields(
+      context.id(),
+      context.has_type_id() ? absl::make_optional(context.type_id())
+                            : absl::nullopt,
+      last_update_time, update_name, context.name(), absl::Now());
+}
+
 // Runs a property insertion query for a NodeType.
 template <typename NodeType>
 absl::Status RDBMSMetadataAccessObject::InsertProperty(
@@ -555,6 +634,44 @@ absl::Status RDBMSMetadataAccessObject::InsertProperty(
   }
 }
 
+// Runs bulk property insertion queries for a NodeType.
+template <typename NodeType>
+absl::Status RDBMSMetadataAccessObject::InsertProperties(
+    const absl::Span<const QueryExecutor::NodeProperty> properties) {
+  NodeType node;
+  const TypeKind type_kind = ResolveTypeKind(&node);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->InsertArtifactProperties(properties);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->InsertExecutionProperties(properties);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->InsertContextProperties(properties);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Unsupported TypeKind: ", type_kind));
+  }
+}
+
+// Runs bulk property upsert queries for a NodeType.
+template <typename NodeType>
+absl::Status RDBMSMetadataAccessObject::UpsertProperties(
+    const absl::Span<const QueryExecutor::NodeProperty> properties) {
+  NodeType node;
+  const TypeKind type_kind = ResolveTypeKind(&node);
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE:
+      return executor_->UpsertArtifactProperties(properties);
+    case TypeKind::EXECUTION_TYPE:
+      return executor_->UpsertExecutionProperties(properties);
+    case TypeKind::CONTEXT_TYPE:
+      return executor_->UpsertContextProperties(properties);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Unsupported TypeKind: ", type_kind));
+  }
+}
+
 // Generates a property update query for a NodeType.
 template <typename NodeType>
 absl::Status RDBMSMetadataAccessObject::UpdateProperty(
@@ -708,48 +825,52 @@ absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
     MLMD_RETURN_IF_ERROR(
         executor_->InsertTypeProperty(*type_id, property_name, property_type));
   }
-  return absl::OkStatus();
+  return executor_->IncrementTypeGeneration();
 }
 
 // Generates a query to find all type instances.
 absl::Status RDBMSMetadataAccessObject::GenerateFindAllTypeInstancesQuery(
-    const TypeKind type_kind, RecordSet* record_set) {
+    const TypeKind type_kind, ResultSet* record_set) {
   return executor_->SelectAllTypes(type_kind, record_set);
 }
 
+absl::Status RDBMSMetadataAccessObject::GetTypeGeneration(
+    absl::optional<int64>* generation) {
+  *generation = absl::nullopt;
+  if (type_cache_ == nullptr) {
+    return absl::OkStatus();
+  }
+  return executor_->SelectTypeGeneration(generation);
+}
+
 // FindType takes a result of a query for types, and populates additional
 // information such as properties, and returns it in `types`.
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypesFromRecordSet(
-    const RecordSet& type_record_set, std::vector<MessageType>* types,
+    const ResultSet& type_record_set, std::vector<MessageType>* types,
     bool get_properties) {
   // Query type with the given condition
-  const int num_records = type_record_set.records_size();
+  const int num_records = type_record_set.num_rows();
   if (num_records == 0) return absl::OkStatus();
 
   types->resize(num_records);
+  const std::vector<const google::protobuf::FieldDescriptor*> fields =
+      FindColumnFields<MessageType>(type_record_set);
   for (int i = 0; i < num_records; ++i) {
     MLMD_RETURN_IF_ERROR(
-        ParseRecordSetToMessage(type_record_set, &types->at(i), i));
+        ParseRecordSetToMessage(type_record_set, fields, &types->at(i), i));
   }
   if (get_properties) {
-    RecordSet property_record_set;
+    ResultSet property_record_set;
     std::vector<int64> type_ids;
     absl::c_transform(*types, std::back_inserter(type_ids),
                       [](const MessageType& type) { return type.id(); });
     MLMD_RETURN_IF_ERROR(
         executor_->SelectPropertiesByTypeID(type_ids, &property_record_set));
-    // Builds a map between type.id and all its properties.
-    absl::flat_hash_map<int64, std::vector<RecordSet::Record>>
-        type_id_to_records;
-    for (const RecordSet::Record& record : property_record_set.records()) {
-      int64 type_id;
-      CHECK(absl::SimpleAtoi(record.values(0), &type_id));
-      if (type_id_to_records.contains(type_id)) {
-        type_id_to_records[type_id].push_back(record);
-      } else {
-        type_id_to_records.insert({type_id, {record}});
-      }
+    // Builds a map between type.id and the rows of all its properties.
+    absl::flat_hash_map<int64, std::vector<int>> type_id_to_records;
+    for (int row = 0; row < property_record_set.num_rows(); ++row) {
+      type_id_to_records[property_record_set.GetInt(row, 0)].push_back(row);
     }
     // Builds a map between type.id and its position in `types` vector.
     absl::flat_hash_map<int64, int64> type_id_to_pos;
@@ -759,8 +880,9 @@ absl::Status RDBMSMetadataAccessObject::FindTypesFromRecordSet(
     // Populates `properties` field.
     for (auto i = type_id_to_records.begin(); i != type_id_to_records.end();
          ++i) {
-      MLMD_RETURN_IF_ERROR(ParseRecordsToMapField(
-          i->second, "properties", &types->at(type_id_to_pos[i->first])));
+      MLMD_RETURN_IF_ERROR(
+          ParseRecordsToMapField(property_record_set, i->second, "properties",
+                                 &types->at(type_id_to_pos[i->first])));
     }
   }
 
@@ -788,7 +910,22 @@ absl::Status RDBMSMetadataAccessObject::FindTypesImpl(
   absl::c_transform(deduped_id_set, std::back_inserter(deduped_ids),
                     [](const int64 id) { return id; });
 
-  RecordSet record_set;
+  // Returns the types without their properties from `type_cache_`, if all of
+  // them are cached.
+  absl::optional<int64> generation;
+  MLMD_RETURN_IF_ERROR(GetTypeGeneration(&generation));
+  if (generation) {
+    for (const int64 id : deduped_ids) {
+      MessageType type;
+      if (!type_cache_->FindType(*generation, id, &type)) break;
+      type.clear_properties();
+      types.push_back(std::move(type));
+    }
+    if (types.size() == deduped_ids.size()) return absl::OkStatus();
+    types.clear();
+  }
+
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectTypesByID(deduped_ids, type_kind, &record_set));
   MLMD_RETURN_IF_ERROR(
@@ -808,8 +945,13 @@ absl::Status RDBMSMetadataAccessObject::FindTypesImpl(
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
                                                      MessageType* type) {
+  absl::optional<int64> generation;
+  MLMD_RETURN_IF_ERROR(GetTypeGeneration(&generation));
+  if (generation && type_cache_->FindType(*generation, type_id, type)) {
+    return absl::OkStatus();
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectTypeByID(type_id, type_kind, &record_set));
   std::vector<MessageType> types;
@@ -819,6 +961,7 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
         absl::StrCat("No type found for query, type_id: ", type_id));
   }
   *type = std::move(types[0]);
+  if (generation) type_cache_->InsertType(*generation, *type);
   return absl::OkStatus();
 }
 
@@ -826,8 +969,13 @@ template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
     absl::string_view name, absl::optional<absl::string_view> version,
     MessageType* type) {
+  absl::optional<int64> generation;
+  MLMD_RETURN_IF_ERROR(GetTypeGeneration(&generation));
+  if (generation && type_cache_->FindType(*generation, name, version, type)) {
+    return absl::OkStatus();
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectTypeByNameAndVersion(
       name, version, type_kind, &record_set));
   std::vector<MessageType> types;
@@ -838,6 +986,7 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
                      version ? *version : "nullopt", "`"));
   }
   *type = std::move(types[0]);
+  if (generation) type_cache_->InsertType(*generation, *type);
   return absl::OkStatus();
 }
 
@@ -848,7 +997,7 @@ absl::Status RDBMSMetadataAccessObject::FindAllTypeInstancesImpl(
     std::vector<MessageType>* types) {
   MessageType type;
   const TypeKind type_kind = ResolveTypeKind(&type);
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       GenerateFindAllTypeInstancesQuery(type_kind, &record_set));
 
@@ -879,6 +1028,7 @@ absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
   // updates the list of type properties
   const google::protobuf::Map<std::string, PropertyType>& stored_properties =
       stored_type.properties();
+  bool properties_inserted = false;
   for (const auto& p : type.properties()) {
     const std::string& property_name = p.first;
     const PropertyType property_type = p.second;
@@ -898,6 +1048,10 @@ absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
     }
     MLMD_RETURN_IF_ERROR(executor_->InsertTypeProperty(
         stored_type.id(), property_name, property_type));
+    properties_inserted = true;
+  }
+  if (properties_inserted) {
+    MLMD_RETURN_IF_ERROR(executor_->IncrementTypeGeneration());
   }
   return absl::OkStatus();
 }
@@ -913,17 +1067,48 @@ absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIdImpl(
     return absl::InvalidArgumentError("output_parent_types is not empty");
   }
 
-  // Retrieve parent types based on `type_ids`.
-  RecordSet record_set;
-  MLMD_RETURN_IF_ERROR(
-      executor_->SelectParentTypesByTypeID(type_ids, &record_set));
-  if (record_set.records_size() == 0) return absl::OkStatus();
-
   // `type_id` and `parent_type_id` have a 1:1 mapping based on the database
   // records.
   std::vector<int64> type_ids_with_parent, parent_type_ids;
-  ConvertToTypeAndParentTypeIds(record_set, type_ids_with_parent,
-                                parent_type_ids);
+  // Retrieve parent types based on `type_ids`, from `type_cache_` if all of
+  // them are cached.
+  absl::optional<int64> generation;
+  MLMD_RETURN_IF_ERROR(GetTypeGeneration(&generation));
+  bool cached = generation.has_value();
+  for (int i = 0; cached && i < type_ids.size(); ++i) {
+    std::vector<int64> cached_parent_type_ids;
+    cached = type_cache_->FindParentTypeIds(*generation, type_ids[i],
+                                            &cached_parent_type_ids);
+    for (const int64 parent_type_id : cached_parent_type_ids) {
+      type_ids_with_parent.push_back(type_ids[i]);
+      parent_type_ids.push_back(parent_type_id);
+    }
+  }
+  if (!cached) {
+    type_ids_with_parent.clear();
+    parent_type_ids.clear();
+    ResultSet record_set;
+    MLMD_RETURN_IF_ERROR(
+        executor_->SelectParentTypesByTypeID(type_ids, &record_set));
+    ConvertToTypeAndParentTypeIds(record_set, type_ids_with_parent,
+                                  parent_type_ids);
+    if (generation) {
+      // The types without a parent are cached as well.
+      absl::flat_hash_map<int64, std::vector<int64>> type_id_to_parent_ids;
+      for (const int64 type_id : type_ids) {
+        type_id_to_parent_ids[type_id];
+      }
+      for (int i = 0; i < type_ids_with_parent.size(); ++i) {
+        type_id_to_parent_ids[type_ids_with_parent[i]].push_back(
+            parent_type_ids[i]);
+      }
+      for (auto& entry : type_id_to_parent_ids) {
+        type_cache_->InsertParentTypeIds(*generation, entry.first,
+                                         std::move(entry.second));
+      }
+    }
+  }
+  if (parent_type_ids.empty()) return absl::OkStatus();
 
   // Creates a {parent_id, parent_type} mapping.
   std::vector<Type> parent_types;
@@ -972,17 +1157,63 @@ absl::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
                                     "Cannot create node for ",
                                     node.ShortDebugString());
 
-  // insert properties
-  const google::protobuf::Map<std::string, Value> prev_properties;
-  int num_changed_properties = 0;
-  MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.properties(), prev_properties, *node_id,
-      /*is_custom_property=*/false, num_changed_properties));
-  int num_changed_custom_properties = 0;
-  MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.custom_properties(), prev_properties, *node_id,
-      /*is_custom_property=*/true, num_changed_custom_properties));
-  return absl::OkStatus();
+  // insert properties, which are sent together
+  return executor_->BatchWrites([&]() {
+    const google::protobuf::Map<std::string, Value> prev_properties;
+    int num_changed_properties = 0;
+    MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
+        node.properties(), prev_properties, *node_id,
+        /*is_custom_property=*/false, num_changed_properties));
+    int num_changed_custom_properties = 0;
+    return ModifyProperties<NodeType>(
+        node.custom_properties(), prev_properties, *node_id,
+        /*is_custom_property=*/true, num_changed_custom_properties);
+  });
+}
+
+// Creates the `nodes` as CreateNodeImpl, with one bulk insert of the nodes and
+// one of their properties, each sent in statements of bounded size.
+// Returns INVALID_ARGUMENT error, if any node does not align with its type.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::CreateNodesImpl(
+    const absl::Span<const Node> nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  // validate the nodes, looking up each of their types once
+  absl::flat_hash_map<int64, NodeType> node_types;
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return absl::InvalidArgumentError("Type id is missing.");
+    auto it = node_types.find(node.type_id());
+    if (it == node_types.end()) {
+      NodeType node_type;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(FindTypeImpl(node.type_id(), &node_type),
+                                        "Cannot find type for ",
+                                        node.ShortDebugString());
+      it = node_types.insert({node.type_id(), std::move(node_type)}).first;
+    }
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, it->second),
+        "Cannot validate properties of ", node.ShortDebugString());
+  }
+
+  // insert the nodes and get the assigned ids
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateBasicNodes(nodes, node_ids),
+                                    "Cannot create ", nodes.size(), " nodes");
+
+  // insert the properties of all nodes together
+  std::vector<QueryExecutor::NodeProperty> properties;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (const auto& p : nodes[i].properties()) {
+      properties.push_back({(*node_ids)[i], p.first,
+                            /*is_custom_property=*/false, &p.second});
+    }
+    for (const auto& p : nodes[i].custom_properties()) {
+      properties.push_back({(*node_ids)[i], p.first,
+                            /*is_custom_property=*/true, &p.second});
+    }
+  }
+  return InsertProperties<NodeType>(properties);
 }
 
 template <typename Node>
@@ -997,36 +1228,32 @@ absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
     return absl::InvalidArgumentError("nodes parameter is not empty");
   }
 
-  RecordSet node_record_set;
-  RecordSet properties_record_set;
-
-  MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(node_ids, &node_record_set,
-                                               &properties_record_set));
-
-  MLMD_RETURN_IF_ERROR(ParseRecordSetToMessageArray(node_record_set, &nodes));
-
-  // if there are properties associated with the nodes, parse the returned
-  // values.
-  if (!properties_record_set.records().empty()) {
-    // First we build a hash map from node ids to Node messages, to
-    // facilitate lookups.
-    absl::flat_hash_map<int64, typename std::vector<Node>::iterator> node_by_id;
-    for (auto i = nodes.begin(); i != nodes.end(); ++i) {
-      node_by_id.insert({i->id(), i});
+  // The rows are parsed in one pass as they are read, so that they are not all
+  // kept in memory at once. As they are sorted by node id, the rows of a node
+  // are adjacent, and a node is added at its first row.
+  const auto parse_rows = [&nodes](const ResultSet& rows) -> absl::Status {
+    const std::vector<const google::protobuf::FieldDescriptor*> fields =
+        FindColumnFields<Node>(rows);
+    const int id_column = rows.FindColumn("id");
+    const int property_column = rows.FindColumn("property_name");
+    if (id_column < 0 || property_column < 0) {
+      return absl::InternalError(
+          "The nodes with properties have no id or property_name column.");
     }
-
-    CHECK_EQ(properties_record_set.column_names_size(), 6);
-    for (const RecordSet::Record& record : properties_record_set.records()) {
-      // Match the record against a node in the hash map.
-      int64 node_id;
-      CHECK(absl::SimpleAtoi(record.values(0), &node_id));
-      auto iter = node_by_id.find(node_id);
-      CHECK(iter != node_by_id.end());
-      Node& node = *iter->second;
-
-      MLMD_RETURN_IF_ERROR(PopulateNodeProperties(record, node));
+    for (int row = 0; row < rows.num_rows(); ++row) {
+      if (nodes.empty() || nodes.back().id() != rows.GetInt(row, id_column)) {
+        nodes.push_back(Node());
+        MLMD_RETURN_IF_ERROR(
+            ParseRecordSetToMessage(rows, fields, &nodes.back(), row));
+      }
+      if (!rows.IsNull(row, property_column)) {
+        MLMD_RETURN_IF_ERROR(
+            PopulateNodeProperties(rows, row, property_column, nodes.back()));
+      }
     }
-  }
+    return absl::OkStatus();
+  };
+  MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(node_ids, parse_rows));
 
   if (node_ids.size() != nodes.size()) {
     std::vector<int64> found_ids;
@@ -1084,15 +1311,17 @@ absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   MLMD_RETURN_IF_ERROR(FindTypeImpl(type_id, &stored_type));
   MLMD_RETURN_IF_ERROR(ValidatePropertiesWithType(node, stored_type));
 
-  // Update, insert, delete properties if changed.
+  // Update, insert, delete properties if changed, which are sent together.
   int num_changed_properties = 0;
-  MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.properties(), stored_node.properties(), node.id(),
-      /*is_custom_property=*/false, num_changed_properties));
   int num_changed_custom_properties = 0;
-  MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
-      node.custom_properties(), stored_node.custom_properties(), node.id(),
-      /*is_custom_property=*/true, num_changed_custom_properties));
+  MLMD_RETURN_IF_ERROR(executor_->BatchWrites([&]() {
+    MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
+        node.properties(), stored_node.properties(), node.id(),
+        /*is_custom_property=*/false, num_changed_properties));
+    return ModifyProperties<NodeType>(
+        node.custom_properties(), stored_node.custom_properties(), node.id(),
+        /*is_custom_property=*/true, num_changed_custom_properties);
+  }));
   // Update node if attributes are different or properties are updated, so that
   // the last_update_time_since_epoch is updated properly.
   google::protobuf::util::MessageDifferencer diff;
@@ -1111,47 +1340,140 @@ absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   return absl::OkStatus();
 }
 
+// Updates the fields and properties of a `Node` listed in `update_mask` without
+// reading it first. The properties are upserted or deleted, and then the node
+// row is updated with one query conditioned on its id, type_id and
+// `last_update_time`, which are only read again if no row is updated.
+// Returns INVALID_ARGUMENT error, if a path is unknown, or the node cannot be
+// found, or does not match with its type.
+// Returns FAILED_PRECONDITION error, if the node has been updated after
+// `last_update_time`.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(
+    const Node& node, const google::protobuf::FieldMask& update_mask,
+    const absl::optional<int64> last_update_time) {
+  if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
+  // sort the paths into fields, upserted properties and deleted properties
+  absl::flat_hash_set<std::string> fields;
+  Node masked_node;
+  std::vector<QueryExecutor::NodeProperty> upserted_properties;
+  std::vector<absl::string_view> deleted_properties;
+  for (const std::string& path : update_mask.paths()) {
+    absl::string_view name = path;
+    if (absl::ConsumePrefix(&name, "properties.")) {
+      const auto it = node.properties().find(std::string(name));
+      if (it == node.properties().end()) {
+        deleted_properties.push_back(name);
+        continue;
+      }
+      (*masked_node.mutable_properties())[it->first] = it->second;
+      upserted_properties.push_back(
+          {node.id(), it->first, /*is_custom_property=*/false, &it->second});
+    } else if (absl::ConsumePrefix(&name, "custom_properties.")) {
+      const auto it = node.custom_properties().find(std::string(name));
+      if (it == node.custom_properties().end()) {
+        deleted_properties.push_back(name);
+        continue;
+      }
+      if (it->second.value_case() == Value::VALUE_NOT_SET) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("No value is given for custom property: ", name));
+      }
+      upserted_properties.push_back(
+          {node.id(), it->first, /*is_custom_property=*/true, &it->second});
+    } else if (IsUpdatableField(node, path)) {
+      fields.insert(path);
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown path in update_mask: ", path));
+    }
+  }
+  // the listed properties are validated with the (cached) type of the node
+  if (!masked_node.properties().empty()) {
+    if (!node.has_type_id()) {
+      return absl::InvalidArgumentError(
+          "No type_id is given to update the properties.");
+    }
+    NodeType node_type;
+    MLMD_RETURN_IF_ERROR(FindTypeImpl(node.type_id(), &node_type));
+    MLMD_RETURN_IF_ERROR(ValidatePropertiesWithType(masked_node, node_type));
+  }
+
+  // Upsert and delete properties, and then update the node, which are sent
+  // together. The node update is the last write, whose changed rows are read.
+  const absl::Status status = executor_->BatchWrites([&]() {
+    if (!upserted_properties.empty()) {
+      MLMD_RETURN_IF_ERROR(UpsertProperties<NodeType>(upserted_properties));
+    }
+    for (const absl::string_view name : deleted_properties) {
+      MLMD_RETURN_IF_ERROR(DeleteProperty<NodeType>(node.id(), name));
+    }
+    return RunNodeFieldsUpdate(node, fields, last_update_time);
+  });
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given node already exists: ", node.DebugString(), status.ToString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  int64 num_changed_rows;
+  MLMD_RETURN_IF_ERROR(executor_->SelectNumChangedRows(&num_changed_rows));
+  if (num_changed_rows > 0) return absl::OkStatus();
+
+  // the node is not updated, so it is read to tell why
+  Node stored_node;
+  const absl::Status find_status = FindNodeImpl(node.id(), &stored_node);
+  if (absl::IsNotFound(find_status)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot find the given id ", node.id()));
+  }
+  MLMD_RETURN_IF_ERROR(find_status);
+  if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Given type_id ", node.type_id(),
+        " is different from the one known before: ", stored_node.type_id()));
+  }
+  return absl::FailedPreconditionError(absl::StrCat(
+      "Node ", node.id(), " has been updated at ",
+      stored_node.last_update_time_since_epoch(), " after the given ",
+      last_update_time.value_or(0), " last_update_time_since_epoch."));
+}
+
 // Takes a record set that has one record per event, parses them into Event
 // objects, gets the paths for the events from the database using collected
 // event ids, and assign paths to each corresponding event.
 // Returns INVALID_ARGUMENT error, if the `events` is null.
 absl::Status RDBMSMetadataAccessObject::FindEventsFromRecordSet(
-    const RecordSet& event_record_set, std::vector<Event>* events) {
+    const ResultSet& event_record_set, std::vector<Event>* events) {
   if (events == nullptr)
     return absl::InvalidArgumentError("Given events is NULL.");
 
-  events->reserve(event_record_set.records_size());
+  events->reserve(event_record_set.num_rows());
   MLMD_RETURN_IF_ERROR(ParseRecordSetToMessageArray(event_record_set, events));
 
   absl::flat_hash_map<int64, Event*> event_id_to_event_map;
   std::vector<int64> event_ids;
-  event_ids.reserve(event_record_set.records_size());
+  event_ids.reserve(event_record_set.num_rows());
   for (int i = 0; i < events->size(); ++i) {
-    CHECK_LT(i, event_record_set.records_size());
-    const RecordSet::Record& record = event_record_set.records()[i];
-    int64 event_id;
-    CHECK(absl::SimpleAtoi(record.values(0), &event_id));
+    CHECK_LT(i, event_record_set.num_rows());
+    const int64 event_id = event_record_set.GetInt(i, 0);
     event_id_to_event_map[event_id] = &(*events)[i];
     event_ids.push_back(event_id);
   }
 
-  RecordSet path_record_set;
+  ResultSet path_record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectEventPathByEventIDs(event_ids, &path_record_set));
-  for (const RecordSet::Record& record : path_record_set.records()) {
-    int64 event_id;
-    CHECK(absl::SimpleAtoi(record.values(0), &event_id));
-    auto iter = event_id_to_event_map.find(event_id);
+  for (int row = 0; row < path_record_set.num_rows(); ++row) {
+    auto iter = event_id_to_event_map.find(path_record_set.GetInt(row, 0));
     CHECK(iter != event_id_to_event_map.end());
     Event* event = iter->second;
-    bool is_index_step;
-    CHECK(absl::SimpleAtob(record.values(1), &is_index_step));
-    if (is_index_step) {
-      int64 step_index;
-      CHECK(absl::SimpleAtoi(record.values(2), &step_index));
-      event->mutable_path()->add_steps()->set_index(step_index);
+    if (path_record_set.GetBool(row, 1)) {
+      event->mutable_path()->add_steps()->set_index(
+          path_record_set.GetInt(row, 2));
     } else {
-      event->mutable_path()->add_steps()->set_key(record.values(3));
+      event->mutable_path()->add_steps()->set_key(
+          path_record_set.ToString(row, 3));
     }
   }
   return absl::OkStatus();
@@ -1224,23 +1546,26 @@ absl::Status RDBMSMetadataAccessObject::FindTypeByNameAndVersion(
 absl::Status RDBMSMetadataAccessObject::FindTypeIdByNameAndVersion(
     absl::string_view name, absl::optional<absl::string_view> version,
     TypeKind type_kind, int64* type_id) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectTypeByNameAndVersion(
       name, version, type_kind, &record_set));
-  if (record_set.records().empty()) {
+  if (record_set.num_rows() == 0) {
     return absl::NotFoundError(
         absl::StrCat("No type found for query, name: `", name, "`, version: `",
                      version ? *version : "nullopt", "`"));
   }
-  for (int i = 0; i < record_set.column_names_size(); i++) {
-    if (record_set.column_names(i) == "id") {
-      if (absl::SimpleAtoi(record_set.records(0).values(i), type_id)) {
-        return absl::OkStatus();
-      }
-      return absl::InternalError(absl::StrCat(
-          "Cannot parse RecordSet for type_id on type name: `", name,
-          "`, version: `", version ? *version : "nullopt", "`"));
+  const int id_column = record_set.FindColumn("id");
+  if (id_column >= 0) {
+    if (record_set.type(0, id_column) != ResultSet::Type::kString) {
+      *type_id = record_set.GetInt(0, id_column);
+      return absl::OkStatus();
+    }
+    if (absl::SimpleAtoi(record_set.GetString(0, id_column), type_id)) {
+      return absl::OkStatus();
     }
+    return absl::InternalError(absl::StrCat(
+        "Cannot parse RecordSet for type_id on type name: `", name,
+        "`, version: `", version ? *version : "nullopt", "`"));
   }
   return absl::NotFoundError(
       absl::StrCat("No type_id found from RecordSet for type name: `", name,
@@ -1273,7 +1598,8 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return executor_->IncrementTypeGeneration();
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
@@ -1290,7 +1616,8 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return executor_->IncrementTypeGeneration();
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
@@ -1308,12 +1635,14 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return executor_->IncrementTypeGeneration();
 }
 
 absl::Status RDBMSMetadataAccessObject::DeleteParentTypeInheritanceLink(
     int64 type_id, int64 parent_type_id) {
-  return executor_->DeleteParentType(type_id, parent_type_id);
+  MLMD_RETURN_IF_ERROR(executor_->DeleteParentType(type_id, parent_type_id));
+  return executor_->IncrementTypeGeneration();
 }
 
 absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeId(
@@ -1346,6 +1675,17 @@ absl::Status RDBMSMetadataAccessObject::CreateArtifact(const Artifact& artifact,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts, std::vector<int64>* artifact_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes contain an existing node: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateExecution(
     const Execution& execution, int64* execution_id) {
   const absl::Status& status =
@@ -1358,6 +1698,17 @@ absl::Status RDBMSMetadataAccessObject::CreateExecution(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions, std::vector<int64>* execution_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes contain an existing node: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
                                                       int64* context_id) {
   const absl::Status& status =
@@ -1370,6 +1721,17 @@ absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts, std::vector<int64>* context_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Context, ContextType>(contexts, context_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given nodes contain an existing node: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactsById(
     const absl::Span<const int64> artifact_ids,
     std::vector<Artifact>* artifacts) {
@@ -1411,8 +1773,34 @@ absl::Status RDBMSMetadataAccessObject::UpdateContext(const Context& context) {
   return UpdateNodeImpl<Context, ContextType>(context);
 }
 
+absl::Status RDBMSMetadataAccessObject::UpdateArtifact(
+    const Artifact& artifact, const google::protobuf::FieldMask& update_mask,
+    const absl::optional<int64> last_update_time) {
+  return UpdateNodeImpl<Artifact, ArtifactType>(artifact, update_mask,
+                                                last_update_time);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdateExecution(
+    const Execution& execution, const google::protobuf::FieldMask& update_mask,
+    const absl::optional<int64> last_update_time) {
+  return UpdateNodeImpl<Execution, ExecutionType>(execution, update_mask,
+                                                  last_update_time);
+}
+
+absl::Status RDBMSMetadataAccessObject::UpdateContext(
+    const Context& context, const google::protobuf::FieldMask& update_mask,
+    const absl::optional<int64> last_update_time) {
+  return UpdateNodeImpl<Context, ContextType>(context, update_mask,
+                                              last_update_time);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
                                                     int64* event_id) {
+  return CreateEvent(event, /*is_already_validated=*/false, event_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateEvent(
+    const Event& event, const bool is_already_validated, int64* event_id) {
   // validate the given event
   if (!event.has_artifact_id())
     return absl::InvalidArgumentError("No artifact id is specified.");
@@ -1420,19 +1808,20 @@ absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
     return absl::InvalidArgumentError("No execution id is specified.");
   if (!event.has_type() || event.type() == Event::UNKNOWN)
     return absl::InvalidArgumentError("No event type is specified.");
-  RecordSet artifacts;
-  MLMD_RETURN_IF_ERROR(
-      executor_->SelectArtifactsByID({event.artifact_id()}, &artifacts));
-  RecordSet executions;
-  MLMD_RETURN_IF_ERROR(
-      executor_->SelectExecutionsByID({event.execution_id()}, &executions));
-  RecordSet record_set;
-  if (artifacts.records_size() == 0)
-    return absl::InvalidArgumentError(
-        absl::StrCat("No artifact with the given id ", event.artifact_id()));
-  if (executions.records_size() == 0)
-    return absl::InvalidArgumentError(
-        absl::StrCat("No execution with the given id ", event.execution_id()));
+  if (!is_already_validated) {
+    ResultSet artifacts;
+    MLMD_RETURN_IF_ERROR(
+        executor_->SelectArtifactsByID({event.artifact_id()}, &artifacts));
+    ResultSet executions;
+    MLMD_RETURN_IF_ERROR(
+        executor_->SelectExecutionsByID({event.execution_id()}, &executions));
+    if (artifacts.num_rows() == 0)
+      return absl::InvalidArgumentError(
+          absl::StrCat("No artifact with the given id ", event.artifact_id()));
+    if (executions.num_rows() == 0)
+      return absl::InvalidArgumentError(absl::StrCat(
+          "No execution with the given id ", event.execution_id()));
+  }
 
   // insert an event and get its given id
   int64 event_time = event.has_milliseconds_since_epoch()
@@ -1447,12 +1836,8 @@ absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
         absl::StrCat("Given event already exists: ", event.DebugString(),
                      status.ToString()));
   }
-  // insert event paths
-  for (const Event::Path::Step& step : event.path().steps()) {
-    // step value oneof
-    MLMD_RETURN_IF_ERROR(executor_->InsertEventPath(*event_id, step));
-  }
-  return absl::OkStatus();
+  // insert event paths, which are sent together
+  return executor_->InsertEventPaths(*event_id, event.path());
 }
 
 absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
@@ -1461,13 +1846,13 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
     return absl::InvalidArgumentError("Given events is NULL.");
   }
 
-  RecordSet event_record_set;
+  ResultSet event_record_set;
   if (!artifact_ids.empty()) {
     MLMD_RETURN_IF_ERROR(
         executor_->SelectEventByArtifactIDs(artifact_ids, &event_record_set));
   }
 
-  if (event_record_set.records_size() == 0) {
+  if (event_record_set.num_rows() == 0) {
     return absl::NotFoundError("Cannot find events by given artifact ids.");
   }
   return FindEventsFromRecordSet(event_record_set, events);
@@ -1479,13 +1864,13 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
     return absl::InvalidArgumentError("Given events is NULL.");
   }
 
-  RecordSet event_record_set;
+  ResultSet event_record_set;
   if (!execution_ids.empty()) {
     MLMD_RETURN_IF_ERROR(
         executor_->SelectEventByExecutionIDs(execution_ids, &event_record_set));
   }
 
-  if (event_record_set.records_size() == 0) {
+  if (event_record_set.num_rows() == 0) {
     return absl::NotFoundError("Cannot find events by given execution ids.");
   }
   return FindEventsFromRecordSet(event_record_set, events);
@@ -1493,21 +1878,32 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
 
 absl::Status RDBMSMetadataAccessObject::CreateAssociation(
     const Association& association, int64* association_id) {
+  return CreateAssociation(association, /*is_already_validated=*/false,
+                           association_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateAssociation(
+    const Association& association, const bool is_already_validated,
+    int64* association_id) {
   if (!association.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
-  RecordSet context_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({association.context_id()},
-                                                     &context_id_header));
-  if (context_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Context id not found.");
+  if (!is_already_validated) {
+    ResultSet context_id_header;
+    MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
+        {association.context_id()}, &context_id_header));
+    if (context_id_header.num_rows() == 0)
+      return absl::InvalidArgumentError("Context id not found.");
+  }
 
   if (!association.has_execution_id())
     return absl::InvalidArgumentError("No execution id is specified");
-  RecordSet execution_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
-      {association.execution_id()}, &execution_id_header));
-  if (execution_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Execution id not found.");
+  if (!is_already_validated) {
+    ResultSet execution_id_header;
+    MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
+        {association.execution_id()}, &execution_id_header));
+    if (execution_id_header.num_rows() == 0)
+      return absl::InvalidArgumentError("Execution id not found.");
+  }
 
   absl::Status status = executor_->InsertAssociation(
       association.context_id(), association.execution_id(), association_id);
@@ -1523,7 +1919,7 @@ absl::Status RDBMSMetadataAccessObject::CreateAssociation(
 
 absl::Status RDBMSMetadataAccessObject::FindContextsByExecution(
     int64 execution_id, std::vector<Context>* contexts) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectAssociationByExecutionID(execution_id, &record_set));
   const std::vector<int64> context_ids = AssociationsToContextIds(record_set);
@@ -1544,7 +1940,7 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
 absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
     int64 context_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Execution>* executions, std::string* next_page_token) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectAssociationByContextIDs({context_id}, &record_set));
   const std::vector<int64> ids = AssociationsToExecutionIds(record_set);
@@ -1560,21 +1956,32 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
 
 absl::Status RDBMSMetadataAccessObject::CreateAttribution(
     const Attribution& attribution, int64* attribution_id) {
+  return CreateAttribution(attribution, /*is_already_validated=*/false,
+                           attribution_id);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateAttribution(
+    const Attribution& attribution, const bool is_already_validated,
+    int64* attribution_id) {
   if (!attribution.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
-  RecordSet context_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({attribution.context_id()},
-                                                     &context_id_header));
-  if (context_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Context id not found.");
+  if (!is_already_validated) {
+    ResultSet context_id_header;
+    MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
+        {attribution.context_id()}, &context_id_header));
+    if (context_id_header.num_rows() == 0)
+      return absl::InvalidArgumentError("Context id not found.");
+  }
 
   if (!attribution.has_artifact_id())
     return absl::InvalidArgumentError("No artifact id is specified");
-  RecordSet artifact_id_header;
-  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
-      {attribution.artifact_id()}, &artifact_id_header));
-  if (artifact_id_header.records_size() == 0)
-    return absl::InvalidArgumentError("Artifact id not found.");
+  if (!is_already_validated) {
+    ResultSet artifact_id_header;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
+        {attribution.artifact_id()}, &artifact_id_header));
+    if (artifact_id_header.num_rows() == 0)
+      return absl::InvalidArgumentError("Artifact id not found.");
+  }
 
   absl::Status status = executor_->InsertAttributionDirect(
       attribution.context_id(), attribution.artifact_id(), attribution_id);
@@ -1589,7 +1996,7 @@ absl::Status RDBMSMetadataAccessObject::CreateAttribution(
 
 absl::Status RDBMSMetadataAccessObject::FindContextsByArtifact(
     int64 artifact_id, std::vector<Context>* contexts) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectAttributionByArtifactID(artifact_id, &record_set));
   const std::vector<int64> context_ids = AttributionsToContextIds(record_set);
@@ -1610,7 +2017,7 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
     int64 context_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Artifact>* artifacts, std::string* next_page_token) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectAttributionByContextID(context_id, &record_set));
   const std::vector<int64> ids = AttributionsToArtifactIds(record_set);
@@ -1631,11 +2038,11 @@ absl::Status RDBMSMetadataAccessObject::CreateParentContext(
         absl::StrCat("Missing parent / child id in the parent_context: ",
                      parent_context.DebugString()));
   }
-  RecordSet contexts_id_header;
+  ResultSet contexts_id_header;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
       {parent_context.parent_id(), parent_context.child_id()},
       &contexts_id_header));
-  if (contexts_id_header.records_size() < 2) {
+  if (contexts_id_header.num_rows() < 2) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Given parent / child id in the parent_context cannot be found: ",
         parent_context.DebugString()));
@@ -1656,7 +2063,7 @@ absl::Status RDBMSMetadataAccessObject::CreateParentContext(
 absl::Status RDBMSMetadataAccessObject::FindLinkedContextsImpl(
     int64 context_id, ParentContextTraverseDirection direction,
     std::vector<Context>& output_contexts) {
-  RecordSet record_set;
+  ResultSet record_set;
   if (direction == ParentContextTraverseDirection::kParent) {
     MLMD_RETURN_IF_ERROR(
         executor_->SelectParentContextsByContextID(context_id, &record_set));
@@ -1696,7 +2103,7 @@ absl::Status RDBMSMetadataAccessObject::FindChildContextsByContextId(
 
 absl::Status RDBMSMetadataAccessObject::FindArtifacts(
     std::vector<Artifact>* artifacts) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectAllArtifactIDs(&record_set));
   std::vector<int64> ids = ConvertToIds(record_set);
   if (ids.empty()) {
@@ -1709,7 +2116,7 @@ template <>
 absl::Status RDBMSMetadataAccessObject::ListNodeIds(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set, Artifact* tag) {
+    ResultSet* record_set, Artifact* tag) {
   return executor_->ListArtifactIDsUsingOptions(options, candidate_ids,
                                                 record_set);
 }
@@ -1718,7 +2125,7 @@ template <>
 absl::Status RDBMSMetadataAccessObject::ListNodeIds(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set, Execution* tag) {
+    ResultSet* record_set, Execution* tag) {
   return executor_->ListExecutionIDsUsingOptions(options, candidate_ids,
                                                  record_set);
 }
@@ -1727,7 +2134,7 @@ template <>
 absl::Status RDBMSMetadataAccessObject::ListNodeIds(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
-    RecordSet* record_set, Context* tag) {
+    ResultSet* record_set, Context* tag) {
   return executor_->ListContextIDsUsingOptions(options, candidate_ids,
                                                record_set);
 }
@@ -1752,7 +2159,7 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
   ListOperationOptions updated_options = options;
   updated_options.set_max_result_size(options.max_result_size() + 1);
   // Retrieve ids based on the list options
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       ListNodeIds<Node>(updated_options, candidate_ids, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1805,9 +2212,74 @@ absl::Status RDBMSMetadataAccessObject::ListContexts(
   return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token);
 }
 
+template <>
+absl::Status RDBMSMetadataAccessObject::SelectNodeIdsAfterId(
+    const int64 after_id, const int max_num_ids, ResultSet* record_set,
+    Artifact* tag) {
+  return executor_->SelectArtifactIDsAfterID(after_id, max_num_ids,
+                                             record_set);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::SelectNodeIdsAfterId(
+    const int64 after_id, const int max_num_ids, ResultSet* record_set,
+    Execution* tag) {
+  return executor_->SelectExecutionIDsAfterID(after_id, max_num_ids,
+                                              record_set);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::SelectNodeIdsAfterId(
+    const int64 after_id, const int max_num_ids, ResultSet* record_set,
+    Context* tag) {
+  return executor_->SelectContextIDsAfterID(after_id, max_num_ids,
+                                            record_set);
+}
+
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::ListNodesAfterId(
+    const int64 after_id, const int max_num_nodes, std::vector<Node>* nodes) {
+  if (max_num_nodes <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "max_num_nodes is required to be greater than 0. Set value:",
+        max_num_nodes));
+  }
+  if (!nodes->empty()) {
+    return absl::InvalidArgumentError("nodes argument is not empty");
+  }
+  ResultSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      SelectNodeIdsAfterId<Node>(after_id, max_num_nodes, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  // The nodes are retrieved in ascending order of id.
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListArtifactsAfterId(
+    const int64 after_id, const int max_num_artifacts,
+    std::vector<Artifact>* artifacts) {
+  return ListNodesAfterId<Artifact>(after_id, max_num_artifacts, artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListExecutionsAfterId(
+    const int64 after_id, const int max_num_executions,
+    std::vector<Execution>* executions) {
+  return ListNodesAfterId<Execution>(after_id, max_num_executions,
+                                     executions);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListContextsAfterId(
+    const int64 after_id, const int max_num_contexts,
+    std::vector<Context>* contexts) {
+  return ListNodesAfterId<Context>(after_id, max_num_contexts, contexts);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
     const int64 type_id, const absl::string_view name, Artifact* artifact) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectArtifactByTypeIDAndArtifactName(
       type_id, name, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1829,7 +2301,7 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
     const int64 type_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Artifact>* artifacts, std::string* next_page_token) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectArtifactsByTypeID(type_id, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1847,7 +2319,7 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByTypeId(
 
 absl::Status RDBMSMetadataAccessObject::FindExecutions(
     std::vector<Execution>* executions) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectAllExecutionIDs(&record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
   if (ids.empty()) {
@@ -1858,7 +2330,7 @@ absl::Status RDBMSMetadataAccessObject::FindExecutions(
 
 absl::Status RDBMSMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
     const int64 type_id, const absl::string_view name, Execution* execution) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectExecutionByTypeIDAndExecutionName(
       type_id, name, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1881,7 +2353,7 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
 absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
     const int64 type_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Execution>* executions, std::string* next_page_token) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(
       executor_->SelectExecutionsByTypeID(type_id, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1899,7 +2371,7 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
 
 absl::Status RDBMSMetadataAccessObject::FindContexts(
     std::vector<Context>* contexts) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectAllContextIDs(&record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
   if (ids.empty()) {
@@ -1911,7 +2383,7 @@ absl::Status RDBMSMetadataAccessObject::FindContexts(
 absl::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
     const int64 type_id, absl::optional<ListOperationOptions> list_options,
     std::vector<Context>* contexts, std::string* next_page_token) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByTypeID(type_id, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
   if (ids.empty()) {
@@ -1929,7 +2401,7 @@ absl::Status RDBMSMetadataAccessObject::FindContextsByTypeId(
 
 absl::Status RDBMSMetadataAccessObject::FindArtifactsByURI(
     const absl::string_view uri, std::vector<Artifact>* artifacts) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByURI(uri, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
   if (ids.empty()) {
@@ -1941,7 +2413,7 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByURI(
 
 absl::Status RDBMSMetadataAccessObject::FindContextByTypeIdAndContextName(
     int64 type_id, absl::string_view name, bool id_only, Context* context) {
-  RecordSet record_set;
+  ResultSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextByTypeIDAndContextName(
       type_id, name, &record_set));
   const std::vector<int64> ids = ConvertToIds(record_set);
@@ -1983,7 +2455,7 @@ absl::Status RDBMSMetadataAccessObject::SkipBoundaryNodesImpl(
     boundary_options.set_max_result_size(kBatchSize);
     boundary_options.set_filter_query(
         absl::Substitute("NOT($0)", *boundary_condition));
-    RecordSet record_set;
+    ResultSet record_set;
     MLMD_RETURN_IF_ERROR(ListNodeIds<Node>(
         boundary_options, list_ids.subspan(i * kBatchSize, kBatchSize),
         &record_set));
@@ -16,14 +16,18 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_RDBMS_METADATA_ACCESS_OBJECT_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "google/protobuf/field_mask.pb.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/query_executor.h"
+#include "ml_metadata/metadata_store/result_set.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
@@ -46,8 +50,10 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   virtual ~RDBMSMetadataAccessObject() = default;
 
   // default & copy constructors are disallowed.
-  RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor)
-      : executor_(std::move(executor)) {}
+  // The types are cached in `type_cache` if it is given, which is not owned.
+  RDBMSMetadataAccessObject(std::unique_ptr<QueryExecutor> executor,
+                            TypeCache* type_cache = nullptr)
+      : executor_(std::move(executor)), type_cache_(type_cache) {}
 
   // default & copy constructors are disallowed.
   RDBMSMetadataAccessObject() = delete;
@@ -144,6 +150,9 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateArtifact(const Artifact& artifact,
                               int64* artifact_id) final;
 
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+
   absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
                                  std::vector<Artifact>* artifacts) final;
 
@@ -161,6 +170,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                             std::vector<Context>* contexts,
                             std::string* next_page_token) final;
 
+  absl::Status ListArtifactsAfterId(int64 after_id, int max_num_artifacts,
+                                    std::vector<Artifact>* artifacts) final;
+
+  absl::Status ListExecutionsAfterId(int64 after_id, int max_num_executions,
+                                     std::vector<Execution>* executions) final;
+
+  absl::Status ListContextsAfterId(int64 after_id, int max_num_contexts,
+                                   std::vector<Context>* contexts) final;
+
   absl::Status FindArtifactsByTypeId(
       int64 artifact_type_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Artifact>* artifacts, std::string* next_page_token) final;
@@ -174,9 +192,16 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   absl::Status UpdateArtifact(const Artifact& artifact) final;
 
+  absl::Status UpdateArtifact(const Artifact& artifact,
+                              const google::protobuf::FieldMask& update_mask,
+                              absl::optional<int64> last_update_time) final;
+
   absl::Status CreateExecution(const Execution& execution,
                                int64* execution_id) final;
 
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
                                   std::vector<Execution>* executions) final;
 
@@ -192,8 +217,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   absl::Status UpdateExecution(const Execution& execution) final;
 
+  absl::Status UpdateExecution(const Execution& execution,
+                               const google::protobuf::FieldMask& update_mask,
+                               absl::optional<int64> last_update_time) final;
+
   absl::Status CreateContext(const Context& context, int64* context_id) final;
 
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+
   absl::Status FindContextsById(absl::Span<const int64> context_ids,
                                 std::vector<Context>* contexts) final;
 
@@ -210,8 +242,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   absl::Status UpdateContext(const Context& context) final;
 
+  absl::Status UpdateContext(const Context& context,
+                             const google::protobuf::FieldMask& update_mask,
+                             absl::optional<int64> last_update_time) final;
+
   absl::Status CreateEvent(const Event& event, int64* event_id) final;
 
+  absl::Status CreateEvent(const Event& event, bool is_already_validated,
+                           int64* event_id) final;
+
   absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
                                      std::vector<Event>* events) final;
 
@@ -221,6 +260,10 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateAssociation(const Association& association,
                                  int64* association_id) final;
 
+  absl::Status CreateAssociation(const Association& association,
+                                 bool is_already_validated,
+                                 int64* association_id) final;
+
 
   absl::Status FindContextsByExecution(int64 execution_id,
                                        std::vector<Context>* contexts) final;
@@ -235,6 +278,10 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateAttribution(const Attribution& attribution,
                                  int64* attribution_id) final;
 
+  absl::Status CreateAttribution(const Attribution& attribution,
+                                 bool is_already_validated,
+                                 int64* attribution_id) final;
+
   absl::Status FindContextsByArtifact(int64 artifact_id,
                                       std::vector<Context>* contexts) final;
 
@@ -342,15 +389,25 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Creates a Context (without properties).
   absl::Status CreateBasicNode(const Context& context, int64* node_id);
 
-  // Retrieves nodes (and their properties) based on the provided 'ids'.
-  // 'header' contains the non-property information, and 'properties' contains
-  // information about properties. The node id is present in both record sets
-  // and can be used to join the information. The 'properties' are returned
-  // using the same convention as
-  // QueryExecutor::Select{Node}PropertyBy{Node}ID().
+  // Creates Artifacts (without properties) with bulk inserts.
+  absl::Status CreateBasicNodes(absl::Span<const Artifact> artifacts,
+                                std::vector<int64>* node_ids);
+
+  // Creates Executions (without properties) with bulk inserts.
+  absl::Status CreateBasicNodes(absl::Span<const Execution> executions,
+                                std::vector<int64>* node_ids);
+
+  // Creates Contexts (without properties) with bulk inserts.
+  absl::Status CreateBasicNodes(absl::Span<const Context> contexts,
+                                std::vector<int64>* node_ids);
+
+  // Retrieves nodes (and their properties) based on the provided 'ids' in one
+  // query, and streams their rows in batches to 'callback'. The rows are sorted
+  // by node id, with a row per property of a node, using the same convention
+  // as QueryExecutor::Select{Node}sWithPropertiesByID().
   template <typename T>
   absl::Status RetrieveNodesById(
-      absl::Span<const int64> id, RecordSet* header, RecordSet* properties,
+      absl::Span<const int64> id, MetadataSource::RowBatchCallback callback,
       T* tag = nullptr /* used only for the template */);
 
   // Update an Artifact's type_id and URI.
@@ -362,12 +419,39 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Update a Context's type id and name.
   absl::Status RunNodeUpdate(const Context& context);
 
+  // Update the fields of an Artifact named by `fields` (uri, state) without
+  // reading it, if it still has the `last_update_time`.
+  absl::Status RunNodeFieldsUpdate(
+      const Artifact& artifact, const absl::flat_hash_set<std::string>& fields,
+      absl::optional<int64> last_update_time);
+
+  // Update the fields of an Execution named by `fields` (last_known_state).
+  absl::Status RunNodeFieldsUpdate(
+      const Execution& execution,
+      const absl::flat_hash_set<std::string>& fields,
+      absl::optional<int64> last_update_time);
+
+  // Update the fields of a Context named by `fields` (name).
+  absl::Status RunNodeFieldsUpdate(
+      const Context& context, const absl::flat_hash_set<std::string>& fields,
+      absl::optional<int64> last_update_time);
+
   // Runs a property insertion query for a NodeType.
   template <typename NodeType>
   absl::Status InsertProperty(const int64 node_id, const absl::string_view name,
                               const bool is_custom_property,
                               const Value& value);
 
+  // Runs bulk property insertion queries for a NodeType.
+  template <typename NodeType>
+  absl::Status InsertProperties(
+      absl::Span<const QueryExecutor::NodeProperty> properties);
+
+  // Runs bulk property upsert queries for a NodeType.
+  template <typename NodeType>
+  absl::Status UpsertProperties(
+      absl::Span<const QueryExecutor::NodeProperty> properties);
+
   // Generates a property update query for a NodeType.
   template <typename NodeType>
   absl::Status UpdateProperty(const int64 node_id, const absl::string_view name,
@@ -414,14 +498,19 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   // Generates a query to find all type instances.
   absl::Status GenerateFindAllTypeInstancesQuery(const TypeKind type_kind,
-                                                 RecordSet* record_set);
+                                                 ResultSet* record_set);
+
+  // Queries the type generation to find and insert the types in `type_cache_`
+  // at. Sets `generation` to nullopt, if there is no `type_cache_` or the types
+  // cannot be cached in the transaction.
+  absl::Status GetTypeGeneration(absl::optional<int64>* generation);
 
   // FindType takes a result of a query for types, and populates additional
   // information such as properties, and returns it in `types`.
   // If `get_properties` equals false, skip the query that retrieves properties
   // from property table.
   template <typename MessageType>
-  absl::Status FindTypesFromRecordSet(const RecordSet& type_record_set,
+  absl::Status FindTypesFromRecordSet(const ResultSet& type_record_set,
                                       std::vector<MessageType>* types,
                                       bool get_properties = true);
 
@@ -485,6 +574,13 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   absl::Status CreateNodeImpl(const Node& node, int64* node_id);
 
+  // Creates the `nodes` as CreateNodeImpl with bulk inserts, and returns the
+  // assigned ids in the order of `nodes`.
+  // Returns the same errors as CreateNodeImpl for any of the nodes.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodesImpl(absl::Span<const Node> nodes,
+                               std::vector<int64>* node_ids);
+
   // Queries a `Node` which is one of {`Artifact`, `Execution`, `Context`} by
   // an id.
   // Returns NOT_FOUND error, if the given id cannot be found.
@@ -511,18 +607,31 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   absl::Status UpdateNodeImpl(const Node& node);
 
+  // Updates the fields and properties of a `Node` listed in `update_mask`
+  // without reading it first. The node row is updated with one conditional
+  // query, and the node is only read if no row is updated to tell the error.
+  // Returns INVALID_ARGUMENT error, if a path is unknown, or the node cannot be
+  // found, or does not match with its type.
+  // Returns FAILED_PRECONDITION error, if the node has been updated after
+  // `last_update_time`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  absl::Status UpdateNodeImpl(const Node& node,
+                              const google::protobuf::FieldMask& update_mask,
+                              absl::optional<int64> last_update_time);
+
   // Takes a record set that has one record per event and for each record:
   //   parses it into an Event object
   //   gets the path of the event from the database
   // Returns INVALID_ARGUMENT error, if the `events` is null.
-  absl::Status FindEventsFromRecordSet(const RecordSet& event_record_set,
+  absl::Status FindEventsFromRecordSet(const ResultSet& event_record_set,
                                        std::vector<Event>* events);
 
   // Takes a record set that has one record per association and parses it into
   // an Association object for each record.
   // Returns INVALID_ARGUMENT error, if the `associations` is null.
   absl::Status FindAssociationsFromRecordSet(
-      const RecordSet& association_record_set,
+      const ResultSet& association_record_set,
       std::vector<Association>* associations);
 
   // Retrieves the ids of the nodes based on 'options' and `candidate_ids`.
@@ -535,7 +644,7 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status ListNodeIds(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
-      RecordSet* record_set,
+      ResultSet* record_set,
       Node* tag = nullptr /* used only for template instantiation*/);
 
   // Queries nodes stored in the metadata source using `options`.
@@ -560,6 +669,22 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                          std::vector<Node>* nodes,
                          std::string* next_page_token);
 
+  // Retrieves the ids of up to `max_num_ids` nodes with ids greater than
+  // `after_id` in ascending order. The returned record_set has a single row
+  // per id.
+  template <typename Node>
+  absl::Status SelectNodeIdsAfterId(
+      int64 after_id, int max_num_ids, ResultSet* record_set,
+      Node* tag = nullptr /* used only for template instantiation*/);
+
+  // Queries up to `max_num_nodes` nodes with ids greater than `after_id` in
+  // ascending order of id.
+  // RETURNS INVALID_ARGUMENT if `max_num_nodes` is not positive or `nodes` is
+  //    not empty.
+  template <typename Node>
+  absl::Status ListNodesAfterId(int64 after_id, int max_num_nodes,
+                                std::vector<Node>* nodes);
+
   // Traverse a ParentContext relation to look for parent or child context.
   enum class ParentContextTraverseDirection { kParent, kChild };
 
@@ -608,6 +733,9 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   std::unique_ptr<QueryExecutor> executor_;
 
+  // The cache of the types, or null if the types are not cached.
+  TypeCache* type_cache_;
+
   friend RDBMSMetadataAccessObjectTest;
 };
 
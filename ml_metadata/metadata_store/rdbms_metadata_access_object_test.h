@@ -105,7 +105,7 @@ class RDBMSMetadataAccessObjectTest
                                       std::vector<MessageType>* types,
                                       bool get_properties) {
     return rdbms_metadata_access_object_->FindTypesFromRecordSet(
-        type_record_set, types, get_properties);
+        ResultSet::FromRecordSet(type_record_set), types, get_properties);
   }
 
   template <typename MessageType>
@@ -0,0 +1,116 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/read_coalescer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the key of the reads of `request` to `method`. The serialization is
+// deterministic, so that identical requests with map fields share a key.
+std::string GetReadKey(const absl::string_view method,
+                       const google::protobuf::Message& request) {
+  std::string key = absl::StrCat(method, ":");
+  {
+    google::protobuf::io::StringOutputStream stream(&key);
+    google::protobuf::io::CodedOutputStream output(&stream);
+    output.SetSerializationDeterministic(true);
+    request.SerializeToCodedStream(&output);
+  }
+  return key;
+}
+
+}  // namespace
+
+absl::Status ReadCoalescer::Coalesce(const absl::string_view method,
+                                     const google::protobuf::Message& request,
+                                     google::protobuf::Message* response,
+                                     const Read& read,
+                                     const absl::Time deadline) {
+  const std::string key = GetReadKey(method, request);
+  std::shared_ptr<Flight> flight;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = flights_.find(key);
+    if (it != flights_.end() && it->second->generation == generation_) {
+      // Waits for the identical read in progress.
+      std::shared_ptr<Flight> leader = it->second;
+      ++leader->num_waiters;
+      if (!mu_.AwaitWithDeadline(absl::Condition(&leader->is_done),
+                                 deadline)) {
+        --leader->num_waiters;
+        return absl::DeadlineExceededError(absl::StrCat(
+            "Deadline exceeded while waiting for the identical ", method,
+            " read in progress."));
+      }
+      if (!absl::IsCancelled(leader->status) &&
+          !absl::IsDeadlineExceeded(leader->status)) {
+        if (leader->status.ok()) {
+          response->CopyFrom(*leader->response);
+        }
+        return leader->status;
+      }
+    } else {
+      // Starts a read, which replaces the reads which have started before the
+      // last write.
+      flight = std::make_shared<Flight>();
+      flight->generation = generation_;
+      flights_[key] = flight;
+    }
+  }
+  if (flight == nullptr) {
+    // The read waited for has been stopped for its own request.
+    return read(response);
+  }
+
+  const absl::Status status = read(response);
+  int num_waiters;
+  {
+    absl::MutexLock lock(&mu_);
+    // No more requests wait for the read once it is removed.
+    auto it = flights_.find(key);
+    if (it != flights_.end() && it->second == flight) {
+      flights_.erase(it);
+    }
+    num_waiters = flight->num_waiters;
+  }
+  std::unique_ptr<google::protobuf::Message> shared_response;
+  if (num_waiters > 0 && status.ok()) {
+    shared_response.reset(response->New());
+    shared_response->CopyFrom(*response);
+  }
+  absl::MutexLock lock(&mu_);
+  flight->status = status;
+  flight->response = std::move(shared_response);
+  flight->is_done = true;
+  return status;
+}
+
+void ReadCoalescer::WriteFinished() {
+  absl::MutexLock lock(&mu_);
+  ++generation_;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,94 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_READ_COALESCER_H_
+#define ML_METADATA_METADATA_STORE_READ_COALESCER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Deduplicates identical read requests which are in progress at the same time,
+// e.g., the GetArtifactType requests of the workers of a pipeline run which
+// start together, so that they share a single execution on the database.
+//
+// The first request with a given method and serialized request runs its read,
+// and the identical requests which arrive before it finishes wait for it and
+// get a copy of its response. A request only waits for a read which has
+// started after the last call of WriteFinished, so that it does not get a
+// response which misses a write finished before the request.
+//
+// This class is thread-safe.
+class ReadCoalescer {
+ public:
+  // A read request, which fills the given response.
+  using Read = std::function<absl::Status(google::protobuf::Message* response)>;
+
+  ReadCoalescer() = default;
+
+  // Disallow copy and assign.
+  ReadCoalescer(const ReadCoalescer&) = delete;
+  ReadCoalescer& operator=(const ReadCoalescer&) = delete;
+
+  // Fills `response` with the response of the read of `request` to `method`,
+  // either by running `read`, or by waiting for an identical read in progress.
+  // If the identical read is cancelled or exceeds its deadline, `read` is run
+  // instead. A request waits for the identical read until its own `deadline`.
+  // Returns DEADLINE_EXCEEDED error, if the identical read is still in
+  // progress at `deadline`.
+  // Returns the error of the read.
+  absl::Status Coalesce(absl::string_view method,
+                        const google::protobuf::Message& request,
+                        google::protobuf::Message* response, const Read& read,
+                        absl::Time deadline = absl::InfiniteFuture());
+
+  // Records that a write has finished. The reads in progress are no longer
+  // shared with the requests which start afterwards.
+  void WriteFinished();
+
+ private:
+  // A read in progress, and the requests waiting for its response.
+  struct Flight {
+    // The value of `generation_` when the read has started.
+    int64 generation = 0;
+    int num_waiters = 0;
+    // True if `status` and `response` are set.
+    bool is_done = false;
+    absl::Status status;
+    // A copy of the response for the waiters, or null if there is none.
+    std::unique_ptr<google::protobuf::Message> response;
+  };
+
+  absl::Mutex mu_;
+  // The number of calls of WriteFinished.
+  int64 generation_ ABSL_GUARDED_BY(mu_) = 0;
+  // The reads in progress by method and serialized request.
+  absl::flat_hash_map<std::string, std::shared_ptr<Flight>> flights_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_READ_COALESCER_H_
@@ -0,0 +1,191 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/read_coalescer.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+// The time given to the concurrent requests to wait for a read in progress.
+constexpr absl::Duration kJoinTime = absl::Milliseconds(200);
+
+class ReadCoalescerTest : public ::testing::Test {
+ protected:
+  // Returns a read which blocks until `release_` is notified, and then
+  // returns a type with the given `id`, or `status` if it is not ok.
+  ReadCoalescer::Read BlockingRead(
+      const int64 id, const absl::Status status = absl::OkStatus()) {
+    return [this, id, status](google::protobuf::Message* response) {
+      ++num_runs_;
+      release_.WaitForNotification();
+      static_cast<GetArtifactTypeResponse*>(response)
+          ->mutable_artifact_type()
+          ->set_id(id);
+      return status;
+    };
+  }
+
+  ReadCoalescer read_coalescer_;
+  absl::Notification release_;
+  std::atomic<int> num_runs_{0};
+};
+
+TEST_F(ReadCoalescerTest, SharesIdenticalConcurrentReads) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  std::vector<GetArtifactTypeResponse> responses(4);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i]() {
+      EXPECT_EQ(absl::OkStatus(),
+                read_coalescer_.Coalesce("GetArtifactType", request,
+                                         &responses[i], BlockingRead(i + 1)));
+    });
+  }
+  absl::SleepFor(kJoinTime);
+  release_.Notify();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(1, num_runs_);
+  for (const GetArtifactTypeResponse& response : responses) {
+    EXPECT_EQ(responses[0].artifact_type().id(), response.artifact_type().id());
+  }
+}
+
+TEST_F(ReadCoalescerTest, DoesNotShareDifferentReads) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  GetArtifactTypeResponse response;
+  std::thread blocked_read([&]() {
+    EXPECT_EQ(absl::OkStatus(),
+              read_coalescer_.Coalesce("GetArtifactType", request, &response,
+                                       BlockingRead(1)));
+  });
+  absl::SleepFor(kJoinTime);
+
+  // Reads of another request or another method run on their own.
+  GetArtifactTypeRequest other_request;
+  other_request.set_type_name("other_type");
+  GetArtifactTypeResponse other_response;
+  EXPECT_EQ(absl::OkStatus(),
+            read_coalescer_.Coalesce(
+                "GetArtifactType", other_request, &other_response,
+                [](google::protobuf::Message*) { return absl::OkStatus(); }));
+  GetExecutionTypeResponse other_method_response;
+  EXPECT_EQ(absl::OkStatus(),
+            read_coalescer_.Coalesce(
+                "GetExecutionType", request, &other_method_response,
+                [](google::protobuf::Message*) { return absl::OkStatus(); }));
+  release_.Notify();
+  blocked_read.join();
+}
+
+TEST_F(ReadCoalescerTest, DoesNotShareReadStartedBeforeWrite) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  GetArtifactTypeResponse response;
+  std::thread blocked_read([&]() {
+    EXPECT_EQ(absl::OkStatus(),
+              read_coalescer_.Coalesce("GetArtifactType", request, &response,
+                                       BlockingRead(1)));
+  });
+  absl::SleepFor(kJoinTime);
+  read_coalescer_.WriteFinished();
+
+  // The read in progress may miss the write, so the request runs its own read.
+  GetArtifactTypeResponse response_after_write;
+  EXPECT_EQ(absl::OkStatus(),
+            read_coalescer_.Coalesce(
+                "GetArtifactType", request, &response_after_write,
+                [](google::protobuf::Message* response) {
+                  static_cast<GetArtifactTypeResponse*>(response)
+                      ->mutable_artifact_type()
+                      ->set_id(2);
+                  return absl::OkStatus();
+                }));
+  EXPECT_EQ(2, response_after_write.artifact_type().id());
+  release_.Notify();
+  blocked_read.join();
+  EXPECT_EQ(1, response.artifact_type().id());
+}
+
+TEST_F(ReadCoalescerTest, StopsWaitingAtDeadline) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  GetArtifactTypeResponse response;
+  std::thread blocked_read([&]() {
+    EXPECT_EQ(absl::OkStatus(),
+              read_coalescer_.Coalesce("GetArtifactType", request, &response,
+                                       BlockingRead(1)));
+  });
+  absl::SleepFor(kJoinTime);
+
+  // The identical request gives up waiting for the read at its deadline.
+  GetArtifactTypeResponse waiter_response;
+  const absl::Status status = read_coalescer_.Coalesce(
+      "GetArtifactType", request, &waiter_response, BlockingRead(2),
+      absl::Now() + kJoinTime);
+  EXPECT_TRUE(absl::IsDeadlineExceeded(status));
+  EXPECT_FALSE(waiter_response.has_artifact_type());
+  release_.Notify();
+  blocked_read.join();
+  EXPECT_EQ(1, response.artifact_type().id());
+  EXPECT_EQ(1, num_runs_);
+}
+
+TEST_F(ReadCoalescerTest, RunsReadAgainIfSharedReadIsCancelled) {
+  GetArtifactTypeRequest request;
+  request.set_type_name("test_type");
+  GetArtifactTypeResponse cancelled_response;
+  absl::Status cancelled_status;
+  std::thread cancelled_read([&]() {
+    cancelled_status = read_coalescer_.Coalesce(
+        "GetArtifactType", request, &cancelled_response,
+        BlockingRead(1, absl::CancelledError("cancelled")));
+  });
+  absl::SleepFor(kJoinTime);
+  GetArtifactTypeResponse response;
+  absl::Status status;
+  std::thread read([&]() {
+    status = read_coalescer_.Coalesce(
+        "GetArtifactType", request, &response, BlockingRead(2));
+  });
+  absl::SleepFor(kJoinTime);
+  release_.Notify();
+  cancelled_read.join();
+  read.join();
+
+  EXPECT_TRUE(absl::IsCancelled(cancelled_status));
+  EXPECT_EQ(absl::OkStatus(), status);
+  EXPECT_EQ(2, response.artifact_type().id());
+  EXPECT_EQ(2, num_runs_);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,50 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/read_your_writes_guard.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+
+ReadYourWritesGuard::ReadYourWritesGuard(const absl::Duration window)
+    : window_(window) {}
+
+void ReadYourWritesGuard::WriteFinished(const absl::string_view token,
+                                        const absl::Time now) {
+  absl::MutexLock lock(&mu_);
+  ForgetExpiredWrites(now);
+  last_write_times_[token] = now;
+  writes_.emplace_back(now, std::string(token));
+}
+
+bool ReadYourWritesGuard::HasRecentWrite(const absl::string_view token,
+                                         const absl::Time now) {
+  absl::MutexLock lock(&mu_);
+  ForgetExpiredWrites(now);
+  return last_write_times_.contains(token);
+}
+
+void ReadYourWritesGuard::ForgetExpiredWrites(const absl::Time now) {
+  while (!writes_.empty() && writes_.front().first + window_ <= now) {
+    auto it = last_write_times_.find(writes_.front().second);
+    // A later write of the token keeps it.
+    if (it != last_write_times_.end() && it->second == writes_.front().first) {
+      last_write_times_.erase(it);
+    }
+    writes_.pop_front();
+  }
+}
+
+}  // namespace ml_metadata
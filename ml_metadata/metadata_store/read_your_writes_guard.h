@@ -0,0 +1,68 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_READ_YOUR_WRITES_GUARD_H_
+#define ML_METADATA_METADATA_STORE_READ_YOUR_WRITES_GUARD_H_
+
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+// Remembers the clients which have written recently, so that their reads can
+// be sent to the primary database instead of a read replica which may not have
+// replicated their writes yet. The clients are identified by tokens they pass
+// with their requests.
+//
+// This class is thread-safe.
+class ReadYourWritesGuard {
+ public:
+  // Creates a guard which remembers the writes for `window`.
+  explicit ReadYourWritesGuard(absl::Duration window);
+
+  // Disallow copy and assign.
+  ReadYourWritesGuard(const ReadYourWritesGuard&) = delete;
+  ReadYourWritesGuard& operator=(const ReadYourWritesGuard&) = delete;
+
+  // Records that the client with `token` has finished a write at `now`.
+  void WriteFinished(absl::string_view token, absl::Time now = absl::Now());
+
+  // Returns true if the client with `token` has finished a write within the
+  // window before `now`.
+  bool HasRecentWrite(absl::string_view token, absl::Time now = absl::Now());
+
+ private:
+  // Forgets the writes finished before the window preceding `now`.
+  void ForgetExpiredWrites(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration window_;
+
+  absl::Mutex mu_;
+  // The time of the last write by token.
+  absl::flat_hash_map<std::string, absl::Time> last_write_times_
+      ABSL_GUARDED_BY(mu_);
+  // The writes in the order they have finished, to expire the tokens.
+  std::deque<std::pair<absl::Time, std::string>> writes_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_READ_YOUR_WRITES_GUARD_H_
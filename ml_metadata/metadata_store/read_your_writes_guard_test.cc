@@ -0,0 +1,48 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/read_your_writes_guard.h"
+
+#include <gtest/gtest.h>
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+namespace {
+
+TEST(ReadYourWritesGuardTest, RemembersWritesWithinWindow) {
+  ReadYourWritesGuard guard(absl::Seconds(10));
+  const absl::Time start = absl::FromUnixSeconds(1000);
+  guard.WriteFinished("client_1", start);
+
+  EXPECT_TRUE(guard.HasRecentWrite("client_1", start + absl::Seconds(9)));
+  EXPECT_FALSE(guard.HasRecentWrite("client_2", start + absl::Seconds(9)));
+  EXPECT_FALSE(guard.HasRecentWrite("client_1", start + absl::Seconds(10)));
+}
+
+TEST(ReadYourWritesGuardTest, LaterWriteExtendsWindow) {
+  ReadYourWritesGuard guard(absl::Seconds(10));
+  const absl::Time start = absl::FromUnixSeconds(1000);
+  guard.WriteFinished("client_1", start);
+  guard.WriteFinished("client_2", start + absl::Seconds(5));
+  guard.WriteFinished("client_1", start + absl::Seconds(8));
+
+  EXPECT_TRUE(guard.HasRecentWrite("client_1", start + absl::Seconds(12)));
+  EXPECT_TRUE(guard.HasRecentWrite("client_2", start + absl::Seconds(12)));
+  EXPECT_TRUE(guard.HasRecentWrite("client_1", start + absl::Seconds(17)));
+  EXPECT_FALSE(guard.HasRecentWrite("client_2", start + absl::Seconds(17)));
+  EXPECT_FALSE(guard.HasRecentWrite("client_1", start + absl::Seconds(18)));
+}
+
+}  // namespace
+}  // namespace ml_metadata
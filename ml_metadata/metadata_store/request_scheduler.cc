@@ -0,0 +1,117 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace ml_metadata {
+
+RequestScheduler::RequestScheduler(const int num_workers,
+                                   const int max_queue_depth,
+                                   const int max_concurrent_heavy_requests)
+    : max_queue_depth_(std::max(max_queue_depth, 1)),
+      max_concurrent_heavy_requests_(
+          std::max(max_concurrent_heavy_requests, 1)) {
+  const int num_worker_threads = std::max(num_workers, 1);
+  workers_.reserve(num_worker_threads);
+  for (int i = 0; i < num_worker_threads; ++i) {
+    workers_.emplace_back([this]() { RunWorker(); });
+  }
+}
+
+RequestScheduler::~RequestScheduler() { Shutdown(); }
+
+absl::Status RequestScheduler::Schedule(const RequestClass request_class,
+                                        std::function<void()> request) {
+  absl::MutexLock lock(&mu_);
+  if (shutdown_) {
+    return absl::FailedPreconditionError(
+        "The request scheduler has been shut down.");
+  }
+  if (regular_requests_.size() + heavy_requests_.size() >= max_queue_depth_) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "The server is overloaded: ", max_queue_depth_,
+        " requests are already waiting to be executed."));
+  }
+  std::deque<QueuedRequest>& queue = request_class == RequestClass::kHeavy
+                                         ? heavy_requests_
+                                         : regular_requests_;
+  queue.push_back({next_sequence_number_++, std::move(request)});
+  return absl::OkStatus();
+}
+
+void RequestScheduler::Shutdown() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (shutdown_) return;
+    shutdown_ = true;
+  }
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+int RequestScheduler::queue_depth() const {
+  absl::MutexLock lock(&mu_);
+  return regular_requests_.size() + heavy_requests_.size();
+}
+
+bool RequestScheduler::HasWork() const {
+  const bool can_run_heavy =
+      !heavy_requests_.empty() &&
+      num_running_heavy_requests_ < max_concurrent_heavy_requests_;
+  const bool drained = regular_requests_.empty() && heavy_requests_.empty();
+  return !regular_requests_.empty() || can_run_heavy ||
+         (shutdown_ && drained);
+}
+
+void RequestScheduler::RunWorker() {
+  while (true) {
+    std::function<void()> request;
+    bool is_heavy = false;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &RequestScheduler::HasWork));
+      const bool can_run_heavy =
+          !heavy_requests_.empty() &&
+          num_running_heavy_requests_ < max_concurrent_heavy_requests_;
+      if (regular_requests_.empty() && !can_run_heavy) {
+        // Shut down and no request is left to run.
+        return;
+      }
+      // Picks the earliest scheduled request among the runnable ones.
+      is_heavy = can_run_heavy &&
+                 (regular_requests_.empty() ||
+                  heavy_requests_.front().sequence_number <
+                      regular_requests_.front().sequence_number);
+      std::deque<QueuedRequest>& queue =
+          is_heavy ? heavy_requests_ : regular_requests_;
+      request = std::move(queue.front().request);
+      queue.pop_front();
+      if (is_heavy) ++num_running_heavy_requests_;
+    }
+    request();
+    if (is_heavy) {
+      absl::MutexLock lock(&mu_);
+      --num_running_heavy_requests_;
+    }
+  }
+}
+
+}  // namespace ml_metadata
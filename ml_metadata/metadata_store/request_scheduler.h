@@ -0,0 +1,97 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_REQUEST_SCHEDULER_H_
+#define ML_METADATA_METADATA_STORE_REQUEST_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Runs requests on a fixed pool of worker threads with a bounded queue.
+//
+// Requests are either regular or heavy. Heavy requests, e.g., lineage graph
+// traversals, may occupy at most `max_concurrent_heavy_requests` workers at a
+// time, so that a burst of them cannot starve the regular requests. Otherwise
+// requests run in the order they are scheduled.
+//
+// This class is thread-safe.
+class RequestScheduler {
+ public:
+  enum class RequestClass { kRegular, kHeavy };
+
+  // Starts `num_workers` worker threads. At most `max_queue_depth` requests
+  // can wait for a worker at the same time. Non-positive values are treated
+  // as 1.
+  RequestScheduler(int num_workers, int max_queue_depth,
+                   int max_concurrent_heavy_requests);
+
+  // Disallow copy and assign.
+  RequestScheduler(const RequestScheduler&) = delete;
+  RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+  // Runs the queued requests and stops the workers.
+  ~RequestScheduler();
+
+  // Queues `request` to be run by a worker thread.
+  // Returns RESOURCE_EXHAUSTED error, if `max_queue_depth` requests are
+  //   already waiting.
+  // Returns FAILED_PRECONDITION error, if the scheduler is shut down.
+  absl::Status Schedule(RequestClass request_class,
+                        std::function<void()> request);
+
+  // Stops accepting new requests, runs the queued ones and joins the workers.
+  // Calling it more than once is a no-op.
+  void Shutdown();
+
+  // Returns the number of requests waiting for a worker.
+  int queue_depth() const;
+
+ private:
+  // A queued request with the order in which it was scheduled.
+  struct QueuedRequest {
+    int64 sequence_number;
+    std::function<void()> request;
+  };
+
+  // The main loop of the worker threads.
+  void RunWorker();
+
+  // Returns true if a worker can take a request, or must exit.
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int max_queue_depth_;
+  const int max_concurrent_heavy_requests_;
+
+  mutable absl::Mutex mu_;
+  std::deque<QueuedRequest> regular_requests_ ABSL_GUARDED_BY(mu_);
+  std::deque<QueuedRequest> heavy_requests_ ABSL_GUARDED_BY(mu_);
+  int num_running_heavy_requests_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 next_sequence_number_ ABSL_GUARDED_BY(mu_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_REQUEST_SCHEDULER_H_
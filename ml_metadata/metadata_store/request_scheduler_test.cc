@@ -0,0 +1,96 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_scheduler.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+
+namespace ml_metadata {
+namespace {
+
+using RequestClass = RequestScheduler::RequestClass;
+
+TEST(RequestSchedulerTest, RunsScheduledRequests) {
+  std::atomic<int> num_runs(0);
+  {
+    RequestScheduler scheduler(/*num_workers=*/4, /*max_queue_depth=*/100,
+                               /*max_concurrent_heavy_requests=*/1);
+    for (int i = 0; i < 50; ++i) {
+      ASSERT_EQ(absl::OkStatus(),
+                scheduler.Schedule(i % 2 ? RequestClass::kHeavy
+                                         : RequestClass::kRegular,
+                                   [&num_runs]() { ++num_runs; }));
+    }
+  }
+  EXPECT_EQ(50, num_runs);
+}
+
+TEST(RequestSchedulerTest, RejectsRequestsBeyondQueueDepth) {
+  RequestScheduler scheduler(/*num_workers=*/1, /*max_queue_depth=*/2,
+                             /*max_concurrent_heavy_requests=*/1);
+  absl::Notification started, release;
+  ASSERT_EQ(absl::OkStatus(),
+            scheduler.Schedule(RequestClass::kRegular, [&]() {
+              started.Notify();
+              release.WaitForNotification();
+            }));
+  started.WaitForNotification();
+  EXPECT_EQ(absl::OkStatus(),
+            scheduler.Schedule(RequestClass::kRegular, []() {}));
+  EXPECT_EQ(absl::OkStatus(),
+            scheduler.Schedule(RequestClass::kHeavy, []() {}));
+  EXPECT_EQ(2, scheduler.queue_depth());
+  EXPECT_TRUE(absl::IsResourceExhausted(
+      scheduler.Schedule(RequestClass::kRegular, []() {})));
+  release.Notify();
+  scheduler.Shutdown();
+  EXPECT_EQ(0, scheduler.queue_depth());
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      scheduler.Schedule(RequestClass::kRegular, []() {})));
+}
+
+TEST(RequestSchedulerTest, HeavyRequestsDoNotStarveRegularRequests) {
+  RequestScheduler scheduler(/*num_workers=*/2, /*max_queue_depth=*/100,
+                             /*max_concurrent_heavy_requests=*/1);
+  absl::Notification release_heavy;
+  std::atomic<int> num_heavy_runs(0);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(absl::OkStatus(),
+              scheduler.Schedule(RequestClass::kHeavy, [&]() {
+                ++num_heavy_runs;
+                release_heavy.WaitForNotification();
+              }));
+  }
+  // A single heavy request runs, and the other worker serves the regular
+  // request scheduled after the burst of heavy requests.
+  absl::Notification regular_done;
+  ASSERT_EQ(absl::OkStatus(),
+            scheduler.Schedule(RequestClass::kRegular,
+                               [&]() { regular_done.Notify(); }));
+  regular_done.WaitForNotification();
+  EXPECT_LE(num_heavy_runs, 1);
+  release_heavy.Notify();
+  scheduler.Shutdown();
+  EXPECT_EQ(5, num_heavy_runs);
+}
+
+}  // namespace
+}  // namespace ml_metadata
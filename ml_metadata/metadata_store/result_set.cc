@@ -0,0 +1,260 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/result_set.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "ml_metadata/metadata_store/constants.h"
+
+namespace ml_metadata {
+namespace {
+
+// The size of a block storing the strings of the values.
+constexpr size_t kStringBlockSize = 64 * 1024;
+
+// Returns `value` with the fewest digits it is parsed back from, as the
+// backends format it.
+std::string FormatDouble(const double value) {
+  std::string result = absl::StrFormat("%.15g", value);
+  double parsed;
+  if (!absl::SimpleAtod(result, &parsed) || parsed != value) {
+    result = absl::StrFormat("%.17g", value);
+  }
+  return result;
+}
+
+}  // namespace
+
+ResultSet::ResultSet(ResultSet&& other) noexcept { *this = std::move(other); }
+
+ResultSet& ResultSet::operator=(ResultSet&& other) noexcept {
+  if (this == &other) return *this;
+  columns_ = std::move(other.columns_);
+  string_blocks_ = std::move(other.string_blocks_);
+  free_space_ = other.free_space_;
+  free_space_size_ = other.free_space_size_;
+  other.Clear();
+  return *this;
+}
+
+ResultSet ResultSet::FromRecordSet(const RecordSet& record_set) {
+  ResultSet result_set;
+  for (const std::string& column_name : record_set.column_names()) {
+    result_set.AddColumn(column_name);
+  }
+  if (record_set.column_names().empty() && !record_set.records().empty()) {
+    for (int column = 0; column < record_set.records(0).values_size();
+         ++column) {
+      result_set.AddColumn("");
+    }
+  }
+  for (const RecordSet::Record& record : record_set.records()) {
+    CHECK_EQ(record.values_size(), result_set.num_columns());
+    for (int column = 0; column < record.values_size(); ++column) {
+      if (record.values(column) == kMetadataSourceNull) {
+        result_set.AppendNull(column);
+      } else {
+        result_set.AppendString(column, record.values(column));
+      }
+    }
+  }
+  return result_set;
+}
+
+RecordSet ResultSet::ToRecordSet() const {
+  RecordSet record_set;
+  const int rows = num_rows();
+  if (rows == 0) return record_set;
+  for (const Column& column : columns_) {
+    record_set.add_column_names(column.name);
+  }
+  record_set.mutable_records()->Reserve(rows);
+  for (int row = 0; row < rows; ++row) {
+    RecordSet::Record* record = record_set.add_records();
+    for (int column = 0; column < num_columns(); ++column) {
+      record->add_values(ToString(row, column));
+    }
+  }
+  return record_set;
+}
+
+void ResultSet::Clear() {
+  columns_.clear();
+  string_blocks_.clear();
+  free_space_ = nullptr;
+  free_space_size_ = 0;
+}
+
+void ResultSet::ClearRows() {
+  for (Column& column : columns_) {
+    column.values.clear();
+  }
+  if (string_blocks_.empty()) return;
+  string_blocks_.resize(1);
+  free_space_ = string_blocks_[0].data.get();
+  free_space_size_ = string_blocks_[0].size;
+}
+
+void ResultSet::AddColumn(const absl::string_view name) {
+  CHECK_EQ(num_rows(), 0) << "Columns must be added before the rows.";
+  columns_.push_back({std::string(name), {}});
+}
+
+void ResultSet::AppendNull(const int column) {
+  Value value;
+  value.type = Type::kNull;
+  value.size = 0;
+  value.int_value = 0;
+  columns_[column].values.push_back(value);
+}
+
+void ResultSet::AppendInt(const int column, const int64 int_value) {
+  Value value;
+  value.type = Type::kInt;
+  value.size = 0;
+  value.int_value = int_value;
+  columns_[column].values.push_back(value);
+}
+
+void ResultSet::AppendDouble(const int column, const double double_value) {
+  Value value;
+  value.type = Type::kDouble;
+  value.size = 0;
+  value.double_value = double_value;
+  columns_[column].values.push_back(value);
+}
+
+void ResultSet::AppendString(const int column,
+                             const absl::string_view string_value) {
+  Value value;
+  value.type = Type::kString;
+  value.size = string_value.size();
+  value.string_value = CopyString(string_value);
+  columns_[column].values.push_back(value);
+}
+
+int ResultSet::FindColumn(const absl::string_view name) const {
+  for (int column = 0; column < num_columns(); ++column) {
+    if (columns_[column].name == name) return column;
+  }
+  return -1;
+}
+
+int64 ResultSet::GetInt(const int row, const int column) const {
+  const Value& value = columns_[column].values[row];
+  switch (value.type) {
+    case Type::kInt:
+      return value.int_value;
+    case Type::kDouble:
+      return static_cast<int64>(value.double_value);
+    case Type::kString: {
+      int64 int_value;
+      CHECK(absl::SimpleAtoi(GetString(row, column), &int_value))
+          << "Not an integer: " << GetString(row, column);
+      return int_value;
+    }
+    default:
+      return 0;
+  }
+}
+
+double ResultSet::GetDouble(const int row, const int column) const {
+  const Value& value = columns_[column].values[row];
+  switch (value.type) {
+    case Type::kInt:
+      return value.int_value;
+    case Type::kDouble:
+      return value.double_value;
+    case Type::kString: {
+      double double_value;
+      CHECK(absl::SimpleAtod(GetString(row, column), &double_value))
+          << "Not a number: " << GetString(row, column);
+      return double_value;
+    }
+    default:
+      return 0;
+  }
+}
+
+bool ResultSet::GetBool(const int row, const int column) const {
+  const Value& value = columns_[column].values[row];
+  switch (value.type) {
+    case Type::kInt:
+      return value.int_value != 0;
+    case Type::kDouble:
+      return value.double_value != 0;
+    case Type::kString: {
+      bool bool_value;
+      CHECK(absl::SimpleAtob(GetString(row, column), &bool_value))
+          << "Not a bool: " << GetString(row, column);
+      return bool_value;
+    }
+    default:
+      return false;
+  }
+}
+
+absl::string_view ResultSet::GetString(const int row, const int column) const {
+  const Value& value = columns_[column].values[row];
+  CHECK(value.type == Type::kString)
+      << "Not a string: " << ToString(row, column);
+  return absl::string_view(value.string_value, value.size);
+}
+
+std::string ResultSet::ToString(const int row, const int column) const {
+  const Value& value = columns_[column].values[row];
+  switch (value.type) {
+    case Type::kInt:
+      return absl::StrCat(value.int_value);
+    case Type::kDouble:
+      return FormatDouble(value.double_value);
+    case Type::kString:
+      return std::string(value.string_value, value.size);
+    default:
+      return kMetadataSourceNull;
+  }
+}
+
+const char* ResultSet::CopyString(const absl::string_view value) {
+  if (value.empty()) return "";
+  if (value.size() > free_space_size_) {
+    // Large strings get a block of their own, so that the free space of the
+    // last block is kept for the following strings.
+    const size_t block_size = std::max(value.size(), kStringBlockSize);
+    StringBlock block = {std::unique_ptr<char[]>(new char[block_size]),
+                         block_size};
+    char* copy = block.data.get();
+    std::memcpy(copy, value.data(), value.size());
+    if (block_size - value.size() >= free_space_size_) {
+      free_space_ = copy + value.size();
+      free_space_size_ = block_size - value.size();
+    }
+    string_blocks_.push_back(std::move(block));
+    return copy;
+  }
+  char* copy = free_space_;
+  std::memcpy(copy, value.data(), value.size());
+  free_space_ += value.size();
+  free_space_size_ -= value.size();
+  return copy;
+}
+
+}  // namespace ml_metadata
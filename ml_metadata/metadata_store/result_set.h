@@ -0,0 +1,161 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_RESULT_SET_H_
+#define ML_METADATA_METADATA_STORE_RESULT_SET_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+
+// The rows returned by a query to a MetadataSource, stored by column. Each
+// value keeps the type it is returned with by the backend, so that numbers are
+// not converted to strings and back, and the strings of all the values are
+// copied to blocks owned by the result set instead of being allocated one by
+// one. The backends which only return strings, e.g., with a text protocol,
+// store strings, which are parsed when they are read as numbers.
+//
+// Usage example:
+//
+//    ResultSet results;
+//    TF_CHECK_OK(src.ExecuteTemplateQuery(query, parameters, &results));
+//    for (int row = 0; row < results.num_rows(); ++row) {
+//      int64 id = results.GetInt(row, /*column=*/0);
+//      absl::string_view name = results.GetString(row, /*column=*/1);
+//    }
+class ResultSet {
+ public:
+  // The type of a value.
+  enum class Type { kNull, kInt, kDouble, kString };
+
+  ResultSet() = default;
+
+  // Disallows copy, as the values refer to the string blocks of the result set.
+  ResultSet(const ResultSet&) = delete;
+  ResultSet& operator=(const ResultSet&) = delete;
+  ResultSet(ResultSet&& other) noexcept;
+  ResultSet& operator=(ResultSet&& other) noexcept;
+
+  // Returns a result set with the rows of `record_set`, whose values are
+  // strings, or nulls if they are kMetadataSourceNull.
+  static ResultSet FromRecordSet(const RecordSet& record_set);
+
+  // Returns the rows as a RecordSet, in which numbers are formatted as strings
+  // and nulls are kMetadataSourceNull. As with the backends, the column names
+  // are only set if there are rows.
+  RecordSet ToRecordSet() const;
+
+  // Removes all the columns and rows.
+  void Clear();
+
+  // Removes the rows and keeps the columns, e.g., to read the next batch of
+  // rows of a query. The first string block is kept for the strings of the
+  // following rows.
+  void ClearRows();
+
+  // Adds a column named `name`. Columns are added before the rows.
+  void AddColumn(absl::string_view name);
+
+  // Appends a value to the last row of `column`. A row is added once a value
+  // has been appended to each of its columns.
+  void AppendNull(int column);
+  void AppendInt(int column, int64 value);
+  void AppendDouble(int column, double value);
+  void AppendString(int column, absl::string_view value);
+
+  int num_columns() const { return columns_.size(); }
+
+  int num_rows() const {
+    return columns_.empty() ? 0 : columns_.back().values.size();
+  }
+
+  const std::string& column_name(int column) const {
+    return columns_[column].name;
+  }
+
+  // Returns the index of the column named `name`, or -1 if there is none.
+  int FindColumn(absl::string_view name) const;
+
+  Type type(int row, int column) const {
+    return columns_[column].values[row].type;
+  }
+
+  bool IsNull(int row, int column) const {
+    return type(row, column) == Type::kNull;
+  }
+
+  // Returns the value as an integer. Strings are parsed, and nulls are 0.
+  // Check-fails if a string is not an integer.
+  int64 GetInt(int row, int column) const;
+
+  // Returns the value as a double. Strings are parsed, and nulls are 0.
+  // Check-fails if a string is not a number.
+  double GetDouble(int row, int column) const;
+
+  // Returns the value as a bool. Strings are parsed, and nulls are false.
+  // Check-fails if a string is not a bool.
+  bool GetBool(int row, int column) const;
+
+  // Returns the string value, which is valid as long as the result set.
+  // Check-fails if the value is not a string.
+  absl::string_view GetString(int row, int column) const;
+
+  // Returns the value formatted as a string, or kMetadataSourceNull for nulls.
+  std::string ToString(int row, int column) const;
+
+ private:
+  // A value of a column. Strings point to the string blocks.
+  struct Value {
+    Type type;
+    uint32 size;
+    union {
+      int64 int_value;
+      double double_value;
+      const char* string_value;
+    };
+  };
+
+  struct Column {
+    std::string name;
+    std::vector<Value> values;
+  };
+
+  // A block of memory storing strings.
+  struct StringBlock {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  // Returns a copy of `value` in the string blocks.
+  const char* CopyString(absl::string_view value);
+
+  std::vector<Column> columns_;
+
+  // The blocks which store the strings of the values. Strings are appended to
+  // the last block while they fit in it.
+  std::vector<StringBlock> string_blocks_;
+  char* free_space_ = nullptr;
+  size_t free_space_size_ = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_RESULT_SET_H_
@@ -0,0 +1,126 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/result_set.h"
+
+#include <string>
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+TEST(ResultSetTest, KeepsTypedValues) {
+  ResultSet result_set;
+  result_set.AddColumn("id");
+  result_set.AddColumn("value");
+  result_set.AppendInt(0, 1);
+  result_set.AppendDouble(1, 0.5);
+  result_set.AppendInt(0, 2);
+  result_set.AppendNull(1);
+
+  ASSERT_EQ(2, result_set.num_columns());
+  ASSERT_EQ(2, result_set.num_rows());
+  EXPECT_EQ("value", result_set.column_name(1));
+  EXPECT_EQ(1, result_set.FindColumn("value"));
+  EXPECT_EQ(-1, result_set.FindColumn("name"));
+  EXPECT_EQ(ResultSet::Type::kInt, result_set.type(1, 0));
+  EXPECT_EQ(2, result_set.GetInt(1, 0));
+  EXPECT_EQ(ResultSet::Type::kDouble, result_set.type(0, 1));
+  EXPECT_EQ(0.5, result_set.GetDouble(0, 1));
+  EXPECT_TRUE(result_set.GetBool(0, 0));
+  EXPECT_TRUE(result_set.IsNull(1, 1));
+  EXPECT_EQ(0, result_set.GetInt(1, 1));
+  EXPECT_EQ(kMetadataSourceNull, result_set.ToString(1, 1));
+}
+
+TEST(ResultSetTest, CopiesStrings) {
+  ResultSet result_set;
+  result_set.AddColumn("name");
+  const std::string large_string(100 * 1024, 'a');
+  {
+    std::string value = "name_1";
+    result_set.AppendString(0, value);
+    value = "overwritten";
+  }
+  result_set.AppendString(0, large_string);
+  result_set.AppendString(0, "");
+  result_set.AppendString(0, "42");
+
+  // The strings are kept by the result set, also once it is moved.
+  ResultSet moved_result_set = std::move(result_set);
+  EXPECT_EQ(0, result_set.num_rows());
+  ASSERT_EQ(4, moved_result_set.num_rows());
+  EXPECT_EQ("name_1", moved_result_set.GetString(0, 0));
+  EXPECT_EQ(large_string, moved_result_set.GetString(1, 0));
+  EXPECT_EQ("", moved_result_set.GetString(2, 0));
+  // Strings are parsed when they are read as numbers.
+  EXPECT_EQ(42, moved_result_set.GetInt(3, 0));
+  EXPECT_EQ(42.0, moved_result_set.GetDouble(3, 0));
+}
+
+TEST(ResultSetTest, ClearRowsKeepsColumns) {
+  ResultSet result_set;
+  result_set.AddColumn("name");
+  result_set.AppendString(0, "name_1");
+  result_set.ClearRows();
+  EXPECT_EQ(1, result_set.num_columns());
+  EXPECT_EQ(0, result_set.num_rows());
+
+  result_set.AppendString(0, "name_2");
+  ASSERT_EQ(1, result_set.num_rows());
+  EXPECT_EQ("name_2", result_set.GetString(0, 0));
+}
+
+TEST(ResultSetTest, ConvertsFromAndToRecordSet) {
+  const RecordSet record_set = ParseTextProtoOrDie<RecordSet>(R"pb(
+    column_names: "id"
+    column_names: "name"
+    records { values: "1" values: "name_1" }
+    records { values: "2" values: "__MLMD_NULL__" }
+  )pb");
+  const ResultSet result_set = ResultSet::FromRecordSet(record_set);
+  ASSERT_EQ(2, result_set.num_rows());
+  EXPECT_EQ(2, result_set.GetInt(1, 0));
+  EXPECT_EQ("name_1", result_set.GetString(0, 1));
+  EXPECT_TRUE(result_set.IsNull(1, 1));
+  EXPECT_THAT(result_set.ToRecordSet(), EqualsProto(record_set));
+
+  ResultSet typed_result_set;
+  typed_result_set.AddColumn("value");
+  typed_result_set.AppendDouble(0, 0.1);
+  typed_result_set.AppendInt(0, -3);
+  EXPECT_THAT(typed_result_set.ToRecordSet(),
+              EqualsProto(ParseTextProtoOrDie<RecordSet>(R"pb(
+                column_names: "value"
+                records { values: "0.1" }
+                records { values: "-3" }
+              )pb")));
+
+  // The column names are not set without rows.
+  ResultSet empty_result_set;
+  empty_result_set.AddColumn("id");
+  EXPECT_THAT(empty_result_set.ToRecordSet(), EqualsProto(RecordSet()));
+}
+
+}  // namespace
+}  // namespace ml_metadata
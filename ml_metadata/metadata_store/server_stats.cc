@@ -0,0 +1,100 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/server_stats.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
+
+namespace ml_metadata {
+namespace {
+
+// The upper limits of the latency buckets in microseconds.
+constexpr int64 kBucketLimitsMicros[] = {
+    100,    250,    500,     1000,    2500,    5000,    10000,   25000,
+    50000,  100000, 250000,  500000,  1000000, 2500000, 5000000, 10000000};
+constexpr int kNumBuckets = std::size(kBucketLimitsMicros) + 1;
+
+}  // namespace
+
+void ServerStats::CallStarted(const absl::string_view method) {
+  absl::MutexLock lock(&mu_);
+  ++methods_[method].num_in_flight;
+}
+
+void ServerStats::CallFinished(const absl::string_view method,
+                               const absl::Duration latency, const bool ok) {
+  const int64 latency_micros = absl::ToInt64Microseconds(latency);
+  const int bucket =
+      std::lower_bound(std::begin(kBucketLimitsMicros),
+                       std::end(kBucketLimitsMicros), latency_micros) -
+      std::begin(kBucketLimitsMicros);
+  absl::MutexLock lock(&mu_);
+  Method& stats = methods_[method];
+  --stats.num_in_flight;
+  ++stats.num_calls;
+  if (!ok) {
+    ++stats.num_errors;
+  }
+  if (stats.bucket_counts.empty()) {
+    stats.bucket_counts.resize(kNumBuckets);
+  }
+  ++stats.bucket_counts[bucket];
+  stats.sum_latency += latency;
+  stats.max_latency = std::max(stats.max_latency, latency);
+}
+
+void ServerStats::Export(GetServerStatsResponse* response) const {
+  {
+    absl::MutexLock lock(&mu_);
+    for (const auto& name_and_stats : methods_) {
+      const Method& stats = name_and_stats.second;
+      GetServerStatsResponse::MethodStats* method_stats =
+          response->add_method_stats();
+      method_stats->set_method(name_and_stats.first);
+      method_stats->set_num_calls(stats.num_calls);
+      method_stats->set_num_errors(stats.num_errors);
+      method_stats->set_num_in_flight(stats.num_in_flight);
+      LatencyHistogram* latency = method_stats->mutable_latency();
+      for (const int64 limit : kBucketLimitsMicros) {
+        latency->add_bucket_limits_micros(limit);
+      }
+      for (int i = 0; i < kNumBuckets; ++i) {
+        latency->add_bucket_counts(
+            stats.bucket_counts.empty() ? 0 : stats.bucket_counts[i]);
+      }
+      latency->set_sum_micros(absl::ToInt64Microseconds(stats.sum_latency));
+      latency->set_max_micros(absl::ToInt64Microseconds(stats.max_latency));
+    }
+  }
+  for (const auto& tag_and_totals : transaction_stats_->GetTotals()) {
+    const TransactionStats::Totals& totals = tag_and_totals.second;
+    GetServerStatsResponse::TransactionStats* transaction_stats =
+        response->add_transaction_stats();
+    transaction_stats->set_tag(tag_and_totals.first);
+    transaction_stats->set_num_transactions(totals.num_transactions);
+    transaction_stats->set_num_failed_transactions(
+        totals.num_failed_transactions);
+    transaction_stats->set_num_queries(totals.num_queries);
+    transaction_stats->set_num_rows(totals.num_rows);
+    transaction_stats->set_sum_micros(
+        absl::ToInt64Microseconds(totals.total_time));
+    transaction_stats->set_num_retries(totals.num_retries);
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,80 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SERVER_STATS_H_
+#define ML_METADATA_METADATA_STORE_SERVER_STATS_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// Statistics of the calls of the metadata store server by method: the number
+// of calls, errors and calls in progress, and a histogram of the latencies.
+//
+// This class is thread-safe.
+class ServerStats {
+ public:
+  // Exports the transactions recorded in transaction_stats, which defaults to
+  // the statistics of the process.
+  explicit ServerStats(
+      const TransactionStats* transaction_stats = &TransactionStats::Global())
+      : transaction_stats_(transaction_stats) {}
+
+  // Disallow copy and assign.
+  ServerStats(const ServerStats&) = delete;
+  ServerStats& operator=(const ServerStats&) = delete;
+
+  // Records that a call of `method` has started.
+  void CallStarted(absl::string_view method);
+
+  // Records that a call of `method` started by CallStarted has finished after
+  // `latency`, and whether it has succeeded.
+  void CallFinished(absl::string_view method, absl::Duration latency, bool ok);
+
+  // Fills `response` with the statistics of the methods, and the statistics
+  // of the transactions recorded in the TransactionStats.
+  void Export(GetServerStatsResponse* response) const;
+
+ private:
+  struct Method {
+    int64 num_calls = 0;
+    int64 num_errors = 0;
+    int64 num_in_flight = 0;
+    // The counts of the latencies by bucket of kBucketLimits, followed by the
+    // count of the latencies above the last limit.
+    std::vector<int64> bucket_counts;
+    absl::Duration sum_latency;
+    absl::Duration max_latency;
+  };
+
+  // Not owned by this class.
+  const TransactionStats* const transaction_stats_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Method> methods_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SERVER_STATS_H_
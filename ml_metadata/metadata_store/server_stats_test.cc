@@ -0,0 +1,107 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/server_stats.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::UnorderedElementsAre;
+
+constexpr char kLatencyBucketLimits[] = R"(
+  bucket_limits_micros: [ 100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+                          50000, 100000, 250000, 500000, 1000000, 2500000,
+                          5000000, 10000000 ]
+)";
+
+TEST(ServerStatsTest, ExportsCallsByMethod) {
+  ServerStats server_stats;
+  server_stats.CallStarted("/Put");
+  server_stats.CallFinished("/Put", absl::Microseconds(200), /*ok=*/true);
+  server_stats.CallStarted("/Put");
+  server_stats.CallFinished("/Put", absl::Seconds(20), /*ok=*/false);
+  server_stats.CallStarted("/Get");
+
+  GetServerStatsResponse response;
+  server_stats.Export(&response);
+  EXPECT_THAT(
+      response.method_stats(),
+      UnorderedElementsAre(
+          EqualsProto(ParseTextProtoOrDie<GetServerStatsResponse::MethodStats>(
+              absl::StrCat(R"(
+                method: '/Put'
+                num_calls: 2
+                num_errors: 1
+                num_in_flight: 0
+                latency {
+                  bucket_counts: [ 0, 1, 0, 0, 0, 0, 0, 0, 0,
+                                   0, 0, 0, 0, 0, 0, 0, 1 ]
+                  sum_micros: 20000200
+                  max_micros: 20000000
+              )",
+                           kLatencyBucketLimits, "}"))),
+          EqualsProto(ParseTextProtoOrDie<GetServerStatsResponse::MethodStats>(
+              absl::StrCat(R"(
+                method: '/Get'
+                num_calls: 0
+                num_errors: 0
+                num_in_flight: 1
+                latency {
+                  bucket_counts: [ 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                   0, 0, 0, 0, 0, 0, 0, 0 ]
+                  sum_micros: 0
+                  max_micros: 0
+              )",
+                           kLatencyBucketLimits, "}")))));
+}
+
+TEST(ServerStatsTest, ExportsTransactionStats) {
+  TransactionStats transaction_stats;
+  transaction_stats.Record("server_stats_test", /*committed=*/true,
+                           /*num_queries=*/3, /*num_rows=*/5,
+                           absl::Milliseconds(2));
+  transaction_stats.Record("server_stats_test", /*committed=*/false,
+                           /*num_queries=*/1, /*num_rows=*/0,
+                           absl::Milliseconds(1));
+  transaction_stats.RecordRetry("server_stats_test");
+
+  ServerStats server_stats(&transaction_stats);
+  GetServerStatsResponse response;
+  server_stats.Export(&response);
+  EXPECT_THAT(
+      response.transaction_stats(),
+      UnorderedElementsAre(EqualsProto(
+          ParseTextProtoOrDie<GetServerStatsResponse::TransactionStats>(R"(
+            tag: 'server_stats_test'
+            num_transactions: 2
+            num_failed_transactions: 1
+            num_queries: 4
+            num_rows: 5
+            sum_micros: 3000
+            num_retries: 1
+          )"))));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -15,15 +15,22 @@ limitations under the License.
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
 #include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
 #include "sqlite3.h"
 
 namespace ml_metadata {
@@ -31,10 +38,18 @@ namespace ml_metadata {
 namespace {
 
 constexpr char kInMemoryConnection[] = ":memory:";
-constexpr char kBeginTransaction[] = "BEGIN;";
+constexpr char kBeginTransaction[] = "BEGIN IMMEDIATE;";
+constexpr char kBeginReadOnlyTransaction[] = "BEGIN DEFERRED;";
 constexpr char kCommitTransaction[] = "COMMIT;";
 constexpr char kRollbackTransaction[] = "ROLLBACK;";
 
+// The number of virtual machine instructions run by a query between two checks
+// of its deadline.
+constexpr int kQueryDeadlineCheckPeriod = 10000;
+
+// The max number of prepared statements cached by a connection.
+constexpr int kMaxPreparedStatements = 1000;
+
 // Returns a Sqlite3 connection flags based on the SqliteMetadataSourceConfig.
 // (see https://www.sqlite.org/c3ref/open.html for details)
 int GetConnectionFlag(const SqliteMetadataSourceConfig& config) {
@@ -95,6 +110,140 @@ int WaitThenRetry(void* options, int retried_times) {
   return 1;
 }
 
+// Appends to `pragmas` the statement setting `pragma` to the name of an enum
+// value of SqliteMetadataSourceConfig without its `prefix`.
+void AppendEnumPragma(const absl::string_view pragma,
+                      const std::string& value_name,
+                      const absl::string_view prefix, std::string* pragmas) {
+  absl::StrAppend(pragmas, "PRAGMA ", pragma, " = ",
+                  absl::StripPrefix(value_name, prefix), ";");
+}
+
+// Returns the PRAGMA statements setting the tuning parameters given in the
+// SqliteMetadataSourceConfig, or an empty string if none is given.
+// (see https://www.sqlite.org/pragma.html for details)
+std::string GetPragmas(const SqliteMetadataSourceConfig& config) {
+  std::string pragmas;
+  if (config.journal_mode() !=
+      SqliteMetadataSourceConfig::JOURNAL_MODE_UNSPECIFIED) {
+    AppendEnumPragma(
+        "journal_mode",
+        SqliteMetadataSourceConfig::JournalMode_Name(config.journal_mode()),
+        "JOURNAL_MODE_", &pragmas);
+  }
+  if (config.synchronous() !=
+      SqliteMetadataSourceConfig::SYNCHRONOUS_UNSPECIFIED) {
+    AppendEnumPragma(
+        "synchronous",
+        SqliteMetadataSourceConfig::Synchronous_Name(config.synchronous()),
+        "SYNCHRONOUS_", &pragmas);
+  }
+  if (config.has_cache_size()) {
+    absl::StrAppend(&pragmas, "PRAGMA cache_size = ", config.cache_size(),
+                    ";");
+  }
+  if (config.has_mmap_size()) {
+    absl::StrAppend(&pragmas, "PRAGMA mmap_size = ", config.mmap_size(), ";");
+  }
+  if (config.temp_store() !=
+      SqliteMetadataSourceConfig::TEMP_STORE_UNSPECIFIED) {
+    AppendEnumPragma(
+        "temp_store",
+        SqliteMetadataSourceConfig::TempStore_Name(config.temp_store()),
+        "TEMP_STORE_", &pragmas);
+  }
+  return pragmas;
+}
+
+// A callback of sqlite3_progress_handler, which interrupts the running query of
+// the `metadata_source` once its deadline has passed or it is cancelled.
+int InterruptIfPastQueryDeadline(void* metadata_source) {
+  return !static_cast<const MetadataSource*>(metadata_source)
+              ->CheckQueryDeadline()
+              .ok();
+}
+
+// Returns the error of the last failed call on `db` running `query`.
+absl::Status GetQueryError(sqlite3* db, const std::string& query) {
+  const std::string error_details = sqlite3_errmsg(db);
+  if (absl::StrContains(error_details, "database is locked")) {
+    return absl::AbortedError(
+        "Concurrent writes aborted after max number of retries.");
+  }
+  return absl::InternalError(absl::StrCat(
+      "Error when executing query: ", error_details, " query: ", query));
+}
+
+// Binds the `values` to the host parameters of `statement`. The bound strings
+// are not copied, so `values` must outlive the bindings.
+absl::Status BindValues(sqlite3* db, sqlite3_stmt* statement,
+                        const std::string& query,
+                        const absl::Span<const QueryParameter* const> values) {
+  for (int i = 0; i < values.size(); ++i) {
+    const QueryParameter& value = *values[i];
+    int result_code = SQLITE_OK;
+    switch (value.type()) {
+      case QueryParameter::Type::kInt:
+        result_code = sqlite3_bind_int64(statement, i + 1, value.int_value());
+        break;
+      case QueryParameter::Type::kDouble:
+        result_code = sqlite3_bind_double(statement, i + 1,
+                                          value.double_value());
+        break;
+      case QueryParameter::Type::kString:
+        result_code = sqlite3_bind_text(statement, i + 1, value.text().data(),
+                                        value.text().size(), SQLITE_STATIC);
+        break;
+      default:
+        result_code = sqlite3_bind_null(statement, i + 1);
+    }
+    if (result_code != SQLITE_OK) {
+      return GetQueryError(db, query);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Steps a prepared `statement` to completion, and appends its rows to
+// `results`.
+absl::Status StepStatement(sqlite3* db, sqlite3_stmt* statement,
+                           const std::string& query, ResultSet* results) {
+  while (true) {
+    const int result_code = sqlite3_step(statement);
+    if (result_code == SQLITE_DONE) {
+      return absl::OkStatus();
+    }
+    if (result_code != SQLITE_ROW) {
+      return GetQueryError(db, query);
+    }
+    AppendSqliteRowToResultSet(statement, results);
+  }
+}
+
+// Steps a prepared `statement` to completion, and passes its rows to `callback`
+// in batches of up to `batch_size` rows.
+absl::Status StreamStatement(sqlite3* db, sqlite3_stmt* statement,
+                             const std::string& query, const int batch_size,
+                             const MetadataSource::RowBatchCallback callback) {
+  ResultSet rows;
+  while (true) {
+    const int result_code = sqlite3_step(statement);
+    if (result_code == SQLITE_DONE) {
+      break;
+    }
+    if (result_code != SQLITE_ROW) {
+      return GetQueryError(db, query);
+    }
+    AppendSqliteRowToResultSet(statement, &rows);
+    if (rows.num_rows() >= batch_size) {
+      MLMD_RETURN_IF_ERROR(callback(rows));
+      rows.ClearRows();
+    }
+  }
+  if (rows.num_rows() == 0) return absl::OkStatus();
+  return callback(rows);
+}
+
 }  // namespace
 
 SqliteMetadataSource::SqliteMetadataSource(
@@ -121,11 +270,27 @@ absl::Status SqliteMetadataSource::ConnectImpl() {
         absl::StrCat("Cannot connect sqlite3 database: ", error_message));
   }
   // required to handle cases when tables are locked when executing queries
-  sqlite3_busy_handler(db_, &WaitThenRetry, nullptr);
+  if (config_.busy_timeout_sec() > 0) {
+    sqlite3_busy_timeout(db_, static_cast<int>(absl::ToInt64Milliseconds(
+                                  absl::Seconds(config_.busy_timeout_sec()))));
+  } else {
+    sqlite3_busy_handler(db_, &WaitThenRetry, nullptr);
+  }
+  const std::string pragmas = GetPragmas(config_);
+  if (!pragmas.empty()) {
+    const absl::Status status = RunStatement(pragmas, nullptr);
+    if (!status.ok()) {
+      sqlite3_close(db_);
+      db_ = nullptr;
+      return absl::InternalError(absl::StrCat(
+          "Cannot set the pragmas of sqlite3 database: ", status.message()));
+    }
+  }
   return absl::OkStatus();
 }
 
 absl::Status SqliteMetadataSource::CloseImpl() {
+  FinalizePreparedStatements();
   if (db_ != nullptr) {
     int error_code = sqlite3_close(db_);
     if (error_code != SQLITE_OK) {
@@ -138,37 +303,170 @@ absl::Status SqliteMetadataSource::CloseImpl() {
 }
 
 absl::Status SqliteMetadataSource::RunStatement(const std::string& query,
-                                                RecordSet* results = nullptr) {
-  char* error_message;
-  if (sqlite3_exec(db_, query.c_str(), &ConvertSqliteResultsToRecordSet,
-                   results, &error_message) != SQLITE_OK) {
-    std::string error_details = error_message;
-    sqlite3_free(error_message);
-    if (absl::StrContains(error_details, "database is locked")) {
-      return absl::AbortedError(
-          "Concurrent writes aborted after max number of retries.");
-    }
-    return absl::InternalError(absl::StrCat(
-        "Error when executing query: ", error_details, " query: ", query));
+                                                ResultSet* results = nullptr) {
+  return RunStatements(
+      query, [&](const std::string& text, sqlite3_stmt* statement) {
+        return StepStatement(db_, statement, text, results);
+      });
+}
+
+absl::Status SqliteMetadataSource::RunStatements(const std::string& query,
+                                                 const StatementRunner run) {
+  const char* remaining = query.c_str();
+  while (*remaining != '\0') {
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(db_, remaining, -1, &statement, &remaining) !=
+        SQLITE_OK) {
+      return GetQueryError(db_, query);
+    }
+    // The rest of the query may be a comment or white spaces.
+    if (statement == nullptr) continue;
+    const absl::Status status = run(query, statement);
+    sqlite3_finalize(statement);
+    MLMD_RETURN_IF_ERROR(status);
   }
   return absl::OkStatus();
 }
 
+absl::Status SqliteMetadataSource::RunWithQueryDeadline(
+    absl::FunctionRef<absl::Status()> run) {
+  if (!has_query_deadline()) {
+    return run();
+  }
+  sqlite3_progress_handler(db_, kQueryDeadlineCheckPeriod,
+                           &InterruptIfPastQueryDeadline, this);
+  absl::Status status = run();
+  sqlite3_progress_handler(db_, 0, nullptr, nullptr);
+  if (!status.ok() && sqlite3_errcode(db_) == SQLITE_INTERRUPT) {
+    const absl::Status deadline_status = CheckQueryDeadline();
+    if (!deadline_status.ok()) {
+      return deadline_status;
+    }
+  }
+  return status;
+}
+
 absl::Status SqliteMetadataSource::ExecuteQueryImpl(const std::string& query,
-                                                    RecordSet* results) {
-  return RunStatement(query, results);
+                                                    ResultSet* results) {
+  return RunWithQueryDeadline([&]() { return RunStatement(query, results); });
+}
+
+absl::Status SqliteMetadataSource::ExecuteTemplateQueryImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters, ResultSet* results) {
+  return RunTemplateQuery(
+      query_template, parameters,
+      [&](const std::string& text, sqlite3_stmt* statement) {
+        return StepStatement(db_, statement, text, results);
+      });
+}
+
+absl::Status SqliteMetadataSource::ExecuteQueryStreamingImpl(
+    const std::string& query, const RowBatchCallback callback) {
+  return RunWithQueryDeadline([&]() {
+    return RunStatements(
+        query, [&](const std::string& text, sqlite3_stmt* statement) {
+          return StreamStatement(db_, statement, text, kRowBatchSize,
+                                 callback);
+        });
+  });
+}
+
+absl::Status SqliteMetadataSource::ExecuteTemplateQueryStreamingImpl(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    const RowBatchCallback callback) {
+  return RunTemplateQuery(
+      query_template, parameters,
+      [&](const std::string& text, sqlite3_stmt* statement) {
+        return StreamStatement(db_, statement, text, kRowBatchSize, callback);
+      });
+}
+
+absl::Status SqliteMetadataSource::RunTemplateQuery(
+    const QueryTemplate& query_template,
+    const absl::Span<const QueryParameter> parameters,
+    const StatementRunner run) {
+  PreparedStatementKey key;
+  std::vector<const QueryParameter*> bound_values;
+  const bool is_reusable =
+      query_template.GetPreparedStatementKey(parameters, &key, &bound_values);
+  // The errors are reported with the template, as the statement is composed
+  // only when it is prepared.
+  const std::string& query = query_template.query();
+  sqlite3_stmt* statement = nullptr;
+  bool is_persistent = true;
+  auto it = prepared_statements_.find(key);
+  if (it != prepared_statements_.end()) {
+    statement = it->second;
+  } else {
+    is_persistent =
+        is_reusable && prepared_statements_.size() < kMaxPreparedStatements;
+    const std::string statement_text = query_template.ComposePreparedStatement(
+        parameters,
+        [this](absl::string_view value) { return EscapeString(value); });
+    const char* tail = nullptr;
+    if (sqlite3_prepare_v3(db_, statement_text.data(), statement_text.size(),
+                           is_persistent ? SQLITE_PREPARE_PERSISTENT : 0,
+                           &statement, &tail) != SQLITE_OK) {
+      return GetQueryError(db_, statement_text);
+    }
+    const absl::string_view rest(
+        tail, statement_text.data() + statement_text.size() - tail);
+    if (statement == nullptr ||
+        !absl::StripAsciiWhitespace(absl::StripSuffix(rest, ";")).empty()) {
+      // Templates with several statements are run without being prepared.
+      sqlite3_finalize(statement);
+      return RunWithQueryDeadline([&]() {
+        return RunStatements(ComposeQuery(query_template, parameters), run);
+      });
+    }
+    if (is_persistent) {
+      prepared_statements_[std::move(key)] = statement;
+    }
+  }
+  absl::Status status = BindValues(db_, statement, query, bound_values);
+  if (status.ok()) {
+    status = RunWithQueryDeadline([&]() { return run(query, statement); });
+  }
+  // Resets the statement so that it releases its locks and bindings.
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+  if (!is_persistent) {
+    sqlite3_finalize(statement);
+  }
+  return status;
+}
+
+void SqliteMetadataSource::FinalizePreparedStatements() {
+  for (const auto& query_and_statement : prepared_statements_) {
+    sqlite3_finalize(query_and_statement.second);
+  }
+  prepared_statements_.clear();
 }
 
 absl::Status SqliteMetadataSource::BeginImpl() {
+  // A read-only connection cannot take the write lock.
+  if (config_.connection_mode() == SqliteMetadataSourceConfig::READONLY) {
+    return BeginReadOnlyImpl();
+  }
   return RunStatement(kBeginTransaction);
 }
 
+absl::Status SqliteMetadataSource::BeginReadOnlyImpl() {
+  return RunStatement(kBeginReadOnlyTransaction);
+}
+
 
 absl::Status SqliteMetadataSource::CommitImpl() {
   return RunStatement(kCommitTransaction);
 }
 
 absl::Status SqliteMetadataSource::RollbackImpl() {
+  // An interrupted query may have rolled back the transaction already.
+  if (sqlite3_get_autocommit(db_)) {
+    return absl::OkStatus();
+  }
   return RunStatement(kRollbackTransaction);
 }
 
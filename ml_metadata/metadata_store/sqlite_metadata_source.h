@@ -15,8 +15,15 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "sqlite3.h"
 
@@ -26,6 +33,8 @@ namespace ml_metadata {
 // database, and destroys it when the metadata source is destructed. It can be
 // configured via a SqliteMetadataSourceConfig to use physical Sqlite3 and open
 // it in read only, read and write, and create if not exists modes.
+// The statements of template queries are prepared once per connection and
+// reused, with the values among the parameters bound to them.
 // This class is thread-unsafe. Multiple objects can be created by using the
 // same SqliteMetadataSourceConfig to use the same Sqlite3 database.
 class SqliteMetadataSource : public MetadataSource {
@@ -48,9 +57,30 @@ class SqliteMetadataSource : public MetadataSource {
   // Closes in memory db. All data stored will be cleaned up.
   absl::Status CloseImpl() final;
 
-  // Executes a SQL statement and returns the rows if any.
+  // Executes a SQL statement and returns the rows if any. The statement is
+  // interrupted once the query deadline has passed or it is cancelled.
   absl::Status ExecuteQueryImpl(const std::string& query,
-                                RecordSet* results) final;
+                                ResultSet* results) final;
+
+  // Executes a template query with the prepared statement of the template,
+  // which is cached for the following queries. The values among the
+  // parameters are bound to the statement, and the others, e.g., id lists and
+  // column names, are substituted into its text.
+  absl::Status ExecuteTemplateQueryImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters, ResultSet* results) final;
+
+  // Steps the statements of a query, and passes the rows in batches to
+  // `callback` as they are read.
+  absl::Status ExecuteQueryStreamingImpl(const std::string& query,
+                                         RowBatchCallback callback) final;
+
+  // Streams the rows of a template query, which is prepared as in
+  // ExecuteTemplateQueryImpl.
+  absl::Status ExecuteTemplateQueryStreamingImpl(
+      const QueryTemplate& query_template,
+      absl::Span<const QueryParameter> parameters,
+      RowBatchCallback callback) final;
 
   // Commits a transaction.
   absl::Status CommitImpl() final;
@@ -58,16 +88,46 @@ class SqliteMetadataSource : public MetadataSource {
   // Rollbacks a transaction
   absl::Status RollbackImpl() final;
 
-  // Begins a transaction
+  // Begins a transaction, which takes the write lock at once unless the
+  // connection is read-only, so that concurrent writers wait for each other
+  // with the busy timeout instead of failing when they start to write.
   absl::Status BeginImpl() final;
 
+  // Begins a deferred transaction, which reads from a snapshot taken by its
+  // first query and takes no write lock.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Runs a prepared statement of `query` to completion.
+  using StatementRunner = absl::FunctionRef<absl::Status(
+      const std::string& query, sqlite3_stmt* statement)>;
 
   // Util methods to execute query.
-  absl::Status RunStatement(const std::string& query, RecordSet* results);
+  absl::Status RunStatement(const std::string& query, ResultSet* results);
+
+  // Prepares the statements of `query` one after another, and runs each of
+  // them with `run`.
+  absl::Status RunStatements(const std::string& query, StatementRunner run);
+
+  // Prepares the statement of a template query, or reuses its cached one,
+  // binds the values among the parameters to it, and runs it with `run`.
+  absl::Status RunTemplateQuery(const QueryTemplate& query_template,
+                                absl::Span<const QueryParameter> parameters,
+                                StatementRunner run);
+
+  // Runs `run`, which is interrupted once the query deadline has passed or the
+  // query is cancelled.
+  absl::Status RunWithQueryDeadline(absl::FunctionRef<absl::Status()> run);
+
+  // Finalizes the cached prepared statements.
+  void FinalizePreparedStatements();
 
   // The sqlite3 handle to a database.
   sqlite3* db_ = nullptr;
 
+  // The prepared statements of the template queries by their keys.
+  absl::flat_hash_map<PreparedStatementKey, sqlite3_stmt*>
+      prepared_statements_;
+
   // A config including connection parameters.
   SqliteMetadataSourceConfig config_;
 };
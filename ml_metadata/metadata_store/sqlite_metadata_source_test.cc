@@ -14,13 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
+#include <cstdio>
 #include <memory>
+#include <string>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
+#include "ml_metadata/metadata_store/query_template.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/test_util.h"
 
 namespace ml_metadata {
@@ -86,6 +94,195 @@ TEST(SqliteMetadataSourceExtendedTest, TestEscapeString) {
   EXPECT_EQ(metadata_source->EscapeString("'\"text\"'"), "''\"text\"''");
 }
 
+TEST(SqliteMetadataSourceExtendedTest, TestExecuteTemplateQuery) {
+  SqliteMetadataSourceContainer container;
+  container.InitSchemaAndPopulateRows();
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+
+  // The statement of a template is reused with other values.
+  const QueryTemplate insert_query("INSERT INTO t1 VALUES ($0, $1);");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                insert_query,
+                {QueryParameter::Int(4), QueryParameter::String("v'4")},
+                nullptr));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                insert_query, {QueryParameter::Int(5), QueryParameter()},
+                nullptr));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                insert_query,
+                {QueryParameter::Int(-6), QueryParameter::String("$1")},
+                nullptr));
+
+  // Column names and id lists are substituted into the query.
+  ResultSet query_results;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteTemplateQuery(
+                "SELECT `$0`, c1 + $2 AS c3 FROM t1 "
+                "WHERE c1 IN ($1) ORDER BY c1;",
+                {QueryParameter::Identifier("c2"),
+                 QueryParameter::Sql("1, 4, 5, -6"),
+                 QueryParameter::Double(0.5)},
+                &query_results));
+  EXPECT_THAT(query_results.ToRecordSet(),
+              EqualsProto(ParseTextProtoOrDie<RecordSet>(R"(
+                column_names: "c2"
+                column_names: "c3"
+                records { values: "$1" values: "-5.5" }
+                records { values: "v1" values: "1.5" }
+                records { values: "v'4" values: "4.5" }
+                records { values: "__MLMD_NULL__" values: "5.5" }
+              )")));
+
+  // The errors of prepared statements are the same as the ones of queries.
+  EXPECT_TRUE(absl::IsInternal(metadata_source->ExecuteTemplateQuery(
+      "SELECT c3 FROM t1 WHERE c1 = $0;", {QueryParameter::Int(1)},
+      nullptr)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
+// A query which runs for a long time.
+constexpr char kLongRunningQuery[] =
+    "WITH RECURSIVE cnt(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM cnt "
+    "WHERE x < 10000000000) SELECT MAX(x) FROM cnt;";
+
+TEST(SqliteMetadataSourceExtendedTest, TestQueryDeadline) {
+  SqliteMetadataSourceContainer container;
+  container.InitSchemaAndPopulateRows();
+  MetadataSource* metadata_source = container.GetMetadataSource();
+
+  // A running query is interrupted at the deadline.
+  metadata_source->SetQueryDeadline(absl::Now() + absl::Milliseconds(50),
+                                    /*is_cancelled=*/nullptr);
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  EXPECT_TRUE(absl::IsDeadlineExceeded(
+      metadata_source->ExecuteQuery(kLongRunningQuery, nullptr)));
+  // A query is not started once the deadline has passed.
+  EXPECT_TRUE(absl::IsDeadlineExceeded(
+      metadata_source->ExecuteQuery("SELECT * FROM t1;", nullptr)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Rollback());
+
+  metadata_source->ClearQueryDeadline();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  RecordSet record_set;
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("SELECT * FROM t1;", &record_set));
+  EXPECT_EQ(3, record_set.records_size());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
+TEST(SqliteMetadataSourceExtendedTest, TestQueryCancellation) {
+  SqliteMetadataSourceContainer container;
+  container.InitSchemaAndPopulateRows();
+  MetadataSource* metadata_source = container.GetMetadataSource();
+
+  const absl::Time cancel_time = absl::Now() + absl::Milliseconds(50);
+  metadata_source->SetQueryDeadline(
+      absl::InfiniteFuture(),
+      [cancel_time]() { return absl::Now() >= cancel_time; });
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  EXPECT_TRUE(absl::IsCancelled(
+      metadata_source->ExecuteQuery(kLongRunningQuery, nullptr)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Rollback());
+}
+
+// Returns the single value returned by `query`.
+std::string QueryValue(MetadataSource* metadata_source,
+                       const std::string& query) {
+  ResultSet results;
+  CHECK_EQ(absl::OkStatus(), metadata_source->ExecuteQuery(query, &results));
+  CHECK_EQ(1, results.num_rows());
+  return results.ToString(0, 0);
+}
+
+TEST(SqliteMetadataSourceExtendedTest, TestWalModeReadsDuringWrites) {
+  const std::string filename =
+      absl::StrCat(::testing::TempDir(), "mlmd_sqlite_wal_test.db");
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::remove(absl::StrCat(filename, suffix).c_str());
+  }
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(filename);
+  config.set_journal_mode(SqliteMetadataSourceConfig::JOURNAL_MODE_WAL);
+  config.set_synchronous(SqliteMetadataSourceConfig::SYNCHRONOUS_NORMAL);
+  config.set_cache_size(-4096);
+  config.set_mmap_size(1 << 20);
+  config.set_temp_store(SqliteMetadataSourceConfig::TEMP_STORE_MEMORY);
+  config.set_busy_timeout_sec(0.5);
+  SqliteMetadataSourceContainer writer_container(config);
+  writer_container.InitSchemaAndPopulateRows();
+  MetadataSource* writer = writer_container.GetMetadataSource();
+
+  // The pragmas are set when connecting.
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  EXPECT_EQ("wal", QueryValue(writer, "PRAGMA journal_mode;"));
+  EXPECT_EQ("1", QueryValue(writer, "PRAGMA synchronous;"));
+  EXPECT_EQ("-4096", QueryValue(writer, "PRAGMA cache_size;"));
+  EXPECT_EQ("2", QueryValue(writer, "PRAGMA temp_store;"));
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+
+  config.set_connection_mode(SqliteMetadataSourceConfig::READONLY);
+  config.clear_journal_mode();
+  SqliteMetadataSource reader(config);
+  ASSERT_EQ(absl::OkStatus(), reader.Connect());
+
+  // A write commits while a read is in progress, which keeps its snapshot.
+  ASSERT_EQ(absl::OkStatus(), reader.Begin());
+  EXPECT_EQ("3", QueryValue(&reader, "SELECT COUNT(*) FROM t1;"));
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4');", nullptr));
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+  EXPECT_EQ("3", QueryValue(&reader, "SELECT COUNT(*) FROM t1;"));
+  ASSERT_EQ(absl::OkStatus(), reader.Commit());
+
+  // A read does not wait for the write in progress.
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("INSERT INTO t1 VALUES (5, 'v5');", nullptr));
+  ASSERT_EQ(absl::OkStatus(), reader.Begin());
+  EXPECT_EQ("4", QueryValue(&reader, "SELECT COUNT(*) FROM t1;"));
+  ASSERT_EQ(absl::OkStatus(), reader.Commit());
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+}
+
+TEST(SqliteMetadataSourceExtendedTest, TestWritersWaitAtBegin) {
+  const std::string filename =
+      absl::StrCat(::testing::TempDir(), "mlmd_sqlite_begin_test.db");
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::remove(absl::StrCat(filename, suffix).c_str());
+  }
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(filename);
+  config.set_journal_mode(SqliteMetadataSourceConfig::JOURNAL_MODE_WAL);
+  config.set_busy_timeout_sec(0.1);
+  SqliteMetadataSourceContainer writer_container(config);
+  writer_container.InitSchemaAndPopulateRows();
+  MetadataSource* writer = writer_container.GetMetadataSource();
+  SqliteMetadataSource other_writer(config);
+  ASSERT_EQ(absl::OkStatus(), other_writer.Connect());
+
+  // A transaction which may write takes the write lock when it begins.
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  EXPECT_TRUE(absl::IsAborted(other_writer.Begin()));
+  EXPECT_FALSE(other_writer.transaction_open());
+
+  // A read-only transaction neither waits for the writer nor sees its writes.
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4');", nullptr));
+  ASSERT_EQ(absl::OkStatus(), other_writer.BeginReadOnly());
+  EXPECT_EQ("3", QueryValue(&other_writer, "SELECT COUNT(*) FROM t1;"));
+  ASSERT_EQ(absl::OkStatus(), other_writer.Commit());
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), other_writer.Begin());
+  EXPECT_EQ("4", QueryValue(&other_writer, "SELECT COUNT(*) FROM t1;"));
+  ASSERT_EQ(absl::OkStatus(), other_writer.Commit());
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
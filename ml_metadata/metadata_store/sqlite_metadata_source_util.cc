@@ -14,8 +14,6 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
 
-#include "ml_metadata/proto/metadata_source.pb.h"
-#include "ml_metadata/metadata_store/constants.h"
 #include "sqlite3.h"
 
 namespace ml_metadata {
@@ -27,24 +25,34 @@ std::string SqliteEscapeString(absl::string_view value) {
   return result;
 }
 
-int ConvertSqliteResultsToRecordSet(void* results, int column_num,
-                                    char** column_vals, char** column_names) {
-  // return if queries return no result, e.g., create, insert, update, etc.
-  if (column_num == 0) return SQLITE_OK;
-  RecordSet* record_set = static_cast<RecordSet*>(results);
-  // ignore the results of the query, if the user passes a nullptr for results.
-  if (record_set == nullptr) return SQLITE_OK;
-  // parse the query results to the record_sets (column_names and records)
-  // as sqlite calls the callback repetitively for each row, it sets the column
-  // names at the first time.
-  bool is_column_name_initted = (record_set->column_names_size() == column_num);
-  if (!is_column_name_initted) record_set->clear_column_names();
-  RecordSet::Record* record = record_set->add_records();
+void AppendSqliteRowToResultSet(sqlite3_stmt* statement, ResultSet* results) {
+  const int column_num = sqlite3_column_count(statement);
+  if (column_num == 0 || results == nullptr) return;
+  if (results->num_columns() != column_num) {
+    results->Clear();
+    for (int i = 0; i < column_num; i++) {
+      results->AddColumn(sqlite3_column_name(statement, i));
+    }
+  }
   for (int i = 0; i < column_num; i++) {
-    if (!is_column_name_initted) record_set->add_column_names(column_names[i]);
-    record->add_values(column_vals[i] ? column_vals[i] : kMetadataSourceNull);
+    switch (sqlite3_column_type(statement, i)) {
+      case SQLITE_INTEGER:
+        results->AppendInt(i, sqlite3_column_int64(statement, i));
+        break;
+      case SQLITE_FLOAT:
+        results->AppendDouble(i, sqlite3_column_double(statement, i));
+        break;
+      case SQLITE_NULL:
+        results->AppendNull(i);
+        break;
+      default: {
+        const unsigned char* value = sqlite3_column_text(statement, i);
+        results->AppendString(
+            i, absl::string_view(reinterpret_cast<const char*>(value),
+                                 sqlite3_column_bytes(statement, i)));
+      }
+    }
   }
-  return SQLITE_OK;
 }
 
 }  // namespace ml_metadata
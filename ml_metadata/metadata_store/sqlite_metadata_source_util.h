@@ -18,19 +18,18 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/result_set.h"
+#include "sqlite3.h"
 
 namespace ml_metadata {
 
 // Escapes strings having single quotes using built-in printf in Sqlite3 C API.
 std::string SqliteEscapeString(absl::string_view value);
 
-// Converts the query results (`column_vals`) if any to a RecordSet (`results`).
-// It is used as a callback of sqlite3_exec. The `results` should be owned by
-// the caller of sqlite3_exec. If the given RecordSet (`results`) is nullptr,
-// the query result is ignored.
-// (see https://www.sqlite.org/c3ref/exec.html for details)
-int ConvertSqliteResultsToRecordSet(void* results, int column_num,
-                                    char** column_vals, char** column_names);
+// Appends the current row of a stepped prepared `statement` to `results`, with
+// the types of its values. The columns are added with the first row. If the
+// given ResultSet (`results`) is nullptr, the row is ignored.
+void AppendSqliteRowToResultSet(sqlite3_stmt* statement, ResultSet* results);
 
 }  // namespace ml_metadata
 
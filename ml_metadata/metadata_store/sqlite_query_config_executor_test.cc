@@ -14,16 +14,23 @@ limitations under the License.
 ==============================================================================*/
 // Test suite for a sqlite query config-based QueryExecutor.
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/query_config_executor.h"
 #include "ml_metadata/metadata_store/query_executor.h"
 #include "ml_metadata/metadata_store/query_executor_test.h"
+#include "ml_metadata/metadata_store/result_set.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
 
 namespace ml_metadata {
@@ -58,6 +65,76 @@ class SqliteQueryConfigExecutorContainer : public QueryConfigExecutorContainer {
   std::unique_ptr<QueryExecutor> query_executor_;
 };
 
+// The nodes are inserted one by one if the insert ids may not be consecutive,
+// e.g., with a query config which does not tell.
+TEST(SqliteQueryConfigExecutorExtendedTest,
+     InsertsNodesWithoutConsecutiveInsertIds) {
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  query_config.clear_select_consecutive_insert_ids();
+  SqliteMetadataSource metadata_source((SqliteMetadataSourceConfig()));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  QueryConfigExecutor query_executor(query_config, &metadata_source);
+  ASSERT_EQ(absl::OkStatus(), query_executor.InitMetadataSource());
+  int64 artifact_type_id;
+  ASSERT_EQ(absl::OkStatus(), query_executor.InsertArtifactType(
+                                  "artifact_type", absl::nullopt, absl::nullopt,
+                                  &artifact_type_id));
+
+  std::vector<Artifact> artifacts(3);
+  for (int i = 0; i < artifacts.size(); ++i) {
+    artifacts[i].set_type_id(artifact_type_id);
+    artifacts[i].set_uri("/foo/bar");
+    artifacts[i].set_name(absl::StrCat("artifact_", i));
+  }
+  const int64 num_queries = metadata_source.num_queries();
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), query_executor.InsertArtifacts(
+                                  artifacts, absl::Now(), &artifact_ids));
+  // An insert and a last insert id query per artifact.
+  EXPECT_EQ(metadata_source.num_queries() - num_queries, 2 * artifacts.size());
+  ASSERT_EQ(artifact_ids.size(), artifacts.size());
+  for (int i = 0; i < artifacts.size(); ++i) {
+    ResultSet record_set;
+    ASSERT_EQ(absl::OkStatus(),
+              query_executor.SelectArtifactByTypeIDAndArtifactName(
+                  artifact_type_id, artifacts[i].name(), &record_set));
+    ASSERT_EQ(record_set.num_rows(), 1);
+    EXPECT_EQ(record_set.GetInt(0, 0), artifact_ids[i]);
+  }
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+}
+
+// The queries run in read-only transactions without their LOCK IN SHARE MODE
+// clause, which SQLite does not support, and with it otherwise.
+TEST(SqliteQueryConfigExecutorExtendedTest,
+     RunsReadOnlyQueriesWithoutSharedLocks) {
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  const std::string query = std::string(
+      absl::StripSuffix(query_config.select_artifact_by_id().query(), "; "));
+  query_config.mutable_select_artifact_by_id()->set_query(
+      absl::StrCat(query, " LOCK IN SHARE MODE; "));
+  SqliteMetadataSource metadata_source((SqliteMetadataSourceConfig()));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  QueryConfigExecutor query_executor(query_config, &metadata_source);
+  ASSERT_EQ(absl::OkStatus(), query_executor.InitMetadataSource());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  ResultSet record_set;
+  EXPECT_FALSE(query_executor.SelectArtifactsByID({1}, &record_set).ok());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Rollback());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source.BeginReadOnly());
+  EXPECT_EQ(absl::OkStatus(),
+            query_executor.SelectArtifactsByID({1}, &record_set));
+  EXPECT_EQ(record_set.num_rows(), 0);
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
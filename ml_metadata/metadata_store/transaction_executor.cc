@@ -15,10 +15,72 @@ limitations under the License.
 
 #include "ml_metadata/metadata_store/transaction_executor.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <glog/logging.h>
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
 #include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
+namespace {
+
+// The retries of the transactions of this process, which are taken from a
+// bucket refilled by the committed transactions, so that the transactions are
+// retried at a bounded rate once most of them are aborted.
+//
+// This class is thread-safe.
+class RetryBudget {
+ public:
+  // The max number of retries held by the bucket, which is full at first.
+  static constexpr double kMaxRetries = 100;
+
+  static RetryBudget& Global() {
+    static RetryBudget* const global_budget = new RetryBudget();
+    return *global_budget;
+  }
+
+  // Takes a retry from the bucket, and returns false if it is empty.
+  bool TryTakeRetry() {
+    absl::MutexLock lock(&mu_);
+    if (num_retries_ < 1) return false;
+    num_retries_ -= 1;
+    return true;
+  }
+
+  // Adds the retries earned by a committed transaction to the bucket.
+  void AddRetries(const double num_retries) {
+    absl::MutexLock lock(&mu_);
+    num_retries_ = std::min(kMaxRetries, num_retries_ + num_retries);
+  }
+
+ private:
+  absl::Mutex mu_;
+  double num_retries_ ABSL_GUARDED_BY(mu_) = kMaxRetries;
+};
+
+// Returns the random wait before the retry after `num_retries` retries, which
+// is drawn uniformly up to the max wait growing exponentially with them.
+absl::Duration GetBackoff(const RetryOptions& retry_options,
+                          const int num_retries) {
+  const double max_backoff_micros =
+      std::min(retry_options.initial_backoff_micros() *
+                   std::pow(retry_options.backoff_multiplier(), num_retries),
+               static_cast<double>(retry_options.max_backoff_micros()));
+  if (!(max_backoff_micros > 0)) return absl::ZeroDuration();
+  thread_local absl::BitGen bit_gen;
+  return absl::Microseconds(absl::Uniform(bit_gen, 0.0, max_backoff_micros));
+}
+
+}  // namespace
 
 absl::Status RdbmsTransactionExecutor::Execute(
     const std::function<absl::Status()>& txn_body,
@@ -29,7 +91,78 @@ absl::Status RdbmsTransactionExecutor::Execute(
         "connected");
   }
 
-  MLMD_RETURN_IF_ERROR(metadata_source_->Begin());
+  // Joins the enclosing transaction, which commits or rolls back the updates
+  // of txn_body with its own ones.
+  if (metadata_source_->transaction_open()) {
+    return txn_body();
+  }
+
+  for (int num_retries = 0;; ++num_retries) {
+    const absl::Status status = ExecuteOnce(txn_body, transaction_options);
+    if (status.ok()) {
+      RetryBudget::Global().AddRetries(retry_options_.retry_budget_ratio());
+      return status;
+    }
+    // A transaction which failed to roll back cannot be run again.
+    if (!absl::IsAborted(status) || metadata_source_->transaction_open() ||
+        num_retries >= retry_options_.max_num_retries()) {
+      return status;
+    }
+    if (!RetryBudget::Global().TryTakeRetry()) {
+      LOG_EVERY_N(WARNING, 100)
+          << "The retry budget is used up, aborted transactions are not "
+             "retried: "
+          << status;
+      return status;
+    }
+    absl::SleepFor(GetBackoff(retry_options_, num_retries));
+    // The retry is not started once the request has given up.
+    if (!metadata_source_->CheckQueryDeadline().ok()) {
+      return status;
+    }
+    transaction_stats_->RecordRetry(transaction_options.tag());
+  }
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteInSavepoint(
+    const std::function<absl::Status()>& body) const {
+  if (metadata_source_ == nullptr || !metadata_source_->transaction_open()) {
+    return absl::FailedPreconditionError(
+        "ExecuteInSavepoint should be called within a transaction");
+  }
+  const std::string savepoint =
+      absl::StrCat("mlmd_savepoint_", num_savepoints_);
+  MLMD_RETURN_IF_ERROR(metadata_source_->Savepoint(savepoint));
+  ++num_savepoints_;
+  const absl::Status status = body();
+  --num_savepoints_;
+  if (!status.ok()) {
+    if (absl::IsAborted(status) || absl::IsDeadlineExceeded(status) ||
+        absl::IsCancelled(status)) {
+      return status;
+    }
+    const absl::Status rollback_status =
+        metadata_source_->RollbackToSavepoint(savepoint);
+    if (!rollback_status.ok()) {
+      return absl::InternalError(
+          absl::StrCat("Cannot roll back to the savepoint after the error: ",
+                       status.ToString(), ", due to ",
+                       rollback_status.ToString()));
+    }
+  }
+  MLMD_RETURN_IF_ERROR(metadata_source_->ReleaseSavepoint(savepoint));
+  return status;
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteOnce(
+    const std::function<absl::Status()>& txn_body,
+    const TransactionOptions& transaction_options) const {
+  const absl::Time start_time = absl::Now();
+  const int64 start_num_queries = metadata_source_->num_queries();
+  const int64 start_num_rows = metadata_source_->num_rows();
+  MLMD_RETURN_IF_ERROR(transaction_options.read_only()
+                           ? metadata_source_->BeginReadOnly()
+                           : metadata_source_->Begin());
 
   absl::Status transaction_status = txn_body();
   if (transaction_status.ok()) {
@@ -39,6 +172,11 @@ absl::Status RdbmsTransactionExecutor::Execute(
   if (!transaction_status.ok()) {
     transaction_status.Update(metadata_source_->Rollback());
   }
+  transaction_stats_->Record(
+      transaction_options.tag(), transaction_status.ok(),
+      metadata_source_->num_queries() - start_num_queries,
+      metadata_source_->num_rows() - start_num_rows,
+      absl::Now() - start_time);
   return transaction_status;
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace ml_metadata {
@@ -40,33 +41,79 @@ class TransactionExecutor {
       const std::function<absl::Status()>& txn_body,
       const TransactionOptions& transaction_options = TransactionOptions())
       const = 0;
+
+  // Runs body within the transaction of an enclosing Execute, and undoes the
+  // updates of body alone if it fails, so that the transaction can go on.
+  virtual absl::Status ExecuteInSavepoint(
+      const std::function<absl::Status()>& body) const = 0;
 };
 
 // An implementation of TransactionExecutor.
 // It contains a method to execute the transaction body and tries to commit
 // the execution result in the database by using Begin/Commit/Rollback
-// methods in MetadataSource.
+// methods in MetadataSource. The transactions aborted by the database, e.g.,
+// by deadlocks or lock timeouts, are run again as given by the RetryOptions.
+// The transactions are recorded in transaction_stats, which defaults to the
+// statistics of the process.
 class RdbmsTransactionExecutor : public TransactionExecutor {
  public:
-  explicit RdbmsTransactionExecutor(MetadataSource* metadata_source)
-      : metadata_source_(metadata_source) {}
+  explicit RdbmsTransactionExecutor(
+      MetadataSource* metadata_source,
+      const RetryOptions& retry_options = RetryOptions(),
+      TransactionStats* transaction_stats = &TransactionStats::Global())
+      : metadata_source_(metadata_source),
+        retry_options_(retry_options),
+        transaction_stats_(transaction_stats) {}
   ~RdbmsTransactionExecutor() override = default;
 
   // Tries to commit the execution result of txn_body.
   // When the txn_body returns OK, it calls Commit, otherwise it calls Rollback.
+  // If transaction_options.read_only is set, the transaction begins with
+  // BeginReadOnly, and the txn_body must not write.
+  // If it is called within the txn_body of another Execute, the txn_body runs
+  // in the enclosing transaction, and its error fails the enclosing one.
+  // If the transaction is aborted, it is rolled back and run again after a
+  // random backoff, up to max_num_retries times while the retry budget and the
+  // query deadline of the metadata source allow it. The txn_body must give the
+  // same result when it is run again, e.g., by clearing its outputs first.
   //
   // Returns FAILED_PRECONDITION if metadata_source is null or not connected.
   // Returns detailed internal errors of transaction, i.e.
   //   Begin, Rollback and Commit.
+  // Returns ABORTED error if the last run of the transaction is aborted.
   absl::Status Execute(const std::function<absl::Status()>& txn_body,
                        const TransactionOptions& transaction_options =
                            TransactionOptions()) const override;
 
+  // Runs body in a savepoint of the open transaction, which is rolled back to
+  // if body fails. The errors which abort the whole transaction, i.e., ABORTED,
+  // DEADLINE_EXCEEDED and CANCELLED, are returned without rolling back to the
+  // savepoint, and fail the enclosing Execute.
+  //
+  // Returns FAILED_PRECONDITION if no transaction is open.
+  // Returns the error of body, once its updates are undone.
+  // Returns INTERNAL error if the savepoint cannot be rolled back to.
+  absl::Status ExecuteInSavepoint(
+      const std::function<absl::Status()>& body) const override;
+
  private:
+  // Runs txn_body in a transaction once.
+  absl::Status ExecuteOnce(const std::function<absl::Status()>& txn_body,
+                           const TransactionOptions& transaction_options) const;
+
   // The MetadataSource which has the connection to a database.
   // It also supports other database primitves like Commit and Abort.
   // Not owned by this class.
   MetadataSource* metadata_source_;
+
+  // The options to run the aborted transactions again.
+  const RetryOptions retry_options_;
+
+  // The statistics of the transactions. Not owned by this class.
+  TransactionStats* const transaction_stats_;
+
+  // The number of savepoints open in the transaction, which names the next.
+  mutable int num_savepoints_ = 0;
 };
 
 }  // namespace ml_metadata
@@ -22,21 +22,27 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/result_set.h"
+#include "ml_metadata/metadata_store/transaction_stats.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
 namespace {
 
+using ::testing::_;
 using ::testing::Return;
 
 class MockMetadataSource : public MetadataSource {
  public:
   MOCK_METHOD(absl::Status, BeginImpl, (), (override));
+  MOCK_METHOD(absl::Status, BeginReadOnlyImpl, (), (override));
   MOCK_METHOD(absl::Status, ConnectImpl, (), (override));
   MOCK_METHOD(absl::Status, CloseImpl, (), (override));
   MOCK_METHOD(absl::Status, RollbackImpl, (), (override));
   MOCK_METHOD(absl::Status, CommitImpl, (), ());
   MOCK_METHOD(absl::Status, ExecuteQueryImpl,
-              (const std::string& query, RecordSet* results), (override));
+              (const std::string& query, ResultSet* results), (override));
   MOCK_METHOD(std::string, EscapeString, (absl::string_view value),
               (const, override));
 };
@@ -86,6 +92,29 @@ TEST(TransactionExecutorTest, ReturnOkWhenBothTxnBodyAndCommitOk) {
   EXPECT_EQ(absl::OkStatus(), txn_executor.Execute(kFuncReturnOk));
 }
 
+TEST(TransactionExecutorTest, BeginsReadOnlyTransaction) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, BeginReadOnlyImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  // These methods should not be called.
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
+  EXPECT_CALL(mock_metadata_source, RollbackImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+  TransactionOptions options;
+  options.set_read_only(true);
+
+  EXPECT_EQ(absl::OkStatus(), txn_executor.Execute(kFuncReturnOk, options));
+}
+
 TEST(TransactionExecutorTest, ReturnErrorWhenTxnBodyReturnsError) {
   MockMetadataSource mock_metadata_source;
   // These calls should be called once and only once.
@@ -137,6 +166,180 @@ TEST(TransactionExecutorTest, ReturnErrorWhenTxnBodyReturnsOkButCommitFails) {
   EXPECT_EQ(txn_executor.Execute(kFuncReturnOk), kTfCommitErrorStatus);
 }
 
+TEST(TransactionExecutorTest, NestedTxnBodyJoinsEnclosingTransaction) {
+  MockMetadataSource mock_metadata_source;
+  // The nested transaction body does not begin nor commit a transaction.
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CloseImpl())
+      .Times(0);
+
+  // Initialize the mock_metadata_source.
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+
+  EXPECT_EQ(absl::OkStatus(), txn_executor.Execute([&]() -> absl::Status {
+    return txn_executor.Execute(kFuncReturnOk);
+  }));
+  // The error of the nested transaction body rolls back the enclosing one.
+  EXPECT_EQ(txn_executor.Execute([&]() -> absl::Status {
+    return txn_executor.Execute(kFuncReturnInternalError);
+  }),
+            kTfFuncErrorStatus);
+}
+
+TEST(TransactionExecutorTest, SavepointUndoesFailedBodyAlone) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl()).Times(0);
+  {
+    ::testing::InSequence in_sequence;
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT mlmd_savepoint_0", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT mlmd_savepoint_0", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("SAVEPOINT mlmd_savepoint_0", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("ROLLBACK TO SAVEPOINT mlmd_savepoint_0", _))
+        .WillOnce(Return(absl::OkStatus()));
+    EXPECT_CALL(mock_metadata_source,
+                ExecuteQueryImpl("RELEASE SAVEPOINT mlmd_savepoint_0", _))
+        .WillOnce(Return(absl::OkStatus()));
+  }
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      txn_executor.ExecuteInSavepoint(kFuncReturnOk)));
+  // The error of the body is returned, and the transaction is committed.
+  EXPECT_EQ(absl::OkStatus(), txn_executor.Execute([&]() -> absl::Status {
+    EXPECT_EQ(absl::OkStatus(), txn_executor.ExecuteInSavepoint(kFuncReturnOk));
+    EXPECT_EQ(kTfFuncErrorStatus,
+              txn_executor.ExecuteInSavepoint(kFuncReturnInternalError));
+    return absl::OkStatus();
+  }));
+}
+
+TEST(TransactionExecutorTest, RecordsTransactionStatsByTag) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(_, _))
+      .WillRepeatedly([](const std::string& query, ResultSet* results) {
+        results->AddColumn("value");
+        results->AppendInt(/*column=*/0, 1);
+        return absl::OkStatus();
+      });
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  TransactionStats transaction_stats;
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source, RetryOptions(),
+                                        &transaction_stats);
+
+  TransactionOptions transaction_options;
+  transaction_options.set_tag("transaction_executor_test");
+  const std::function<absl::Status()> run_two_queries =
+      [&]() -> absl::Status {
+    ResultSet record_set_1, record_set_2;
+    MLMD_RETURN_IF_ERROR(
+        mock_metadata_source.ExecuteQuery("SELECT 1", &record_set_1));
+    return mock_metadata_source.ExecuteQuery("SELECT 2", &record_set_2);
+  };
+  EXPECT_EQ(absl::OkStatus(),
+            txn_executor.Execute(run_two_queries, transaction_options));
+  EXPECT_EQ(txn_executor.Execute(kFuncReturnInternalError, transaction_options),
+            kTfFuncErrorStatus);
+
+  const TransactionStats::Totals totals =
+      transaction_stats.GetTotals()["transaction_executor_test"];
+  EXPECT_EQ(totals.num_transactions, 2);
+  EXPECT_EQ(totals.num_failed_transactions, 1);
+  EXPECT_EQ(totals.num_queries, 2);
+  EXPECT_EQ(totals.num_rows, 2);
+}
+
+TEST(TransactionExecutorTest, RetriesAbortedTransactions) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(7)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  // The first transaction commits at its third run, and the last one is still
+  // aborted at its third run.
+  const absl::Status aborted_status = absl::AbortedError("Fake deadlock.");
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(aborted_status))
+      .WillOnce(Return(aborted_status))
+      .WillOnce(Return(absl::OkStatus()))
+      .WillOnce(Return(aborted_status))
+      .WillOnce(Return(aborted_status))
+      .WillOnce(Return(aborted_status));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(6)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RetryOptions retry_options;
+  retry_options.set_max_num_retries(2);
+  retry_options.set_initial_backoff_micros(100);
+  TransactionStats transaction_stats;
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source, retry_options,
+                                        &transaction_stats);
+
+  TransactionOptions transaction_options;
+  transaction_options.set_tag("transaction_executor_retry_test");
+  int num_runs = 0;
+  const std::function<absl::Status()> count_runs = [&]() -> absl::Status {
+    ++num_runs;
+    return absl::OkStatus();
+  };
+  EXPECT_EQ(absl::OkStatus(),
+            txn_executor.Execute(count_runs, transaction_options));
+  EXPECT_EQ(3, num_runs);
+  // The errors other than ABORTED are not retried.
+  EXPECT_EQ(txn_executor.Execute(kFuncReturnInternalError, transaction_options),
+            kTfFuncErrorStatus);
+  num_runs = 0;
+  EXPECT_EQ(txn_executor.Execute(count_runs, transaction_options),
+            aborted_status);
+  EXPECT_EQ(3, num_runs);
+
+  const TransactionStats::Totals totals =
+      transaction_stats.GetTotals()["transaction_executor_retry_test"];
+  EXPECT_EQ(totals.num_transactions, 7);
+  EXPECT_EQ(totals.num_failed_transactions, 6);
+  EXPECT_EQ(totals.num_retries, 4);
+}
+
 TEST(TransactionExecutorTest, ReturnConnectErrorWhenConnectFails) {
   MockMetadataSource mock_metadata_source;
   // These calls should be called once and only once.
@@ -0,0 +1,100 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/transaction_stats.h"
+
+#include <atomic>
+
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the totals of `tag` in `totals`, or the ones of kOtherTags if there
+// are kMaxNumTags other tags already.
+TransactionStats::Totals& GetTagTotals(
+    const absl::string_view tag,
+    absl::flat_hash_map<std::string, TransactionStats::Totals>& totals) {
+  auto it = totals.find(tag);
+  if (it == totals.end()) {
+    const int num_tags =
+        totals.size() - totals.count(TransactionStats::kOtherTags);
+    it = num_tags < TransactionStats::kMaxNumTags
+             ? totals.try_emplace(tag).first
+             : totals.try_emplace(TransactionStats::kOtherTags).first;
+  }
+  return it->second;
+}
+
+}  // namespace
+
+constexpr char TransactionStats::kOtherTags[];
+constexpr int TransactionStats::kMaxNumTags;
+constexpr int TransactionStats::kNumShards;
+
+TransactionStats& TransactionStats::Global() {
+  static TransactionStats* const global_stats = new TransactionStats();
+  return *global_stats;
+}
+
+TransactionStats::Shard& TransactionStats::GetThreadShard() {
+  // The threads are assigned to the shards in turn.
+  static std::atomic<int> next_shard_index(0);
+  thread_local const int shard_index =
+      next_shard_index.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shards_[shard_index];
+}
+
+void TransactionStats::Record(const absl::string_view tag,
+                              const bool committed, const int64 num_queries,
+                              const int64 num_rows,
+                              const absl::Duration duration) {
+  Shard& shard = GetThreadShard();
+  absl::MutexLock lock(&shard.mu);
+  Totals& totals = GetTagTotals(tag, shard.totals);
+  ++totals.num_transactions;
+  if (!committed) {
+    ++totals.num_failed_transactions;
+  }
+  totals.num_queries += num_queries;
+  totals.num_rows += num_rows;
+  totals.total_time += duration;
+}
+
+void TransactionStats::RecordRetry(const absl::string_view tag) {
+  Shard& shard = GetThreadShard();
+  absl::MutexLock lock(&shard.mu);
+  ++GetTagTotals(tag, shard.totals).num_retries;
+}
+
+absl::flat_hash_map<std::string, TransactionStats::Totals>
+TransactionStats::GetTotals() const {
+  absl::flat_hash_map<std::string, Totals> merged_totals;
+  for (const Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    for (const auto& tag_and_totals : shard.totals) {
+      const Totals& totals = tag_and_totals.second;
+      Totals& merged = GetTagTotals(tag_and_totals.first, merged_totals);
+      merged.num_transactions += totals.num_transactions;
+      merged.num_failed_transactions += totals.num_failed_transactions;
+      merged.num_queries += totals.num_queries;
+      merged.num_rows += totals.num_rows;
+      merged.total_time += totals.total_time;
+      merged.num_retries += totals.num_retries;
+    }
+  }
+  return merged_totals;
+}
+
+}  // namespace ml_metadata
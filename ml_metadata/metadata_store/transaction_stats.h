@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TRANSACTION_STATS_H_
+#define ML_METADATA_METADATA_STORE_TRANSACTION_STATS_H_
+
+#include <array>
+#include <string>
+
+#include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Statistics of the transactions run in this process, aggregated by the tag of
+// their TransactionOptions, so that the server can report which requests use
+// the database the most. The transactions are recorded by
+// RdbmsTransactionExecutor.
+//
+// The totals are kept in shards, each used by a part of the threads, so that
+// the concurrent transactions do not contend on a single mutex. The shards are
+// only merged when the totals are read.
+//
+// This class is thread-safe.
+class TransactionStats {
+ public:
+  // The tag under which the transactions are recorded once `kMaxNumTags`
+  // distinct tags have been seen, as the tags are given by the clients.
+  static constexpr char kOtherTags[] = "<other tags>";
+  static constexpr int kMaxNumTags = 1000;
+  // The number of shards of the totals.
+  static constexpr int kNumShards = 16;
+
+  // The totals of the transactions with a tag.
+  struct Totals {
+    int64 num_transactions = 0;
+    // The number of transactions which were rolled back.
+    int64 num_failed_transactions = 0;
+    // The number of queries run by the transactions.
+    int64 num_queries = 0;
+    // The number of rows returned by the queries.
+    int64 num_rows = 0;
+    absl::Duration total_time;
+    // The number of times aborted transactions were run again.
+    int64 num_retries = 0;
+  };
+
+  // Returns the statistics of this process. The tests may use their own
+  // instances instead.
+  static TransactionStats& Global();
+
+  TransactionStats() = default;
+
+  // Disallow copy and assign.
+  TransactionStats(const TransactionStats&) = delete;
+  TransactionStats& operator=(const TransactionStats&) = delete;
+
+  // Records a transaction with the given `tag`, which has run `num_queries`
+  // queries returning `num_rows` rows in `duration`.
+  void Record(absl::string_view tag, bool committed, int64 num_queries,
+              int64 num_rows, absl::Duration duration);
+
+  // Records that an aborted transaction with the given `tag` is run again.
+  void RecordRetry(absl::string_view tag);
+
+  // Returns the totals of the recorded transactions by tag.
+  absl::flat_hash_map<std::string, Totals> GetTotals() const;
+
+ private:
+  // The totals recorded by a part of the threads, aligned to a cache line so
+  // that the shards do not share one.
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    mutable absl::Mutex mu;
+    absl::flat_hash_map<std::string, Totals> totals ABSL_GUARDED_BY(mu);
+  };
+
+  // Returns the shard of the calling thread.
+  Shard& GetThreadShard();
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TRANSACTION_STATS_H_
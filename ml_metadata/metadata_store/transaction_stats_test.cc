@@ -0,0 +1,65 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/transaction_stats.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+namespace {
+
+TEST(TransactionStatsTest, MergesTheTotalsOfAllThreads) {
+  TransactionStats transaction_stats;
+  constexpr int kNumThreads = 2 * TransactionStats::kNumShards;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&transaction_stats]() {
+      transaction_stats.Record("test", /*committed=*/true, /*num_queries=*/2,
+                               /*num_rows=*/3, absl::Milliseconds(1));
+      transaction_stats.RecordRetry("test");
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  const TransactionStats::Totals totals = transaction_stats.GetTotals()["test"];
+  EXPECT_EQ(totals.num_transactions, kNumThreads);
+  EXPECT_EQ(totals.num_failed_transactions, 0);
+  EXPECT_EQ(totals.num_queries, 2 * kNumThreads);
+  EXPECT_EQ(totals.num_rows, 3 * kNumThreads);
+  EXPECT_EQ(totals.total_time, absl::Milliseconds(kNumThreads));
+  EXPECT_EQ(totals.num_retries, kNumThreads);
+}
+
+TEST(TransactionStatsTest, RecordsTooManyTagsAsOtherTags) {
+  TransactionStats transaction_stats;
+  for (int i = 0; i < TransactionStats::kMaxNumTags + 1; ++i) {
+    transaction_stats.RecordRetry(absl::StrCat("tag_", i));
+  }
+
+  const auto totals = transaction_stats.GetTotals();
+  EXPECT_EQ(totals.size(), TransactionStats::kMaxNumTags + 1);
+  EXPECT_EQ(totals.at(TransactionStats::kOtherTags).num_retries, 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
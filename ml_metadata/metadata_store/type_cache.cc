@@ -0,0 +1,152 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/type_cache.h"
+
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns the key of a type by its name and version, where an empty version
+// is the same as no version.
+std::pair<std::string, absl::optional<std::string>> NameKey(
+    const absl::string_view name,
+    const absl::optional<absl::string_view> version) {
+  if (version && !version->empty()) {
+    return {std::string(name), std::string(*version)};
+  }
+  return {std::string(name), absl::nullopt};
+}
+
+}  // namespace
+
+TypeCache* TypeCache::ForDatabase(const absl::string_view database) {
+  static absl::Mutex* const mu = new absl::Mutex();
+  static auto* const caches =
+      new absl::flat_hash_map<std::string, std::unique_ptr<TypeCache>>();
+  absl::MutexLock lock(mu);
+  std::unique_ptr<TypeCache>& cache = (*caches)[database];
+  if (cache == nullptr) {
+    cache = absl::make_unique<TypeCache>();
+  }
+  return cache.get();
+}
+
+template <>
+TypeCache::Types<ArtifactType>& TypeCache::GetTypes<ArtifactType>() {
+  return artifact_types_;
+}
+
+template <>
+TypeCache::Types<ExecutionType>& TypeCache::GetTypes<ExecutionType>() {
+  return execution_types_;
+}
+
+template <>
+TypeCache::Types<ContextType>& TypeCache::GetTypes<ContextType>() {
+  return context_types_;
+}
+
+template <typename Type>
+bool TypeCache::FindType(const int64 generation, const int64 type_id,
+                         Type* type) {
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) return false;
+  const Types<Type>& types = GetTypes<Type>();
+  auto it = types.by_id.find(type_id);
+  if (it == types.by_id.end()) return false;
+  *type = it->second;
+  return true;
+}
+
+template <typename Type>
+bool TypeCache::FindType(const int64 generation, const absl::string_view name,
+                         const absl::optional<absl::string_view> version,
+                         Type* type) {
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) return false;
+  const Types<Type>& types = GetTypes<Type>();
+  auto id_it = types.by_name.find(NameKey(name, version));
+  if (id_it == types.by_name.end()) return false;
+  auto it = types.by_id.find(id_it->second);
+  if (it == types.by_id.end()) return false;
+  *type = it->second;
+  return true;
+}
+
+bool TypeCache::FindParentTypeIds(const int64 generation, const int64 type_id,
+                                  std::vector<int64>* parent_type_ids) {
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) return false;
+  auto it = parent_type_ids_.find(type_id);
+  if (it == parent_type_ids_.end()) return false;
+  *parent_type_ids = it->second;
+  return true;
+}
+
+template <typename Type>
+void TypeCache::InsertType(const int64 generation, const Type& type) {
+  absl::MutexLock lock(&mu_);
+  if (!AdvanceTo(generation)) return;
+  Types<Type>& types = GetTypes<Type>();
+  types.by_id[type.id()] = type;
+  types.by_name[NameKey(type.name(),
+                        type.has_version()
+                            ? absl::make_optional<absl::string_view>(
+                                  type.version())
+                            : absl::nullopt)] = type.id();
+}
+
+void TypeCache::InsertParentTypeIds(const int64 generation,
+                                    const int64 type_id,
+                                    std::vector<int64> parent_type_ids) {
+  absl::MutexLock lock(&mu_);
+  if (!AdvanceTo(generation)) return;
+  parent_type_ids_[type_id] = std::move(parent_type_ids);
+}
+
+bool TypeCache::AdvanceTo(const int64 generation) {
+  if (generation < generation_) return false;
+  if (generation > generation_) {
+    generation_ = generation;
+    artifact_types_ = {};
+    execution_types_ = {};
+    context_types_ = {};
+    parent_type_ids_.clear();
+  }
+  return true;
+}
+
+template bool TypeCache::FindType(int64, int64, ArtifactType*);
+template bool TypeCache::FindType(int64, int64, ExecutionType*);
+template bool TypeCache::FindType(int64, int64, ContextType*);
+template bool TypeCache::FindType(int64, absl::string_view,
+                                  absl::optional<absl::string_view>,
+                                  ArtifactType*);
+template bool TypeCache::FindType(int64, absl::string_view,
+                                  absl::optional<absl::string_view>,
+                                  ExecutionType*);
+template bool TypeCache::FindType(int64, absl::string_view,
+                                  absl::optional<absl::string_view>,
+                                  ContextType*);
+template void TypeCache::InsertType(int64, const ArtifactType&);
+template void TypeCache::InsertType(int64, const ExecutionType&);
+template void TypeCache::InsertType(int64, const ContextType&);
+
+}  // namespace ml_metadata
@@ -0,0 +1,113 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+#define ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Caches the types of a database, which are read much more often than they
+// are changed, e.g., a type is read to validate each node created of it.
+//
+// The entries are tagged with the type generation of the database, which is
+// increased by each change of the types. The entries are only found at the
+// generation they were inserted at, and a newer generation drops the older
+// entries, so that the types changed by any client are never served stale.
+//
+// The Type is one of {ArtifactType, ExecutionType, ContextType}.
+//
+// This class is thread-safe.
+class TypeCache {
+ public:
+  TypeCache() = default;
+
+  // Disallow copy and assign.
+  TypeCache(const TypeCache&) = delete;
+  TypeCache& operator=(const TypeCache&) = delete;
+
+  // Returns the cache shared in the process by the connections to the
+  // `database`, which names the database uniquely, e.g., by its host, port and
+  // name. The cache is created at the first call and is never deleted.
+  static TypeCache* ForDatabase(absl::string_view database);
+
+  // Finds the type with `type_id` cached at `generation`, with its properties.
+  // Returns false if it is not cached.
+  template <typename Type>
+  bool FindType(int64 generation, int64 type_id, Type* type);
+
+  // Finds the type with `name` and `version` cached at `generation`, with its
+  // properties. Returns false if it is not cached.
+  template <typename Type>
+  bool FindType(int64 generation, absl::string_view name,
+                absl::optional<absl::string_view> version, Type* type);
+
+  // Finds the parent type ids of the type with `type_id` cached at
+  // `generation`. Returns false if they are not cached.
+  bool FindParentTypeIds(int64 generation, int64 type_id,
+                         std::vector<int64>* parent_type_ids);
+
+  // Caches the `type` with its properties read at `generation`.
+  template <typename Type>
+  void InsertType(int64 generation, const Type& type);
+
+  // Caches the `parent_type_ids` of the type with `type_id` read at
+  // `generation`.
+  void InsertParentTypeIds(int64 generation, int64 type_id,
+                           std::vector<int64> parent_type_ids);
+
+ private:
+  // The cached types of a kind.
+  template <typename Type>
+  struct Types {
+    absl::flat_hash_map<int64, Type> by_id;
+    // The ids of the types by their name and version.
+    absl::flat_hash_map<std::pair<std::string, absl::optional<std::string>>,
+                        int64>
+        by_name;
+  };
+
+  // Returns the cached types of the kind of Type.
+  template <typename Type>
+  Types<Type>& GetTypes() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Drops the entries if `generation` is newer than `generation_`. Returns
+  // false if `generation` is older, as the entries read at it must not be
+  // cached.
+  bool AdvanceTo(int64 generation) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  absl::Mutex mu_;
+  // The generation the entries are read at.
+  int64 generation_ ABSL_GUARDED_BY(mu_) = -1;
+  Types<ArtifactType> artifact_types_ ABSL_GUARDED_BY(mu_);
+  Types<ExecutionType> execution_types_ ABSL_GUARDED_BY(mu_);
+  Types<ContextType> context_types_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64, std::vector<int64>> parent_type_ids_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
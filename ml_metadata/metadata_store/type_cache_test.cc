@@ -0,0 +1,101 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/type_cache.h"
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+
+TEST(TypeCacheTest, FindsTypesByIdAndName) {
+  TypeCache cache;
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"pb(
+    id: 1 name: 'type' version: 'v1' properties { key: 'p' value: INT }
+  )pb");
+  cache.InsertType(/*generation=*/5, type);
+
+  ArtifactType found;
+  ASSERT_TRUE(cache.FindType(5, 1, &found));
+  EXPECT_THAT(found, EqualsProto(type));
+  found.Clear();
+  ASSERT_TRUE(cache.FindType(5, "type", absl::string_view("v1"), &found));
+  EXPECT_THAT(found, EqualsProto(type));
+
+  EXPECT_FALSE(cache.FindType(5, "type", absl::nullopt, &found));
+  EXPECT_FALSE(cache.FindType(5, 2, &found));
+  // The types of other kinds are kept apart.
+  ExecutionType execution_type;
+  EXPECT_FALSE(cache.FindType(5, 1, &execution_type));
+}
+
+TEST(TypeCacheTest, EmptyVersionIsNoVersion) {
+  TypeCache cache;
+  const ContextType type =
+      ParseTextProtoOrDie<ContextType>("id: 1 name: 'type'");
+  cache.InsertType(5, type);
+
+  ContextType found;
+  EXPECT_TRUE(cache.FindType(5, "type", absl::nullopt, &found));
+  EXPECT_TRUE(cache.FindType(5, "type", absl::string_view(""), &found));
+}
+
+TEST(TypeCacheTest, FindsOnlyAtInsertedGeneration) {
+  TypeCache cache;
+  const ArtifactType type =
+      ParseTextProtoOrDie<ArtifactType>("id: 1 name: 'type'");
+  cache.InsertType(5, type);
+  cache.InsertParentTypeIds(5, 1, {2});
+
+  ArtifactType found;
+  std::vector<int64> parent_type_ids;
+  EXPECT_FALSE(cache.FindType(6, 1, &found));
+  EXPECT_FALSE(cache.FindType(4, 1, &found));
+  EXPECT_FALSE(cache.FindParentTypeIds(6, 1, &parent_type_ids));
+  ASSERT_TRUE(cache.FindParentTypeIds(5, 1, &parent_type_ids));
+  EXPECT_THAT(parent_type_ids, ElementsAre(2));
+}
+
+TEST(TypeCacheTest, NewerGenerationDropsOlderEntries) {
+  TypeCache cache;
+  cache.InsertType(5, ParseTextProtoOrDie<ArtifactType>("id: 1 name: 'a'"));
+  cache.InsertType(6, ParseTextProtoOrDie<ArtifactType>("id: 2 name: 'b'"));
+  // The entries read at an older generation are not cached.
+  cache.InsertType(5, ParseTextProtoOrDie<ArtifactType>("id: 3 name: 'c'"));
+
+  ArtifactType found;
+  EXPECT_FALSE(cache.FindType(5, 1, &found));
+  EXPECT_FALSE(cache.FindType(5, 3, &found));
+  EXPECT_FALSE(cache.FindType(6, 1, &found));
+  EXPECT_FALSE(cache.FindType(6, 3, &found));
+  EXPECT_TRUE(cache.FindType(6, 2, &found));
+}
+
+TEST(TypeCacheTest, SharesCachePerDatabase) {
+  TypeCache* cache = TypeCache::ForDatabase("db_1");
+  EXPECT_EQ(cache, TypeCache::ForDatabase("db_1"));
+  EXPECT_NE(cache, TypeCache::ForDatabase("db_2"));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -28,7 +28,7 @@ namespace {
 // no-lint to support vc (C2026) 16380 max length for char[].
 const std::string kBaseQueryConfig = absl::StrCat(  // NOLINT
 R"pb(
-  schema_version: 8
+  schema_version: 9
   drop_type_table { query: " DROP TABLE IF EXISTS `Type`; " }
   create_type_table {
     query: " CREATE TABLE IF NOT EXISTS `Type` ( "
@@ -153,6 +153,12 @@ R"pb(
     parameter_num: 1
   }
   select_last_insert_id { query: " SELECT last_insert_rowid(); " }
+  select_first_insert_id {
+    query: " SELECT last_insert_rowid() - changes() + 1; "
+  }
+  # The writes are serialized, so the rows of an insert get consecutive ids.
+  select_consecutive_insert_ids { query: " SELECT 1; " }
+  select_num_changed_rows { query: " SELECT changes(); " }
 )pb",
 R"pb(
   drop_artifact_table { query: " DROP TABLE IF EXISTS `Artifact`; " }
@@ -180,6 +186,13 @@ R"pb(
            ") VALUES($0, $1, $2, $3, $4, $5);"
     parameter_num: 6
   }
+  insert_artifacts {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_artifact_by_id {
     query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
            "        `create_time_since_epoch`, `last_update_time_since_epoch` "
@@ -187,6 +200,11 @@ R"pb(
            " WHERE id IN ($0); "
     parameter_num: 1
   }
+  select_artifact_ids_after_id {
+    query: " SELECT `id` from `Artifact` WHERE `id` > $0 "
+           " ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
+  }
   select_artifact_by_type_id_and_name {
     query: " SELECT `id` from `Artifact` WHERE `type_id` = $0 and `name` = $1; "
     parameter_num: 2
@@ -206,6 +224,17 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 5
   }
+  update_artifact_fields {
+    query: " UPDATE `Artifact` "
+           " SET `uri` = CASE WHEN $3 THEN $4 ELSE `uri` END, "
+           "     `state` = CASE WHEN $5 THEN $6 ELSE `state` END, "
+           "     `last_update_time_since_epoch` = CASE "
+           "       WHEN `last_update_time_since_epoch` < $7 THEN $7 "
+           "       ELSE `last_update_time_since_epoch` + 1 END "
+           " WHERE `id` = $0 AND ($1 IS NULL OR `type_id` = $1) AND "
+           "       ($2 IS NULL OR `last_update_time_since_epoch` = $2); "
+    parameter_num: 8
+  }
   drop_artifact_property_table {
     query: " DROP TABLE IF EXISTS `ArtifactProperty`; "
   }
@@ -231,6 +260,24 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_artifact_properties {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  upsert_artifact_properties {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON CONFLICT (`artifact_id`, `name`, `is_custom_property`) "
+           " DO UPDATE SET `int_value` = excluded.`int_value`, "
+           "     `double_value` = excluded.`double_value`, "
+           "     `string_value` = excluded.`string_value`;"
+    parameter_num: 1
+  }
   select_artifact_property_by_artifact_id {
     query: " SELECT `artifact_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -239,6 +286,16 @@ R"pb(
            " WHERE `artifact_id` IN ($0); "
     parameter_num: 1
   }
+  select_artifacts_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, `uri`, `state`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Artifact` AS N "
+           " LEFT JOIN `ArtifactProperty` AS P ON P.`artifact_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id`; "
+    parameter_num: 1
+  }
   update_artifact_property {
     query: " UPDATE `ArtifactProperty` "
            " SET `$0` = $1 "
@@ -284,6 +341,13 @@ R"pb(
            ") VALUES($0, $1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_executions {
+    query: " INSERT INTO `Execution`( "
+           "   `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_execution_by_id {
     query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
            "        `create_time_since_epoch`, `last_update_time_since_epoch` "
@@ -291,6 +355,11 @@ R"pb(
            " WHERE id IN ($0); "
     parameter_num: 1
   }
+  select_execution_ids_after_id {
+    query: " SELECT `id` from `Execution` WHERE `id` > $0 "
+           " ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
+  }
   select_execution_by_type_id_and_name {
     query: " SELECT `id` from `Execution` WHERE `type_id` = $0 and `name` = $1;"
     parameter_num: 2
@@ -306,6 +375,17 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 4
   }
+  update_execution_fields {
+    query: " UPDATE `Execution` "
+           " SET `last_known_state` = "
+           "       CASE WHEN $3 THEN $4 ELSE `last_known_state` END, "
+           "     `last_update_time_since_epoch` = CASE "
+           "       WHEN `last_update_time_since_epoch` < $5 THEN $5 "
+           "       ELSE `last_update_time_since_epoch` + 1 END "
+           " WHERE `id` = $0 AND ($1 IS NULL OR `type_id` = $1) AND "
+           "       ($2 IS NULL OR `last_update_time_since_epoch` = $2); "
+    parameter_num: 6
+  }
   drop_execution_property_table {
     query: " DROP TABLE IF EXISTS `ExecutionProperty`; "
   }
@@ -331,6 +411,24 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_execution_properties {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  upsert_execution_properties {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON CONFLICT (`execution_id`, `name`, `is_custom_property`) "
+           " DO UPDATE SET `int_value` = excluded.`int_value`, "
+           "     `double_value` = excluded.`double_value`, "
+           "     `string_value` = excluded.`string_value`;"
+    parameter_num: 1
+  }
   select_execution_property_by_execution_id {
     query: " SELECT `execution_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -339,6 +437,16 @@ R"pb(
            " WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
+  select_executions_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, `last_known_state`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Execution` AS N "
+           " LEFT JOIN `ExecutionProperty` AS P ON P.`execution_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id`; "
+    parameter_num: 1
+  }
   update_execution_property {
     query: " UPDATE `ExecutionProperty` "
            " SET `$0` = $1 "
@@ -383,12 +491,24 @@ R"pb(
            ") VALUES($0, $1, $2, $3);"
     parameter_num: 4
   }
+  insert_contexts {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_context_by_id {
     query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
            "        `last_update_time_since_epoch`"
            " from `Context` WHERE id IN ($0); "
     parameter_num: 1
   }
+  select_context_ids_after_id {
+    query: " SELECT `id` from `Context` WHERE `id` > $0 "
+           " ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
+  }
   select_contexts_by_type_id {
     query: " SELECT `id` from `Context` WHERE `type_id` = $0; "
     parameter_num: 1
@@ -404,6 +524,16 @@ R"pb(
            " WHERE id = $0;"
     parameter_num: 4
   }
+  update_context_fields {
+    query: " UPDATE `Context` "
+           " SET `name` = CASE WHEN $3 THEN $4 ELSE `name` END, "
+           "     `last_update_time_since_epoch` = CASE "
+           "       WHEN `last_update_time_since_epoch` < $5 THEN $5 "
+           "       ELSE `last_update_time_since_epoch` + 1 END "
+           " WHERE `id` = $0 AND ($1 IS NULL OR `type_id` = $1) AND "
+           "       ($2 IS NULL OR `last_update_time_since_epoch` = $2); "
+    parameter_num: 6
+  }
   drop_context_property_table {
     query: " DROP TABLE IF EXISTS `ContextProperty`; "
   }
@@ -429,6 +559,24 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_context_properties {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  upsert_context_properties {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON CONFLICT (`context_id`, `name`, `is_custom_property`) "
+           " DO UPDATE SET `int_value` = excluded.`int_value`, "
+           "     `double_value` = excluded.`double_value`, "
+           "     `string_value` = excluded.`string_value`;"
+    parameter_num: 1
+  }
   select_context_property_by_context_id {
     query: " SELECT `context_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -437,6 +585,16 @@ R"pb(
            " WHERE `context_id` IN ($0); "
     parameter_num: 1
   }
+  select_contexts_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Context` AS N "
+           " LEFT JOIN `ContextProperty` AS P ON P.`context_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id`; "
+    parameter_num: 1
+  }
   update_context_property {
     query: " UPDATE `ContextProperty` "
            " SET `$0` = $1 "
@@ -551,6 +709,12 @@ R"pb(
            ") VALUES($0, $2, $3);"
     parameter_num: 4
   }
+  insert_event_paths {
+    query: " INSERT INTO `EventPath`( "
+           "   `event_id`, `is_index_step`, `step_index`, `step_key` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_event_path_by_event_ids {
     query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
            " from `EventPath` "
@@ -636,7 +800,8 @@ R"pb(
   drop_mlmd_env_table { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
   create_mlmd_env_table {
     query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
-           "   `schema_version` INTEGER PRIMARY KEY "
+           "   `schema_version` INTEGER PRIMARY KEY, "
+           "   `type_generation` BIGINT NOT NULL DEFAULT 0 "
            " ); "
   }
   check_mlmd_env_table {
@@ -650,6 +815,16 @@ R"pb(
     query: " UPDATE `MLMDEnv` SET `schema_version` = $0; "
     parameter_num: 1
   }
+  select_type_generation {
+    query: " SELECT `type_generation` FROM `MLMDEnv`; "
+  }
+  increment_type_generation {
+    query: " UPDATE `MLMDEnv` SET `type_generation` = `type_generation` + 1; "
+  }
+  set_type_generation {
+    query: " UPDATE `MLMDEnv` SET `type_generation` = $0; "
+    parameter_num: 1
+  }
   check_tables_in_v0_13_2 {
     query: " SELECT `Type`.`is_artifact_type` from "
            " `Artifact`, `Event`, `Execution`, `Type`, `ArtifactProperty`, "
@@ -2072,6 +2247,53 @@ R"pb(
         }
       }
       db_verification { total_num_indexes: 32 total_num_tables: 15 }
+      # Downgrade from v9.
+      downgrade_queries {
+        query: " CREATE TABLE `MLMDEnvTemp` ( "
+               "   `schema_version` INTEGER PRIMARY KEY "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `MLMDEnvTemp` (`schema_version`) "
+               " SELECT `schema_version` FROM `MLMDEnv`; "
+      }
+      downgrade_queries { query: " DROP TABLE `MLMDEnv`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `MLMDEnvTemp` RENAME TO `MLMDEnv`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND `tbl_name` = 'MLMDEnv' AND "
+                 "       `sql` NOT LIKE '%type_generation%'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v9, we added `type_generation` to `MLMDEnv`, which is incremented by
+  # each change of the types, so that the types can be cached. It starts from
+  # the time of the upgrade in microseconds, above the generations cached
+  # before a downgrade.
+  migration_schemes {
+    key: 9
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` "
+               " ADD COLUMN `type_generation` BIGINT NOT NULL DEFAULT 0; "
+      }
+      upgrade_queries {
+        query: " UPDATE `MLMDEnv` SET `type_generation` = "
+               "     CAST(strftime('%s', 'now') AS INTEGER) * 1000000; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `MLMDEnv` "
+                 " WHERE `type_generation` <= 0; "
+        }
+      }
+      db_verification { total_num_indexes: 32 total_num_tables: 15 }
     }
   }
 )pb");
@@ -2082,6 +2304,48 @@ const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
 R"pb(
   metadata_source_type: MYSQL_METADATA_SOURCE
   select_last_insert_id { query: " SELECT last_insert_id(); " }
+  select_first_insert_id { query: " SELECT last_insert_id(); " }
+  # The ids of the rows of an insert are consecutive if they are incremented
+  # by one, and InnoDB allocates them at once, i.e., unless its lock mode is
+  # interleaved (2), the default of MySQL 8.0.
+  select_consecutive_insert_ids {
+    query: " SELECT @@auto_increment_increment = 1 AND "
+           "        @@innodb_autoinc_lock_mode <> 2; "
+  }
+  select_num_changed_rows { query: " SELECT ROW_COUNT(); " }
+  # The upserts refer to the inserted rows with the VALUES() function. It is
+  # deprecated since MySQL 8.0.20 in favor of row aliases, which MySQL 5.6, 5.7
+  # and 8.0 before 8.0.19 reject, while all of them accept VALUES().
+  upsert_artifact_properties {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `int_value` = VALUES(`int_value`), "
+           "     `double_value` = VALUES(`double_value`), "
+           "     `string_value` = VALUES(`string_value`);"
+    parameter_num: 1
+  }
+  upsert_execution_properties {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `int_value` = VALUES(`int_value`), "
+           "     `double_value` = VALUES(`double_value`), "
+           "     `string_value` = VALUES(`string_value`);"
+    parameter_num: 1
+  }
+  upsert_context_properties {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `int_value` = VALUES(`int_value`), "
+           "     `double_value` = VALUES(`double_value`), "
+           "     `string_value` = VALUES(`string_value`);"
+    parameter_num: 1
+  }
   select_type_by_name {
     query: " SELECT `id`, `name`, `version`, `description`, "
            "        `input_type`, `output_type` FROM `Type` "
@@ -2119,6 +2383,39 @@ R"pb(
            " LOCK IN SHARE MODE; "
     parameter_num: 1
   }
+  select_artifacts_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, `uri`, `state`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Artifact` AS N "
+           " LEFT JOIN `ArtifactProperty` AS P ON P.`artifact_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id` "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+  select_executions_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, `last_known_state`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Execution` AS N "
+           " LEFT JOIN `ExecutionProperty` AS P ON P.`execution_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id` "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+  select_contexts_with_properties_by_id {
+    query: " SELECT `id`, `type_id`, N.`name` AS `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch`, "
+           "        P.`name` AS `property_name`, `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " FROM `Context` AS N "
+           " LEFT JOIN `ContextProperty` AS P ON P.`context_id` = N.`id` "
+           " WHERE N.`id` IN ($0) ORDER BY N.`id` "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
   select_parent_type_by_type_id {
     query: " SELECT `type_id`, `parent_type_id` "
            " FROM `ParentType` WHERE type_id IN ($0) "
@@ -3513,6 +3810,44 @@ R"pb(
         }
       }
       db_verification { total_num_indexes: 74 total_num_tables: 15 }
+      # Downgrade from v9.
+      downgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` DROP COLUMN `type_generation`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'MLMDEnv' AND "
+                 "       `column_name` = 'type_generation'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v9, we added `type_generation` to `MLMDEnv`, which is incremented by
+  # each change of the types, so that the types can be cached. It starts from
+  # the time of the upgrade in microseconds, above the generations cached
+  # before a downgrade.
+  migration_schemes {
+    key: 9
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` "
+               " ADD COLUMN `type_generation` BIGINT NOT NULL DEFAULT 0; "
+      }
+      upgrade_queries {
+        query: " UPDATE `MLMDEnv` "
+               " SET `type_generation` = UNIX_TIMESTAMP() * 1000000; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `MLMDEnv` "
+                 " WHERE `type_generation` <= 0; "
+        }
+      }
+      db_verification { total_num_indexes: 74 total_num_tables: 15 }
     }
   }
 )pb");